@@ -42,9 +42,9 @@
 #include <fp_shape.h>
 #include <class_zone.h>
 #include <convert_basic_shapes_to_polygon.h>
+#include <thread_pool.h>
 #include <trigo.h>
 #include <vector>
-#include <thread>
 #include <algorithm>
 #include <atomic>
 
@@ -712,12 +712,13 @@ void BOARD_ADAPTER::createLayers( REPORTER* aStatusReporter )
         // Add zones objects
         // /////////////////////////////////////////////////////////////////////
         std::atomic<size_t> nextZone( 0 );
-        std::atomic<size_t> threadsFinished( 0 );
+        THREAD_POOL&        tp = GetKiCadThreadPool();
+        std::vector<std::future<void>> returns;
 
-        size_t parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
+        size_t parallelThreadCount = tp.GetThreadCount();
         for( size_t ii = 0; ii < parallelThreadCount; ++ii )
         {
-            std::thread t = std::thread( [&]()
+            returns.push_back( tp.Submit( [&]()
             {
                 for( size_t areaId = nextZone.fetch_add( 1 );
                             areaId < zones.size();
@@ -735,15 +736,10 @@ void BOARD_ADAPTER::createLayers( REPORTER* aStatusReporter )
                     if( layerContainer != m_layers_container2D.end() )
                         AddSolidAreasShapesToContainer( zone, layerContainer->second, layer );
                 }
-
-                threadsFinished++;
-            } );
-
-            t.detach();
+            } ) );
         }
 
-        while( threadsFinished < parallelThreadCount )
-            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        tp.WaitAll( returns );
 
     }
 
@@ -814,14 +810,15 @@ void BOARD_ADAPTER::createLayers( REPORTER* aStatusReporter )
         if( selected_layer_id.size() > 0 )
         {
             std::atomic<size_t> nextItem( 0 );
-            std::atomic<size_t> threadsFinished( 0 );
+            THREAD_POOL&        tp = GetKiCadThreadPool();
+            std::vector<std::future<void>> returns;
 
             size_t parallelThreadCount = std::min<size_t>(
-                    std::max<size_t>( std::thread::hardware_concurrency(), 2 ),
+                    tp.GetThreadCount(),
                     selected_layer_id.size() );
             for( size_t ii = 0; ii < parallelThreadCount; ++ii )
             {
-                std::thread t = std::thread( [&nextItem, &threadsFinished, &selected_layer_id, this]()
+                returns.push_back( tp.Submit( [&nextItem, &selected_layer_id, this]()
                 {
                     for( size_t i = nextItem.fetch_add( 1 );
                                 i < selected_layer_id.size();
@@ -833,15 +830,10 @@ void BOARD_ADAPTER::createLayers( REPORTER* aStatusReporter )
                             // This will make a union of all added contours
                             layerPoly->second->Simplify( SHAPE_POLY_SET::PM_FAST );
                     }
-
-                    threadsFinished++;
-                } );
-
-                t.detach();
+                } ) );
             }
 
-            while( threadsFinished < parallelThreadCount )
-                std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+            tp.WaitAll( returns );
         }
     }
 
@@ -32,7 +32,6 @@
 #include <atomic>
 #include <chrono>
 #include <climits>
-#include <thread>
 
 #include "c3d_render_raytracing.h"
 #include "mortoncodes.h"
@@ -40,6 +39,7 @@
 #include "3d_fastmath.h"
 #include "3d_math.h"
 #include "../common_ogl/ogl_utils.h"
+#include <thread_pool.h>
 #include <profile.h>        // To use GetRunningMicroSecs or another profiling utility
 
 // This should be used in future for the function
@@ -371,14 +371,15 @@ void C3D_RENDER_RAYTRACING::rt_render_tracing( GLubyte* ptrPBO ,
 
     std::atomic<size_t> numBlocksRendered( 0 );
     std::atomic<size_t> currentBlock( 0 );
-    std::atomic<size_t> threadsFinished( 0 );
+    THREAD_POOL&        tp = GetKiCadThreadPool();
+    std::vector<std::future<void>> returns;
 
     size_t parallelThreadCount = std::min<size_t>(
-            std::max<size_t>( std::thread::hardware_concurrency(), 2 ),
+            tp.GetThreadCount(),
             m_blockPositions.size() );
     for( size_t ii = 0; ii < parallelThreadCount; ++ii )
     {
-        std::thread t = std::thread( [&]()
+        returns.push_back( tp.Submit( [&]()
         {
             for( size_t iBlock = currentBlock.fetch_add( 1 );
                         iBlock < m_blockPositions.size() && !breakLoop;
@@ -397,15 +398,10 @@ void C3D_RENDER_RAYTRACING::rt_render_tracing( GLubyte* ptrPBO ,
                         breakLoop = true;
                 }
             }
-
-            threadsFinished++;
-        } );
-
-        t.detach();
+        } ) );
     }
 
-    while( threadsFinished < parallelThreadCount )
-        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    tp.WaitAll( returns );
 
     m_nrBlocksRenderProgress += numBlocksRendered;
 
@@ -919,12 +915,13 @@ void C3D_RENDER_RAYTRACING::rt_render_post_process_shade( GLubyte* ptrPBO,
         m_postshader_ssao.SetShadowsEnabled( m_boardAdapter.GetFlag( FL_RENDER_RAYTRACING_SHADOWS ) );
 
         std::atomic<size_t> nextBlock( 0 );
-        std::atomic<size_t> threadsFinished( 0 );
+        THREAD_POOL&        tp = GetKiCadThreadPool();
+        std::vector<std::future<void>> returns;
 
-        size_t parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
+        size_t parallelThreadCount = tp.GetThreadCount();
         for( size_t ii = 0; ii < parallelThreadCount; ++ii )
         {
-            std::thread t = std::thread( [&]()
+            returns.push_back( tp.Submit( [&]()
             {
                 for( size_t y = nextBlock.fetch_add( 1 );
                             y < m_realBufferSize.y;
@@ -938,15 +935,10 @@ void C3D_RENDER_RAYTRACING::rt_render_post_process_shade( GLubyte* ptrPBO,
                         ptr++;
                     }
                 }
-
-                threadsFinished++;
-            } );
-
-            t.detach();
+            } ) );
         }
 
-        while( threadsFinished < parallelThreadCount )
-            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        tp.WaitAll( returns );
 
         m_postshader_ssao.SetShadedBuffer( m_shaderBuffer );
 
@@ -970,12 +962,13 @@ void C3D_RENDER_RAYTRACING::rt_render_post_process_blur_finish( GLubyte *ptrPBO,
     {
         // Now blurs the shader result and compute the final color
         std::atomic<size_t> nextBlock( 0 );
-        std::atomic<size_t> threadsFinished( 0 );
+        THREAD_POOL&        tp = GetKiCadThreadPool();
+        std::vector<std::future<void>> returns;
 
-        size_t parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
+        size_t parallelThreadCount = tp.GetThreadCount();
         for( size_t ii = 0; ii < parallelThreadCount; ++ii )
         {
-            std::thread t = std::thread( [&]()
+            returns.push_back( tp.Submit( [&]()
             {
                 for( size_t y = nextBlock.fetch_add( 1 );
                             y < m_realBufferSize.y;
@@ -999,15 +992,10 @@ void C3D_RENDER_RAYTRACING::rt_render_post_process_blur_finish( GLubyte *ptrPBO,
                         ptr += 4;
                     }
                 }
-
-                threadsFinished++;
-            } );
-
-            t.detach();
+            } ) );
         }
 
-        while( threadsFinished < parallelThreadCount )
-            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        tp.WaitAll( returns );
 
 
         // Debug code
@@ -1024,14 +1012,15 @@ void C3D_RENDER_RAYTRACING::render_preview( GLubyte *ptrPBO )
     m_isPreview = true;
 
     std::atomic<size_t> nextBlock( 0 );
-    std::atomic<size_t> threadsFinished( 0 );
+    THREAD_POOL&        tp = GetKiCadThreadPool();
+    std::vector<std::future<void>> returns;
 
     size_t parallelThreadCount = std::min<size_t>(
-            std::max<size_t>( std::thread::hardware_concurrency(), 2 ),
+            tp.GetThreadCount(),
             m_blockPositions.size() );
     for( size_t ii = 0; ii < parallelThreadCount; ++ii )
     {
-        std::thread t = std::thread( [&]()
+        returns.push_back( tp.Submit( [&]()
         {
             for( size_t iBlock = nextBlock.fetch_add( 1 );
                         iBlock < m_blockPositionsFast.size();
@@ -1637,15 +1626,10 @@ void C3D_RENDER_RAYTRACING::render_preview( GLubyte *ptrPBO )
                     }
                 }
             }
-
-            threadsFinished++;
-        } );
-
-        t.detach();
+        } ) );
     }
 
-    while( threadsFinished < parallelThreadCount )
-        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    tp.WaitAll( returns );
 }
 
 
@@ -30,11 +30,10 @@
 #include "cimage.h"
 #include "buffers_debug.h"
 #include <cstring> // For memcpy
+#include <thread_pool.h>
 
 #include <algorithm>
 #include <atomic>
-#include <thread>
-#include <chrono>
 
 #ifndef CLAMP
 #define CLAMP(n, min, max) {if( n < min ) n=min; else if( n > max ) n = max;}
@@ -477,13 +476,14 @@ void CIMAGE::EfxFilter( CIMAGE* aInImg, IMAGE_FILTER aFilterType )
     m_wraping         = IMAGE_WRAP::CLAMP;
 
     std::atomic<size_t> nextRow( 0 );
-    std::atomic<size_t> threadsFinished( 0 );
+    THREAD_POOL&        tp = GetKiCadThreadPool();
+    std::vector<std::future<void>> returns;
 
-    size_t parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
+    size_t parallelThreadCount = tp.GetThreadCount();
 
     for( size_t ii = 0; ii < parallelThreadCount; ++ii )
     {
-        std::thread t = std::thread( [&]()
+        returns.push_back( tp.Submit( [&]()
         {
             for( size_t iy = nextRow.fetch_add( 1 );
                         iy < m_height;
@@ -512,15 +512,10 @@ void CIMAGE::EfxFilter( CIMAGE* aInImg, IMAGE_FILTER aFilterType )
                     m_pixels[ix + iy * m_width] = v;
                 }
             }
-
-            threadsFinished++;
-        } );
-
-        t.detach();
+        } ) );
     }
 
-    while( threadsFinished < parallelThreadCount )
-        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    tp.WaitAll( returns );
 }
 
 
@@ -99,5 +99,5 @@ PGM_BASE& Pgm()
 
 bool IFACE::OnKifaceStart( PGM_BASE* aProgram, int aCtlBits )
 {
-    return start_common( aCtlBits );
+    return start_common( aProgram, aCtlBits );
 }
@@ -141,6 +141,31 @@ static const wxChar DebugZoneFiller[] = wxT( "DebugZoneFiller" );
 
 static const wxChar SkipBoundingBoxFpLoad[] = wxT( "SkipBoundingBoxFpLoad" );
 
+/**
+ * Caps the number of worker threads in the shared thread pool used for zone filling,
+ * connectivity, 3D rendering, etc.  0 uses one thread per hardware thread.
+ */
+static const wxChar MaximumThreads[] = wxT( "MaximumThreads" );
+
+/**
+ * Parses the tracks, footprints, zones, etc. of a board file on the shared thread pool.  Turn
+ * off to load boards on the loading thread only.
+ */
+static const wxChar ParallelBoardLoad[] = wxT( "ParallelBoardLoad" );
+
+/**
+ * Keeps a cache of zone fill data (triangulations, raw fills and what they were built from)
+ * next to saved boards, so that reopening them doesn't have to rebuild it.
+ */
+static const wxChar ZoneFillCache[] = wxT( "ZoneFillCache" );
+
+/**
+ * Merge the clearance holes of zone fills by groups, in parallel.  Much faster on large
+ * boards, but intersections are rounded differently, so fills are not vertex-for-vertex the
+ * same as with a single merge.
+ */
+static const wxChar ZoneFillMergeByGroups[] = wxT( "ZoneFillMergeByGroups" );
+
 } // namespace KEYS
 
 
@@ -240,6 +265,14 @@ ADVANCED_CFG::ADVANCED_CFG()
 
     m_SkipBoundingBoxOnFpLoad   = false;
 
+    m_MaximumThreads            = 0;
+
+    m_ParallelBoardLoad         = true;
+
+    m_ZoneFillCache             = false;
+
+    m_ZoneFillMergeByGroups     = false;
+
     loadFromConfigFile();
 }
 
@@ -320,6 +353,18 @@ void ADVANCED_CFG::loadSettings( wxConfigBase& aCfg )
     configParams.push_back( new PARAM_CFG_BOOL( true, AC_KEYS::SkipBoundingBoxFpLoad,
                                                 &m_SkipBoundingBoxOnFpLoad, false ) );
 
+    configParams.push_back( new PARAM_CFG_INT( true, AC_KEYS::MaximumThreads,
+                                               &m_MaximumThreads, 0, 0, 500 ) );
+
+    configParams.push_back( new PARAM_CFG_BOOL( true, AC_KEYS::ParallelBoardLoad,
+                                                &m_ParallelBoardLoad, true ) );
+
+    configParams.push_back( new PARAM_CFG_BOOL( true, AC_KEYS::ZoneFillCache,
+                                                &m_ZoneFillCache, false ) );
+
+    configParams.push_back( new PARAM_CFG_BOOL( true, AC_KEYS::ZoneFillMergeByGroups,
+                                                &m_ZoneFillMergeByGroups, false ) );
+
     wxConfigLoadSetups( &aCfg, configParams );
 
     for( PARAM_CFG* param : configParams )
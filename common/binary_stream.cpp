@@ -0,0 +1,122 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include <binary_stream.h>
+
+
+void BINARY_STREAM_WRITER::WriteHeader( const std::string& aMagic, uint32_t aVersion )
+{
+    WriteString( aMagic );
+    Write<uint32_t>( aVersion );
+}
+
+
+void BINARY_STREAM_WRITER::WriteString( const std::string& aString )
+{
+    Write<uint32_t>( aString.size() );
+    m_data.insert( m_data.end(), aString.begin(), aString.end() );
+}
+
+
+bool BINARY_STREAM_WRITER::WriteFile( const wxString& aFileName ) const
+{
+    wxFileName tempFile( aFileName );
+    tempFile.SetFullName( wxT( "." ) + tempFile.GetFullName() + wxT( "$" ) );
+
+    {
+        wxFFile file( tempFile.GetFullPath(), "wb" );
+
+        if( !file.IsOpened() )
+            return false;
+
+        if( file.Write( m_data.data(), m_data.size() ) != m_data.size() || !file.Close() )
+        {
+            file.Close();
+            wxRemoveFile( tempFile.GetFullPath() );
+            return false;
+        }
+    }
+
+    if( !wxRenameFile( tempFile.GetFullPath(), aFileName ) )
+    {
+        wxRemoveFile( tempFile.GetFullPath() );
+        return false;
+    }
+
+    return true;
+}
+
+
+bool BINARY_STREAM_READER::ReadFile( const wxString& aFileName )
+{
+    m_data.clear();
+    m_pos = 0;
+    m_ok = false;
+
+    if( !wxFileName::FileExists( aFileName ) )
+        return false;
+
+    wxFFile file( aFileName, "rb" );
+
+    if( !file.IsOpened() || file.Length() <= 0 )
+        return false;
+
+    m_data.resize( file.Length() );
+
+    if( file.Read( m_data.data(), m_data.size() ) != m_data.size() )
+    {
+        m_data.clear();
+        return false;
+    }
+
+    m_ok = true;
+    return true;
+}
+
+
+bool BINARY_STREAM_READER::ReadHeader( const std::string& aMagic, uint32_t aVersion )
+{
+    if( ReadString() != aMagic || Read<uint32_t>() != aVersion )
+        m_ok = false;
+
+    return m_ok;
+}
+
+
+std::string BINARY_STREAM_READER::ReadString()
+{
+    uint32_t size = Read<uint32_t>();
+
+    if( !m_ok || m_data.size() - m_pos < size )
+    {
+        m_ok = false;
+        return std::string();
+    }
+
+    std::string str( m_data.data() + m_pos, size );
+    m_pos += size;
+    return str;
+}
@@ -27,6 +27,7 @@
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>         // bsearch()
+#include <cstring>
 #include <cctype>
 
 #include <dsnlexer.h>
@@ -36,6 +37,21 @@
 
 //-----<DSNLEXER>-------------------------------------------------------------
 
+/// FNV-1a, as in hashtables.h, but over a counted range so that tokens needn't be terminated.
+static inline unsigned hashKeyword( const char* aText, size_t aLength )
+{
+    unsigned hash = 2166136261u;
+
+    for( size_t ii = 0; ii < aLength; ++ii )
+    {
+        hash ^= (unsigned char) aText[ii];
+        hash *= 16777619;
+    }
+
+    return hash;
+}
+
+
 void DSNLEXER::init()
 {
     curTok  = DSN_NONE;
@@ -49,22 +65,28 @@ void DSNLEXER::init()
 
     curOffset = 0;
 
-#if 1
-    if( keywordCount > 11 )
-    {
-        // resize the hashtable bucket count
-        keyword_hash.reserve( keywordCount );
-    }
+    // Build an open addressed hash table over keywords[].  It is kept at most half full so
+    // that probe sequences stay short.
+    unsigned slotCount = 16;
+
+    while( slotCount < keywordCount * 2 )
+        slotCount *= 2;
+
+    keywordSlots.assign( slotCount, nullptr );
+    keywordMask = slotCount - 1;
 
-    // fill the specialized "C string" hashtable from keywords[]
     const KEYWORD*  it  = keywords;
     const KEYWORD*  end = it + keywordCount;
 
     for( ; it < end; ++it )
     {
-        keyword_hash[it->name] = it->token;
+        unsigned slot = hashKeyword( it->name, strlen( it->name ) ) & keywordMask;
+
+        while( keywordSlots[slot] )
+            slot = ( slot + 1 ) & keywordMask;
+
+        keywordSlots[slot] = it;
     }
-#endif
 }
 
 
@@ -227,10 +249,15 @@ LINE_READER* DSNLEXER::PopReader()
 
 int DSNLEXER::findToken( const std::string& tok )
 {
-    KEYWORD_MAP::const_iterator it = keyword_hash.find( tok.c_str() );
+    unsigned slot = hashKeyword( tok.data(), tok.size() ) & keywordMask;
+
+    while( const KEYWORD* kw = keywordSlots[slot] )
+    {
+        if( !strncmp( kw->name, tok.data(), tok.size() ) && kw->name[tok.size()] == '\0' )
+            return kw->token;
 
-    if( it != keyword_hash.end() )
-        return it->second;
+        slot = ( slot + 1 ) & keywordMask;
+    }
 
     return DSN_SYMBOL;      // not a keyword, some arbitrary symbol.
 }
@@ -665,7 +692,15 @@ L_read:
                 }
 
                 else
-                    curText += *head++;
+                {
+                    // copy the run of plain characters up to the next escape or quote
+                    const char* run = head;
+
+                    while( head < limit && *head != '\\' && *head != '"' )
+                        ++head;
+
+                    curText.append( run, head );
+                }
 
             }   // while
 
@@ -746,11 +781,12 @@ L_read:
     }           // specctraMode
 
     // non-quoted token, read it into curText.
-    curText.clear();
-
     head = cur;
+
     while( head<limit && !isSep( *head ) )
-        curText += *head++;
+        ++head;
+
+    curText.assign( cur, head );
 
     if( isNumber( curText.c_str(), curText.c_str() + curText.size() ) )
     {
@@ -797,3 +833,67 @@ wxArrayString* DSNLEXER::ReadCommentLines()
 
     return ret;
 }
+
+
+void DSNLEXER::CaptureCurrentList( std::string& aText )
+{
+    wxASSERT( !specctraMode );
+
+    const char* cur = start + curOffset;
+    int         depth = 1;
+
+    aText += '(';
+
+    while( true )
+    {
+        const char* head = cur;
+        bool        inString = false;
+
+        // Quoted strings cannot span lines, nor can comments follow other tokens on a line
+        while( head < limit && isSpace( *head ) )
+            ++head;
+
+        if( head < limit && *head == '#' )
+            head = limit;
+
+        for( ; head < limit; ++head )
+        {
+            if( inString )
+            {
+                if( *head == '\\' && head + 1 < limit )
+                    ++head;
+                else if( *head == '"' )
+                    inString = false;
+            }
+            else if( *head == '"' )
+            {
+                inString = true;
+            }
+            else if( *head == '(' )
+            {
+                ++depth;
+            }
+            else if( *head == ')' && --depth == 0 )
+            {
+                aText.append( cur, head + 1 );
+
+                prevTok   = curTok;
+                curTok    = DSN_RIGHT;
+                curText   = ")";
+                curOffset = head - start;
+                next      = head + 1;
+                return;
+            }
+        }
+
+        aText.append( cur, limit );
+
+        if( readLine() == 0 )
+        {
+            THROW_PARSE_ERROR( _( "Unexpected end of file" ), CurSource(), CurLine(),
+                               CurLineNumber(), CurOffset() );
+        }
+
+        cur = start;
+    }
+}
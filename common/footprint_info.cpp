@@ -40,7 +40,6 @@
 #include <thread>
 #include <utility>
 #include <wildcards_and_files_ext.h>
-#include <wx/textfile.h>
 
 
 FOOTPRINT_INFO* FOOTPRINT_LIST::GetModuleInfo( const wxString& aLibNickname,
@@ -153,8 +152,7 @@ FOOTPRINT_LIST* FOOTPRINT_LIST::GetInstance( KIWAY& aKiway )
 
     if( !footprintInfo->GetCount() )
     {
-        wxTextFile footprintInfoCache( aKiway.Prj().GetProjectPath() + "fp-info-cache" );
-        footprintInfo->ReadCacheFromFile( &footprintInfoCache );
+        footprintInfo->ReadCacheFromFile( aKiway.Prj().GetProjectPath() + "fp-info-cache" );
     }
 
     return footprintInfo;
@@ -43,119 +43,37 @@ const double STROKE_FONT::STROKE_FONT_SCALE = 1.0 / 21.0;
 const double STROKE_FONT::ITALIC_TILT = 1.0 / 8;
 
 
-GLYPH_LIST*         g_newStrokeFontGlyphs = nullptr;     ///< Glyph list
-std::vector<BOX2D>* g_newStrokeFontGlyphBoundingBoxes;   ///< Bounding boxes of the glyphs
+// FONT_OFFSET is here for historical reasons, due to the way the stroke font was built. It allows
+// shapes coordinates like W M ... to be >= 0. Only shapes like j y have coordinates < 0
+static const int FONT_OFFSET = -10;
 
 
 STROKE_FONT::STROKE_FONT( GAL* aGal ) :
-    m_gal( aGal ), m_glyphs( nullptr ), m_glyphBoundingBoxes( nullptr )
+    m_gal( aGal ), m_glyphs( nullptr ), m_glyphCount( 0 )
 {
 }
 
 
 bool STROKE_FONT::LoadNewStrokeFont( const char* const aNewStrokeFont[], int aNewStrokeFontSize )
 {
-    if( g_newStrokeFontGlyphs )
-    {
-        m_glyphs = g_newStrokeFontGlyphs;
-        m_glyphBoundingBoxes = g_newStrokeFontGlyphBoundingBoxes;
-        return true;
-    }
+    m_glyphs = aNewStrokeFont;
+    m_glyphCount = aNewStrokeFontSize;
+    return true;
+}
 
-    g_newStrokeFontGlyphs = new GLYPH_LIST;
-    g_newStrokeFontGlyphs->reserve( aNewStrokeFontSize );
 
-    g_newStrokeFontGlyphBoundingBoxes = new std::vector<BOX2D>;
-    g_newStrokeFontGlyphBoundingBoxes->reserve( aNewStrokeFontSize );
+const char* STROKE_FONT::getGlyph( int aChar ) const
+{
+    // Index into the glyph table
+    int dd = aChar - ' ';
 
-    for( int j = 0; j < aNewStrokeFontSize; j++ )
+    if( dd >= m_glyphCount || dd < 0 )
     {
-        GLYPH*   glyph = new GLYPH;
-        double   glyphStartX = 0.0;
-        double   glyphEndX = 0.0;
-        double   glyphWidth = 0.0;
-
-        std::vector<VECTOR2D>* pointList = nullptr;
-
-        int strokes = 0;
-        int i = 0;
-
-        while( aNewStrokeFont[j][i] )
-        {
-
-            if( aNewStrokeFont[j][i] == ' ' && aNewStrokeFont[j][i+1] == 'R' )
-                strokes++;
-
-            i += 2;
-        }
-
-        glyph->reserve( strokes + 1 );
-
-        i = 0;
-
-        while( aNewStrokeFont[j][i] )
-        {
-            VECTOR2D    point( 0.0, 0.0 );
-            char        coordinate[2] = { 0, };
-
-            for( int k : { 0, 1 } )
-                coordinate[k] = aNewStrokeFont[j][i + k];
-
-            if( i < 2 )
-            {
-                // The first two values contain the width of the char
-                glyphStartX = ( coordinate[0] - 'R' ) * STROKE_FONT_SCALE;
-                glyphEndX   = ( coordinate[1] - 'R' ) * STROKE_FONT_SCALE;
-                glyphWidth  = glyphEndX - glyphStartX;
-            }
-            else if( ( coordinate[0] == ' ' ) && ( coordinate[1] == 'R' ) )
-            {
-                if( pointList )
-                    pointList->shrink_to_fit();
-
-                // Raise pen
-                pointList = nullptr;
-            }
-            else
-            {
-                // In stroke font, coordinates values are coded as <value> + 'R',
-                // <value> is an ASCII char.
-                // therefore every coordinate description of the Hershey format has an offset,
-                // it has to be subtracted
-                // Note:
-                //  * the stroke coordinates are stored in reduced form (-1.0 to +1.0),
-                //    and the actual size is stroke coordinate * glyph size
-                //  * a few shapes have a height slightly bigger than 1.0 ( like '{' '[' )
-                point.x = (double) ( coordinate[0] - 'R' ) * STROKE_FONT_SCALE - glyphStartX;
-                #define FONT_OFFSET -10
-                // FONT_OFFSET is here for historical reasons, due to the way the stroke font
-                // was built. It allows shapes coordinates like W M ... to be >= 0
-                // Only shapes like j y have coordinates < 0
-                point.y = (double) ( coordinate[1] - 'R' + FONT_OFFSET ) * STROKE_FONT_SCALE;
-
-                if( !pointList )
-                {
-                    pointList = new std::vector<VECTOR2D>;
-                    glyph->push_back( pointList );
-                }
-
-                pointList->push_back( point );
-            }
-
-            i += 2;
-        }
-
-        if( pointList )
-            pointList->shrink_to_fit();
-
-        // Compute the bounding box of the glyph
-        g_newStrokeFontGlyphBoundingBoxes->emplace_back( computeBoundingBox( glyph, glyphWidth ) );
-        g_newStrokeFontGlyphs->push_back( glyph );
+        int substitute = aChar == '\t' ? ' ' : '?';
+        dd = substitute - ' ';
     }
 
-    m_glyphs = g_newStrokeFontGlyphs;
-    m_glyphBoundingBoxes = g_newStrokeFontGlyphBoundingBoxes;
-    return true;
+    return m_glyphs[dd];
 }
 
 
@@ -168,24 +86,6 @@ double STROKE_FONT::GetInterline( double aGlyphHeight )
 }
 
 
-BOX2D STROKE_FONT::computeBoundingBox( const GLYPH* aGLYPH, double aGlyphWidth ) const
-{
-    VECTOR2D min( 0, 0 );
-    VECTOR2D max( aGlyphWidth, 0 );
-
-    for( const std::vector<VECTOR2D>* pointList : *aGLYPH )
-    {
-        for( const VECTOR2D& point : *pointList )
-        {
-            min.y = std::min( min.y, point.y );
-            max.y = std::max( max.y, point.y );
-        }
-    }
-
-    return BOX2D( min, max - min );
-}
-
-
 void STROKE_FONT::Draw( const UTF8& aText, const VECTOR2D& aPosition, double aRotationAngle )
 {
     if( aText.empty() )
@@ -340,7 +240,7 @@ void STROKE_FONT::drawSingleLineText( const UTF8& aText )
         // The choice of spaces is somewhat arbitrary but sufficient for aligning text
         if( *chIt == '\t' )
         {
-            double space = glyphSize.x * m_glyphBoundingBoxes->at( 0 ).GetEnd().x;
+            double space = glyphSize.x * glyphWidth( m_glyphs[0] );
 
             // We align to the 4th column (fmod) but only need to account for 3 of
             // the four spaces here with the extra.  This ensures that we have at
@@ -408,23 +308,14 @@ void STROKE_FONT::drawSingleLineText( const UTF8& aText )
             continue;
         }
 
-        // Index into bounding boxes table
-        int dd = (signed) *chIt - ' ';
-
-        if( dd >= (int) m_glyphBoundingBoxes->size() || dd < 0 )
-        {
-            int substitute = *chIt == '\t' ? ' ' : '?';
-            dd = substitute - ' ';
-        }
-
-        const GLYPH* glyph = m_glyphs->at( dd );
-        const BOX2D& bbox  = m_glyphBoundingBoxes->at( dd );
+        const char* glyph = getGlyph( *chIt );
+        double      glyphAdvance = glyphWidth( glyph );
 
         if( in_overbar )
         {
             double overbar_start_x = xOffset;
             double overbar_start_y = - computeOverbarVerticalPosition();
-            double overbar_end_x = xOffset + glyphSize.x * bbox.GetEnd().x;
+            double overbar_end_x = xOffset + glyphSize.x * glyphAdvance;
             double overbar_end_y = overbar_start_y;
 
             if( !last_had_overbar )
@@ -449,36 +340,51 @@ void STROKE_FONT::drawSingleLineText( const UTF8& aText )
         {
             double   vOffset = computeUnderlineVerticalPosition();
             VECTOR2D startUnderline( xOffset, - vOffset );
-            VECTOR2D endUnderline( xOffset + glyphSize.x * bbox.GetEnd().x, - vOffset );
+            VECTOR2D endUnderline( xOffset + glyphSize.x * glyphAdvance, - vOffset );
 
             m_gal->DrawLine( startUnderline, endUnderline );
         }
 
-        for( const std::vector<VECTOR2D>* ptList : *glyph )
-        {
-            std::deque<VECTOR2D> ptListScaled;
+        // The glyph points are decoded on the fly, and each stroke drawn when the pen is raised
+        double               glyphStartX = ( glyph[0] - 'R' ) * STROKE_FONT_SCALE;
+        std::deque<VECTOR2D> ptListScaled;
 
-            for( const VECTOR2D& pt : *ptList )
+        for( const char* coord = glyph + 2; ; coord += 2 )
+        {
+            if( !coord[0] || ( coord[0] == ' ' && coord[1] == 'R' ) )
             {
-                VECTOR2D scaledPt( pt.x * glyphSize.x + xOffset, pt.y * glyphSize.y + yOffset );
+                if( !ptListScaled.empty() )
+                    m_gal->DrawPolyline( ptListScaled );
 
-                if( m_gal->IsFontItalic() )
-                {
-                    // FIXME should be done other way - referring to the lowest Y value of point
-                    // because now italic fonts are translated a bit
-                    if( m_gal->IsTextMirrored() )
-                        scaledPt.x += scaledPt.y * STROKE_FONT::ITALIC_TILT;
-                    else
-                        scaledPt.x -= scaledPt.y * STROKE_FONT::ITALIC_TILT;
-                }
-
-                ptListScaled.push_back( scaledPt );
+                ptListScaled.clear();
+
+                if( !coord[0] )
+                    break;
+
+                continue;
+            }
+
+            // In stroke font, coordinates values are coded as <value> + 'R', <value> is an
+            // ASCII char. The stroke coordinates are stored in reduced form (-1.0 to +1.0),
+            // and the actual size is stroke coordinate * glyph size
+            VECTOR2D pt( (double) ( coord[0] - 'R' ) * STROKE_FONT_SCALE - glyphStartX,
+                         (double) ( coord[1] - 'R' + FONT_OFFSET ) * STROKE_FONT_SCALE );
+            VECTOR2D scaledPt( pt.x * glyphSize.x + xOffset, pt.y * glyphSize.y + yOffset );
+
+            if( m_gal->IsFontItalic() )
+            {
+                // FIXME should be done other way - referring to the lowest Y value of point
+                // because now italic fonts are translated a bit
+                if( m_gal->IsTextMirrored() )
+                    scaledPt.x += scaledPt.y * STROKE_FONT::ITALIC_TILT;
+                else
+                    scaledPt.x -= scaledPt.y * STROKE_FONT::ITALIC_TILT;
             }
 
-            m_gal->DrawPolyline( ptListScaled );
+            ptListScaled.push_back( scaledPt );
         }
 
-        xOffset += glyphSize.x * bbox.GetEnd().x;
+        xOffset += glyphSize.x * glyphAdvance;
     }
 
     m_gal->Restore();
@@ -539,7 +445,7 @@ VECTOR2D STROKE_FONT::ComputeStringBoundaryLimits( const UTF8& aText, const VECT
         // The choice of spaces is somewhat arbitrary but sufficient for aligning text
         if( *it == '\t' )
         {
-            double spaces = m_glyphBoundingBoxes->at( 0 ).GetEnd().x;
+            double spaces = glyphWidth( m_glyphs[0] );
             double addlSpace = 3.0 * spaces - std::fmod( curX, 4.0 * spaces );
 
             // Add the remaining space (between 0 and 3 spaces)
@@ -587,17 +493,7 @@ VECTOR2D STROKE_FONT::ComputeStringBoundaryLimits( const UTF8& aText, const VECT
             continue;
         }
 
-        // Index in the bounding boxes table
-        int dd = (signed) *it - ' ';
-
-        if( dd >= (int) m_glyphBoundingBoxes->size() || dd < 0 )
-        {
-            int substitute = *it == '\t' ? ' ' : '?';
-            dd = substitute - ' ';
-        }
-
-        const BOX2D& box = m_glyphBoundingBoxes->at( dd );
-        curX += box.GetEnd().x * curScale;
+        curX += glyphWidth( getGlyph( *it ) ) * curScale;
     }
 
     string_bbox.x = std::max( maxX, curX ) * aGlyphSize.x;
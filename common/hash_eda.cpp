@@ -26,9 +26,13 @@
 #include <hash_eda.h>
 
 #include <class_module.h>
+#include <class_track.h>
+#include <class_zone.h>
 #include <fp_text.h>
 #include <fp_shape.h>
 #include <class_pad.h>
+#include <pcb_text.h>
+#include <pcb_shape.h>
 
 #include <functional>
 
@@ -46,6 +50,45 @@ static inline size_t hash_board_item( const BOARD_ITEM* aItem, int aFlags )
 }
 
 
+// Text attributes shared by FP_TEXT and PCB_TEXT (but not their position or rotation)
+static inline void hash_text( size_t& aSeed, const EDA_TEXT* aText, int aFlags )
+{
+    hash_combine( aSeed, aText->GetText().ToStdString() );
+    hash_combine( aSeed, aText->IsItalic() );
+    hash_combine( aSeed, aText->IsBold() );
+    hash_combine( aSeed, aText->IsMirrored() );
+    hash_combine( aSeed, aText->GetTextWidth() );
+    hash_combine( aSeed, aText->GetTextHeight() );
+    hash_combine( aSeed, aText->GetHorizJustify() );
+    hash_combine( aSeed, aText->GetVertJustify() );
+
+    if( aFlags & HASH_FILL )
+        hash_combine( aSeed, aText->IsVisible(), aText->GetTextThickness() );
+}
+
+
+// Common calculation part for PCB_SHAPE and FP_SHAPE, in absolute coordinates
+static inline void hash_shape( size_t& aSeed, const PCB_SHAPE* aShape, int aFlags )
+{
+    hash_combine( aSeed, aShape->GetShape() );
+    hash_combine( aSeed, aShape->GetWidth() );
+
+    if( aFlags & HASH_POS )
+    {
+        hash_combine( aSeed, aShape->GetStart().x, aShape->GetStart().y );
+        hash_combine( aSeed, aShape->GetEnd().x, aShape->GetEnd().y );
+        hash_combine( aSeed, aShape->GetBezControl1().x, aShape->GetBezControl1().y );
+        hash_combine( aSeed, aShape->GetBezControl2().x, aShape->GetBezControl2().y );
+
+        for( auto it = aShape->GetPolyShape().CIterateWithHoles(); it; it++ )
+            hash_combine( aSeed, it->x, it->y );
+    }
+
+    if( aFlags & HASH_ROT )
+        hash_combine( aSeed, aShape->GetAngle() );
+}
+
+
 size_t hash_eda( const EDA_ITEM* aItem, int aFlags )
 {
     size_t ret = 0;
@@ -85,6 +128,23 @@ size_t hash_eda( const EDA_ITEM* aItem, int aFlags )
             hash_combine( ret, pad->GetDelta().x << 4 );
             hash_combine( ret, pad->GetDelta().y << 5 );
 
+            if( aFlags & HASH_FILL )
+            {
+                hash_combine( ret, pad->GetDrillSize().x, pad->GetDrillSize().y );
+                hash_combine( ret, pad->GetAttribute() );
+                hash_combine( ret, pad->GetRoundRectRadiusRatio() );
+                hash_combine( ret, pad->GetChamferRectRatio(), pad->GetChamferPositions() );
+                hash_combine( ret, pad->GetRemoveUnconnected(), pad->GetKeepTopBottom() );
+
+                if( pad->GetShape() == PAD_SHAPE_CUSTOM )
+                {
+                    hash_combine( ret, pad->GetAnchorPadShape() );
+
+                    for( const std::shared_ptr<PCB_SHAPE>& primitive : pad->GetPrimitives() )
+                        hash_shape( ret, primitive.get(), HASH_POS | HASH_ROT | HASH_FILL );
+                }
+            }
+
             hash_combine( ret, hash_board_item( pad, aFlags ) );
 
             if( aFlags & HASH_POS )
@@ -114,14 +174,7 @@ size_t hash_eda( const EDA_ITEM* aItem, int aFlags )
                 break;
 
             ret = hash_board_item( text, aFlags );
-            hash_combine( ret, text->GetText().ToStdString() );
-            hash_combine( ret,  text->IsItalic() );
-            hash_combine( ret, text->IsBold() );
-            hash_combine( ret, text->IsMirrored() );
-            hash_combine( ret, text->GetTextWidth() );
-            hash_combine( ret, text->GetTextHeight() );
-            hash_combine( ret, text->GetHorizJustify() );
-            hash_combine( ret, text->GetVertJustify() );
+            hash_text( ret, text, aFlags );
 
             if( aFlags & HASH_POS )
             {
@@ -136,6 +189,21 @@ size_t hash_eda( const EDA_ITEM* aItem, int aFlags )
         }
         break;
 
+    case PCB_TEXT_T:
+        {
+            const PCB_TEXT* text = static_cast<const PCB_TEXT*>( aItem );
+
+            ret = hash_board_item( text, aFlags );
+            hash_text( ret, text, aFlags );
+
+            if( aFlags & HASH_POS )
+                hash_combine( ret, text->GetTextPos().x, text->GetTextPos().y );
+
+            if( aFlags & HASH_ROT )
+                hash_combine( ret, text->GetTextAngle() );
+        }
+        break;
+
     case PCB_FP_SHAPE_T:
         {
             const FP_SHAPE* segment = static_cast<const FP_SHAPE*>( aItem );
@@ -160,6 +228,12 @@ size_t hash_eda( const EDA_ITEM* aItem, int aFlags )
                     hash_combine( ret, segment->GetStart().y );
                     hash_combine( ret, segment->GetEnd().x );
                     hash_combine( ret, segment->GetEnd().y );
+
+                    if( aFlags & HASH_FILL )
+                    {
+                        for( auto it = segment->GetPolyShape().CIterateWithHoles(); it; it++ )
+                            hash_combine( ret, it->x, it->y );
+                    }
                 }
             }
 
@@ -168,6 +242,76 @@ size_t hash_eda( const EDA_ITEM* aItem, int aFlags )
         }
         break;
 
+    case PCB_SHAPE_T:
+        ret = hash_board_item( static_cast<const PCB_SHAPE*>( aItem ), aFlags );
+        hash_shape( ret, static_cast<const PCB_SHAPE*>( aItem ), aFlags );
+        break;
+
+    case PCB_TRACE_T:
+    case PCB_ARC_T:
+    case PCB_VIA_T:
+        {
+            const TRACK* track = static_cast<const TRACK*>( aItem );
+
+            ret = hash_board_item( track, aFlags );
+            hash_combine( ret, track->Type(), track->GetWidth() );
+
+            if( aFlags & HASH_POS )
+            {
+                hash_combine( ret, track->GetStart().x, track->GetStart().y );
+                hash_combine( ret, track->GetEnd().x, track->GetEnd().y );
+
+                if( track->Type() == PCB_ARC_T )
+                {
+                    const ARC* arc = static_cast<const ARC*>( track );
+                    hash_combine( ret, arc->GetMid().x, arc->GetMid().y );
+                }
+            }
+
+            if( track->Type() == PCB_VIA_T )
+            {
+                const VIA* via = static_cast<const VIA*>( track );
+
+                hash_combine( ret, via->GetViaType(), via->GetDrillValue() );
+                hash_combine( ret, via->GetRemoveUnconnected(), via->GetKeepTopBottom() );
+            }
+
+            if( aFlags & HASH_NET )
+                hash_combine( ret, track->GetNetCode() );
+        }
+        break;
+
+    case PCB_ZONE_AREA_T:
+    case PCB_FP_ZONE_AREA_T:
+        {
+            const ZONE_CONTAINER* zone = static_cast<const ZONE_CONTAINER*>( aItem );
+
+            // Hashes the zone settings and outline, but not its fill
+            ret = hash_board_item( zone, aFlags );
+            hash_combine( ret, zone->GetPriority(), zone->GetLocalClearance(),
+                          zone->GetMinThickness(), zone->GetPadConnection() );
+            hash_combine( ret, zone->GetThermalReliefGap(), zone->GetThermalReliefSpokeWidth() );
+            hash_combine( ret, zone->GetFillMode(), zone->GetHatchThickness(),
+                          zone->GetHatchGap(), zone->GetHatchOrientation() );
+            hash_combine( ret, zone->GetHatchSmoothingLevel(), zone->GetHatchSmoothingValue(),
+                          zone->GetHatchHoleMinArea(), zone->GetHatchBorderAlgorithm() );
+            hash_combine( ret, zone->GetCornerSmoothingType(), zone->GetCornerRadius() );
+            hash_combine( ret, zone->GetIslandRemovalMode(), zone->GetMinIslandArea() );
+            hash_combine( ret, zone->GetIsRuleArea(), zone->GetDoNotAllowCopperPour(),
+                          zone->GetDoNotAllowVias(), zone->GetDoNotAllowTracks(),
+                          zone->GetDoNotAllowPads(), zone->GetDoNotAllowFootprints() );
+
+            if( aFlags & HASH_POS )
+            {
+                for( auto it = zone->Outline()->CIterateWithHoles(); it; it++ )
+                    hash_combine( ret, it->x, it->y );
+            }
+
+            if( aFlags & HASH_NET )
+                hash_combine( ret, zone->GetNetCode() );
+        }
+        break;
+
     default:
         wxASSERT_MSG( false, "Unhandled type in function hashModItem() (exporter_gencad.cpp)" );
     }
@@ -29,6 +29,7 @@
 #include <kiface_i.h>
 #include <pgm_base.h>
 #include <systemdirsappend.h>
+#include <thread_pool.h>
 
 #include <common.h>
 
@@ -85,8 +86,13 @@ static void setSearchPaths( SEARCH_STACK* aDst, KIWAY::FACE_T aId )
 }
 
 
-bool KIFACE_I::start_common( int aCtlBits )
+bool KIFACE_I::start_common( PGM_BASE* aProgram, int aCtlBits )
 {
+    // The common library, and so GetKiCadThreadPool(), is linked into each kiface.  Use the
+    // pool of the hosting program instead, so that all kifaces share the same threads.
+    if( aProgram )
+        SetKiCadThreadPool( &aProgram->GetThreadPool() );
+
     m_start_flags = aCtlBits;
     m_bm.Init();
     setSearchPaths( &m_bm.m_search, m_id );
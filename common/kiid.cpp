@@ -30,8 +30,9 @@
 #include <boost/uuid/uuid_io.hpp>
 #include <boost/functional/hash.hpp>
 
-// Create only once, as seeding is *very* expensive
-static boost::uuids::random_generator randomGenerator;
+// Create only once per thread, as seeding is *very* expensive.  The generator is not
+// thread-safe, and items are created on worker threads (e.g. when loading boards).
+static thread_local boost::uuids::random_generator randomGenerator;
 
 // These don't have the same performance penalty, but might as well be consistent
 static boost::uuids::string_generator stringGenerator;
@@ -165,10 +165,65 @@ wxString UOP::Format() const
 
 UCODE::~UCODE()
 {
-    for ( auto op : m_ucode )
+}
+
+
+void UCODE::AddOp( UOP* uop )
+{
+    m_ucode.push_back( std::move( *uop ) );
+    delete uop;
+
+    foldConstants();
+}
+
+
+void UCODE::foldConstants()
+{
+    int    op = m_ucode.back().GetOp();
+    size_t argCount;
+
+    if( op & TR_OP_BINARY_MASK )
+        argCount = 2;
+    else if( op & TR_OP_UNARY_MASK )
+        argCount = 1;
+    else
+        return;
+
+    if( m_ucode.size() < argCount + 1 )
+        return;
+
+    // Code is emitted in postfix order, so an operator's operands are the ops directly
+    // before it -- and an operand which is a single constant push is a complete subtree.
+    auto first = m_ucode.end() - argCount - 1;
+
+    for( auto it = first; it != m_ucode.end() - 1; ++it )
+    {
+        if( !it->IsConstant() )
+            return;
+    }
+
+    // The scratch context has no error callback, so anything going wrong here would be lost.
+    // Leave such code unfolded instead; it then reports its error when it is run.
+    CONTEXT ctx;
+
+    try
     {
-        delete op;
+        for( auto it = first; it != m_ucode.end(); ++it )
+            it->Exec( &ctx );
     }
+    catch( ... )
+    {
+        return;
+    }
+
+    if( ctx.IsErrorPending() || ctx.SP() != 1 )
+        return;
+
+    std::unique_ptr<VALUE> result = std::make_unique<VALUE>();
+    result->Set( *ctx.Pop() );
+
+    m_ucode.erase( first, m_ucode.end() );
+    m_ucode.emplace_back( TR_UOP_PUSH_VALUE, std::move( result ) );
 }
 
 
@@ -176,9 +231,9 @@ wxString UCODE::Dump() const
 {
     wxString rv;
 
-    for( auto op : m_ucode )
+    for( const UOP& op : m_ucode )
     {
-        rv += op->Format();
+        rv += op.Format();
         rv += "\n";
     }
 
@@ -1065,7 +1120,7 @@ void UOP::Exec( CONTEXT* ctx )
     case TR_UOP_PUSH_VAR:
     {
         auto value = ctx->AllocValue();
-        value->Set( m_ref->GetValue( ctx ) );
+        m_ref->FetchValue( ctx, value );
         ctx->Push( value );
     }
         break;
@@ -1166,10 +1221,12 @@ VALUE* UCODE::Run( CONTEXT* ctx )
 {
     static VALUE g_false( 0 );
 
+    ctx->Reset();
+
     try
     {
-        for( UOP* op : m_ucode )
-            op->Exec( ctx );
+        for( UOP& op : m_ucode )
+            op.Exec( ctx );
     }
     catch(...)
     {
@@ -57,6 +57,7 @@
 #include <settings/common_settings.h>
 #include <settings/settings_manager.h>
 #include <systemdirsappend.h>
+#include <thread_pool.h>
 #include <trace_helpers.h>
 
 
@@ -133,6 +134,14 @@ wxApp& PGM_BASE::App()
 }
 
 
+THREAD_POOL& PGM_BASE::GetThreadPool()
+{
+    // Called through the vtable, so this is always the pool of the program, never the one
+    // of a kiface
+    return GetKiCadThreadPool();
+}
+
+
 void PGM_BASE::SetEditorName( const wxString& aFileName )
 {
     m_editor_name = aFileName;
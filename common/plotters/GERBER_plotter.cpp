@@ -38,6 +38,7 @@
 #include "gbr_plotter_aperture_macros.h"
 
 #include <gbr_metadata.h>
+#include <hash_eda.h>
 
 // if GBR_USE_MACROS is defined, pads having a shape that is not a Gerber primitive
 // will use a macro when possible
@@ -208,16 +209,7 @@ bool GERBER_PLOTTER::StartPlot()
 
     wxASSERT( outputFile );
 
-    finalFile = outputFile;     // the actual gerber file will be created later
-
-    // Create a temp file in system temp to avoid potential network share buffer issues for the final read and save
-    m_workFilename = wxFileName::CreateTempFileName( "" );
-    workFile   = wxFopen( m_workFilename, wxT( "wt" ));
-    outputFile = workFile;
-    wxASSERT( outputFile );
-
-    if( outputFile == NULL )
-        return false;
+    finalFile = outputFile;     // the header goes to the actual gerber file
 
     for( unsigned ii = 0; ii < m_headerExtraLines.GetCount(); ii++ )
     {
@@ -262,6 +254,19 @@ bool GERBER_PLOTTER::StartPlot()
     // Add aperture list start point
     fputs( "G04 APERTURE LIST*\n", outputFile );
 
+    // The aperture list is known only at the end of the plot, so the body goes to a work file,
+    // appended to the actual gerber file after the aperture list by EndPlot().
+    // Create a temp file in system temp to avoid potential network share buffer issues for the
+    // final read and save. It is a binary file: its contents are copied as is, and the end of
+    // lines are converted when written to the actual gerber file.
+    m_workFilename = wxFileName::CreateTempFileName( "" );
+    workFile   = wxFopen( m_workFilename, wxT( "w+b" ));
+    outputFile = workFile;
+    wxASSERT( outputFile );
+
+    if( outputFile == NULL )
+        return false;
+
     // Give a minimal value to the default pen size, used to plot items in sketch mode
     if( m_renderSettings )
     {
@@ -276,63 +281,56 @@ bool GERBER_PLOTTER::StartPlot()
 
 bool GERBER_PLOTTER::EndPlot()
 {
-    char     line[1024];
-    wxString msg;
-
     wxASSERT( outputFile );
 
     /* Outfile is actually a temporary file i.e. workFile */
     fputs( "M02*\n", outputFile );
     fflush( outputFile );
 
-    fclose( workFile );
-    workFile   = wxFopen( m_workFilename, wxT( "rt" ));
-    wxASSERT( workFile );
     outputFile = finalFile;
 
-    // Placement of apertures in RS274X
-    while( fgets( line, 1024, workFile ) )
+    // Placement of apertures in RS274X, after the header already written by StartPlot().
+    // Add aperture list macro:
+    if( m_hasApertureRoundRect | m_hasApertureRotOval ||
+        m_hasApertureOutline4P || m_hasApertureRotRect ||
+        m_hasApertureChamferedRect )
     {
-        fputs( line, outputFile );
+        fputs( "G04 Aperture macros list*\n", outputFile );
 
-        char* substr = strtok( line, "\n\r" );
+        if( m_hasApertureRoundRect )
+            fputs( APER_MACRO_ROUNDRECT_HEADER, outputFile );
 
-        if( substr && strcmp( substr, "G04 APERTURE LIST*" ) == 0 )
-        {
-            // Add aperture list macro:
-            if( m_hasApertureRoundRect | m_hasApertureRotOval ||
-                m_hasApertureOutline4P || m_hasApertureRotRect ||
-                m_hasApertureChamferedRect )
-            {
-                fputs( "G04 Aperture macros list*\n", outputFile );
+        if( m_hasApertureRotOval )
+            fputs( APER_MACRO_SHAPE_OVAL_HEADER, outputFile );
 
-                if( m_hasApertureRoundRect )
-                    fputs( APER_MACRO_ROUNDRECT_HEADER, outputFile );
+        if( m_hasApertureRotRect )
+            fputs( APER_MACRO_ROT_RECT_HEADER, outputFile );
 
-                if( m_hasApertureRotOval )
-                    fputs( APER_MACRO_SHAPE_OVAL_HEADER, outputFile );
+        if( m_hasApertureOutline4P )
+            fputs( APER_MACRO_OUTLINE4P_HEADER, outputFile );
 
-                if( m_hasApertureRotRect )
-                    fputs( APER_MACRO_ROT_RECT_HEADER, outputFile );
+        if( m_hasApertureChamferedRect )
+        {
+            fputs( APER_MACRO_OUTLINE5P_HEADER, outputFile );
+            fputs( APER_MACRO_OUTLINE6P_HEADER, outputFile );
+            fputs( APER_MACRO_OUTLINE7P_HEADER, outputFile );
+            fputs( APER_MACRO_OUTLINE8P_HEADER, outputFile );
+        }
 
-                if( m_hasApertureOutline4P )
-                    fputs( APER_MACRO_OUTLINE4P_HEADER, outputFile );
+        fputs( "G04 Aperture macros list end*\n", outputFile );
+    }
 
-                if( m_hasApertureChamferedRect )
-                {
-                    fputs( APER_MACRO_OUTLINE5P_HEADER, outputFile );
-                    fputs( APER_MACRO_OUTLINE6P_HEADER, outputFile );
-                    fputs( APER_MACRO_OUTLINE7P_HEADER, outputFile );
-                    fputs( APER_MACRO_OUTLINE8P_HEADER, outputFile );
-                }
+    writeApertureList();
+    fputs( "G04 APERTURE END LIST*\n", outputFile );
 
-                fputs( "G04 Aperture macros list end*\n", outputFile );
-            }
+    // Append the body, in large blocks
+    std::vector<char> buffer( 1 << 16 );
+    size_t            count;
 
-            writeApertureList();
-            fputs( "G04 APERTURE END LIST*\n", outputFile );
-        }
-    }
+    rewind( workFile );
+
+    while( ( count = fread( buffer.data(), 1, buffer.size(), workFile ) ) > 0 )
+        fwrite( buffer.data(), 1, count, outputFile );
 
     fclose( workFile );
     fclose( finalFile );
@@ -360,23 +358,50 @@ void GERBER_PLOTTER::SetCurrentLineWidth( int aWidth, void* aData )
 }
 
 
+// Hash of the parameters GetOrCreateAperture() compares to find an existing aperture
+static size_t hashAperture( const wxSize& aSize, int aRadius, double aRotDegree,
+                            APERTURE::APERTURE_TYPE aType, int aApertureAttribute )
+{
+    // 0.0 and -0.0 are the same rotation, but do not have the same hash
+    if( aRotDegree == 0.0 )
+        aRotDegree = 0.0;
+
+    return hash_val( aSize.x, aSize.y, aRadius, aRotDegree, (int) aType, aApertureAttribute );
+}
+
+
+static size_t hashAperture( const std::vector<wxPoint>& aCorners, APERTURE::APERTURE_TYPE aType,
+                            int aApertureAttribute )
+{
+    size_t hash = hash_val( (int) aType, aApertureAttribute );
+
+    for( const wxPoint& corner : aCorners )
+        hash_combine( hash, corner.x, corner.y );
+
+    return hash;
+}
+
+
 int GERBER_PLOTTER::GetOrCreateAperture( const wxSize& aSize, int aRadius, double aRotDegree,
                         APERTURE::APERTURE_TYPE aType, int aApertureAttribute )
 {
-    int last_D_code = 9;
+    size_t hash = hashAperture( aSize, aRadius, aRotDegree, aType, aApertureAttribute );
 
     // Search an existing aperture
-    for( int idx = 0; idx < (int)m_apertures.size(); ++idx )
+    auto candidates = m_apertureIndex.equal_range( hash );
+
+    for( auto it = candidates.first; it != candidates.second; ++it )
     {
-        APERTURE* tool = &m_apertures[idx];
-        last_D_code = tool->m_DCode;
+        APERTURE* tool = &m_apertures[it->second];
 
         if( (tool->m_Type == aType) && (tool->m_Size == aSize) &&
             (tool->m_Radius == aRadius) && (tool->m_Rotation == aRotDegree) &&
             (tool->m_ApertureAttribute == aApertureAttribute) )
-            return idx;
+            return it->second;
     }
 
+    int last_D_code = m_apertures.empty() ? 9 : m_apertures.back().m_DCode;
+
     // Allocate a new aperture
     APERTURE new_tool;
     new_tool.m_Size  = aSize;
@@ -387,6 +412,7 @@ int GERBER_PLOTTER::GetOrCreateAperture( const wxSize& aSize, int aRadius, doubl
     new_tool.m_ApertureAttribute = aApertureAttribute;
 
     m_apertures.push_back( new_tool );
+    m_apertureIndex.emplace( hash, m_apertures.size() - 1 );
 
     return m_apertures.size() - 1;
 }
@@ -395,35 +421,22 @@ int GERBER_PLOTTER::GetOrCreateAperture( const wxSize& aSize, int aRadius, doubl
 int GERBER_PLOTTER::GetOrCreateAperture( const std::vector<wxPoint>& aCorners, double aRotDegree,
                          APERTURE::APERTURE_TYPE aType, int aApertureAttribute )
 {
-    int last_D_code = 9;
+    size_t hash = hashAperture( aCorners, aType, aApertureAttribute );
 
     // Search an existing aperture
-    for( int idx = 0; idx < (int)m_apertures.size(); ++idx )
-    {
-        APERTURE* tool = &m_apertures[idx];
+    auto candidates = m_apertureIndex.equal_range( hash );
 
-       last_D_code = tool->m_DCode;
+    for( auto it = candidates.first; it != candidates.second; ++it )
+    {
+        APERTURE* tool = &m_apertures[it->second];
 
-        if( (tool->m_Type == aType) && (tool->m_Corners.size() == aCorners.size() ) &&
+        if( (tool->m_Type == aType) && (tool->m_Corners == aCorners) &&
             (tool->m_ApertureAttribute == aApertureAttribute) )
-        {
-            // A candidate is found. the corner lists must be the same
-            bool is_same = true;
-
-            for( size_t ii = 0; ii < aCorners.size(); ii++ )
-            {
-                if( aCorners[ii] != tool->m_Corners[ii] )
-                {
-                    is_same = false;
-                    break;
-                }
-            }
-
-            if( is_same )
-                return idx;
-        }
+            return it->second;
     }
 
+    int last_D_code = m_apertures.empty() ? 9 : m_apertures.back().m_DCode;
+
     // Allocate a new aperture
     APERTURE new_tool;
 
@@ -436,6 +449,7 @@ int GERBER_PLOTTER::GetOrCreateAperture( const std::vector<wxPoint>& aCorners, d
     new_tool.m_ApertureAttribute = aApertureAttribute;
 
     m_apertures.push_back( new_tool );
+    m_apertureIndex.emplace( hash, m_apertures.size() - 1 );
 
     return m_apertures.size() - 1;
 }
@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <unordered_map>
 #include <vector>
 #include <math/box2.h>
 #include <eda_item.h>       // FILL_TYPE
@@ -351,6 +352,8 @@ protected:
     void writeApertureList();
 
     std::vector<APERTURE> m_apertures;  // The list of available apertures
+    std::unordered_multimap<size_t, int> m_apertureIndex;   // Indexes in m_apertures, by hash
+                                                            // of the aperture parameters
     int     m_currentApertureIdx;       // The index of the current aperture in m_apertures
     bool    m_hasApertureRoundRect;     // true is at least one round rect aperture is in use
     bool    m_hasApertureRotOval;       // true is at least one oval rotated aperture is in use
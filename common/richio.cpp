@@ -252,6 +252,41 @@ STRING_LINE_READER::STRING_LINE_READER( const STRING_LINE_READER& aStartingPoint
 }
 
 
+BUFFERED_FILE_LINE_READER::BUFFERED_FILE_LINE_READER( const wxString& aFileName ) :
+    STRING_LINE_READER( std::string(), aFileName )
+{
+    FILE* fp = wxFopen( aFileName, wxT( "rt" ) );
+
+    if( !fp )
+    {
+        wxString msg = wxString::Format(
+            _( "Unable to open filename \"%s\" for reading" ), aFileName.GetData() );
+        THROW_IO_ERROR( msg );
+    }
+
+    // In text mode the size is only an upper bound (line endings may be translated)
+    fseek( fp, 0, SEEK_END );
+    long size = ftell( fp );
+    rewind( fp );
+
+    m_lines.resize( size > 0 ? size : 0 );
+
+    size_t count = m_lines.empty() ? 0 : fread( &m_lines[0], 1, m_lines.size(), fp );
+    bool   failed = ferror( fp );
+
+    fclose( fp );
+
+    if( failed )
+    {
+        wxString msg = wxString::Format(
+            _( "Error reading file \"%s\"" ), aFileName.GetData() );
+        THROW_IO_ERROR( msg );
+    }
+
+    m_lines.resize( count );
+}
+
+
 char* STRING_LINE_READER::ReadLine()
 {
     size_t  nlOffset = m_lines.find( '\n', m_ndx );
@@ -0,0 +1,213 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <thread_pool.h>
+
+#include <advanced_config.h>
+
+#include <algorithm>
+
+
+// The pool (if any) owning the current thread, and the index of the thread's own queue in it
+static thread_local THREAD_POOL* s_ownerPool = nullptr;
+static thread_local size_t       s_ownerIndex = 0;
+
+
+THREAD_POOL::THREAD_POOL( size_t aThreadCount ) :
+        m_pending( 0 ),
+        m_nextQueue( 0 ),
+        m_stop( false )
+{
+    if( aThreadCount == 0 )
+        aThreadCount = std::thread::hardware_concurrency();
+
+    aThreadCount = std::max<size_t>( aThreadCount, 1 );
+
+    for( size_t ii = 0; ii < aThreadCount; ++ii )
+        m_queues.push_back( std::make_unique<TASK_QUEUE>() );
+
+    for( size_t ii = 0; ii < aThreadCount; ++ii )
+        m_workers.emplace_back( &THREAD_POOL::workerLoop, this, ii );
+}
+
+
+THREAD_POOL::~THREAD_POOL()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_sleepMutex );
+        m_stop = true;
+    }
+
+    m_wakeup.notify_all();
+
+    for( std::thread& worker : m_workers )
+        worker.join();
+}
+
+
+void THREAD_POOL::enqueue( std::function<void()>&& aTask )
+{
+    size_t idx;
+
+    if( s_ownerPool == this )
+        idx = s_ownerIndex;
+    else
+        idx = m_nextQueue.fetch_add( 1 ) % m_queues.size();
+
+    {
+        std::lock_guard<std::mutex> lock( m_queues[idx]->m_mutex );
+        m_queues[idx]->m_tasks.push_back( std::move( aTask ) );
+    }
+
+    {
+        // Taking the sleep mutex here ensures a worker between its predicate check and its
+        // wait cannot miss the notification.
+        std::lock_guard<std::mutex> lock( m_sleepMutex );
+        m_pending.fetch_add( 1 );
+    }
+
+    m_wakeup.notify_one();
+}
+
+
+bool THREAD_POOL::popTask( std::function<void()>& aTask )
+{
+    size_t count = m_queues.size();
+    size_t start;
+
+    if( s_ownerPool == this )
+    {
+        // Our own work first, newest first (it is the most likely to be cache-hot)
+        TASK_QUEUE& own = *m_queues[s_ownerIndex];
+        std::lock_guard<std::mutex> lock( own.m_mutex );
+
+        if( !own.m_tasks.empty() )
+        {
+            aTask = std::move( own.m_tasks.back() );
+            own.m_tasks.pop_back();
+            return true;
+        }
+
+        start = s_ownerIndex + 1;
+    }
+    else
+    {
+        start = m_nextQueue.load();
+    }
+
+    // Steal the oldest task from someone else
+    for( size_t ii = 0; ii < count; ++ii )
+    {
+        TASK_QUEUE& victim = *m_queues[( start + ii ) % count];
+        std::lock_guard<std::mutex> lock( victim.m_mutex );
+
+        if( !victim.m_tasks.empty() )
+        {
+            aTask = std::move( victim.m_tasks.front() );
+            victim.m_tasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void THREAD_POOL::RunAll( std::vector<std::function<void()>>& aTasks )
+{
+    if( aTasks.empty() )
+        return;
+
+    std::vector<std::future<void>> returns;
+
+    for( size_t ii = 1; ii < aTasks.size(); ++ii )
+        returns.push_back( Submit( aTasks[ii] ) );
+
+    aTasks[0]();
+    WaitAll( returns );
+}
+
+
+bool THREAD_POOL::RunPendingTask()
+{
+    if( m_pending.load() == 0 )
+        return false;
+
+    std::function<void()> task;
+
+    if( !popTask( task ) )
+        return false;
+
+    m_pending.fetch_sub( 1 );
+    task();
+
+    return true;
+}
+
+
+bool THREAD_POOL::IsWorkerThread() const
+{
+    return s_ownerPool == this;
+}
+
+
+void THREAD_POOL::workerLoop( size_t aIndex )
+{
+    s_ownerPool = this;
+    s_ownerIndex = aIndex;
+
+    while( true )
+    {
+        if( RunPendingTask() )
+            continue;
+
+        std::unique_lock<std::mutex> lock( m_sleepMutex );
+
+        m_wakeup.wait( lock, [this]()
+                             {
+                                 return m_stop || m_pending.load() > 0;
+                             } );
+
+        if( m_stop && m_pending.load() == 0 )
+            break;
+    }
+
+    s_ownerPool = nullptr;
+}
+
+
+// The pool of the program hosting this module, if it was handed over
+static std::atomic<THREAD_POOL*> s_hostPool( nullptr );
+
+
+THREAD_POOL& GetKiCadThreadPool()
+{
+    if( THREAD_POOL* hostPool = s_hostPool.load() )
+        return *hostPool;
+
+    static THREAD_POOL pool( std::max( ADVANCED_CFG::GetCfg().m_MaximumThreads, 0 ) );
+
+    return pool;
+}
+
+
+void SetKiCadThreadPool( THREAD_POOL* aPool )
+{
+    s_hostPool.store( aPool );
+}
@@ -133,7 +133,7 @@ bool IFACE::OnKifaceStart( PGM_BASE* aProgram, int aCtlBits )
     InitSettings( new CVPCB_SETTINGS );
     aProgram->GetSettingsManager().RegisterSettings( KifaceSettings() );
 
-    start_common( aCtlBits );
+    start_common( aProgram, aCtlBits );
 
     /*  Now that there are no *.mod files in the standard library, this function
         has no utility.  User should simply set the variable manually.
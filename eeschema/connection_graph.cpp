@@ -19,11 +19,11 @@
  */
 
 #include <list>
-#include <thread>
 #include <algorithm>
 #include <future>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <profile.h>
 #include <common.h>
 #include <erc.h>
@@ -40,6 +40,7 @@
 #include <connection_graph.h>
 #include <widgets/ui_common.h>
 #include <kicad_string.h>
+#include <thread_pool.h>
 
 #include <advanced_config.h> // for realtime connectivity switch
 
@@ -416,6 +417,7 @@ void CONNECTION_GRAPH::Reset()
     m_item_to_subgraph_map.clear();
     m_local_label_cache.clear();
     m_global_label_cache.clear();
+    m_sheet_items.clear();
     m_last_net_code = 1;
     m_last_bus_code = 1;
     m_last_subgraph_code = 1;
@@ -426,33 +428,147 @@ void CONNECTION_GRAPH::Recalculate( const SCH_SHEET_LIST& aSheetList, bool aUnco
 {
     PROF_COUNTER recalc_time( "CONNECTION_GRAPH::Recalculate" );
 
-    if( aUnconditional )
-        Reset();
+    // The item lists of the last update tell which sheets were modified since then.  They are
+    // only meaningful if the hierarchy did not change.
+    std::unordered_map<SCH_SHEET_PATH, std::vector<SCH_ITEM*>> previous_items;
+
+    if( !aUnconditional && aSheetList == m_sheetList )
+        previous_items.swap( m_sheet_items );
+
+    Reset();
 
     PROF_COUNTER update_items( "updateItemConnectivity" );
 
     m_sheetList = aSheetList;
 
-    for( const SCH_SHEET_PATH& sheet : aSheetList )
+    std::vector<std::vector<SCH_ITEM*>> sheet_items( aSheetList.size() );
+
+    // A screen shared by several sheets is modified for all of them
+    std::unordered_set<SCH_SCREEN*> dirty_screens;
+
+    for( size_t ii = 0; ii < aSheetList.size(); ++ii )
     {
-        std::vector<SCH_ITEM*> items;
+        const SCH_SHEET_PATH& sheet = aSheetList[ii];
+        std::vector<SCH_ITEM*>& items = sheet_items[ii];
+        std::vector<SCH_ITEM*>  signature;
+        bool                    dirty = false;
 
         for( SCH_ITEM* item : sheet.LastScreen()->Items() )
         {
-            if( item->IsConnectable() && ( aUnconditional || item->IsConnectivityDirty() ) )
-                items.push_back( item );
+            if( !item->IsConnectable() )
+                continue;
+
+            items.push_back( item );
+            signature.push_back( item );
+            dirty |= item->IsConnectivityDirty();
+
+            // Pins can be replaced without dirtying their parent (e.g. when the library symbol
+            // is refreshed), so they are part of the signature
+            if( item->Type() == SCH_SHEET_T )
+            {
+                for( SCH_SHEET_PIN* pin : static_cast<SCH_SHEET*>( item )->GetPins() )
+                {
+                    signature.push_back( pin );
+                    dirty |= pin->IsConnectivityDirty();
+                }
+            }
+            else if( item->Type() == SCH_COMPONENT_T )
+            {
+                for( SCH_PIN* pin : static_cast<SCH_COMPONENT*>( item )->GetPins( &sheet ) )
+                {
+                    signature.push_back( pin );
+                    dirty |= pin->IsConnectivityDirty();
+                }
+            }
         }
 
-        m_items.reserve( m_items.size() + items.size() );
+        auto previous = previous_items.find( sheet );
 
-        updateItemConnectivity( sheet, items );
+        if( dirty || previous == previous_items.end() || previous->second != signature )
+            dirty_screens.insert( sheet.LastScreen() );
 
-        // UpdateDanglingState() also adds connected items for SCH_TEXT
-        sheet.LastScreen()->TestDanglingEnds( &sheet );
+        m_sheet_items[sheet] = std::move( signature );
+    }
+
+    // The sheets sharing a screen share its items, so they are updated by the same task; the
+    // items of different screens are independent
+    std::vector<std::vector<size_t>> screen_sheets;
+    std::unordered_map<SCH_SCREEN*, size_t> screen_index;
+    int updated_sheets = 0;
+
+    for( size_t ii = 0; ii < aSheetList.size(); ++ii )
+    {
+        SCH_SCREEN* screen = aSheetList[ii].LastScreen();
+        auto        it = screen_index.emplace( screen, screen_sheets.size() ).first;
+
+        if( it->second == screen_sheets.size() )
+            screen_sheets.emplace_back();
+
+        screen_sheets[it->second].push_back( ii );
+
+        if( dirty_screens.count( screen ) )
+            updated_sheets++;
+    }
+
+    // Each sheet has its own result buffers, merged in sheet order so that m_items does not
+    // depend on the scheduling
+    std::vector<std::vector<SCH_ITEM*>> sheet_connectable_items( aSheetList.size() );
+    std::vector<std::vector<std::pair<SCH_SHEET_PATH, SCH_PIN*>>> sheet_power_pins(
+            aSheetList.size() );
+
+    THREAD_POOL& tp = GetKiCadThreadPool();
+    size_t parallelThreadCount = std::min<size_t>( tp.GetThreadCount(), screen_sheets.size() );
+
+    std::atomic<size_t> nextScreen( 0 );
+    std::vector<std::future<size_t>> returns;
+
+    auto update_lambda = [&]() -> size_t
+    {
+        for( size_t screenId = nextScreen++; screenId < screen_sheets.size();
+             screenId = nextScreen++ )
+        {
+            for( size_t ii : screen_sheets[screenId] )
+            {
+                const SCH_SHEET_PATH& sheet = aSheetList[ii];
+                bool unchanged = !dirty_screens.count( sheet.LastScreen() );
+
+                updateItemConnectivity( sheet, sheet_items[ii], unchanged,
+                                        sheet_connectable_items[ii], sheet_power_pins[ii] );
+
+                // UpdateDanglingState() also adds connected items for SCH_TEXT
+                if( !unchanged )
+                    sheet.LastScreen()->TestDanglingEnds( &sheet );
+            }
+        }
+
+        return 1;
+    };
+
+    if( parallelThreadCount <= 1 )
+        update_lambda();
+    else
+    {
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns.push_back( tp.Submit( update_lambda ) );
+
+        // Finalize the threads
+        tp.WaitAll( returns );
+    }
+
+    for( size_t ii = 0; ii < aSheetList.size(); ++ii )
+    {
+        m_items.insert( m_items.end(), sheet_connectable_items[ii].begin(),
+                        sheet_connectable_items[ii].end() );
+        m_invisible_power_pins.insert( m_invisible_power_pins.end(), sheet_power_pins[ii].begin(),
+                                       sheet_power_pins[ii].end() );
     }
 
     if( wxLog::IsAllowedTraceMask( ConnProfileMask ) )
+    {
+        wxLogTrace( ConnProfileMask, "%d of %d sheets updated", updated_sheets,
+                    (int) aSheetList.size() );
         update_items.Show();
+    }
 
     PROF_COUNTER build_graph( "buildConnectionGraph" );
 
@@ -467,7 +583,9 @@ void CONNECTION_GRAPH::Recalculate( const SCH_SHEET_LIST& aSheetList, bool aUnco
         recalc_time.Show();
 
 #ifndef DEBUG
-    // Pressure relief valve for release builds
+    // Pressure relief valve for release builds.  Incremental updates only skip the item
+    // connectivity of the unmodified sheets; the subgraphs are still rebuilt for the whole
+    // schematic, so a large one can still be too slow to update on every edit.
     const double max_recalc_time_msecs = 250.;
 
     if( m_allowRealTime && ADVANCED_CFG::GetCfg().m_realTimeConnectivity &&
@@ -479,15 +597,44 @@ void CONNECTION_GRAPH::Recalculate( const SCH_SHEET_LIST& aSheetList, bool aUnco
 }
 
 
+/**
+ * Pack a point in a single integer, to key hash maps on it.
+ */
+static inline uint64_t packPoint( const wxPoint& aPoint )
+{
+    return ( (uint64_t) (uint32_t) aPoint.x << 32 ) | (uint32_t) aPoint.y;
+}
+
+
+static inline wxPoint unpackPoint( uint64_t aKey )
+{
+    return wxPoint( (int32_t) ( aKey >> 32 ), (int32_t) ( aKey & 0xFFFFFFFF ) );
+}
+
+
 void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
-                                               const std::vector<SCH_ITEM*>& aItemList )
+                                               const std::vector<SCH_ITEM*>& aItemList,
+                                               bool aUnchanged,
+                                               std::vector<SCH_ITEM*>& aConnectableItems,
+                                               std::vector<std::pair<SCH_SHEET_PATH, SCH_PIN*>>&
+                                                       aInvisiblePowerPins )
 {
-    std::map< wxPoint, std::vector<SCH_ITEM*> > connection_map;
+    std::unordered_map<uint64_t, std::vector<SCH_ITEM*>> connection_map;
+
+    if( !aUnchanged )
+        connection_map.reserve( 2 * aItemList.size() );
+
+    aConnectableItems.reserve( aItemList.size() );
 
     for( SCH_ITEM* item : aItemList )
     {
-        std::vector< wxPoint > points = item->GetConnectionPoints();
-        item->ConnectedItems( aSheet ).clear();
+        std::vector< wxPoint > points;
+
+        if( !aUnchanged )
+        {
+            points = item->GetConnectionPoints();
+            item->ConnectedItems( aSheet ).clear();
+        }
 
         if( item->Type() == SCH_SHEET_T )
         {
@@ -496,11 +643,16 @@ void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
                 if( !pin->Connection( &aSheet ) )
                     pin->InitializeConnection( aSheet, this );
 
-                pin->ConnectedItems( aSheet ).clear();
                 pin->Connection( &aSheet )->Reset();
 
-                connection_map[ pin->GetTextPos() ].push_back( pin );
-                m_items.emplace_back( pin );
+                if( !aUnchanged )
+                {
+                    pin->ConnectedItems( aSheet ).clear();
+                    connection_map[ packPoint( pin->GetTextPos() ) ].push_back( pin );
+                }
+
+                pin->SetConnectivityDirty( false );
+                aConnectableItems.emplace_back( pin );
             }
         }
         else if( item->Type() == SCH_COMPONENT_T )
@@ -518,24 +670,27 @@ void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
             {
                 pin->InitializeConnection( aSheet, this );
 
-                wxPoint pos = pin->GetPosition();
-
                 // because calling the first time is not thread-safe
                 pin->GetDefaultNetName( aSheet );
-                pin->ConnectedItems( aSheet ).clear();
 
                 // Invisible power pins need to be post-processed later
 
                 if( pin->IsPowerConnection() && !pin->IsVisible() )
-                    m_invisible_power_pins.emplace_back( std::make_pair( aSheet, pin ) );
+                    aInvisiblePowerPins.emplace_back( std::make_pair( aSheet, pin ) );
 
-                connection_map[ pos ].push_back( pin );
-                m_items.emplace_back( pin );
+                if( !aUnchanged )
+                {
+                    pin->ConnectedItems( aSheet ).clear();
+                    connection_map[ packPoint( pin->GetPosition() ) ].push_back( pin );
+                }
+
+                pin->SetConnectivityDirty( false );
+                aConnectableItems.emplace_back( pin );
             }
         }
         else
         {
-            m_items.emplace_back( item );
+            aConnectableItems.emplace_back( item );
             auto conn = item->InitializeConnection( aSheet, this );
 
             // Set bus/net property here so that the propagation code uses it
@@ -548,9 +703,14 @@ void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
 
             case SCH_BUS_BUS_ENTRY_T:
                 conn->SetType( CONNECTION_TYPE::BUS );
-                // clean previous (old) links:
-                static_cast<SCH_BUS_BUS_ENTRY*>( item )->m_connected_bus_items[0] = nullptr;
-                static_cast<SCH_BUS_BUS_ENTRY*>( item )->m_connected_bus_items[1] = nullptr;
+
+                if( !aUnchanged )
+                {
+                    // clean previous (old) links:
+                    static_cast<SCH_BUS_BUS_ENTRY*>( item )->m_connected_bus_items[0] = nullptr;
+                    static_cast<SCH_BUS_BUS_ENTRY*>( item )->m_connected_bus_items[1] = nullptr;
+                }
+
                 break;
 
             case SCH_PIN_T:
@@ -559,8 +719,13 @@ void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
 
             case SCH_BUS_WIRE_ENTRY_T:
                 conn->SetType( CONNECTION_TYPE::NET );
-                // clean previous (old) link:
-                static_cast<SCH_BUS_WIRE_ENTRY*>( item )->m_connected_bus_item = nullptr;
+
+                if( !aUnchanged )
+                {
+                    // clean previous (old) link:
+                    static_cast<SCH_BUS_WIRE_ENTRY*>( item )->m_connected_bus_item = nullptr;
+                }
+
                 break;
 
             default:
@@ -568,15 +733,20 @@ void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
             }
 
             for( const wxPoint& point : points )
-                connection_map[ point ].push_back( item );
+                connection_map[ packPoint( point ) ].push_back( item );
         }
 
         item->SetConnectivityDirty( false );
     }
 
+    // The graphical connections of unchanged items are still valid
+    if( aUnchanged )
+        return;
+
     for( const auto& it : connection_map )
     {
-        auto connection_vec = it.second;
+        const wxPoint                 point = unpackPoint( it.first );
+        const std::vector<SCH_ITEM*>& connection_vec = it.second;
 
         for( auto primary_it = connection_vec.begin(); primary_it != connection_vec.end(); primary_it++ )
         {
@@ -597,7 +767,7 @@ void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
                 if( connection_vec.size() == 1 )
                 {
                     SCH_SCREEN* screen = aSheet.LastScreen();
-                    SCH_LINE*   bus = screen->GetBus( it.first );
+                    SCH_LINE*   bus = screen->GetBus( point );
 
                     if( bus )
                     {
@@ -613,13 +783,13 @@ void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
                 if( connection_vec.size() < 2 )
                 {
                     SCH_SCREEN* screen = aSheet.LastScreen();
-                    SCH_LINE*   bus = screen->GetBus( it.first );
+                    SCH_LINE*   bus = screen->GetBus( point );
 
                     if( bus )
                     {
                         auto bus_entry = static_cast<SCH_BUS_BUS_ENTRY*>( connected_item );
 
-                        if( it.first == bus_entry->GetPosition() )
+                        if( point == bus_entry->GetPosition() )
                             bus_entry->m_connected_bus_items[0] = bus;
                         else
                             bus_entry->m_connected_bus_items[1] = bus;
@@ -634,7 +804,7 @@ void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
             else if( connected_item->Type() == SCH_JUNCTION_T )
             {
                 SCH_SCREEN* screen = aSheet.LastScreen();
-                SCH_LINE*   bus    = screen->GetBus( it.first );
+                SCH_LINE*   bus    = screen->GetBus( point );
 
                 connected_item->SetLayer( bus ? LAYER_BUS_JUNCTION : LAYER_JUNCTION );
             }
@@ -672,7 +842,7 @@ void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
                 if( !bus_entry->m_connected_bus_item )
                 {
                     auto screen = aSheet.LastScreen();
-                    auto bus = screen->GetBus( it.first );
+                    auto bus = screen->GetBus( point );
 
                     if( bus )
                         bus_entry->m_connected_bus_item = bus;
@@ -795,12 +965,13 @@ void CONNECTION_GRAPH::buildConnectionGraph()
 
     // Resolve drivers for subgraphs and propagate connectivity info
 
-    // We don't want to spin up a new thread for fewer than 8 nets (overhead costs)
-    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+    // We don't want to spin up a new task for fewer than 4 subgraphs (overhead costs)
+    THREAD_POOL& tp = GetKiCadThreadPool();
+    size_t parallelThreadCount = std::min<size_t>( tp.GetThreadCount(),
             ( m_subgraphs.size() + 3 ) / 4 );
 
     std::atomic<size_t> nextSubgraph( 0 );
-    std::vector<std::future<size_t>> returns( parallelThreadCount );
+    std::vector<std::future<size_t>> returns;
     std::vector<CONNECTION_SUBGRAPH*> dirty_graphs;
 
     std::copy_if( m_subgraphs.begin(), m_subgraphs.end(), std::back_inserter( dirty_graphs ),
@@ -868,16 +1039,15 @@ void CONNECTION_GRAPH::buildConnectionGraph()
         return 1;
     };
 
-    if( parallelThreadCount == 1 )
+    if( parallelThreadCount <= 1 )
         update_lambda();
     else
     {
         for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii] = std::async( std::launch::async, update_lambda );
+            returns.push_back( tp.Submit( update_lambda ) );
 
         // Finalize the threads
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii].wait();
+        tp.WaitAll( returns );
     }
 
     // Now discard any non-driven subgraphs from further consideration
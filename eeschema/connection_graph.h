@@ -252,7 +252,12 @@ public:
     /**
      * Updates the connection graph for the given list of sheets.
      *
-     * @param aSheetList is the list of possibly modified sheets
+     * The graphical connectivity of the items is only recomputed on the sheets that were
+     * modified (items added, removed or dirtied) since the last update; the subgraphs, drivers
+     * and net names are then rebuilt for the whole list, so the result is the same as with a
+     * full recalculation.
+     *
+     * @param aSheetList is the list of all the sheets of the schematic
      * @param aUnconditional is true if an unconditional full recalculation should be done
      */
     void Recalculate( const SCH_SHEET_LIST& aSheetList, bool aUnconditional = false );
@@ -308,9 +313,13 @@ public:
     static bool m_allowRealTime;
 
 private:
-    // All the sheets in the schematic (as long as we don't have partial updates)
+    // All the sheets in the schematic
     SCH_SHEET_LIST m_sheetList;
 
+    // The connectable items (and their pins) of each sheet at the last update, to find the
+    // sheets modified since then
+    std::unordered_map<SCH_SHEET_PATH, std::vector<SCH_ITEM*>> m_sheet_items;
+
     // All connectable items in the schematic
     std::vector<SCH_ITEM*> m_items;
 
@@ -374,13 +383,22 @@ private:
      * checks to ensure that the items should actually connect, the items are
      * linked together using ConnectedItems().
      *
-     * As a side effect, items are loaded into m_items for BuildConnectionGraph()
+     * The graph itself is not modified: the items of different screens can be updated
+     * concurrently.
      *
      * @param aSheet is the path to the sheet of all items in the list
      * @param aItemList is a list of items to consider
+     * @param aUnchanged is true if the items did not change since the last update: their
+     *                   connections are then reset, but the second phase is skipped
+     * @param aConnectableItems receives the items to load into m_items for
+     *                          BuildConnectionGraph()
+     * @param aInvisiblePowerPins receives the items to load into m_invisible_power_pins
      */
     void updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
-                                 const std::vector<SCH_ITEM*>& aItemList );
+                                 const std::vector<SCH_ITEM*>& aItemList, bool aUnchanged,
+                                 std::vector<SCH_ITEM*>& aConnectableItems,
+                                 std::vector<std::pair<SCH_SHEET_PATH, SCH_PIN*>>&
+                                         aInvisiblePowerPins );
 
     /**
      * Generates the connection graph (after all item connectivity has been updated)
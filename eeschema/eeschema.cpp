@@ -240,7 +240,7 @@ bool IFACE::OnKifaceStart( PGM_BASE* aProgram, int aCtlBits )
     InitSettings( new EESCHEMA_SETTINGS );
     aProgram->GetSettingsManager().RegisterSettings( KifaceSettings() );
 
-    start_common( aCtlBits );
+    start_common( aProgram, aCtlBits );
 
     wxFileName fn = SYMBOL_LIB_TABLE::GetGlobalTableFileName();
 
@@ -34,6 +34,7 @@
 #include <pgm_base.h>
 #include <sch_component.h>
 #include <sch_edit_frame.h>
+#include <symbol_info_cache.h>
 #include <symbol_lib_table.h>
 #include <tool/tool_manager.h>
 #include <tools/ee_actions.h>
@@ -97,6 +98,10 @@ COMPONENT_SELECTION SCH_BASE_FRAME::SelectCompFromLibTree( const SCHLIB_FILTER*
     if( !dialogLock.try_lock() )
         return COMPONENT_SELECTION();
 
+    // Libraries which did not change since they were indexed are not loaded
+    wxString symbolInfoCacheFile = GetSymbolInfoCacheFile();
+    GSymbolInfoCache.ReadCacheFromFile( symbolInfoCacheFile );
+
     auto adapterPtr( SYMBOL_TREE_MODEL_ADAPTER::Create( this, libs ) );
     auto adapter = static_cast<SYMBOL_TREE_MODEL_ADAPTER*>( adapterPtr.get() );
     bool loaded = false;
@@ -142,6 +147,9 @@ COMPONENT_SELECTION SCH_BASE_FRAME::SelectCompFromLibTree( const SCHLIB_FILTER*
     if( !loaded )
         adapter->AddLibraries( libNicknames, this );
 
+    if( !symbolInfoCacheFile.IsEmpty() )
+        GSymbolInfoCache.WriteCacheToFile( symbolInfoCacheFile );
+
     if( aHighlight && aHighlight->IsValid() )
         adapter->SetPreselectNode( *aHighlight, /* aUnit */ 0 );
 
@@ -37,6 +37,7 @@
 #include <widgets/msgpanel.h>
 #include <sch_view.h>
 #include <sch_painter.h>
+#include <symbol_info_cache.h>
 #include <symbol_lib_table.h>
 #include <symbol_tree_model_adapter.h>
 #include <pgm_base.h>
@@ -815,9 +816,16 @@ void LIB_VIEW_FRAME::OnSelectSymbol( wxCommandEvent& aEvent )
     auto adapterPtr( SYMBOL_TREE_MODEL_ADAPTER::Create( this, libs ) );
     auto adapter = static_cast<SYMBOL_TREE_MODEL_ADAPTER*>( adapterPtr.get() );
 
+    // Libraries which did not change since they were indexed are not loaded
+    wxString symbolInfoCacheFile = GetSymbolInfoCacheFile();
+    GSymbolInfoCache.ReadCacheFromFile( symbolInfoCacheFile );
+
     const auto libNicknames = libs->GetLogicalLibs();
     adapter->AddLibraries( libNicknames, this );
 
+    if( !symbolInfoCacheFile.IsEmpty() )
+        GSymbolInfoCache.WriteCacheToFile( symbolInfoCacheFile );
+
     LIB_PART* current = GetSelectedSymbol();
     LIB_ID id;
     int unit = 0;
@@ -180,6 +180,18 @@ void SCH_BASE_FRAME::UpdateStatusBar()
 }
 
 
+wxString SCH_BASE_FRAME::GetSymbolInfoCacheFile()
+{
+    if( !GetSettingsManager()->IsProjectOpen()
+            || !wxFileName::IsDirWritable( Prj().GetProjectPath() ) )
+    {
+        return wxEmptyString;
+    }
+
+    return Prj().GetProjectPath() + "sym-info-cache";
+}
+
+
 LIB_PART* SCH_BASE_FRAME::GetLibPart( const LIB_ID& aLibId, bool aUseCacheLib, bool aShowErrorMsg )
 {
     PART_LIB* cache = ( aUseCacheLib ) ? Prj().SchLibs()->GetCacheLibrary() : NULL;
@@ -192,6 +192,12 @@ public:
 
     LIB_PART* GetFlattenedLibPart( const LIB_ID& aLibId, bool aShowErrorMsg = false );
 
+    /**
+     * @return the file keeping the symbol library index of the project (see
+     *         SYMBOL_INFO_CACHE), or an empty string if there is no project to keep it in.
+     */
+    wxString GetSymbolInfoCacheFile();
+
     /**
      * Function SelectComponentFromLibBrowser
      * Calls the library viewer to select component to import into schematic.
@@ -1226,7 +1226,14 @@ void SCH_EDIT_FRAME::RecalculateConnections( SCH_CLEANUP_FLAGS aCleanupFlags )
     if( settings.m_IntersheetsRefShow == true )
         RecomputeIntersheetsRefs();
 
-    Schematic().ConnectionGraph()->Recalculate( list, true );
+    // Only a global cleanup can modify every sheet: otherwise, the sheets unmodified since the
+    // last update are skipped.  Without real-time connectivity, updates are few and far between
+    // and are all done in full, as they always were.
+    bool unconditional = aCleanupFlags == GLOBAL_CLEANUP
+                            || !ADVANCED_CFG::GetCfg().m_realTimeConnectivity
+                            || !CONNECTION_GRAPH::m_allowRealTime;
+
+    Schematic().ConnectionGraph()->Recalculate( list, unconditional );
 }
 
 int SCH_EDIT_FRAME::RecomputeIntersheetsRefs()
@@ -902,6 +902,9 @@ public:
 
     /**
      * Generates the connection data for the entire schematic hierarchy.
+     *
+     * With real-time connectivity, and unless \a aCleanupFlags is GLOBAL_CLEANUP, only the
+     * sheets modified since the last call have the connectivity of their items recomputed.
      */
     void RecalculateConnections( SCH_CLEANUP_FLAGS aCleanupFlags );
 
@@ -54,9 +54,9 @@
 #include <sch_text.h>
 #include <schematic.h>
 #include <symbol_lib_table.h>
+#include <thread_pool.h>
 #include <tool/common_tools.h>
 
-#include <thread>
 #include <algorithm>
 #include <future>
 
@@ -1354,11 +1354,11 @@ void SCH_SCREENS::TestDanglingEnds()
     for( SCH_SCREEN* screen = GetFirst(); screen; screen = GetNext() )
         screens.push_back( screen );
 
-    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
-            screens.size() );
+    THREAD_POOL& tp = GetKiCadThreadPool();
+    size_t parallelThreadCount = std::min<size_t>( tp.GetThreadCount(), screens.size() );
 
     std::atomic<size_t> nextScreen( 0 );
-    std::vector<std::future<size_t>> returns( parallelThreadCount );
+    std::vector<std::future<size_t>> returns;
 
     auto update_lambda = [&screens, &nextScreen]() -> size_t
     {
@@ -1368,16 +1368,15 @@ void SCH_SCREENS::TestDanglingEnds()
         return 1;
     };
 
-    if( parallelThreadCount == 1 )
+    if( parallelThreadCount <= 1 )
         update_lambda();
     else
     {
         for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii] = std::async( std::launch::async, update_lambda );
+            returns.push_back( tp.Submit( update_lambda ) );
 
         // Finalize the threads
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii].wait();
+        tp.WaitAll( returns );
     }
 }
 
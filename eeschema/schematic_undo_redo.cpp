@@ -342,6 +342,9 @@ void SCH_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool aRed
                 break;
             }
 
+            // Connectivity may change
+            item->SetConnectivityDirty();
+
             if( item != &Schematic().Root() )
                 AddToScreen( item, (SCH_SCREEN*) aList->GetScreenForItem( (unsigned) ii ) );
         }
@@ -0,0 +1,246 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <cstdint>
+#include <functional>
+
+#include <wx/filename.h>
+
+#include <binary_stream.h>
+#include <class_libentry.h>
+#include <kicad_string.h>
+#include <symbol_lib_table.h>
+#include <symbol_info_cache.h>
+
+
+static const char     SYMBOL_INFO_CACHE_MAGIC[] = "KiCad symbol info cache";
+static const uint32_t SYMBOL_INFO_CACHE_VERSION = 1;
+
+
+SYMBOL_INFO_CACHE GSymbolInfoCache;
+
+
+SYMBOL_INFO::SYMBOL_INFO( const wxString& aNickname, LIB_PART* aPart ) :
+        m_nickname( aNickname ),
+        m_name( aPart->GetName() ),
+        m_description( aPart->GetDescription() ),
+        m_keywords( aPart->GetKeyWords() ),
+        m_footprint( aPart->GetFootprintField().GetText() ),
+        m_isRoot( aPart->IsRoot() ),
+        m_isPower( aPart->IsPower() ),
+        m_unitCount( aPart->GetUnitCount() ),
+        m_pinCount( 0 )
+{
+    // Derived symbols have the pins of their parent
+    if( aPart->IsRoot() )
+        m_pinCount = aPart->GetPinCount();
+    else if( PART_SPTR parent = aPart->GetParent().lock() )
+        m_pinCount = parent->GetPinCount();
+}
+
+
+SYMBOL_INFO::SYMBOL_INFO( const wxString& aNickname, const wxString& aName,
+                          const wxString& aDescription, const wxString& aKeywords,
+                          const wxString& aFootprint, bool aIsRoot, bool aIsPower,
+                          int aUnitCount, int aPinCount ) :
+        m_nickname( aNickname ),
+        m_name( aName ),
+        m_description( aDescription ),
+        m_keywords( aKeywords ),
+        m_footprint( aFootprint ),
+        m_isRoot( aIsRoot ),
+        m_isPower( aIsPower ),
+        m_unitCount( aUnitCount ),
+        m_pinCount( aPinCount )
+{
+}
+
+
+wxString SYMBOL_INFO::GetSearchText()
+{
+    // Matches are scored by offset from front of string, so inclusion of this spacer
+    // discounts matches found after it.
+    static const wxString discount( wxT( "        " ) );
+
+    wxString text = m_keywords + discount + m_description;
+
+    if( !m_footprint.IsEmpty() )
+        text += discount + m_footprint;
+
+    return text;
+}
+
+
+wxString SYMBOL_INFO::GetUnitReference( int aUnit )
+{
+    return LIB_PART::SubReference( aUnit, false );
+}
+
+
+long long SYMBOL_INFO_CACHE::LibraryTimestamp( SYMBOL_LIB_TABLE* aTable,
+                                               const wxString& aNickname )
+{
+    const SYMBOL_LIB_TABLE_ROW* row = aTable->FindRow( aNickname );
+
+    if( !row )
+        return 0;
+
+    wxString  uri = row->GetFullURI( true );
+    long long timestamp = std::hash<std::string>()( TO_UTF8( uri + row->GetType()
+                                                             + row->GetOptions() ) );
+
+    // Legacy libraries keep the symbol docs in a file of their own
+    wxFileName docFile( uri );
+    docFile.SetExt( "dcm" );
+
+    for( const wxFileName& fn : { wxFileName( uri ), docFile } )
+    {
+        if( fn.FileExists() )
+        {
+            timestamp += fn.GetModificationTime().GetValue().GetValue();
+            timestamp += fn.GetSize().GetValue();
+        }
+        else if( wxFileName::DirExists( fn.GetFullPath() ) )
+        {
+            timestamp += wxFileName::DirName( fn.GetFullPath() ).GetModificationTime()
+                                 .GetValue().GetValue();
+        }
+    }
+
+    return timestamp;
+}
+
+
+std::vector<SYMBOL_INFO>* SYMBOL_INFO_CACHE::GetLibrary( const wxString& aNickname,
+                                                         long long aTimestamp )
+{
+    auto it = m_libraries.find( aNickname );
+
+    if( it == m_libraries.end() || it->second.m_timestamp != aTimestamp )
+        return nullptr;
+
+    return &it->second.m_symbols;
+}
+
+
+void SYMBOL_INFO_CACHE::SetLibrary( const wxString& aNickname, long long aTimestamp,
+                                    const std::vector<LIB_PART*>& aSymbols )
+{
+    LIBRARY& library = m_libraries[ aNickname ];
+
+    library.m_timestamp = aTimestamp;
+    library.m_symbols.clear();
+
+    for( LIB_PART* part : aSymbols )
+        library.m_symbols.emplace_back( aNickname, part );
+
+    m_modified = true;
+}
+
+
+void SYMBOL_INFO_CACHE::WriteCacheToFile( const wxString& aFilePath )
+{
+    if( !m_modified && aFilePath == m_filePath )
+        return;
+
+    BINARY_STREAM_WRITER out;
+
+    out.WriteHeader( SYMBOL_INFO_CACHE_MAGIC, SYMBOL_INFO_CACHE_VERSION );
+    out.Write<uint32_t>( m_libraries.size() );
+
+    for( std::pair<const wxString, LIBRARY>& lib : m_libraries )
+    {
+        out.WriteString( TO_UTF8( lib.first ) );
+        out.Write<int64_t>( lib.second.m_timestamp );
+        out.Write<uint32_t>( lib.second.m_symbols.size() );
+
+        for( SYMBOL_INFO& info : lib.second.m_symbols )
+        {
+            out.WriteString( TO_UTF8( info.GetName() ) );
+            out.WriteString( TO_UTF8( info.GetDescription() ) );
+            out.WriteString( TO_UTF8( info.GetKeywords() ) );
+            out.WriteString( TO_UTF8( info.GetFootprint() ) );
+            out.Write<uint8_t>( info.IsRoot() );
+            out.Write<uint8_t>( info.IsPower() );
+            out.Write<int32_t>( info.GetUnitCount() );
+            out.Write<int32_t>( info.GetPinCount() );
+        }
+    }
+
+    if( out.WriteFile( aFilePath ) )
+    {
+        m_filePath = aFilePath;
+        m_modified = false;
+    }
+}
+
+
+void SYMBOL_INFO_CACHE::ReadCacheFromFile( const wxString& aFilePath )
+{
+    if( aFilePath == m_filePath )
+        return;
+
+    m_libraries.clear();
+    m_filePath = aFilePath;
+    m_modified = false;
+
+    BINARY_STREAM_READER in;
+
+    // Files in another format are simply ignored, the index is rebuilt
+    if( !in.ReadFile( aFilePath )
+            || !in.ReadHeader( SYMBOL_INFO_CACHE_MAGIC, SYMBOL_INFO_CACHE_VERSION ) )
+    {
+        return;
+    }
+
+    uint32_t libCount = in.Read<uint32_t>();
+
+    for( uint32_t ii = 0; ii < libCount && in.Ok(); ++ii )
+    {
+        wxString nickname = FROM_UTF8( in.ReadString().c_str() );
+        LIBRARY& library = m_libraries[ nickname ];
+
+        library.m_timestamp = in.Read<int64_t>();
+
+        uint32_t symbolCount = in.Read<uint32_t>();
+
+        for( uint32_t jj = 0; jj < symbolCount && in.Ok(); ++jj )
+        {
+            wxString name = FROM_UTF8( in.ReadString().c_str() );
+            wxString description = FROM_UTF8( in.ReadString().c_str() );
+            wxString keywords = FROM_UTF8( in.ReadString().c_str() );
+            wxString footprint = FROM_UTF8( in.ReadString().c_str() );
+            bool     isRoot = in.Read<uint8_t>() != 0;
+            bool     isPower = in.Read<uint8_t>() != 0;
+            int      unitCount = in.Read<int32_t>();
+            int      pinCount = in.Read<int32_t>();
+
+            library.m_symbols.emplace_back( nickname, name, description, keywords, footprint,
+                                            isRoot, isPower, unitCount, pinCount );
+        }
+    }
+
+    // A damaged file is ignored as a whole
+    if( !in.Ok() )
+        m_libraries.clear();
+}
@@ -0,0 +1,143 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef SYMBOL_INFO_CACHE_H
+#define SYMBOL_INFO_CACHE_H
+
+#include <map>
+#include <vector>
+
+#include <lib_tree_item.h>
+
+class LIB_PART;
+class SYMBOL_LIB_TABLE;
+
+
+/**
+ * What the symbol chooser shows of a symbol, kept in a SYMBOL_INFO_CACHE so that a library
+ * can be listed without loading it.
+ */
+class SYMBOL_INFO : public LIB_TREE_ITEM
+{
+public:
+    SYMBOL_INFO( const wxString& aNickname, LIB_PART* aPart );
+
+    SYMBOL_INFO( const wxString& aNickname, const wxString& aName, const wxString& aDescription,
+                 const wxString& aKeywords, const wxString& aFootprint, bool aIsRoot,
+                 bool aIsPower, int aUnitCount, int aPinCount );
+
+    LIB_ID GetLibId() const override { return LIB_ID( m_nickname, m_name ); }
+
+    wxString GetName() const override { return m_name; }
+    wxString GetLibNickname() const override { return m_nickname; }
+
+    wxString GetDescription() override { return m_description; }
+    wxString GetKeywords() const { return m_keywords; }
+    wxString GetFootprint() const { return m_footprint; }
+
+    /**
+     * The same search text as LIB_PART::GetSearchText()
+     */
+    wxString GetSearchText() override;
+
+    bool IsRoot() const override { return m_isRoot; }
+    bool IsPower() const { return m_isPower; }
+
+    int GetUnitCount() const override { return m_unitCount; }
+    wxString GetUnitReference( int aUnit ) override;
+
+    /**
+     * @return the number of pins of the symbol, in all its units and body styles.
+     */
+    int GetPinCount() const { return m_pinCount; }
+
+private:
+    wxString m_nickname;
+    wxString m_name;
+    wxString m_description;
+    wxString m_keywords;
+    wxString m_footprint;
+    bool     m_isRoot;
+    bool     m_isPower;
+    int      m_unitCount;
+    int      m_pinCount;
+};
+
+
+/**
+ * An index of the symbol libraries of a library table, saved to a binary file in the
+ * project so that the symbol chooser opens without loading any library: a library is only
+ * loaded when a symbol is picked from it, or when its files changed since it was indexed.
+ */
+class SYMBOL_INFO_CACHE
+{
+public:
+    SYMBOL_INFO_CACHE() :
+            m_modified( false )
+    {
+    }
+
+    /**
+     * @return a timestamp of the library \a aNickname of \a aTable, which changes when the
+     *         library files or its table row change.  Only the files are stat'ed.
+     */
+    static long long LibraryTimestamp( SYMBOL_LIB_TABLE* aTable, const wxString& aNickname );
+
+    /**
+     * @return the indexed symbols of \a aNickname, or NULL if the library is not indexed or
+     *         was indexed with another timestamp than \a aTimestamp.
+     */
+    std::vector<SYMBOL_INFO>* GetLibrary( const wxString& aNickname, long long aTimestamp );
+
+    /**
+     * Index \a aSymbols, which must be all the symbols of the library \a aNickname.
+     */
+    void SetLibrary( const wxString& aNickname, long long aTimestamp,
+                     const std::vector<LIB_PART*>& aSymbols );
+
+    /**
+     * Save the index to \a aFilePath, if it changed since it was read.
+     */
+    void WriteCacheToFile( const wxString& aFilePath );
+
+    /**
+     * Restore the index from \a aFilePath.  Files in another format, or damaged, leave the
+     * index empty.  Nothing is read again if the index was last read from \a aFilePath.
+     */
+    void ReadCacheFromFile( const wxString& aFilePath );
+
+private:
+    struct LIBRARY
+    {
+        long long                m_timestamp;
+        std::vector<SYMBOL_INFO> m_symbols;
+    };
+
+    std::map<wxString, LIBRARY> m_libraries;
+    wxString                    m_filePath;     ///< of the file the index was read from
+    bool                        m_modified;
+};
+
+extern SYMBOL_INFO_CACHE GSymbolInfoCache;        // KIFACE scope.
+
+#endif // SYMBOL_INFO_CACHE_H
@@ -27,6 +27,7 @@
 #include <symbol_lib_table.h>
 #include <class_libentry.h>
 #include <generate_alias_info.h>
+#include <symbol_info_cache.h>
 
 #include <symbol_tree_model_adapter.h>
 
@@ -96,6 +97,25 @@ void SYMBOL_TREE_MODEL_ADAPTER::AddLibrary( wxString const& aLibNickname )
     std::vector<LIB_PART*>      symbols;
     std::vector<LIB_TREE_ITEM*> comp_list;
 
+    // Libraries which did not change since they were indexed are listed from the index,
+    // without loading them
+    long long timestamp = SYMBOL_INFO_CACHE::LibraryTimestamp( m_libs, aLibNickname );
+    std::vector<SYMBOL_INFO>* indexed = GSymbolInfoCache.GetLibrary( aLibNickname, timestamp );
+
+    if( indexed )
+    {
+        for( SYMBOL_INFO& info : *indexed )
+        {
+            if( !onlyPowerSymbols || info.IsPower() )
+                comp_list.push_back( &info );
+        }
+
+        if( comp_list.size() > 0 )
+            DoAddLibrary( aLibNickname, m_libs->GetDescription( aLibNickname ), comp_list, false );
+
+        return;
+    }
+
     try
     {
         m_libs->LoadSymbolLib( symbols, aLibNickname, onlyPowerSymbols );
@@ -108,6 +128,10 @@ void SYMBOL_TREE_MODEL_ADAPTER::AddLibrary( wxString const& aLibNickname )
         return;
     }
 
+    // Only a library loaded in full can be indexed
+    if( !onlyPowerSymbols )
+        GSymbolInfoCache.SetLibrary( aLibNickname, timestamp, symbols );
+
     if( symbols.size() > 0 )
     {
         comp_list.assign( symbols.begin(), symbols.end() );
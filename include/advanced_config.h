@@ -147,6 +147,27 @@ public:
      */
     bool m_SkipBoundingBoxOnFpLoad;
 
+    /**
+     * Maximum number of threads in the shared thread pool.  0 means one per hardware thread.
+     */
+    int m_MaximumThreads;
+
+    /**
+     * Parse the items of large boards on the shared thread pool when loading them.
+     */
+    bool m_ParallelBoardLoad;
+
+    /**
+     * Save zone fill data in a cache file next to the board, and use it when reopening.
+     */
+    bool m_ZoneFillCache;
+
+    /**
+     * Merge zone clearance holes by groups on the thread pool (see
+     * SHAPE_POLY_SET::SimplifyByGroups()) rather than all at once.
+     */
+    bool m_ZoneFillMergeByGroups;
+
 private:
     ADVANCED_CFG();
 
@@ -0,0 +1,140 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef BINARY_STREAM_H
+#define BINARY_STREAM_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <wx/string.h>
+
+
+/**
+ * Appends plain values to a byte buffer, to be written as a whole to a cache file.  Caches
+ * are only ever read back on the machine which wrote them, so values are written in native
+ * byte order.
+ */
+class BINARY_STREAM_WRITER
+{
+public:
+    /**
+     * Start the data with \a aMagic, telling which kind of file it is, and \a aVersion of
+     * its format.
+     */
+    void WriteHeader( const std::string& aMagic, uint32_t aVersion );
+
+    template <typename T>
+    void Write( T aValue )
+    {
+        static_assert( std::is_trivially_copyable<T>::value, "Write() needs a plain value" );
+
+        const char* bytes = reinterpret_cast<const char*>( &aValue );
+        m_data.insert( m_data.end(), bytes, bytes + sizeof( T ) );
+    }
+
+    void WriteString( const std::string& aString );
+
+    const std::vector<char>& Data() const { return m_data; }
+
+    /**
+     * Write the data to \a aFileName.  It is written to a temporary file which is renamed
+     * over \a aFileName, so that an interrupted save leaves the previous file rather than a
+     * truncated one.
+     *
+     * @return true if the file was written.
+     */
+    bool WriteFile( const wxString& aFileName ) const;
+
+private:
+    std::vector<char> m_data;
+};
+
+
+/**
+ * Reads back what BINARY_STREAM_WRITER wrote.  Reading past the end of the data clears Ok()
+ * and returns zeros from then on, so damaged files end the reading rather than crash it.
+ */
+class BINARY_STREAM_READER
+{
+public:
+    BINARY_STREAM_READER() :
+            m_pos( 0 ),
+            m_ok( false )
+    {
+    }
+
+    BINARY_STREAM_READER( const std::vector<char>& aData ) :
+            m_data( aData ),
+            m_pos( 0 ),
+            m_ok( true )
+    {
+    }
+
+    /**
+     * Read all of \a aFileName, in a single read.
+     *
+     * @return false, with Ok() cleared, if the file is missing, empty or cannot be read.
+     */
+    bool ReadFile( const wxString& aFileName );
+
+    /**
+     * Read the header written by BINARY_STREAM_WRITER::WriteHeader().
+     *
+     * @return false, with Ok() cleared, if the data is not of the kind \a aMagic, or not in
+     *         the format \a aVersion.
+     */
+    bool ReadHeader( const std::string& aMagic, uint32_t aVersion );
+
+    bool Ok() const { return m_ok; }
+
+    template <typename T>
+    T Read()
+    {
+        static_assert( std::is_trivially_copyable<T>::value, "Read() needs a plain value" );
+
+        T value = T();
+
+        if( !m_ok || m_data.size() - m_pos < sizeof( T ) )
+        {
+            m_ok = false;
+            return value;
+        }
+
+        memcpy( &value, &m_data[m_pos], sizeof( T ) );
+        m_pos += sizeof( T );
+        return value;
+    }
+
+    std::string ReadString();
+
+private:
+    std::vector<char> m_data;
+    size_t            m_pos;
+    bool              m_ok;
+};
+
+#endif // BINARY_STREAM_H
@@ -110,7 +110,8 @@ protected:
 
     const KEYWORD*      keywords;               ///< table sorted by CMake for bsearch()
     unsigned            keywordCount;           ///< count of keywords table
-    KEYWORD_MAP         keyword_hash;           ///< fast, specialized "C string" hashtable
+    std::vector<const KEYWORD*> keywordSlots;   ///< open addressed hash of keywords[]
+    unsigned            keywordMask;            ///< keywordSlots.size() - 1
 
     void init();
 
@@ -398,6 +399,19 @@ public:
      */
     wxArrayString* ReadCommentLines();
 
+    /**
+     * Function CaptureCurrentList
+     * appends the raw text of the list holding the current token to \a aText, starting with
+     * its opening parenthesis (which must have been the previous token) and ending with the
+     * matching closing parenthesis, and advances past it.  The text is only scanned for
+     * parentheses and quoted strings rather than tokenized, so it can be handed to another
+     * lexer (perhaps on another thread) and parsed later.  Upon return CurTok() is DSN_RIGHT.
+     * Not for use in specctraMode.
+     *
+     * @throw IO_ERROR if the reader hits the end of file before the list is closed.
+     */
+    void CaptureCurrentList( std::string& aText );
+
     /**
      * Function IsSymbol
      * tests a token to see if it is a symbol.  This means it cannot be a
@@ -47,7 +47,6 @@ class FOOTPRINT_ASYNC_LOADER;
 class PROGRESS_REPORTER;
 class wxTopLevelWindow;
 class KIWAY;
-class wxTextFile;
 
 
 /*
@@ -196,8 +195,17 @@ public:
     {
     }
 
-    virtual void WriteCacheToFile( wxTextFile* aFile ) { };
-    virtual void ReadCacheFromFile( wxTextFile* aFile ) { };
+    /**
+     * Save the list, with the timestamp of each of its libraries, to the cache file
+     * \a aFilePath.
+     */
+    virtual void WriteCacheToFile( const wxString& aFilePath ) { };
+
+    /**
+     * Restore the list from the cache file \a aFilePath.  ReadFootprintFiles() then only
+     * reads again the libraries whose timestamps changed.
+     */
+    virtual void ReadCacheFromFile( const wxString& aFilePath ) { };
 
     /**
      * @return the number of items stored in list
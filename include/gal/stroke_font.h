@@ -42,9 +42,6 @@ namespace KIGFX
 {
 class GAL;
 
-typedef std::vector<std::vector<VECTOR2D>*> GLYPH;
-typedef std::vector<GLYPH*>                 GLYPH_LIST;
-
 /**
  * @brief Class STROKE_FONT implements stroke font drawing.
  *
@@ -61,6 +58,9 @@ public:
     /**
      * @brief Load the new stroke font.
      *
+     * The glyphs are read in place from the font data, which must outlive the font: nothing
+     * is decoded or allocated here.
+     *
      * @param aNewStrokeFont is the pointer to the font data.
      * @param aNewStrokeFontSize is the size of the font data.
      * @return True, if the font was successfully loaded, else false.
@@ -113,9 +113,27 @@ public:
 
 
 private:
-    GAL*                      m_gal;                  ///< Pointer to the GAL
-    const GLYPH_LIST*         m_glyphs;               ///< Glyph list
-    const std::vector<BOX2D>* m_glyphBoundingBoxes;   ///< Bounding boxes of the glyphs
+    GAL*               m_gal;              ///< Pointer to the GAL
+    const char* const* m_glyphs;           ///< Glyph list, in the newstroke font format
+    int                m_glyphCount;       ///< Number of glyphs in m_glyphs
+
+    /**
+     * @brief Return the glyph of a character, or the glyph of a substitute character if the
+     * font has no glyph for it.
+     *
+     * A glyph is a string of coordinate pairs, each value coded as an ASCII char offset by 'R'.
+     * The first pair gives the glyph start and end X, and the following ones give the points
+     * of the strokes, separated by " R" (raise pen).
+     */
+    const char* getGlyph( int aChar ) const;
+
+    /**
+     * @brief Return the advance width of a glyph, i.e. the X end of its bounding box.
+     */
+    static double glyphWidth( const char* aGlyph )
+    {
+        return ( aGlyph[1] - 'R' ) * STROKE_FONT_SCALE - ( aGlyph[0] - 'R' ) * STROKE_FONT_SCALE;
+    }
 
     /**
      * @brief Compute the X and Y size of a given text. The text is expected to be
@@ -134,15 +152,6 @@ private:
     double computeOverbarVerticalPosition() const;
     double computeUnderlineVerticalPosition() const;
 
-    /**
-     * @brief Compute the bounding box of a given glyph.
-     *
-     * @param aGlyph is the glyph.
-     * @param aGlyphWidth is the x-component of the bounding box size.
-     * @return is the complete bounding box size.
-     */
-    BOX2D computeBoundingBox( const GLYPH* aGlyph, double aGlyphWidth ) const;
-
     /**
      * @brief Draws a single line of text. Multiline texts should be split before using the
      * function.
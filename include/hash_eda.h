@@ -47,7 +47,11 @@ enum HASH_FLAGS
     HASH_NET    = 0x10,
     HASH_REF    = 0x20,
     HASH_VALUE  = 0x40,
-    HASH_ALL    = 0xff
+    HASH_ALL    = 0xff,
+
+    ///> also hash everything else that shapes copper, such as drills, pad attributes, text
+    ///> thickness and polygon points (for zone fill fingerprints; not part of HASH_ALL)
+    HASH_FILL   = 0x100
 };
 
 /**
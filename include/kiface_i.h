@@ -46,7 +46,7 @@ public:
     /*
     {
         typically call start_common() in your overload
-        return start_common();
+        return start_common( aProgram, aCtlBits );
     }
     */
 
@@ -87,7 +87,7 @@ public:
 protected:
 
     /// Common things to do for a top program module, during OnKifaceStart().
-    bool start_common( int aCtlBits );
+    bool start_common( PGM_BASE* aProgram, int aCtlBits );
 
     /// Common things to do for a top program module, during OnKifaceEnd();
     void end_common();
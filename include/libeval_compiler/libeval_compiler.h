@@ -24,8 +24,10 @@
 #include <cstddef>
 #include <functional>
 #include <map>
+#include <memory>
 #include <string>
 #include <stack>
+#include <vector>
 
 #include <base_units.h>
 #include <wx/intl.h>
@@ -241,6 +243,18 @@ public:
             m_valueStr = val.m_valueStr;
     }
 
+    /**
+     * Return to the undefined state.  The string's buffer is kept so that a recycled value
+     * can be refilled without allocating.
+     */
+    void Clear()
+    {
+        m_type = VT_UNDEFINED;
+        m_valueDbl = 0.0;
+        m_valueStr.clear();
+        m_stringIsWildcard = false;
+    }
+
 private:
     VAR_TYPE_T  m_type;
     double      m_valueDbl;
@@ -256,46 +270,102 @@ public:
 
     virtual VAR_TYPE_T GetType() const = 0;
     virtual VALUE GetValue( CONTEXT* aCtx ) = 0;
+
+    /**
+     * Store the variable's value in \a aResult.  Override to fill in the result directly
+     * rather than going through a temporary VALUE.
+     */
+    virtual void FetchValue( CONTEXT* aCtx, VALUE* aResult )
+    {
+        aResult->Set( GetValue( aCtx ) );
+    }
 };
 
 
 class CONTEXT
 {
 public:
+    CONTEXT() :
+        m_arenaPos( 0 ),
+        m_spillPos( 0 ),
+        m_stack( INITIAL_STACK_SIZE ),
+        m_stackPtr( 0 )
+    {
+    }
+
     virtual ~CONTEXT()
     {
         for( VALUE* value : m_ownedValues )
             delete value;
     }
 
+    /**
+     * Hand out a value for an intermediate result.
+     *
+     * Values come from a fixed-size arena inside the context (spilling into a heap pool for
+     * unusually long expressions) and are recycled by Reset(), so evaluating an expression
+     * repeatedly on the same context doesn't allocate.
+     */
     VALUE* AllocValue()
     {
-        VALUE* value = new VALUE();
-        m_ownedValues.push_back( value );
+        VALUE* value;
+
+        if( m_arenaPos < ARENA_SIZE )
+        {
+            value = &m_arena[ m_arenaPos++ ];
+        }
+        else if( m_spillPos < m_ownedValues.size() )
+        {
+            value = m_ownedValues[ m_spillPos++ ];
+        }
+        else
+        {
+            value = new VALUE();
+            m_ownedValues.push_back( value );
+            m_spillPos++;
+            return value;
+        }
+
+        value->Clear();
         return value;
     }
 
+    /**
+     * Empty the stack, clear any pending error and recycle all values handed out by
+     * AllocValue().  Any VALUE pointer obtained from this context before the call must not be
+     * used afterwards.
+     */
+    void Reset()
+    {
+        m_arenaPos = 0;
+        m_spillPos = 0;
+        m_stackPtr = 0;
+        m_errorStatus.pendingError = false;
+    }
+
     void Push( VALUE* v )
     {
-        m_stack.push( v );
+        // Grows at most a few times over the life of the context, as Reset() keeps capacity
+        if( m_stackPtr >= m_stack.size() )
+            m_stack.resize( m_stack.size() * 2 );
+
+        m_stack[ m_stackPtr++ ] = v;
     }
 
     VALUE* Pop()
     {
-        if( m_stack.size() == 0 )
+        if( m_stackPtr == 0 )
         {
             ReportError( _( "Malformed expression" ) );
             return AllocValue();
         }
 
-        VALUE* value = m_stack.top();
-        m_stack.pop();
-        return value;
+        return m_stack[ --m_stackPtr ];
     }
 
     int SP() const
     {
-        return m_stack.size();
+        return (int) m_stackPtr;
     };
 
     void SetErrorCallback( std::function<void( const wxString& aMessage, int aOffset )> aCallback )
@@ -308,40 +378,20 @@ public:
     const ERROR_STATUS& GetError() const { return m_errorStatus; }
 
 private:
-    std::vector<VALUE*> m_ownedValues;
-    std::stack<VALUE*>  m_stack;
-    ERROR_STATUS        m_errorStatus;
+    static constexpr size_t ARENA_SIZE = 16;
+    static constexpr size_t INITIAL_STACK_SIZE = 32;
 
-    std::function<void( const wxString& aMessage, int aOffset )> m_errorCallback;
-};
-
-
-class UCODE
-{
-public:
-    virtual ~UCODE();
-
-    void AddOp( UOP* uop )
-    {
-        m_ucode.push_back(uop);
-    }
-
-    VALUE* Run( CONTEXT* ctx );
-    wxString Dump() const;
-
-    virtual std::unique_ptr<VAR_REF> CreateVarRef( const wxString& var, const wxString& field )
-    {
-        return nullptr;
-    };
+    VALUE               m_arena[ARENA_SIZE];
+    size_t              m_arenaPos;
+    std::vector<VALUE*> m_ownedValues;
+    size_t              m_spillPos;
 
-    virtual FUNC_CALL_REF CreateFuncCall( const wxString& name )
-    {
-        return nullptr;
-    };
+    std::vector<VALUE*> m_stack;
+    size_t              m_stackPtr;
 
-protected:
+    ERROR_STATUS        m_errorStatus;
 
-    std::vector<UOP*> m_ucode;
+    std::function<void( const wxString& aMessage, int aOffset )> m_errorCallback;
 };
 
 
@@ -367,12 +417,15 @@ public:
         m_value(nullptr)
     {};
 
-    ~UOP()
-    {
-    }
-
     void Exec( CONTEXT* ctx );
 
+    int GetOp() const { return m_op; }
+
+    /**
+     * @return true if the op pushes a value known at compile time.
+     */
+    bool IsConstant() const { return m_op == TR_UOP_PUSH_VALUE && m_value; }
+
     wxString Format() const;
 
 private:
@@ -383,6 +436,47 @@ private:
     std::unique_ptr<VALUE>   m_value;
 };
 
+
+class UCODE
+{
+public:
+    virtual ~UCODE();
+
+    /**
+     * Append \a uop (taking ownership).  Operators whose operands are all constants are
+     * folded into a single constant push.
+     */
+    void AddOp( UOP* uop );
+
+    /**
+     * Evaluate the code on \a ctx.  The context is reset first, so the returned value is only
+     * valid until the next Run() on the same context.
+     */
+    VALUE* Run( CONTEXT* ctx );
+    wxString Dump() const;
+
+    virtual std::unique_ptr<VAR_REF> CreateVarRef( const wxString& var, const wxString& field )
+    {
+        return nullptr;
+    };
+
+    virtual FUNC_CALL_REF CreateFuncCall( const wxString& name )
+    {
+        return nullptr;
+    };
+
+private:
+    /**
+     * Replace the last op and its operands by a single push of their result, if the operands
+     * are all constants and evaluating them raises no error.
+     */
+    void foldConstants();
+
+protected:
+    std::vector<UOP> m_ucode;
+};
+
+
 class TOKENIZER
 {
 public:
@@ -46,6 +46,7 @@ class wxWindow;
 
 class COMMON_SETTINGS;
 class SETTINGS_MANAGER;
+class THREAD_POOL;
 
 /**
  *   A small class to handle the list of existing translations.
@@ -307,6 +308,13 @@ public:
      */
     VTBL_ENTRY wxApp&   App();
 
+    /**
+     * Function GetThreadPool
+     * returns the thread pool of the program.  The kifaces run their parallel work on it
+     * rather than each on a pool of their own.
+     */
+    VTBL_ENTRY THREAD_POOL& GetThreadPool();
+
     //----</Cross Module API>----------------------------------------------------
 
     static const wxChar workingDirKey[];
@@ -284,6 +284,23 @@ public:
 };
 
 
+/**
+ * BUFFERED_FILE_LINE_READER
+ * is a LINE_READER that reads a whole file into memory with one read when it is
+ * constructed, and then hands out its lines like STRING_LINE_READER.  This is considerably
+ * faster than FILE_LINE_READER for large files, at the cost of holding the file in memory.
+ */
+class BUFFERED_FILE_LINE_READER : public STRING_LINE_READER
+{
+public:
+    /**
+     * @param aFileName is the name of the file to read, also used for error reporting.
+     * @throw IO_ERROR if the file can't be opened or read.
+     */
+    BUFFERED_FILE_LINE_READER( const wxString& aFileName );
+};
+
+
 /**
  * INPUTSTREAM_LINE_READER
  * is a LINE_READER that reads from a wxInputStream object.
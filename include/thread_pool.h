@@ -0,0 +1,266 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/**
+ * Exception stored in the future of a task which was cancelled before it started running.
+ */
+class TASK_CANCELLED : public std::exception
+{
+public:
+    const char* what() const noexcept override
+    {
+        return "task cancelled";
+    }
+};
+
+
+/**
+ * A cooperative cancellation flag shared between the submitter of a group of tasks and the
+ * tasks themselves.
+ *
+ * Tasks submitted with a canceller which has been cancelled by the time they are dequeued are
+ * not run at all (their future throws TASK_CANCELLED).  Tasks which are already running are
+ * expected to poll IsCancelled() at their own safe points.  Copies share the same flag.
+ */
+class TASK_CANCELLER
+{
+public:
+    TASK_CANCELLER() :
+            m_flag( std::make_shared<std::atomic<bool>>( false ) )
+    {
+    }
+
+    void Cancel()
+    {
+        m_flag->store( true );
+    }
+
+    bool IsCancelled() const
+    {
+        return m_flag->load();
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> m_flag;
+};
+
+
+/**
+ * A work-stealing pool of worker threads.
+ *
+ * Each worker owns a task deque.  Tasks submitted from a worker go to the back of its own
+ * deque and are popped LIFO by that worker; idle workers steal from the front of the other
+ * deques.  Tasks submitted from outside the pool are distributed round-robin.
+ *
+ * Workers waiting on a task future through Wait() execute pending tasks while the result is
+ * not yet available, so tasks may themselves submit and wait on sub-tasks without starving
+ * the pool.  Other threads (in particular the UI thread) only block: they never pick up tasks
+ * which may belong to an unrelated subsystem.
+ *
+ * Most code should use the shared pool returned by GetKiCadThreadPool() rather than creating
+ * its own, so that overlapping phases (zone filling, connectivity, rendering...) share one
+ * set of threads instead of each spinning up hardware_concurrency() of their own.
+ */
+class THREAD_POOL
+{
+public:
+    /**
+     * @param aThreadCount is the number of worker threads to start.  0 means one thread per
+     *                     hardware thread.
+     */
+    explicit THREAD_POOL( size_t aThreadCount = 0 );
+
+    ~THREAD_POOL();
+
+    THREAD_POOL( const THREAD_POOL& ) = delete;
+    THREAD_POOL& operator=( const THREAD_POOL& ) = delete;
+
+    /**
+     * @return the number of worker threads in the pool.
+     */
+    size_t GetThreadCount() const { return m_workers.size(); }
+
+    /**
+     * Queue a callable for execution on the pool.
+     *
+     * @return a future holding the callable's result (or the exception it threw).
+     */
+    template <typename FUNC>
+    auto Submit( FUNC&& aFunc ) -> std::future<decltype( aFunc() )>
+    {
+        using RESULT = decltype( aFunc() );
+
+        auto task = std::make_shared<std::packaged_task<RESULT()>>( std::forward<FUNC>( aFunc ) );
+        std::future<RESULT> result = task->get_future();
+
+        enqueue( [task]()
+                 {
+                     ( *task )();
+                 } );
+
+        return result;
+    }
+
+    /**
+     * Queue a callable for execution on the pool, skipping it if \a aCanceller is cancelled
+     * before the task starts.
+     */
+    template <typename FUNC>
+    auto Submit( FUNC&& aFunc, const TASK_CANCELLER& aCanceller )
+            -> std::future<decltype( aFunc() )>
+    {
+        using RESULT = decltype( aFunc() );
+
+        return Submit( [func = std::forward<FUNC>( aFunc ), aCanceller]() mutable -> RESULT
+                       {
+                           if( aCanceller.IsCancelled() )
+                               throw TASK_CANCELLED();
+
+                           return func();
+                       } );
+    }
+
+    /**
+     * Block until \a aFuture is ready.
+     *
+     * When called from one of the pool's workers, the worker runs other pending pool tasks
+     * while the result is not yet available.  Any other thread just blocks on the future
+     * (there is no polling delay).
+     *
+     * @param aKeepAlive is called roughly every 100ms while waiting (typically used to keep a
+     *                   progress reporter refreshing).
+     */
+    template <typename T>
+    void Wait( std::future<T>& aFuture, const std::function<void()>& aKeepAlive = nullptr )
+    {
+        if( aKeepAlive )
+        {
+            while( aFuture.wait_for( std::chrono::milliseconds( 100 ) )
+                    != std::future_status::ready )
+            {
+                aKeepAlive();
+            }
+
+            return;
+        }
+
+        if( !IsWorkerThread() )
+        {
+            aFuture.wait();
+            return;
+        }
+
+        while( aFuture.wait_for( std::chrono::seconds( 0 ) ) != std::future_status::ready )
+        {
+            if( !RunPendingTask() )
+                aFuture.wait();
+        }
+    }
+
+    /**
+     * Wait for all of \a aFutures.  See Wait().
+     */
+    template <typename T>
+    void WaitAll( std::vector<std::future<T>>& aFutures,
+                  const std::function<void()>& aKeepAlive = nullptr )
+    {
+        for( std::future<T>& future : aFutures )
+        {
+            if( future.valid() )
+                Wait( future, aKeepAlive );
+        }
+    }
+
+    /**
+     * Run all of \a aTasks, the first one on the calling thread and the others on the pool,
+     * and wait for them.
+     */
+    void RunAll( std::vector<std::function<void()>>& aTasks );
+
+    /**
+     * Run a single queued task on the calling thread, if there is one.
+     *
+     * @return true if a task was run.
+     */
+    bool RunPendingTask();
+
+    /**
+     * @return true if the calling thread is one of the workers of this pool.
+     */
+    bool IsWorkerThread() const;
+
+private:
+    struct TASK_QUEUE
+    {
+        std::mutex                        m_mutex;
+        std::deque<std::function<void()>> m_tasks;
+    };
+
+    void enqueue( std::function<void()>&& aTask );
+
+    bool popTask( std::function<void()>& aTask );
+
+    void workerLoop( size_t aIndex );
+
+    std::vector<std::unique_ptr<TASK_QUEUE>> m_queues;
+    std::vector<std::thread>                 m_workers;
+
+    std::mutex                               m_sleepMutex;
+    std::condition_variable                  m_wakeup;
+    std::atomic<size_t>                      m_pending;
+    std::atomic<size_t>                      m_nextQueue;
+    bool                                     m_stop;
+};
+
+
+/**
+ * Get the shared thread pool.
+ *
+ * The pool is created on first use with the number of threads given by the MaximumThreads
+ * advanced config setting (or one per hardware thread if unset).  In a kiface, this is the
+ * pool of the hosting program (see SetKiCadThreadPool()), so there is one pool per process.
+ */
+THREAD_POOL& GetKiCadThreadPool();
+
+/**
+ * Make GetKiCadThreadPool() return \a aPool rather than a pool of its own.
+ *
+ * The common library is linked into each kiface, which would otherwise each get their own
+ * pool.  Kifaces call this at start up with the pool of the program hosting them.
+ */
+void SetKiCadThreadPool( THREAD_POOL* aPool );
+
+
+#endif // THREAD_POOL_H
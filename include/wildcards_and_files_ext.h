@@ -129,6 +129,7 @@ extern const std::string ArchiveFileExtension;
 
 extern const std::string LegacyPcbFileExtension;
 extern const std::string KiCadPcbFileExtension;
+extern const std::string ZoneFillCacheFileExtension;
 #define PcbFileExtension    KiCadPcbFileExtension       // symlink choice
 extern const std::string KiCadSymbolLibFileExtension;
 extern const std::string PageLayoutDescrFileExtension;
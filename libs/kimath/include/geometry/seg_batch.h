@@ -0,0 +1,124 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __SEG_BATCH_H
+#define __SEG_BATCH_H
+
+#include <vector>
+
+#include <geometry/seg.h>
+
+/**
+ * A set of segments stored as contiguous arrays of coordinates, to find the one closest to a
+ * point or to another segment.
+ *
+ * The distances reported are the ones of SEG::SquaredDistance(), to the unit: the boxes of the
+ * segments are first compared with the query using SIMD instructions when the processor has
+ * them, and SEG::SquaredDistance() is then only called for the segments whose box is close
+ * enough to improve on the closest one found so far.
+ *
+ * As for SEG, the coordinate differences must fit in an int.
+ */
+class SEG_BATCH
+{
+public:
+    using ecoord = SEG::ecoord;
+
+    /// Instruction sets used to compare the boxes of the segments with the query
+    enum class SIMD_LEVEL
+    {
+        SCALAR,
+        SSE2,
+        AVX2
+    };
+
+    struct RESULT
+    {
+        ecoord m_squaredDistance;   ///< VECTOR2I::ECOORD_MAX if no segment was found
+        int    m_index;             ///< index of the closest segment, or -1
+    };
+
+    SEG_BATCH() {}
+
+    void Reserve( size_t aSize );
+
+    void Clear();
+
+    void Append( const SEG& aSeg );
+
+    size_t Size() const { return m_ax.size(); }
+
+    SEG Get( size_t aIndex ) const
+    {
+        return SEG( m_ax[aIndex], m_ay[aIndex], m_bx[aIndex], m_by[aIndex] );
+    }
+
+    /**
+     * Find the first of the segments \a aFirst to \a aLast (excluded) with the smallest
+     * SEG::SquaredDistance() to \a aP, if it is less than \a aBound.
+     */
+    RESULT Nearest( const VECTOR2I& aP, size_t aFirst, size_t aLast,
+                    ecoord aBound = VECTOR2I::ECOORD_MAX ) const;
+
+    RESULT Nearest( const VECTOR2I& aP ) const
+    {
+        return Nearest( aP, 0, Size() );
+    }
+
+    /**
+     * Find the first of the segments \a aFirst to \a aLast (excluded) with the smallest
+     * SEG::SquaredDistance() to \a aSeg, if it is less than \a aBound.
+     */
+    RESULT Nearest( const SEG& aSeg, size_t aFirst, size_t aLast,
+                    ecoord aBound = VECTOR2I::ECOORD_MAX ) const;
+
+    RESULT Nearest( const SEG& aSeg ) const
+    {
+        return Nearest( aSeg, 0, Size() );
+    }
+
+    /**
+     * @return the best instruction set supported by the processor.
+     */
+    static SIMD_LEVEL SupportedSimdLevel();
+
+    /**
+     * @return the instruction set used by the queries, by default the best supported one.
+     */
+    static SIMD_LEVEL GetSimdLevel();
+
+    /**
+     * Use \a aLevel, if it is supported, for the queries of all the batches.  Meant for tests
+     * and benchmarks.
+     */
+    static void SetSimdLevel( SIMD_LEVEL aLevel );
+
+private:
+    template <typename DISTANCE>
+    RESULT nearest( const int aBox[4], size_t aFirst, size_t aLast, ecoord aBound,
+                    DISTANCE aDistance ) const;
+
+    std::vector<int> m_ax, m_ay, m_bx, m_by;
+};
+
+#endif // __SEG_BATCH_H
@@ -27,6 +27,8 @@
 #define __SHAPE_LINE_CHAIN
 
 
+#include <atomic>
+
 #include <clipper.hpp>
 #include <geometry/seg.h>
 #include <geometry/shape.h>
@@ -171,6 +173,7 @@ public:
      */
     void Clear()
     {
+        m_segmentIndex.Reset();
         m_points.clear();
         m_arcs.clear();
         m_shapes.clear();
@@ -186,6 +189,7 @@ public:
      */
     void SetClosed( bool aClosed )
     {
+        m_segmentIndex.Reset();
         m_closed = aClosed;
     }
 
@@ -295,6 +299,7 @@ public:
         else if( aIndex >= PointCount() )
             aIndex -= PointCount();
 
+        m_segmentIndex.Reset();
         m_points[aIndex] = aPos;
 
         if( m_shapes[aIndex] != SHAPE_IS_PT )
@@ -424,6 +429,8 @@ public:
      */
     void Append( const VECTOR2I& aP, bool aAllowDuplication = false )
     {
+        m_segmentIndex.Reset();
+
         if( m_points.size() == 0 )
             m_bbox = BOX2I( aP, VECTOR2I( 0, 0 ) );
 
@@ -664,6 +671,8 @@ public:
 
     void Move( const VECTOR2I& aVector ) override
     {
+        m_segmentIndex.Reset();
+
         for( auto& pt : m_points )
             pt += aVector;
 
@@ -724,7 +733,90 @@ public:
     virtual size_t GetPointCount() const override { return PointCount(); }
     virtual size_t GetSegmentCount() const override { return SegmentCount(); }
 
+    /*
+     * The following queries give the same results as their SHAPE_LINE_CHAIN_BASE versions.
+     * On chains of at least SEGMENT_INDEX_MIN_SEGMENTS segments they use a bounding volume
+     * hierarchy of the segments, built on first use and dropped when the chain is modified,
+     * instead of testing every segment.
+     */
+
+    /// @copydoc SHAPE_LINE_CHAIN_BASE::Collide( const VECTOR2I&, int, int*, VECTOR2I* )
+    bool Collide( const VECTOR2I& aP, int aClearance = 0, int* aActual = nullptr,
+                  VECTOR2I* aLocation = nullptr ) const override;
+
+    /// @copydoc SHAPE_LINE_CHAIN_BASE::Collide( const SEG&, int, int*, VECTOR2I* )
+    bool Collide( const SEG& aSeg, int aClearance = 0, int* aActual = nullptr,
+                  VECTOR2I* aLocation = nullptr ) const override;
+
+    /// @copydoc SHAPE_LINE_CHAIN_BASE::SquaredDistance()
+    SEG::ecoord SquaredDistance( const VECTOR2I& aP, bool aOutlineOnly = false ) const;
+
+    /// @copydoc SHAPE_LINE_CHAIN_BASE::PointInside()
+    bool PointInside( const VECTOR2I& aPt, int aAccuracy = 0, bool aUseBBoxCache = false ) const;
+
+    /// @copydoc SHAPE_LINE_CHAIN_BASE::PointOnEdge()
+    bool PointOnEdge( const VECTOR2I& aP, int aAccuracy = 0 ) const;
+
+    /// @copydoc SHAPE_LINE_CHAIN_BASE::EdgeContainingPoint()
+    int EdgeContainingPoint( const VECTOR2I& aP, int aAccuracy = 0 ) const;
+
+    /// Chains with fewer segments are queried segment by segment
+    static const int SEGMENT_INDEX_MIN_SEGMENTS = 64;
+
 private:
+    class SEGMENT_INDEX;
+
+    /**
+     * Owns the segment index of a chain.  Copies start without an index, as it belongs to the
+     * points of the chain it was built for.
+     */
+    class SEGMENT_INDEX_CACHE
+    {
+    public:
+        SEGMENT_INDEX_CACHE() :
+                m_index( nullptr )
+        {}
+
+        SEGMENT_INDEX_CACHE( const SEGMENT_INDEX_CACHE& ) :
+                m_index( nullptr )
+        {}
+
+        SEGMENT_INDEX_CACHE& operator=( const SEGMENT_INDEX_CACHE& )
+        {
+            Reset();
+            return *this;
+        }
+
+        ~SEGMENT_INDEX_CACHE()
+        {
+            Reset();
+        }
+
+        /// Drops the index; called by every method modifying the chain
+        void Reset()
+        {
+            if( m_index.load( std::memory_order_relaxed ) )
+                release();
+        }
+
+        /// @return the index of \a aChain, building it if needed.  Thread safe.
+        const SEGMENT_INDEX* Get( const SHAPE_LINE_CHAIN& aChain ) const;
+
+    private:
+        void release();
+
+        mutable std::atomic<SEGMENT_INDEX*> m_index;
+    };
+
+    /// @return the segment index, or nullptr if the chain is too short to need one
+    const SEGMENT_INDEX* segmentIndex() const
+    {
+        if( SegmentCount() < SEGMENT_INDEX_MIN_SEGMENTS )
+            return nullptr;
+
+        return m_segmentIndex.Get( *this );
+    }
+
 
     constexpr static ssize_t SHAPE_IS_PT = -1;
 
@@ -752,6 +844,8 @@ private:
 
     /// cached bounding box
     BOX2I m_bbox;
+
+    SEGMENT_INDEX_CACHE m_segmentIndex;
 };
 
 
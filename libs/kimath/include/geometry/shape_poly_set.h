@@ -26,8 +26,10 @@
 #ifndef __SHAPE_POLY_SET_H
 #define __SHAPE_POLY_SET_H
 
+#include <atomic>
 #include <cstdio>
 #include <deque>                        // for deque
+#include <functional>
 #include <vector>                       // for vector
 #include <iosfwd>                       // for string, stringstream
 #include <memory>
@@ -69,6 +71,10 @@ class SHAPE_POLY_SET : public SHAPE
         ///> N.B. SWIG only supports typedef, so avoid c++ 'using' keyword
         typedef std::vector<SHAPE_LINE_CHAIN> POLYGON;
 
+        ///> runs a set of independent tasks (possibly in parallel), and returns when they are
+        ///> all done
+        typedef std::function<void( std::vector<std::function<void()>>& )> TASK_RUNNER;
+
         class TRIANGULATED_POLYGON
         {
         public:
@@ -159,11 +165,21 @@ class SHAPE_POLY_SET : public SHAPE
                 return m_triangles;
             }
 
+            const std::deque<TRI>& Triangles() const
+            {
+                return m_triangles;
+            }
+
             size_t GetVertexCount() const
             {
                 return m_vertices.size();
             }
 
+            const VECTOR2I& GetVertex( int aIndex ) const
+            {
+                return m_vertices[ aIndex ];
+            }
+
             void Move( const VECTOR2I& aVec )
             {
                 for( auto& vertex : m_vertices )
@@ -637,6 +653,7 @@ class SHAPE_POLY_SET : public SHAPE
         ///> Returns the reference to aIndex-th outline in the set
         SHAPE_LINE_CHAIN& Outline( int aIndex )
         {
+            m_contourGrid.Reset();
             return m_polys[aIndex][0];
         }
 
@@ -659,12 +676,14 @@ class SHAPE_POLY_SET : public SHAPE
         ///> Returns the reference to aHole-th hole in the aIndex-th outline
         SHAPE_LINE_CHAIN& Hole( int aOutline, int aHole )
         {
+            m_contourGrid.Reset();
             return m_polys[aOutline][aHole + 1];
         }
 
         ///> Returns the aIndex-th subpolygon in the set
         POLYGON& Polygon( int aIndex )
         {
+            m_contourGrid.Reset();
             return m_polys[aIndex];
         }
 
@@ -707,6 +726,8 @@ class SHAPE_POLY_SET : public SHAPE
         {
             ITERATOR iter;
 
+            m_contourGrid.Reset();
+
             iter.m_poly = this;
             iter.m_currentPolygon = aFirst;
             iter.m_lastPolygon = aLast < 0 ? OutlineCount() - 1 : aLast;
@@ -819,6 +840,8 @@ class SHAPE_POLY_SET : public SHAPE
         {
             SEGMENT_ITERATOR iter;
 
+            m_contourGrid.Reset();
+
             iter.m_poly = this;
             iter.m_currentPolygon = aFirst;
             iter.m_lastPolygon = aLast < 0 ? OutlineCount() - 1 : aLast;
@@ -988,6 +1011,12 @@ class SHAPE_POLY_SET : public SHAPE
         ///> For aFastMode meaning, see function booleanOp
         void Simplify( POLYGON_MODE aFastMode );
 
+        ///> Same as Simplify(), for sets of many small polygons such as the clearance holes of a
+        ///> zone fill: neighbouring polygons are merged by groups first, then the groups together,
+        ///> which is much faster than merging all the polygons at once.
+        ///> aRunTasks runs the merges of the groups, one after the other if not given.
+        void SimplifyByGroups( POLYGON_MODE aFastMode, const TASK_RUNNER& aRunTasks = nullptr );
+
         /**
          * Function NormalizeAreaOutlines
          * Convert a self-intersecting polygon to one (or more) non self-intersecting polygon(s)
@@ -1073,6 +1102,8 @@ class SHAPE_POLY_SET : public SHAPE
          * @param aActual an optional pointer to an int to store the actual distance in the event
          *                of a collision.
          * @return bool - true if the point aP collides with the polygon; false in any other case.
+         *
+         * The contour grid is used if enabled (see EnableContainsCache()).
          */
         bool Collide( const VECTOR2I& aP, int aClearance = 0, int* aActual = nullptr,
                       VECTOR2I* aLocation = nullptr ) const override;
@@ -1132,6 +1163,25 @@ class SHAPE_POLY_SET : public SHAPE
          */
         void BuildBBoxCaches();
 
+        /**
+         * Enables (or disables) a grid of the contours of the set, which speeds up Contains()
+         * and Collide() of points on sets with many contours or large ones.
+         *
+         * The grid is built on the first query, from any thread, and dropped by the editing
+         * actions (including the non-const accessors).  Contours edited through references
+         * obtained before the grid was built are not noticed, so such references must not be
+         * kept across queries.  Results are the same with and without the grid.
+         */
+        void EnableContainsCache( bool aEnable = true )
+        {
+            m_contourGrid.Enable( aEnable );
+        }
+
+        bool IsContainsCacheEnabled() const
+        {
+            return m_contourGrid.IsEnabled();
+        }
+
         const BOX2I BBoxFromCaches() const;
 
         /**
@@ -1143,6 +1193,9 @@ class SHAPE_POLY_SET : public SHAPE
          *                       editing in between, but the caller MUST cache the bbox caches
          *                       before calling (via BuildBBoxCaches(), above)
          * @return true if the polygon contains the point
+         *
+         * With an accuracy of at most 1, the contour grid is used if enabled (see
+         * EnableContainsCache()).
          */
         bool Contains( const VECTOR2I& aP, int aSubpolyIndex = -1, int aAccuracy = 0,
                        bool aUseBBoxCaches = false ) const;
@@ -1389,6 +1442,12 @@ class SHAPE_POLY_SET : public SHAPE
         void CacheTriangulation( bool aPartition = true );
         bool IsTriangulationUpToDate() const;
 
+        /**
+         * Use a triangulation built earlier for the same polygons (for instance one read back
+         * from a file) rather than triangulating again.
+         */
+        void SetTriangulation( std::vector<std::unique_ptr<TRIANGULATED_POLYGON>>&& aTriangulation );
+
         MD5_HASH GetHash() const;
 
         virtual bool HasIndexableSubshapes() const override;
@@ -1401,10 +1460,69 @@ class SHAPE_POLY_SET : public SHAPE
 
         MD5_HASH checksum() const;
 
+        class CONTOUR_GRID;
+
+        /**
+         * Owns the contour grid of the set.  Copies are enabled like the original, but start
+         * without a grid.
+         */
+        class CONTOUR_GRID_CACHE
+        {
+        public:
+            CONTOUR_GRID_CACHE() :
+                    m_enabled( false ),
+                    m_grid( nullptr )
+            {}
+
+            CONTOUR_GRID_CACHE( const CONTOUR_GRID_CACHE& aOther ) :
+                    m_enabled( aOther.m_enabled ),
+                    m_grid( nullptr )
+            {}
+
+            CONTOUR_GRID_CACHE& operator=( const CONTOUR_GRID_CACHE& aOther )
+            {
+                Reset();
+                m_enabled = aOther.m_enabled;
+                return *this;
+            }
+
+            ~CONTOUR_GRID_CACHE()
+            {
+                Reset();
+            }
+
+            void Enable( bool aEnable )
+            {
+                Reset();
+                m_enabled = aEnable;
+            }
+
+            bool IsEnabled() const { return m_enabled; }
+
+            /// Drops the grid; called by every method which can modify the set
+            void Reset()
+            {
+                if( m_grid.load( std::memory_order_relaxed ) )
+                    release();
+            }
+
+            /// @return the grid of \a aSet, building it if needed, or nullptr if disabled.
+            /// Thread safe.
+            const CONTOUR_GRID* Get( const SHAPE_POLY_SET& aSet ) const;
+
+        private:
+            void release();
+
+            bool                               m_enabled;
+            mutable std::atomic<CONTOUR_GRID*> m_grid;
+        };
+
         std::vector<std::unique_ptr<TRIANGULATED_POLYGON>> m_triangulatedPolys;
         bool m_triangulationValid = false;
         MD5_HASH m_hash;
 
+        CONTOUR_GRID_CACHE m_contourGrid;
+
 };
 
 #endif
@@ -0,0 +1,309 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+#include <geometry/seg_batch.h>
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define SEG_BATCH_X86
+#include <immintrin.h>
+#endif
+
+
+/*
+ * The box kernels compute, for aCount segments, a lower bound of the squared distance between
+ * the box of each segment and the query box aBox (min x, min y, max x, max y).
+ *
+ * SEG::NearestPoint() always returns a point of the box of the segment, so no point of the
+ * segment reported by SEG::SquaredDistance() can be closer to the query than the box.  The
+ * bounds are computed with doubles, whose rounding is accounted for by the caller.
+ */
+typedef void ( *BOX_KERNEL )( const int* aAx, const int* aAy, const int* aBx, const int* aBy,
+                              size_t aCount, const double aBox[4], double* aBounds );
+
+
+static void boxBoundsScalar( const int* aAx, const int* aAy, const int* aBx, const int* aBy,
+                             size_t aCount, const double aBox[4], double* aBounds )
+{
+    // The box distances are exact in int64.  They are computed with masks rather than
+    // branches, which would be mispredicted half of the time.
+    typedef int64_t INT64;
+
+    const INT64 boxMinX = aBox[0], boxMinY = aBox[1], boxMaxX = aBox[2], boxMaxY = aBox[3];
+
+    auto positivePart = []( INT64 a ) -> INT64
+                        {
+                            return a & ~( a >> 63 );
+                        };
+
+    // Distance between the ranges [aA, aB] (in any order) and [aMin, aMax]: at most one of the
+    // two gaps is positive
+    auto gap = [&]( INT64 aA, INT64 aB, INT64 aMin, INT64 aMax ) -> INT64
+               {
+                   INT64 lower = ( aA - aB ) & ( ( aA - aB ) >> 63 );
+
+                   return positivePart( aB + lower - aMax ) + positivePart( aMin - aA + lower );
+               };
+
+    for( size_t ii = 0; ii < aCount; ++ii )
+    {
+        INT64 dx = gap( aAx[ii], aBx[ii], boxMinX, boxMaxX );
+        INT64 dy = gap( aAy[ii], aBy[ii], boxMinY, boxMaxY );
+
+        aBounds[ii] = (double) dx * dx + (double) dy * dy;
+    }
+}
+
+
+#ifdef SEG_BATCH_X86
+
+__attribute__(( target( "sse2" ) ))
+static void boxBoundsSse2( const int* aAx, const int* aAy, const int* aBx, const int* aBy,
+                           size_t aCount, const double aBox[4], double* aBounds )
+{
+    const __m128d boxMinX = _mm_set1_pd( aBox[0] );
+    const __m128d boxMinY = _mm_set1_pd( aBox[1] );
+    const __m128d boxMaxX = _mm_set1_pd( aBox[2] );
+    const __m128d boxMaxY = _mm_set1_pd( aBox[3] );
+    const __m128d zero = _mm_setzero_pd();
+    size_t        ii = 0;
+
+    for( ; ii + 2 <= aCount; ii += 2 )
+    {
+        __m128d ax = _mm_cvtepi32_pd( _mm_loadl_epi64( (const __m128i*) ( aAx + ii ) ) );
+        __m128d ay = _mm_cvtepi32_pd( _mm_loadl_epi64( (const __m128i*) ( aAy + ii ) ) );
+        __m128d bx = _mm_cvtepi32_pd( _mm_loadl_epi64( (const __m128i*) ( aBx + ii ) ) );
+        __m128d by = _mm_cvtepi32_pd( _mm_loadl_epi64( (const __m128i*) ( aBy + ii ) ) );
+
+        __m128d dx = _mm_max_pd( _mm_sub_pd( _mm_min_pd( ax, bx ), boxMaxX ),
+                                 _mm_sub_pd( boxMinX, _mm_max_pd( ax, bx ) ) );
+        __m128d dy = _mm_max_pd( _mm_sub_pd( _mm_min_pd( ay, by ), boxMaxY ),
+                                 _mm_sub_pd( boxMinY, _mm_max_pd( ay, by ) ) );
+
+        dx = _mm_max_pd( dx, zero );
+        dy = _mm_max_pd( dy, zero );
+
+        _mm_storeu_pd( aBounds + ii, _mm_add_pd( _mm_mul_pd( dx, dx ), _mm_mul_pd( dy, dy ) ) );
+    }
+
+    boxBoundsScalar( aAx + ii, aAy + ii, aBx + ii, aBy + ii, aCount - ii, aBox, aBounds + ii );
+}
+
+
+__attribute__(( target( "avx2" ) ))
+static void boxBoundsAvx2( const int* aAx, const int* aAy, const int* aBx, const int* aBy,
+                           size_t aCount, const double aBox[4], double* aBounds )
+{
+    const __m256d boxMinX = _mm256_set1_pd( aBox[0] );
+    const __m256d boxMinY = _mm256_set1_pd( aBox[1] );
+    const __m256d boxMaxX = _mm256_set1_pd( aBox[2] );
+    const __m256d boxMaxY = _mm256_set1_pd( aBox[3] );
+    const __m256d zero = _mm256_setzero_pd();
+    size_t        ii = 0;
+
+    for( ; ii + 4 <= aCount; ii += 4 )
+    {
+        __m256d ax = _mm256_cvtepi32_pd( _mm_loadu_si128( (const __m128i*) ( aAx + ii ) ) );
+        __m256d ay = _mm256_cvtepi32_pd( _mm_loadu_si128( (const __m128i*) ( aAy + ii ) ) );
+        __m256d bx = _mm256_cvtepi32_pd( _mm_loadu_si128( (const __m128i*) ( aBx + ii ) ) );
+        __m256d by = _mm256_cvtepi32_pd( _mm_loadu_si128( (const __m128i*) ( aBy + ii ) ) );
+
+        __m256d dx = _mm256_max_pd( _mm256_sub_pd( _mm256_min_pd( ax, bx ), boxMaxX ),
+                                    _mm256_sub_pd( boxMinX, _mm256_max_pd( ax, bx ) ) );
+        __m256d dy = _mm256_max_pd( _mm256_sub_pd( _mm256_min_pd( ay, by ), boxMaxY ),
+                                    _mm256_sub_pd( boxMinY, _mm256_max_pd( ay, by ) ) );
+
+        dx = _mm256_max_pd( dx, zero );
+        dy = _mm256_max_pd( dy, zero );
+
+        _mm256_storeu_pd( aBounds + ii,
+                          _mm256_add_pd( _mm256_mul_pd( dx, dx ), _mm256_mul_pd( dy, dy ) ) );
+    }
+
+    // The scalar code below doesn't use the VEX encoding: avoid the AVX to SSE transition stall
+    _mm256_zeroupper();
+
+    boxBoundsScalar( aAx + ii, aAy + ii, aBx + ii, aBy + ii, aCount - ii, aBox, aBounds + ii );
+}
+
+#endif // SEG_BATCH_X86
+
+
+static std::atomic<int> s_simdLevel( -1 );
+
+
+SEG_BATCH::SIMD_LEVEL SEG_BATCH::SupportedSimdLevel()
+{
+#ifdef SEG_BATCH_X86
+    __builtin_cpu_init();
+
+    if( __builtin_cpu_supports( "avx2" ) )
+        return SIMD_LEVEL::AVX2;
+
+    if( __builtin_cpu_supports( "sse2" ) )
+        return SIMD_LEVEL::SSE2;
+#endif
+
+    return SIMD_LEVEL::SCALAR;
+}
+
+
+SEG_BATCH::SIMD_LEVEL SEG_BATCH::GetSimdLevel()
+{
+    int level = s_simdLevel.load( std::memory_order_relaxed );
+
+    if( level < 0 )
+    {
+        level = static_cast<int>( SupportedSimdLevel() );
+        s_simdLevel.store( level, std::memory_order_relaxed );
+    }
+
+    return static_cast<SIMD_LEVEL>( level );
+}
+
+
+void SEG_BATCH::SetSimdLevel( SIMD_LEVEL aLevel )
+{
+    aLevel = std::min( aLevel, SupportedSimdLevel() );
+    s_simdLevel.store( static_cast<int>( aLevel ), std::memory_order_relaxed );
+}
+
+
+static BOX_KERNEL boxKernel( SEG_BATCH::SIMD_LEVEL aLevel )
+{
+    switch( aLevel )
+    {
+#ifdef SEG_BATCH_X86
+    case SEG_BATCH::SIMD_LEVEL::AVX2: return boxBoundsAvx2;
+    case SEG_BATCH::SIMD_LEVEL::SSE2: return boxBoundsSse2;
+#endif
+    default:                          return boxBoundsScalar;
+    }
+}
+
+
+void SEG_BATCH::Reserve( size_t aSize )
+{
+    m_ax.reserve( aSize );
+    m_ay.reserve( aSize );
+    m_bx.reserve( aSize );
+    m_by.reserve( aSize );
+}
+
+
+void SEG_BATCH::Clear()
+{
+    m_ax.clear();
+    m_ay.clear();
+    m_bx.clear();
+    m_by.clear();
+}
+
+
+void SEG_BATCH::Append( const SEG& aSeg )
+{
+    m_ax.push_back( aSeg.A.x );
+    m_ay.push_back( aSeg.A.y );
+    m_bx.push_back( aSeg.B.x );
+    m_by.push_back( aSeg.B.y );
+}
+
+
+template <typename DISTANCE>
+SEG_BATCH::RESULT SEG_BATCH::nearest( const int aBox[4], size_t aFirst, size_t aLast,
+                                      ecoord aBound, DISTANCE aDistance ) const
+{
+    // The box bounds are computed for blocks of segments, so that an exact distance found
+    // early in a block can still skip the following segments of the block
+    const size_t BLOCK_SIZE = 64;
+
+    const BOX_KERNEL kernel = boxKernel( GetSimdLevel() );
+    const double     box[4] = { (double) aBox[0], (double) aBox[1], (double) aBox[2],
+                                (double) aBox[3] };
+    double           bounds[BLOCK_SIZE];
+    RESULT           result = { VECTOR2I::ECOORD_MAX, -1 };
+
+    // A segment can be skipped when its box is further than the current bound, with a margin
+    // well over the rounding errors of the doubles
+    auto skipLimit = []( ecoord aLimit )
+                     {
+                         return (double) aLimit * ( 1.0 + 1e-9 ) + 1.0;
+                     };
+
+    double limit = skipLimit( aBound );
+
+    for( size_t block = aFirst; block < aLast && aBound > 0; block += BLOCK_SIZE )
+    {
+        size_t count = std::min( BLOCK_SIZE, aLast - block );
+
+        kernel( &m_ax[block], &m_ay[block], &m_bx[block], &m_by[block], count, box, bounds );
+
+        for( size_t ii = 0; ii < count && aBound > 0; ++ii )
+        {
+            if( bounds[ii] > limit )
+                continue;
+
+            ecoord dist = aDistance( Get( block + ii ) );
+
+            if( dist < aBound )
+            {
+                aBound = dist;
+                limit = skipLimit( aBound );
+                result.m_squaredDistance = dist;
+                result.m_index = static_cast<int>( block + ii );
+            }
+        }
+    }
+
+    return result;
+}
+
+
+SEG_BATCH::RESULT SEG_BATCH::Nearest( const VECTOR2I& aP, size_t aFirst, size_t aLast,
+                                      ecoord aBound ) const
+{
+    const int box[4] = { aP.x, aP.y, aP.x, aP.y };
+
+    return nearest( box, aFirst, aLast, aBound,
+                    [&]( const SEG& aCandidate )
+                    {
+                        return aCandidate.SquaredDistance( aP );
+                    } );
+}
+
+
+SEG_BATCH::RESULT SEG_BATCH::Nearest( const SEG& aSeg, size_t aFirst, size_t aLast,
+                                      ecoord aBound ) const
+{
+    const int box[4] = { std::min( aSeg.A.x, aSeg.B.x ), std::min( aSeg.A.y, aSeg.B.y ),
+                         std::max( aSeg.A.x, aSeg.B.x ), std::max( aSeg.A.y, aSeg.B.y ) };
+
+    return nearest( box, aFirst, aLast, aBound,
+                    [&]( const SEG& aCandidate )
+                    {
+                        return aCandidate.SquaredDistance( aSeg );
+                    } );
+}
@@ -272,6 +272,7 @@ static inline bool Collide( const SHAPE_LINE_CHAIN_BASE& aA, const SHAPE_LINE_CH
     }
     else
     {
+        // Long SHAPE_LINE_CHAINs look up the segments near aB's in their segment index
         for( int i = 0; i < aB.GetSegmentCount(); i++ )
         {
             int collision_dist = 0;
@@ -24,11 +24,13 @@
 
 #include <algorithm>
 #include <limits.h>          // for INT_MAX
+#include <limits>
 #include <math.h>            // for hypot
 #include <string>            // for basic_string
 
 #include <clipper.hpp>
 #include <geometry/seg.h>    // for SEG, OPT_VECTOR2I
+#include <geometry/seg_batch.h>
 #include <geometry/shape_line_chain.h>
 #include <math/box2.h>       // for BOX2I
 #include <math/util.h>  // for rescale
@@ -140,6 +142,8 @@ bool SHAPE_LINE_CHAIN_BASE::Collide( const VECTOR2I& aP, int aClearance, int* aA
 
 void SHAPE_LINE_CHAIN::Rotate( double aAngle, const VECTOR2I& aCenter )
 {
+    m_segmentIndex.Reset();
+
     for( auto& pt : m_points )
     {
         pt -= aCenter;
@@ -240,6 +244,8 @@ long long int SHAPE_LINE_CHAIN::Length() const
 
 void SHAPE_LINE_CHAIN::Mirror( bool aX, bool aY, const VECTOR2I& aRef )
 {
+    m_segmentIndex.Reset();
+
     for( auto& pt : m_points )
     {
         if( aX )
@@ -256,6 +262,8 @@ void SHAPE_LINE_CHAIN::Mirror( bool aX, bool aY, const VECTOR2I& aRef )
 
 void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const VECTOR2I& aP )
 {
+    m_segmentIndex.Reset();
+
     if( aEndIndex < 0 )
         aEndIndex += PointCount();
 
@@ -287,6 +295,8 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const VECTOR2I&
 
 void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const SHAPE_LINE_CHAIN& aLine )
 {
+    m_segmentIndex.Reset();
+
     if( aEndIndex < 0 )
         aEndIndex += PointCount();
 
@@ -312,6 +322,8 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const SHAPE_LINE
 
 void SHAPE_LINE_CHAIN::Remove( int aStartIndex, int aEndIndex )
 {
+    m_segmentIndex.Reset();
+
     assert( m_shapes.size() == m_points.size() );
     if( aEndIndex < 0 )
         aEndIndex += PointCount();
@@ -363,6 +375,8 @@ SEG::ecoord SHAPE_LINE_CHAIN_BASE::SquaredDistance( const VECTOR2I& aP, bool aOu
 
 int SHAPE_LINE_CHAIN::Split( const VECTOR2I& aP )
 {
+    m_segmentIndex.Reset();
+
     int ii = -1;
     int min_dist = 2;
 
@@ -439,6 +453,8 @@ const SHAPE_LINE_CHAIN SHAPE_LINE_CHAIN::Slice( int aStartIndex, int aEndIndex )
 
 void SHAPE_LINE_CHAIN::Append( const SHAPE_LINE_CHAIN& aOtherLine )
 {
+    m_segmentIndex.Reset();
+
     assert( m_shapes.size() == m_points.size() );
 
     if( aOtherLine.PointCount() == 0 )
@@ -476,6 +492,8 @@ void SHAPE_LINE_CHAIN::Append( const SHAPE_LINE_CHAIN& aOtherLine )
 
 void SHAPE_LINE_CHAIN::Append( const SHAPE_ARC& aArc )
 {
+    m_segmentIndex.Reset();
+
     auto& chain = aArc.ConvertToPolyline();
 
     for( auto& pt : chain.CPoints() )
@@ -492,6 +510,8 @@ void SHAPE_LINE_CHAIN::Append( const SHAPE_ARC& aArc )
 
 void SHAPE_LINE_CHAIN::Insert( size_t aVertex, const VECTOR2I& aP )
 {
+    m_segmentIndex.Reset();
+
     if( m_shapes[aVertex] != SHAPE_IS_PT )
         convertArc( aVertex );
 
@@ -504,6 +524,8 @@ void SHAPE_LINE_CHAIN::Insert( size_t aVertex, const VECTOR2I& aP )
 
 void SHAPE_LINE_CHAIN::Insert( size_t aVertex, const SHAPE_ARC& aArc )
 {
+    m_segmentIndex.Reset();
+
     if( m_shapes[aVertex] != SHAPE_IS_PT )
         convertArc( aVertex );
 
@@ -814,6 +836,8 @@ const OPT<SHAPE_LINE_CHAIN::INTERSECTION> SHAPE_LINE_CHAIN::SelfIntersecting() c
 
 SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify()
 {
+    m_segmentIndex.Reset();
+
     std::vector<VECTOR2I> pts_unique;
     std::vector<ssize_t> shapes_unique;
 
@@ -1016,6 +1040,8 @@ SHAPE* SHAPE_LINE_CHAIN::Clone() const
 
 bool SHAPE_LINE_CHAIN::Parse( std::stringstream& aStream )
 {
+    m_segmentIndex.Reset();
+
     size_t n_pts;
     size_t n_arcs;
 
@@ -1204,3 +1230,435 @@ bool SHAPE_LINE_CHAIN::POINT_INSIDE_TRACKER::IsInside()
     return m_state > 0;
 }
 
+
+
+const int SHAPE_LINE_CHAIN::SEGMENT_INDEX_MIN_SEGMENTS;
+
+
+/**
+ * A bounding volume hierarchy of the segments of a line chain.
+ *
+ * Consecutive segments of a chain are usually close to each other, so each node simply covers
+ * a range of segment indices, split in two halves down to leaves of a few segments.  Nodes are
+ * visited depth first, lower half first, so segments are reported in increasing index order:
+ * this keeps the results of the queries identical to the ones of a linear scan.
+ */
+class SHAPE_LINE_CHAIN::SEGMENT_INDEX
+{
+public:
+    struct NODE
+    {
+        int m_minX, m_minY, m_maxX, m_maxY;
+        int m_first, m_last;            ///< range of segments covered, m_last excluded
+        int m_lower, m_upper;           ///< child nodes, -1 for leaves
+    };
+
+    SEGMENT_INDEX( const SHAPE_LINE_CHAIN& aChain )
+    {
+        int segCount = aChain.SegmentCount();
+
+        m_nodes.reserve( 2 * ( segCount / LEAF_SIZE + 1 ) );
+        m_segments.Reserve( segCount );
+
+        for( int ii = 0; ii < segCount; ++ii )
+            m_segments.Append( aChain.CSegment( ii ) );
+
+        build( aChain, 0, segCount );
+    }
+
+    /// The segments of the chain, for the distance queries in the leaves
+    const SEG_BATCH& Segments() const { return m_segments; }
+
+    /**
+     * Call \a aVisitor for the range of segments ( first, last excluded ) of each leaf accepted
+     * by \a aAccept, in increasing order, until \a aVisitor returns false.
+     */
+    template <typename ACCEPT, typename VISITOR>
+    void VisitLeaves( ACCEPT aAccept, VISITOR aVisitor ) const
+    {
+        // Balanced tree: the depth is log2 of the leaf count
+        int stack[64];
+        int depth = 0;
+
+        stack[depth++] = 0;
+
+        while( depth > 0 )
+        {
+            const NODE& node = m_nodes[stack[--depth]];
+
+            if( !aAccept( node ) )
+                continue;
+
+            if( node.m_lower < 0 )
+            {
+                if( !aVisitor( node.m_first, node.m_last ) )
+                    return;
+            }
+            else
+            {
+                stack[depth++] = node.m_upper;
+                stack[depth++] = node.m_lower;
+            }
+        }
+    }
+
+    /**
+     * Call \a aVisitor for the index of each segment in a leaf accepted by \a aAccept, in
+     * increasing order, until \a aVisitor returns false.
+     */
+    template <typename ACCEPT, typename VISITOR>
+    void Visit( ACCEPT aAccept, VISITOR aVisitor ) const
+    {
+        VisitLeaves( aAccept,
+                     [&]( int aFirst, int aLast ) -> bool
+                     {
+                         for( int ii = aFirst; ii < aLast; ++ii )
+                         {
+                             if( !aVisitor( ii ) )
+                                 return false;
+                         }
+
+                         return true;
+                     } );
+    }
+
+    /**
+     * Call \a aVisitor for the segments of the leaves closer than \a aMargin to the box with
+     * corners \a aA and \a aB.  See Visit().
+     */
+    template <typename VISITOR>
+    void VisitNear( const VECTOR2I& aA, const VECTOR2I& aB, SEG::ecoord aMargin,
+                    VISITOR aVisitor ) const
+    {
+        SEG::ecoord minX = std::min( aA.x, aB.x ) - aMargin;
+        SEG::ecoord minY = std::min( aA.y, aB.y ) - aMargin;
+        SEG::ecoord maxX = std::max( aA.x, aB.x ) + aMargin;
+        SEG::ecoord maxY = std::max( aA.y, aB.y ) + aMargin;
+
+        Visit( [&]( const NODE& aNode ) -> bool
+               {
+                   return aNode.m_maxX >= minX && aNode.m_minX <= maxX
+                          && aNode.m_maxY >= minY && aNode.m_minY <= maxY;
+               },
+               aVisitor );
+    }
+
+private:
+    static const int LEAF_SIZE = 8;
+
+    int build( const SHAPE_LINE_CHAIN& aChain, int aFirst, int aLast )
+    {
+        int  nodeIdx = m_nodes.size();
+        NODE node;
+
+        m_nodes.emplace_back();
+
+        node.m_first = aFirst;
+        node.m_last = aLast;
+
+        if( aLast - aFirst <= LEAF_SIZE )
+        {
+            node.m_lower = node.m_upper = -1;
+            node.m_minX = node.m_minY = std::numeric_limits<int>::max();
+            node.m_maxX = node.m_maxY = std::numeric_limits<int>::min();
+
+            for( int ii = aFirst; ii < aLast; ++ii )
+            {
+                const SEG seg = aChain.CSegment( ii );
+
+                node.m_minX = std::min( { node.m_minX, seg.A.x, seg.B.x } );
+                node.m_minY = std::min( { node.m_minY, seg.A.y, seg.B.y } );
+                node.m_maxX = std::max( { node.m_maxX, seg.A.x, seg.B.x } );
+                node.m_maxY = std::max( { node.m_maxY, seg.A.y, seg.B.y } );
+            }
+        }
+        else
+        {
+            int mid = aFirst + ( aLast - aFirst ) / 2;
+
+            node.m_lower = build( aChain, aFirst, mid );
+            node.m_upper = build( aChain, mid, aLast );
+
+            const NODE& lower = m_nodes[node.m_lower];
+            const NODE& upper = m_nodes[node.m_upper];
+
+            node.m_minX = std::min( lower.m_minX, upper.m_minX );
+            node.m_minY = std::min( lower.m_minY, upper.m_minY );
+            node.m_maxX = std::max( lower.m_maxX, upper.m_maxX );
+            node.m_maxY = std::max( lower.m_maxY, upper.m_maxY );
+        }
+
+        m_nodes[nodeIdx] = node;
+        return nodeIdx;
+    }
+
+    std::vector<NODE> m_nodes;
+    SEG_BATCH         m_segments;
+};
+
+
+const SHAPE_LINE_CHAIN::SEGMENT_INDEX*
+SHAPE_LINE_CHAIN::SEGMENT_INDEX_CACHE::Get( const SHAPE_LINE_CHAIN& aChain ) const
+{
+    SEGMENT_INDEX* index = m_index.load( std::memory_order_acquire );
+
+    if( index )
+        return index;
+
+    // Another thread may be building one too: the first one stored wins
+    SEGMENT_INDEX* built = new SEGMENT_INDEX( aChain );
+
+    if( m_index.compare_exchange_strong( index, built, std::memory_order_acq_rel ) )
+        return built;
+
+    delete built;
+    return index;
+}
+
+
+void SHAPE_LINE_CHAIN::SEGMENT_INDEX_CACHE::release()
+{
+    delete m_index.exchange( nullptr );
+}
+
+
+
+bool SHAPE_LINE_CHAIN::PointInside( const VECTOR2I& aPt, int aAccuracy,
+                                    bool aUseBBoxCache ) const
+{
+    const SEGMENT_INDEX* index = segmentIndex();
+
+    if( !index )
+        return SHAPE_LINE_CHAIN_BASE::PointInside( aPt, aAccuracy, aUseBBoxCache );
+
+    if( !IsClosed() )
+        return false;
+
+    bool inside = false;
+    int  pointCount = PointCount();
+
+    // Only segments crossing the horizontal line of aPt, and not entirely on its left, can
+    // cross the ray cast from aPt in the positive x direction
+    index->Visit( [&]( const SEGMENT_INDEX::NODE& aNode ) -> bool
+                  {
+                      return aNode.m_maxX >= aPt.x && aNode.m_minY <= aPt.y
+                             && aNode.m_maxY > aPt.y;
+                  },
+                  [&]( int aSeg ) -> bool
+                  {
+                      const VECTOR2I& p1 = m_points[aSeg];
+                      const VECTOR2I& p2 = m_points[aSeg + 1 == pointCount ? 0 : aSeg + 1];
+                      const VECTOR2I  diff = p2 - p1;
+
+                      if( diff.y != 0 )
+                      {
+                          const int d = rescale( diff.x, ( aPt.y - p1.y ), diff.y );
+
+                          if( ( ( p1.y > aPt.y ) != ( p2.y > aPt.y ) ) && ( aPt.x - p1.x < d ) )
+                              inside = !inside;
+                      }
+
+                      return true;
+                  } );
+
+    if( aAccuracy <= 1 )
+        return inside;
+    else
+        return inside || PointOnEdge( aPt, aAccuracy );
+}
+
+
+bool SHAPE_LINE_CHAIN::PointOnEdge( const VECTOR2I& aPt, int aAccuracy ) const
+{
+    return EdgeContainingPoint( aPt, aAccuracy ) >= 0;
+}
+
+
+int SHAPE_LINE_CHAIN::EdgeContainingPoint( const VECTOR2I& aPt, int aAccuracy ) const
+{
+    const SEGMENT_INDEX* index = segmentIndex();
+
+    if( !index )
+        return SHAPE_LINE_CHAIN_BASE::EdgeContainingPoint( aPt, aAccuracy );
+
+    int edge = -1;
+
+    // SEG::Distance() rounds down, hence the extra unit
+    index->VisitNear( aPt, aPt, std::abs( (SEG::ecoord) aAccuracy ) + 2,
+                      [&]( int aSeg ) -> bool
+                      {
+                          const SEG s = CSegment( aSeg );
+
+                          if( s.A == aPt || s.B == aPt || s.Distance( aPt ) <= aAccuracy + 1 )
+                          {
+                              edge = aSeg;
+                              return false;
+                          }
+
+                          return true;
+                      } );
+
+    return edge;
+}
+
+
+SEG::ecoord SHAPE_LINE_CHAIN::SquaredDistance( const VECTOR2I& aP, bool aOutlineOnly ) const
+{
+    const SEGMENT_INDEX* index = segmentIndex();
+
+    if( !index )
+        return SHAPE_LINE_CHAIN_BASE::SquaredDistance( aP, aOutlineOnly );
+
+    if( IsClosed() && PointInside( aP ) && !aOutlineOnly )
+        return 0;
+
+    ecoord d = VECTOR2I::ECOORD_MAX;
+
+    // Skip the nodes which can't hold a segment closer than the closest one found so far
+    index->VisitLeaves( [&]( const SEGMENT_INDEX::NODE& aNode ) -> bool
+                        {
+                            ecoord dx = std::max( { (ecoord) aNode.m_minX - aP.x, (ecoord) 0,
+                                                    (ecoord) aP.x - aNode.m_maxX } );
+                            ecoord dy = std::max( { (ecoord) aNode.m_minY - aP.y, (ecoord) 0,
+                                                    (ecoord) aP.y - aNode.m_maxY } );
+
+                            return dx * dx + dy * dy <= d;
+                        },
+                        [&]( int aFirst, int aLast ) -> bool
+                        {
+                            SEG_BATCH::RESULT nearest =
+                                    index->Segments().Nearest( aP, aFirst, aLast, d );
+
+                            if( nearest.m_index >= 0 )
+                                d = nearest.m_squaredDistance;
+
+                            return d > 0;
+                        } );
+
+    return d;
+}
+
+
+bool SHAPE_LINE_CHAIN::Collide( const VECTOR2I& aP, int aClearance, int* aActual,
+                                VECTOR2I* aLocation ) const
+{
+    const SEGMENT_INDEX* index = segmentIndex();
+
+    if( !index )
+        return SHAPE_LINE_CHAIN_BASE::Collide( aP, aClearance, aActual, aLocation );
+
+    if( IsClosed() && PointInside( aP, aClearance ) )
+    {
+        if( aLocation )
+            *aLocation = aP;
+
+        if( aActual )
+            *aActual = 0;
+
+        return true;
+    }
+
+    SEG::ecoord closest_dist_sq = VECTOR2I::ECOORD_MAX;
+    SEG::ecoord clearance_sq = SEG::Square( aClearance );
+    VECTOR2I nearest;
+
+    // Segments further than aClearance can't collide, and can't be the closest of a collision
+    index->VisitNear( aP, aP, std::abs( (SEG::ecoord) aClearance ) + 1,
+                      [&]( int aSeg ) -> bool
+                      {
+                          const SEG   s = CSegment( aSeg );
+                          VECTOR2I    pn = s.NearestPoint( aP );
+                          SEG::ecoord dist_sq = ( pn - aP ).SquaredEuclideanNorm();
+
+                          if( dist_sq < closest_dist_sq )
+                          {
+                              nearest = pn;
+                              closest_dist_sq = dist_sq;
+
+                              if( closest_dist_sq == 0 )
+                                  return false;
+
+                              // If we're not looking for aActual then any collision will do
+                              if( closest_dist_sq < clearance_sq && !aActual )
+                                  return false;
+                          }
+
+                          return true;
+                      } );
+
+    if( closest_dist_sq == 0 || closest_dist_sq < clearance_sq )
+    {
+        if( aLocation )
+            *aLocation = nearest;
+
+        if( aActual )
+            *aActual = sqrt( closest_dist_sq );
+
+        return true;
+    }
+
+    return false;
+}
+
+
+bool SHAPE_LINE_CHAIN::Collide( const SEG& aSeg, int aClearance, int* aActual,
+                                VECTOR2I* aLocation ) const
+{
+    const SEGMENT_INDEX* index = segmentIndex();
+
+    if( !index )
+        return SHAPE_LINE_CHAIN_BASE::Collide( aSeg, aClearance, aActual, aLocation );
+
+    if( IsClosed() && PointInside( aSeg.A ) )
+    {
+        if( aLocation )
+            *aLocation = aSeg.A;
+
+        if( aActual )
+            *aActual = 0;
+
+        return true;
+    }
+
+    SEG::ecoord closest_dist_sq = VECTOR2I::ECOORD_MAX;
+    SEG::ecoord clearance_sq = SEG::Square( aClearance );
+    VECTOR2I nearest;
+
+    // Segments further than aClearance can't collide, and can't be the closest of a collision
+    index->VisitNear( aSeg.A, aSeg.B, std::abs( (SEG::ecoord) aClearance ) + 1,
+                      [&]( int aIdx ) -> bool
+                      {
+                          const SEG   s = CSegment( aIdx );
+                          SEG::ecoord dist_sq = s.SquaredDistance( aSeg );
+
+                          if( dist_sq < closest_dist_sq )
+                          {
+                              if( aLocation )
+                                  nearest = s.NearestPoint( aSeg );
+
+                              closest_dist_sq = dist_sq;
+
+                              if( closest_dist_sq == 0 )
+                                  return false;
+
+                              // If we're not looking for aActual then any collision will do
+                              if( closest_dist_sq < clearance_sq && !aActual )
+                                  return false;
+                          }
+
+                          return true;
+                      } );
+
+    if( closest_dist_sq == 0 || closest_dist_sq < clearance_sq )
+    {
+        if( aLocation )
+            *aLocation = nearest;
+
+        if( aActual )
+            *aActual = sqrt( closest_dist_sq );
+
+        return true;
+    }
+
+    return false;
+}
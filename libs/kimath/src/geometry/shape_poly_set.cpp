@@ -36,6 +36,7 @@
 #include <set>
 #include <string>                            // for char_traits, operator!=
 #include <type_traits>                       // for swap, move
+#include <utility>
 #include <unordered_set>
 #include <vector>
 
@@ -71,7 +72,7 @@ SHAPE_POLY_SET::SHAPE_POLY_SET( const SHAPE_LINE_CHAIN& aOutline ) :
 
 
 SHAPE_POLY_SET::SHAPE_POLY_SET( const SHAPE_POLY_SET& aOther ) :
-    SHAPE( aOther ), m_polys( aOther.m_polys )
+    SHAPE( aOther ), m_polys( aOther.m_polys ), m_contourGrid( aOther.m_contourGrid )
 {
     if( aOther.IsTriangulationUpToDate() )
     {
@@ -187,6 +188,8 @@ bool SHAPE_POLY_SET::GetGlobalIndex( SHAPE_POLY_SET::VERTEX_INDEX aRelativeIndic
 
 int SHAPE_POLY_SET::NewOutline()
 {
+    m_contourGrid.Reset();
+
     SHAPE_LINE_CHAIN empty_path;
     POLYGON poly;
 
@@ -199,6 +202,8 @@ int SHAPE_POLY_SET::NewOutline()
 
 int SHAPE_POLY_SET::NewHole( int aOutline )
 {
+    m_contourGrid.Reset();
+
     SHAPE_LINE_CHAIN empty_path;
 
     empty_path.SetClosed( true );
@@ -216,6 +221,8 @@ int SHAPE_POLY_SET::NewHole( int aOutline )
 
 int SHAPE_POLY_SET::Append( int x, int y, int aOutline, int aHole, bool aAllowDuplication )
 {
+    m_contourGrid.Reset();
+
     assert( m_polys.size() );
 
     if( aOutline < 0 )
@@ -239,6 +246,8 @@ int SHAPE_POLY_SET::Append( int x, int y, int aOutline, int aHole, bool aAllowDu
 
 void SHAPE_POLY_SET::InsertVertex( int aGlobalIndex, VECTOR2I aNewVertex )
 {
+    m_contourGrid.Reset();
+
     VERTEX_INDEX index;
 
     if( aGlobalIndex < 0 )
@@ -424,6 +433,8 @@ bool SHAPE_POLY_SET::IsSelfIntersecting() const
 
 int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
 {
+    m_contourGrid.Reset();
+
     assert( aOutline.IsClosed() );
 
     POLYGON poly;
@@ -438,6 +449,8 @@ int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
 
 int SHAPE_POLY_SET::AddHole( const SHAPE_LINE_CHAIN& aHole, int aOutline )
 {
+    m_contourGrid.Reset();
+
     assert( m_polys.size() );
 
     if( aOutline < 0 )
@@ -467,17 +480,19 @@ void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType,
         const SHAPE_POLY_SET& aOtherShape,
         POLYGON_MODE aFastMode )
 {
+    m_contourGrid.Reset();
+
     Clipper c;
 
     c.StrictlySimple( aFastMode == PM_STRICTLY_SIMPLE );
 
-    for( auto poly : aShape.m_polys )
+    for( const POLYGON& poly : aShape.m_polys )
     {
         for( size_t i = 0 ; i < poly.size(); i++ )
             c.AddPath( poly[i].convertToClipper( i == 0 ), ptSubject, true );
     }
 
-    for( auto poly : aOtherShape.m_polys )
+    for( const POLYGON& poly : aOtherShape.m_polys )
     {
         for( size_t i = 0; i < poly.size(); i++ )
             c.AddPath( poly[i].convertToClipper( i == 0 ), ptClip, true );
@@ -545,6 +560,8 @@ void SHAPE_POLY_SET::InflateWithLinkedHoles( int aFactor, int aCircleSegmentsCou
 void SHAPE_POLY_SET::Inflate( int aAmount, int aCircleSegmentsCount,
                               CORNER_STRATEGY aCornerStrategy )
 {
+    m_contourGrid.Reset();
+
     // A static table to avoid repetitive calculations of the coefficient
     // 1.0 - cos( M_PI / aCircleSegmentsCount )
     // aCircleSegmentsCount is most of time <= 64 and usually 8, 12, 16, 32
@@ -627,6 +644,8 @@ void SHAPE_POLY_SET::Inflate( int aAmount, int aCircleSegmentsCount,
 
 void SHAPE_POLY_SET::importTree( PolyTree* tree )
 {
+    m_contourGrid.Reset();
+
     m_polys.clear();
 
     for( PolyNode* n = tree->GetFirst(); n; n = n->GetNext() )
@@ -857,6 +876,8 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
 
 void SHAPE_POLY_SET::Fracture( POLYGON_MODE aFastMode )
 {
+    m_contourGrid.Reset();
+
     Simplify( aFastMode );    // remove overlapping holes/degeneracy
 
     for( POLYGON& paths : m_polys )
@@ -1044,6 +1065,8 @@ bool SHAPE_POLY_SET::HasHoles() const
 
 void SHAPE_POLY_SET::Unfracture( POLYGON_MODE aFastMode )
 {
+    m_contourGrid.Reset();
+
     for( POLYGON& path : m_polys )
     {
         unfractureSingle( path );
@@ -1061,8 +1084,76 @@ void SHAPE_POLY_SET::Simplify( POLYGON_MODE aFastMode )
 }
 
 
+void SHAPE_POLY_SET::SimplifyByGroups( POLYGON_MODE aFastMode, const TASK_RUNNER& aRunTasks )
+{
+    m_contourGrid.Reset();
+
+    // The time taken by a merge grows much faster than the number of polygons merged.  Groups
+    // of this size are merged quickly, and remove most of the overlaps of the polygons.
+    const size_t GROUP_SIZE = 512;
+
+    size_t groupCount = m_polys.size() / GROUP_SIZE;
+
+    if( groupCount < 2 )
+    {
+        Simplify( aFastMode );
+        return;
+    }
+
+    // Group the polygons by position along the X axis
+    std::vector<std::pair<int, size_t>> order;
+
+    order.reserve( m_polys.size() );
+
+    for( size_t ii = 0; ii < m_polys.size(); ii++ )
+        order.emplace_back( m_polys[ii][0].BBox().Centre().x, ii );
+
+    std::sort( order.begin(), order.end() );
+
+    std::vector<SHAPE_POLY_SET> groups( groupCount );
+
+    for( size_t ii = 0; ii < order.size(); ii++ )
+    {
+        POLYGON& poly = m_polys[order[ii].second];
+        groups[ii * groupCount / order.size()].m_polys.push_back( std::move( poly ) );
+    }
+
+    std::vector<std::function<void()>> tasks;
+
+    for( SHAPE_POLY_SET& group : groups )
+    {
+        tasks.push_back( [&group, aFastMode]()
+                         {
+                             group.Simplify( aFastMode );
+                         } );
+    }
+
+    if( aRunTasks )
+    {
+        aRunTasks( tasks );
+    }
+    else
+    {
+        for( std::function<void()>& task : tasks )
+            task();
+    }
+
+    m_polys.clear();
+
+    for( SHAPE_POLY_SET& group : groups )
+    {
+        for( POLYGON& poly : group.m_polys )
+            m_polys.push_back( std::move( poly ) );
+    }
+
+    Simplify( aFastMode );
+}
+
+
 int SHAPE_POLY_SET::NormalizeAreaOutlines()
 {
+    m_contourGrid.Reset();
+
     // We are expecting only one main outline, but this main outline can have holes
     // if holes: combine holes and remove them from the main outline.
     // Note also we are using SHAPE_POLY_SET::PM_STRICTLY_SIMPLE in polygon
@@ -1127,6 +1218,8 @@ const std::string SHAPE_POLY_SET::Format() const
 
 bool SHAPE_POLY_SET::Parse( std::stringstream& aStream )
 {
+    m_contourGrid.Reset();
+
     std::string tmp;
 
     aStream >> tmp;
@@ -1234,6 +1327,246 @@ bool SHAPE_POLY_SET::PointOnEdge( const VECTOR2I& aP ) const
 }
 
 
+/**
+ * A uniform grid over the bounding boxes of the contours of a polygon set.
+ *
+ * Each cell lists the contours whose bounding box overlaps it, ordered by polygon and contour,
+ * so a point query only has to ray cast the few contours around the point instead of all of
+ * them.  The ray casts themselves use the segment indices of the large contours.
+ */
+class SHAPE_POLY_SET::CONTOUR_GRID
+{
+public:
+    CONTOUR_GRID( const SHAPE_POLY_SET& aSet )
+    {
+        m_minX = m_minY = std::numeric_limits<int>::max();
+        m_maxX = m_maxY = std::numeric_limits<int>::min();
+
+        for( int polyIdx = 0; polyIdx < (int) aSet.m_polys.size(); polyIdx++ )
+        {
+            const POLYGON& poly = aSet.m_polys[polyIdx];
+            BOX        polyBox = emptyBox();
+
+            for( int contourIdx = 0; contourIdx < (int) poly.size(); contourIdx++ )
+            {
+                CONTOUR contour = { polyIdx, contourIdx, emptyBox() };
+
+                for( const VECTOR2I& pt : poly[contourIdx].CPoints() )
+                    contour.m_box.Merge( pt );
+
+                polyBox.Merge( contour.m_box );
+                m_contours.push_back( contour );
+            }
+
+            m_polygonBoxes.push_back( polyBox );
+
+            if( !polyBox.IsEmpty() )
+            {
+                m_minX = std::min( m_minX, polyBox.m_minX );
+                m_minY = std::min( m_minY, polyBox.m_minY );
+                m_maxX = std::max( m_maxX, polyBox.m_maxX );
+                m_maxY = std::max( m_maxY, polyBox.m_maxY );
+            }
+        }
+
+        // About one cell per contour
+        double side = std::ceil( std::sqrt( (double) m_contours.size() ) );
+        m_size = std::max( 1, std::min( MAX_GRID_SIZE, (int) side ) );
+
+        m_cellWidth = std::max<int64_t>( 1, ( (int64_t) m_maxX - m_minX ) / m_size + 1 );
+        m_cellHeight = std::max<int64_t>( 1, ( (int64_t) m_maxY - m_minY ) / m_size + 1 );
+
+        // Two passes, counting then filling the cells, keep the contours in order
+        m_cellStart.assign( m_size * m_size + 1, 0 );
+
+        forEachCell( [&]( int aCell, int ) { m_cellStart[aCell + 1]++; } );
+
+        for( size_t ii = 1; ii < m_cellStart.size(); ii++ )
+            m_cellStart[ii] += m_cellStart[ii - 1];
+
+        std::vector<int> fill( m_cellStart.begin(), m_cellStart.end() - 1 );
+
+        m_cellContours.resize( m_cellStart.back() );
+
+        forEachCell( [&]( int aCell, int aContour )
+                     {
+                         m_cellContours[fill[aCell]++] = aContour;
+                     } );
+    }
+
+    /**
+     * Same as containsSingle( aP, aSubpolyIndex, 1 ) for a polygon, or for all the polygons
+     * if \a aSubpolyIndex is negative.
+     */
+    bool Contains( const SHAPE_POLY_SET& aSet, const VECTOR2I& aP, int aSubpolyIndex ) const
+    {
+        // Ray casts can only find points inside the bounding box of the contour
+        if( aP.x < m_minX || aP.x > m_maxX || aP.y < m_minY || aP.y > m_maxY )
+            return false;
+
+        int         cell = m_size * cellY( aP.y ) + cellX( aP.x );
+        const int*  it = m_cellContours.data() + m_cellStart[cell];
+        const int*  end = m_cellContours.data() + m_cellStart[cell + 1];
+
+        while( it != end )
+        {
+            const CONTOUR& outline = m_contours[*it++];
+
+            // Holes of a polygon whose outline doesn't reach the cell
+            if( outline.m_contour != 0 )
+                continue;
+
+            const POLYGON& poly = aSet.m_polys[outline.m_polygon];
+            bool           inside = ( aSubpolyIndex < 0 || outline.m_polygon == aSubpolyIndex )
+                                    && outline.m_box.Contains( aP )
+                                    && poly[0].PointInside( aP, 1 );
+
+            for( ; it != end && m_contours[*it].m_polygon == outline.m_polygon; ++it )
+            {
+                const CONTOUR& hole = m_contours[*it];
+
+                if( inside && hole.m_box.Contains( aP )
+                        && poly[hole.m_contour].PointInside( aP, 1 ) )
+                {
+                    inside = false;
+                }
+            }
+
+            if( inside )
+                return true;
+        }
+
+        return false;
+    }
+
+    /// @return the squared distance from \a aP to the bounding box of a polygon
+    SEG::ecoord PolygonBoxSquaredDistance( int aPolygon, const VECTOR2I& aP ) const
+    {
+        const BOX& box = m_polygonBoxes[aPolygon];
+
+        if( box.IsEmpty() )
+            return VECTOR2I::ECOORD_MAX;
+
+        SEG::ecoord dx = std::max<SEG::ecoord>( { (SEG::ecoord) box.m_minX - aP.x, 0,
+                                                  (SEG::ecoord) aP.x - box.m_maxX } );
+        SEG::ecoord dy = std::max<SEG::ecoord>( { (SEG::ecoord) box.m_minY - aP.y, 0,
+                                                  (SEG::ecoord) aP.y - box.m_maxY } );
+
+        return dx * dx + dy * dy;
+    }
+
+private:
+    static const int MAX_GRID_SIZE = 256;
+
+    struct BOX
+    {
+        int m_minX, m_minY, m_maxX, m_maxY;
+
+        bool IsEmpty() const { return m_minX > m_maxX; }
+
+        bool Contains( const VECTOR2I& aP ) const
+        {
+            return aP.x >= m_minX && aP.x <= m_maxX && aP.y >= m_minY && aP.y <= m_maxY;
+        }
+
+        void Merge( const VECTOR2I& aP )
+        {
+            m_minX = std::min( m_minX, aP.x );
+            m_minY = std::min( m_minY, aP.y );
+            m_maxX = std::max( m_maxX, aP.x );
+            m_maxY = std::max( m_maxY, aP.y );
+        }
+
+        void Merge( const BOX& aBox )
+        {
+            m_minX = std::min( m_minX, aBox.m_minX );
+            m_minY = std::min( m_minY, aBox.m_minY );
+            m_maxX = std::max( m_maxX, aBox.m_maxX );
+            m_maxY = std::max( m_maxY, aBox.m_maxY );
+        }
+    };
+
+    struct CONTOUR
+    {
+        int m_polygon;
+        int m_contour;
+        BOX m_box;
+    };
+
+    static BOX emptyBox()
+    {
+        return { std::numeric_limits<int>::max(), std::numeric_limits<int>::max(),
+                 std::numeric_limits<int>::min(), std::numeric_limits<int>::min() };
+    }
+
+    int cellX( int aX ) const
+    {
+        return std::min<int>( m_size - 1, ( (int64_t) aX - m_minX ) / m_cellWidth );
+    }
+
+    int cellY( int aY ) const
+    {
+        return std::min<int>( m_size - 1, ( (int64_t) aY - m_minY ) / m_cellHeight );
+    }
+
+    /// Call \a aFunc( cell, contour ) for each cell overlapped by each contour, in order
+    template <typename FUNC>
+    void forEachCell( FUNC aFunc ) const
+    {
+        for( int ii = 0; ii < (int) m_contours.size(); ii++ )
+        {
+            const BOX& box = m_contours[ii].m_box;
+
+            if( box.IsEmpty() )
+                continue;
+
+            for( int y = cellY( box.m_minY ); y <= cellY( box.m_maxY ); y++ )
+            {
+                for( int x = cellX( box.m_minX ); x <= cellX( box.m_maxX ); x++ )
+                    aFunc( y * m_size + x, ii );
+            }
+        }
+    }
+
+    int              m_minX, m_minY, m_maxX, m_maxY;
+    int              m_size;
+    int64_t          m_cellWidth, m_cellHeight;
+
+    std::vector<CONTOUR> m_contours;
+    std::vector<BOX>     m_polygonBoxes;
+    std::vector<int>     m_cellStart;       ///< first entry of each cell in m_cellContours
+    std::vector<int>     m_cellContours;
+};
+
+
+const SHAPE_POLY_SET::CONTOUR_GRID*
+SHAPE_POLY_SET::CONTOUR_GRID_CACHE::Get( const SHAPE_POLY_SET& aSet ) const
+{
+    if( !m_enabled )
+        return nullptr;
+
+    CONTOUR_GRID* grid = m_grid.load( std::memory_order_acquire );
+
+    if( grid )
+        return grid;
+
+    // Another thread may be building one too: the first one stored wins
+    CONTOUR_GRID* built = new CONTOUR_GRID( aSet );
+
+    if( m_grid.compare_exchange_strong( grid, built, std::memory_order_acq_rel ) )
+        return built;
+
+    delete built;
+    return grid;
+}
+
+
+void SHAPE_POLY_SET::CONTOUR_GRID_CACHE::release()
+{
+    delete m_grid.exchange( nullptr );
+}
+
+
 bool SHAPE_POLY_SET::Collide( const SEG& aSeg, int aClearance, int* aActual,
                               VECTOR2I* aLocation ) const
 {
@@ -1259,7 +1592,37 @@ bool SHAPE_POLY_SET::Collide( const VECTOR2I& aP, int aClearance, int* aActual,
                               VECTOR2I* aLocation ) const
 {
     VECTOR2I nearest;
-    ecoord dist_sq = SquaredDistance( aP, aLocation ? &nearest : nullptr );
+    ecoord dist_sq;
+
+    if( const CONTOUR_GRID* grid = m_contourGrid.Get( *this ) )
+    {
+        ecoord clearance_sq = SEG::Square( aClearance );
+
+        dist_sq = VECTOR2I::ECOORD_MAX;
+
+        // Polygons further than aClearance can neither collide nor be the closest of a
+        // collision.  The others are tested in the same order as SquaredDistance() does.
+        for( int polygonIdx = 0; polygonIdx < OutlineCount() && dist_sq > 0; polygonIdx++ )
+        {
+            ecoord box_dist_sq = grid->PolygonBoxSquaredDistance( polygonIdx, aP );
+
+            if( box_dist_sq != 0 && box_dist_sq >= clearance_sq )
+                continue;
+
+            VECTOR2I polyNearest;
+            ecoord   poly_dist_sq = SquaredDistanceToPolygon( aP, polygonIdx, &polyNearest );
+
+            if( poly_dist_sq < dist_sq )
+            {
+                nearest = polyNearest;
+                dist_sq = poly_dist_sq;
+            }
+        }
+    }
+    else
+    {
+        dist_sq = SquaredDistance( aP, aLocation ? &nearest : nullptr );
+    }
 
     if( dist_sq == 0 || dist_sq < SEG::Square( aClearance ) )
     {
@@ -1356,12 +1719,16 @@ bool SHAPE_POLY_SET::Collide( const SHAPE* aShape, int aClearance, int* aActual,
 
 void SHAPE_POLY_SET::RemoveAllContours()
 {
+    m_contourGrid.Reset();
+
     m_polys.clear();
 }
 
 
 void SHAPE_POLY_SET::RemoveContour( int aContourIdx, int aPolygonIdx )
 {
+    m_contourGrid.Reset();
+
     // Default polygon is the last one
     if( aPolygonIdx < 0 )
         aPolygonIdx += m_polys.size();
@@ -1372,6 +1739,8 @@ void SHAPE_POLY_SET::RemoveContour( int aContourIdx, int aPolygonIdx )
 
 int SHAPE_POLY_SET::RemoveNullSegments()
 {
+    m_contourGrid.Reset();
+
     int removed = 0;
 
     ITERATOR iterator = IterateWithHoles();
@@ -1425,12 +1794,16 @@ int SHAPE_POLY_SET::RemoveNullSegments()
 
 void SHAPE_POLY_SET::DeletePolygon( int aIdx )
 {
+    m_contourGrid.Reset();
+
     m_polys.erase( m_polys.begin() + aIdx );
 }
 
 
 void SHAPE_POLY_SET::Append( const SHAPE_POLY_SET& aSet )
 {
+    m_contourGrid.Reset();
+
     m_polys.insert( m_polys.end(), aSet.m_polys.begin(), aSet.m_polys.end() );
 }
 
@@ -1527,6 +1900,12 @@ bool SHAPE_POLY_SET::Contains( const VECTOR2I& aP, int aSubpolyIndex, int aAccur
     if( m_polys.empty() )
         return false;
 
+    if( aAccuracy <= 1 )
+    {
+        if( const CONTOUR_GRID* grid = m_contourGrid.Get( *this ) )
+            return grid->Contains( *this, aP, aSubpolyIndex );
+    }
+
     // If there is a polygon specified, check the condition against that polygon
     if( aSubpolyIndex >= 0 )
         return containsSingle( aP, aSubpolyIndex, aAccuracy, aUseBBoxCaches );
@@ -1556,6 +1935,8 @@ void SHAPE_POLY_SET::RemoveVertex( int aGlobalIndex )
 
 void SHAPE_POLY_SET::RemoveVertex( VERTEX_INDEX aIndex )
 {
+    m_contourGrid.Reset();
+
     m_polys[aIndex.m_polygon][aIndex.m_contour].Remove( aIndex.m_vertex );
 }
 
@@ -1573,6 +1954,8 @@ void SHAPE_POLY_SET::SetVertex( int aGlobalIndex, const VECTOR2I& aPos )
 
 void SHAPE_POLY_SET::SetVertex( const VERTEX_INDEX& aIndex, const VECTOR2I& aPos )
 {
+    m_contourGrid.Reset();
+
     m_polys[aIndex.m_polygon][aIndex.m_contour].SetPoint( aIndex.m_vertex, aPos );
 }
 
@@ -1580,6 +1963,12 @@ void SHAPE_POLY_SET::SetVertex( const VERTEX_INDEX& aIndex, const VECTOR2I& aPos
 bool SHAPE_POLY_SET::containsSingle( const VECTOR2I& aP, int aSubpolyIndex, int aAccuracy,
                                      bool aUseBBoxCaches ) const
 {
+    if( aAccuracy <= 1 )
+    {
+        if( const CONTOUR_GRID* grid = m_contourGrid.Get( *this ) )
+            return grid->Contains( *this, aP, aSubpolyIndex );
+    }
+
     // Check that the point is inside the outline
     if( m_polys[aSubpolyIndex][0].PointInside( aP, aAccuracy ) )
     {
@@ -1603,6 +1992,8 @@ bool SHAPE_POLY_SET::containsSingle( const VECTOR2I& aP, int aSubpolyIndex, int
 
 void SHAPE_POLY_SET::Move( const VECTOR2I& aVector )
 {
+    m_contourGrid.Reset();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -1618,6 +2009,8 @@ void SHAPE_POLY_SET::Move( const VECTOR2I& aVector )
 
 void SHAPE_POLY_SET::Mirror( bool aX, bool aY, const VECTOR2I& aRef )
 {
+    m_contourGrid.Reset();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -1630,6 +2023,8 @@ void SHAPE_POLY_SET::Mirror( bool aX, bool aY, const VECTOR2I& aRef )
 
 void SHAPE_POLY_SET::Rotate( double aAngle, const VECTOR2I& aCenter )
 {
+    m_contourGrid.Reset();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -1688,6 +2083,9 @@ SEG::ecoord SHAPE_POLY_SET::SquaredDistanceToPolygon( VECTOR2I aPoint, int aPoly
 
     SEG::ecoord minDistance = (*iterator).SquaredDistance( aPoint );
 
+    if( aNearest )
+        *aNearest = (*iterator).NearestPoint( aPoint );
+
     for( iterator++; iterator && minDistance > 0; iterator++ )
     {
         SEG::ecoord currentDistance = (*iterator).SquaredDistance( aPoint );
@@ -1991,6 +2389,7 @@ SHAPE_POLY_SET &SHAPE_POLY_SET::operator=( const SHAPE_POLY_SET& aOther )
 {
     static_cast<SHAPE&>(*this) = aOther;
     m_polys = aOther.m_polys;
+    m_contourGrid = aOther.m_contourGrid;
     m_triangulatedPolys.clear();
     m_triangulationValid = false;
 
@@ -2030,6 +2429,15 @@ bool SHAPE_POLY_SET::IsTriangulationUpToDate() const
 }
 
 
+void SHAPE_POLY_SET::SetTriangulation(
+        std::vector<std::unique_ptr<TRIANGULATED_POLYGON>>&& aTriangulation )
+{
+    m_triangulatedPolys = std::move( aTriangulation );
+    m_triangulationValid = true;
+    m_hash = checksum();
+}
+
+
 static void partitionPolyIntoRegularCellGrid(
         const SHAPE_POLY_SET& aPoly, int aSize, SHAPE_POLY_SET& aOut )
 {
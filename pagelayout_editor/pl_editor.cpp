@@ -135,7 +135,7 @@ bool IFACE::OnKifaceStart( PGM_BASE* aProgram, int aCtlBits )
 {
     InitSettings( new PL_EDITOR_SETTINGS );
     aProgram->GetSettingsManager().RegisterSettings( KifaceSettings() );
-    start_common( aCtlBits );
+    start_common( aProgram, aCtlBits );
     return true;
 }
 
@@ -104,7 +104,7 @@ bool IFACE::OnKifaceStart( PGM_BASE* aProgram, int aCtlBits )
 {
     InitSettings( new PCB_CALCULATOR_SETTINGS );
     aProgram->GetSettingsManager().RegisterSettings( KifaceSettings() );
-    start_common( aCtlBits );
+    start_common( aProgram, aCtlBits );
 
     return true;
 }
@@ -40,7 +40,9 @@
 
 #include "ar_autoplacer.h"
 #include "ar_matrix.h"
+#include <atomic>
 #include <memory>
+#include <thread_pool.h>
 #include <ratsnest/ratsnest_data.h>
 
 #define AR_GAIN            16
@@ -429,6 +431,72 @@ void AR_AUTOPLACER::genModuleOnRoutingMatrix( MODULE* Module )
 }
 
 
+/* Build the summed-area tables of the routing matrix sides.
+ * Entry (row, col) of a table is the sum of the cells above and left of (row, col), so the sum
+ * over any rectangle of cells is found from its 4 corners, whatever the footprint size.
+ */
+void AR_AUTOPLACER::buildSummedAreaTables()
+{
+    int    stride = m_matrix.m_Ncols + 1;
+    size_t size   = (size_t) ( m_matrix.m_Nrows + 1 ) * stride;
+
+    for( int side = 0; side < AR_MAX_ROUTING_LAYERS_COUNT; side++ )
+    {
+        std::vector<int>&     outOfBoard = m_outOfBoardSums[side];
+        std::vector<int>&     occupied   = m_occupiedSums[side];
+        std::vector<int64_t>& keepOut    = m_keepOutSums[side];
+
+        outOfBoard.clear();
+        occupied.clear();
+        keepOut.clear();
+
+        if( !m_matrix.m_BoardSide[side] )
+            continue;
+
+        outOfBoard.assign( size, 0 );
+        occupied.assign( size, 0 );
+        keepOut.assign( size, 0 );
+
+        for( int row = 0; row < m_matrix.m_Nrows; row++ )
+        {
+            size_t  above = (size_t) row * stride;
+            size_t  curr  = above + stride;
+            int     rowOutOfBoard = 0;
+            int     rowOccupied = 0;
+            int64_t rowKeepOut = 0;
+
+            for( int col = 0; col < m_matrix.m_Ncols; col++ )
+            {
+                unsigned int data = m_matrix.GetCell( row, col, side );
+
+                rowOutOfBoard += ( data & CELL_IS_ZONE ) == 0;
+                rowOccupied   += ( data & CELL_IS_MODULE ) != 0;
+                rowKeepOut    += m_matrix.GetDist( row, col, side );
+
+                outOfBoard[curr + col + 1] = outOfBoard[above + col + 1] + rowOutOfBoard;
+                occupied[curr + col + 1]   = occupied[above + col + 1] + rowOccupied;
+                keepOut[curr + col + 1]    = keepOut[above + col + 1] + rowKeepOut;
+            }
+        }
+    }
+}
+
+
+/* Returns the sum of the cells row_min..row_max, col_min..col_max from a summed-area table
+ */
+template <typename T>
+static T sumArea( const std::vector<T>& aTable, int aNcols, int aRowMin, int aRowMax,
+                  int aColMin, int aColMax )
+{
+    size_t stride = aNcols + 1;
+    size_t top    = aRowMin * stride;
+    size_t bottom = ( aRowMax + 1 ) * stride;
+
+    return aTable[bottom + aColMax + 1] - aTable[top + aColMax + 1]
+           - aTable[bottom + aColMin] + aTable[top + aColMin];
+}
+
+
 /* Test if the rectangular area (ux, ux .. y0, y1):
  * - is a free zone (except OCCUPED_By_MODULE returns)
  * - is on the working surface of the board (otherwise returns OUT_OF_BOARD)
@@ -470,19 +538,14 @@ int AR_AUTOPLACER::testRectangle( const EDA_RECT& aRect, int side )
     if( col_max >= ( m_matrix.m_Ncols - 1 ) )
         col_max = m_matrix.m_Ncols - 1;
 
-    for( int row = row_min; row <= row_max; row++ )
-    {
-        for( int col = col_min; col <= col_max; col++ )
-        {
-            unsigned int data = m_matrix.GetCell( row, col, side );
+    if( row_min > row_max || col_min > col_max )
+        return AR_FREE_CELL;
 
-            if( ( data & CELL_IS_ZONE ) == 0 )
-                return AR_OUT_OF_BOARD;
+    if( sumArea( m_outOfBoardSums[side], m_matrix.m_Ncols, row_min, row_max, col_min, col_max ) )
+        return AR_OUT_OF_BOARD;
 
-            if( (data & CELL_IS_MODULE) )
-                return AR_OCCUIPED_BY_MODULE;
-        }
-    }
+    if( sumArea( m_occupiedSums[side], m_matrix.m_Ncols, row_min, row_max, col_min, col_max ) )
+        return AR_OCCUIPED_BY_MODULE;
 
     return AR_FREE_CELL;
 }
@@ -523,29 +586,22 @@ unsigned int AR_AUTOPLACER::calculateKeepOutArea( const EDA_RECT& aRect, int sid
     if( col_max >= ( m_matrix.m_Ncols - 1 ) )
         col_max = m_matrix.m_Ncols - 1;
 
-    unsigned int keepOutCost = 0;
-
-    for( int row = row_min; row <= row_max; row++ )
-    {
-        for( int col = col_min; col <= col_max; col++ )
-        {
-            // m_matrix.GetDist returns the "cost" of the cell
-            // at position (row, col)
-            // in autoplace this is the cost of the cell, if it is
-            // inside aRect
-            keepOutCost += m_matrix.GetDist( row, col, side );
-        }
-    }
+    if( row_min > row_max || col_min > col_max )
+        return 0;
 
-    return keepOutCost;
+    // m_matrix.GetDist returns the "cost" of the cell at position (row, col). In autoplace
+    // the keep out cost is the sum of the costs of the cells inside aRect.
+    return (unsigned int) sumArea( m_keepOutSums[side], m_matrix.m_Ncols, row_min, row_max,
+                                   col_min, col_max );
 }
 
 
 /* Test if the module can be placed on the board.
  * Returns the value TstRectangle().
- * Module is known by its bounding box
+ * Module is known by its bounding box aFpRect, at the current module position.
  */
-int AR_AUTOPLACER::testModuleOnBoard( MODULE* aModule, bool TstOtherSide, const wxPoint& aOffset )
+int AR_AUTOPLACER::testModuleOnBoard( MODULE* aModule, const EDA_RECT& aFpRect, bool TstOtherSide,
+                                      const wxPoint& aOffset )
 {
     int side = AR_SIDE_TOP;
     int otherside = AR_SIDE_BOTTOM;
@@ -555,11 +611,9 @@ int AR_AUTOPLACER::testModuleOnBoard( MODULE* aModule, bool TstOtherSide, const
         side = AR_SIDE_BOTTOM; otherside = AR_SIDE_TOP;
     }
 
-    EDA_RECT    fpBBox = aModule->GetFootprintRect();
+    EDA_RECT    fpBBox = aFpRect;
     fpBBox.Move( -aOffset );
 
-    buildFpAreas( aModule, 0 );
-
     int diag = //testModuleByPolygon( aModule, side, aOffset );
         testRectangle( fpBBox, side );
 
@@ -586,7 +640,7 @@ int AR_AUTOPLACER::getOptimalModulePlacement(MODULE* aModule)
 {
     int     error = 1;
     wxPoint LastPosOK;
-    double  min_cost, curr_cost, Score;
+    double  min_cost;
     bool    TstOtherSide;
 
     aModule->CalculateBoundingBox();
@@ -594,7 +648,8 @@ int AR_AUTOPLACER::getOptimalModulePlacement(MODULE* aModule)
     LastPosOK = m_matrix.m_BrdBox.GetOrigin();
 
     wxPoint     mod_pos = aModule->GetPosition();
-    EDA_RECT    fpBBox  = aModule->GetFootprintRect();
+    EDA_RECT    fpRect  = aModule->GetFootprintRect();
+    EDA_RECT    fpBBox  = fpRect;
 
     // Move fpBBox to have the footprint position at (0,0)
     fpBBox.Move( -mod_pos );
@@ -610,9 +665,6 @@ int AR_AUTOPLACER::getOptimalModulePlacement(MODULE* aModule)
     initialPos.x    -= initialPos.x % m_matrix.m_GridRouting;
     initialPos.y    -= initialPos.y % m_matrix.m_GridRouting;
 
-    m_curPosition = initialPos;
-    auto moduleOffset = mod_pos - m_curPosition;
-
     /* Examine pads, and set TstOtherSide to true if a footprint
      * has at least 1 pad through.
      */
@@ -632,43 +684,87 @@ int AR_AUTOPLACER::getOptimalModulePlacement(MODULE* aModule)
         }
     }
 
-    fpBBox.SetOrigin( fpBBoxOrg + m_curPosition );
+    // Everything the candidate positions are tested against is gathered once, so that the
+    // positions can be tested in parallel without touching the board.
+    buildSummedAreaTables();
 
-    min_cost = -1.0;
-//    m_frame->SetStatusText( wxT( "Score ??, pos ??" ) );
+    std::vector<RATSNEST_PAD> ratsnestPads;
+    buildRatsnestPads( aModule, ratsnestPads );
 
+    int    grid = m_matrix.m_GridRouting;
+    size_t colCount = xylimit.x > initialPos.x ? ( xylimit.x - initialPos.x + grid - 1 ) / grid : 0;
 
-    for( ; m_curPosition.x < xylimit.x; m_curPosition.x += m_matrix.m_GridRouting )
+    // The best position of each column. Columns are merged in scan order below, and within
+    // a column the last position wins a tie, as in a serial scan.
+    struct CANDIDATE
     {
-        m_curPosition.y = initialPos.y;
+        double  m_score = -1.0;     // < 0 if no position of the column can be used
+        wxPoint m_position;
+    };
 
-        for( ; m_curPosition.y < xylimit.y; m_curPosition.y += m_matrix.m_GridRouting )
-        {
+    std::vector<CANDIDATE> candidates( colCount );
+
+    THREAD_POOL& tp = GetKiCadThreadPool();
+    size_t parallelThreadCount = std::min<size_t>( tp.GetThreadCount(), colCount );
 
-            fpBBox.SetOrigin( fpBBoxOrg + m_curPosition );
-            moduleOffset = mod_pos - m_curPosition;
-            int keepOutCost = testModuleOnBoard( aModule, TstOtherSide, moduleOffset );
+    std::atomic<size_t> nextColumn( 0 );
+    std::vector<std::future<size_t>> returns;
+
+    auto scan_lambda = [&]() -> size_t
+    {
+        for( size_t col = nextColumn++; col < colCount; col = nextColumn++ )
+        {
+            CANDIDATE& best = candidates[col];
+            wxPoint    pos( initialPos.x + (int) col * grid, initialPos.y );
 
-            if( keepOutCost >= 0 )    // i.e. if the module can be put here
+            for( ; pos.y < xylimit.y; pos.y += grid )
             {
-                error = 0;
-                // m_frame->build_ratsnest_module( aModule ); // fixme
-                curr_cost   = computePlacementRatsnestCost( aModule, moduleOffset );
-                Score       = curr_cost + keepOutCost;
+                wxPoint moduleOffset = mod_pos - pos;
+                int     keepOutCost = testModuleOnBoard( aModule, fpRect, TstOtherSide,
+                                                         moduleOffset );
 
-                if( (min_cost >= Score ) || (min_cost < 0 ) )
+                if( keepOutCost >= 0 )    // i.e. if the module can be put here
                 {
-                    LastPosOK   = m_curPosition;
-                    min_cost    = Score;
-                    wxString msg;
-/*                    msg.Printf( wxT( "Score %g, pos %s, %s" ),
-                                min_cost,
-                                GetChars( ::CoordinateToString( LastPosOK.x ) ),
-                                GetChars( ::CoordinateToString( LastPosOK.y ) ) );
-                    m_frame->SetStatusText( msg );*/
+                    double curr_cost = computePlacementRatsnestCost( ratsnestPads, moduleOffset );
+                    double Score     = curr_cost + keepOutCost;
+
+                    if( ( best.m_score >= Score ) || ( best.m_score < 0 ) )
+                    {
+                        best.m_position = pos;
+                        best.m_score    = Score;
+                    }
                 }
             }
         }
+
+        return 1;
+    };
+
+    if( parallelThreadCount <= 1 )
+        scan_lambda();
+    else
+    {
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns.push_back( tp.Submit( scan_lambda ) );
+
+        // Finalize the threads
+        tp.WaitAll( returns );
+    }
+
+    min_cost = -1.0;
+
+    for( const CANDIDATE& candidate : candidates )
+    {
+        if( candidate.m_score < 0 )
+            continue;
+
+        error = 0;
+
+        if( ( min_cost >= candidate.m_score ) || ( min_cost < 0 ) )
+        {
+            LastPosOK   = candidate.m_position;
+            min_cost    = candidate.m_score;
+        }
     }
 
     // Regeneration of the modified variable.
@@ -679,39 +775,40 @@ int AR_AUTOPLACER::getOptimalModulePlacement(MODULE* aModule)
 }
 
 
-const D_PAD* AR_AUTOPLACER::nearestPad( MODULE *aRefModule, D_PAD* aRefPad, const wxPoint& aOffset)
+void AR_AUTOPLACER::buildRatsnestPads( MODULE* aModule, std::vector<RATSNEST_PAD>& aPads )
 {
-    const D_PAD* nearest = nullptr;
-    int64_t nearestDist = INT64_MAX;
+    aPads.clear();
 
-    for ( auto mod : m_board->Modules() )
+    for( auto refPad : aModule->Pads() )
     {
-        if ( mod == aRefModule )
-            continue;
+        RATSNEST_PAD ratsnestPad;
 
-        if( !m_matrix.m_BrdBox.Contains( mod->GetPosition() ) )
-            continue;
+        ratsnestPad.m_position = refPad->GetPosition();
 
-        for ( auto pad: mod->Pads() )
+        for( auto mod : m_board->Modules() )
         {
-            if ( pad->GetNetCode() != aRefPad->GetNetCode() || pad->GetNetCode() <= 0 )
+            if( mod == aModule )
                 continue;
 
-            auto dist = (VECTOR2I( aRefPad->GetPosition() - aOffset ) - VECTOR2I( pad->GetPosition() ) ).EuclideanNorm();
+            if( !m_matrix.m_BrdBox.Contains( mod->GetPosition() ) )
+                continue;
 
-            if ( dist < nearestDist )
+            for( auto pad : mod->Pads() )
             {
-                nearestDist = dist;
-                nearest = pad;
+                if( pad->GetNetCode() != refPad->GetNetCode() || pad->GetNetCode() <= 0 )
+                    continue;
+
+                ratsnestPad.m_targets.push_back( pad->GetPosition() );
             }
         }
-    }
 
-    return nearest;
+        aPads.push_back( std::move( ratsnestPad ) );
+    }
 }
 
 
-double AR_AUTOPLACER::computePlacementRatsnestCost( MODULE *aModule, const wxPoint& aOffset )
+double AR_AUTOPLACER::computePlacementRatsnestCost( const std::vector<RATSNEST_PAD>& aPads,
+                                                    const wxPoint& aOffset )
 {
     double  curr_cost;
     VECTOR2I start;      // start point of a ratsnest
@@ -720,15 +817,26 @@ double AR_AUTOPLACER::computePlacementRatsnestCost( MODULE *aModule, const wxPoi
 
     curr_cost = 0;
 
-    for ( auto pad : aModule->Pads() )
+    for( const RATSNEST_PAD& pad : aPads )
     {
-        auto nearest = nearestPad( aModule, pad, aOffset );
-
-        if( !nearest )
+        if( pad.m_targets.empty() )
             continue;
 
-        start   = VECTOR2I( pad->GetPosition() ) - VECTOR2I(aOffset);
-        end     = VECTOR2I( nearest->GetPosition() );
+        start = VECTOR2I( pad.m_position ) - VECTOR2I( aOffset );
+
+        // The nearest pad of the same net
+        int64_t nearestDist = INT64_MAX;
+
+        for( const wxPoint& target : pad.m_targets )
+        {
+            auto dist = ( start - VECTOR2I( target ) ).EuclideanNorm();
+
+            if( dist < nearestDist )
+            {
+                nearestDist = dist;
+                end = VECTOR2I( target );
+            }
+        }
 
         //m_overlay->SetIsStroke( true );
         //m_overlay->SetStrokeColor( COLOR4D(0.0, 1.0, 0.0, 1.0) );
@@ -95,11 +95,27 @@ private:
     bool         fillMatrix();
     void         genModuleOnRoutingMatrix( MODULE* Module );
 
+    /**
+     * A pad of the footprint to place, and the positions of the pads of the other footprints
+     * it should be connected to.
+     */
+    struct RATSNEST_PAD
+    {
+        wxPoint              m_position;
+        std::vector<wxPoint> m_targets;
+    };
+
+    // Build the summed-area tables used by testRectangle() and calculateKeepOutArea()
+    void         buildSummedAreaTables();
+
     int          testRectangle( const EDA_RECT& aRect, int side );
     unsigned int calculateKeepOutArea( const EDA_RECT& aRect, int side );
-    int          testModuleOnBoard( MODULE* aModule, bool TstOtherSide, const wxPoint& aOffset );
+    int          testModuleOnBoard( MODULE* aModule, const EDA_RECT& aFpRect, bool TstOtherSide,
+                                    const wxPoint& aOffset );
     int          getOptimalModulePlacement( MODULE* aModule );
-    double       computePlacementRatsnestCost( MODULE* aModule, const wxPoint& aOffset );
+    void         buildRatsnestPads( MODULE* aModule, std::vector<RATSNEST_PAD>& aPads );
+    double       computePlacementRatsnestCost( const std::vector<RATSNEST_PAD>& aPads,
+                                               const wxPoint& aOffset );
 
     /**
      * Find the "best" module place. The criteria are:
@@ -109,7 +125,6 @@ private:
     MODULE*      pickModule();
 
     void         placeModule( MODULE* aModule, bool aDoNotRecreateRatsnest, const wxPoint& aPos );
-    const D_PAD* nearestPad( MODULE* aRefModule, D_PAD* aRefPad, const wxPoint& aOffset );
 
     // Add a polygonal shape (rectangle) to m_fpAreaFront and/or m_fpAreaBack
     void         addFpBody( wxPoint aStart, wxPoint aEnd, LSET aLayerMask );
@@ -128,6 +143,12 @@ private:
     SHAPE_POLY_SET m_fpAreaTop;         // The polygonal description of the footprint to place, top side;
     SHAPE_POLY_SET m_fpAreaBottom;      // The polygonal description of the footprint to place, bottom side;
 
+    // Summed-area tables of m_matrix sides: count of cells out of the board, count of cells
+    // occupied by a module and sum of the cell distances
+    std::vector<int>     m_outOfBoardSums[AR_MAX_ROUTING_LAYERS_COUNT];
+    std::vector<int>     m_occupiedSums[AR_MAX_ROUTING_LAYERS_COUNT];
+    std::vector<int64_t> m_keepOutSums[AR_MAX_ROUTING_LAYERS_COUNT];
+
     BOARD* m_board;
 
     wxPoint m_curPosition;
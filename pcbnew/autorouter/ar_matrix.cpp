@@ -39,7 +39,7 @@ AR_MATRIX::AR_MATRIX()
     m_BoardSide[1]       = nullptr;
     m_DistSide[0]        = nullptr;
     m_DistSide[1]        = nullptr;
-    m_opWriteCell        = nullptr;
+    m_cellOp             = WRITE_CELL;
     m_Nrows              = 0;
     m_Ncols              = 0;
     m_MemSize            = 0;
@@ -149,18 +149,10 @@ void AR_MATRIX::UnInitRoutingMatrix()
     m_Nrows = m_Ncols = 0;
 }
 
-// Initialize m_opWriteCell member to make the aLogicOp
+// Initialize m_cellOp member to make the aLogicOp
 void AR_MATRIX::SetCellOperation( AR_MATRIX::CELL_OP aLogicOp )
 {
-    switch( aLogicOp )
-    {
-    default:
-    case WRITE_CELL:     m_opWriteCell = &AR_MATRIX::SetCell; break;
-    case WRITE_OR_CELL:  m_opWriteCell = &AR_MATRIX::OrCell;  break;
-    case WRITE_XOR_CELL: m_opWriteCell = &AR_MATRIX::XorCell; break;
-    case WRITE_AND_CELL: m_opWriteCell = &AR_MATRIX::AndCell; break;
-    case WRITE_ADD_CELL: m_opWriteCell = &AR_MATRIX::AddCell; break;
-    }
+    m_cellOp = aLogicOp;
 }
 
 
@@ -703,7 +695,7 @@ void AR_MATRIX::TraceFilledRectangle( int ux0, int uy0, int ux1, int uy1, double
 void AR_MATRIX::TraceFilledRectangle( int ux0, int uy0, int ux1, int uy1, LSET aLayerMask,
         int color, AR_MATRIX::CELL_OP op_logic )
 {
-    int row, col;
+    int row;
     int row_min, row_max, col_min, col_max;
     int trace = 0;
 
@@ -748,16 +740,16 @@ void AR_MATRIX::TraceFilledRectangle( int ux0, int uy0, int ux1, int uy1, LSET a
     if( col_max >= ( m_Ncols - 1 ) )
         col_max = m_Ncols - 1;
 
+    if( col_min > col_max )
+        return;
+
     for( row = row_min; row <= row_max; row++ )
     {
-        for( col = col_min; col <= col_max; col++ )
-        {
-            if( trace & 1 )
-                WriteCell( row, col, AR_SIDE_BOTTOM, color );
+        if( trace & 1 )
+            WriteCellRow( row, col_min, col_max, AR_SIDE_BOTTOM, color );
 
-            if( trace & 2 )
-                WriteCell( row, col, AR_SIDE_TOP, color );
-        }
+        if( trace & 2 )
+            WriteCellRow( row, col_min, col_max, AR_SIDE_TOP, color );
     }
 }
 
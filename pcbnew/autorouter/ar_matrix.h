@@ -65,11 +65,6 @@ public:
     PCB_LAYER_ID m_routeLayerTop;
     PCB_LAYER_ID m_routeLayerBottom;
 
-private:
-    // a pointer to the current selected cell operation
-    void ( AR_MATRIX::*m_opWriteCell )( int aRow, int aCol, int aSide, MATRIX_CELL aCell );
-
-public:
     enum CELL_OP
     {
         WRITE_CELL = 0,
@@ -79,12 +74,57 @@ public:
         WRITE_ADD_CELL = 4
     };
 
+private:
+    // the current selected cell operation
+    CELL_OP m_cellOp;
+
+public:
     AR_MATRIX();
     ~AR_MATRIX();
 
     void WriteCell( int aRow, int aCol, int aSide, MATRIX_CELL aCell )
     {
-        ( *this.*m_opWriteCell )( aRow, aCol, aSide, aCell );
+        WriteCellRow( aRow, aCol, aCol, aSide, aCell );
+    }
+
+    /**
+     * Function WriteCellRow
+     * applies the current cell operation to the cells aColMin to aColMax (included) of a row.
+     * The operation is selected once for the whole row, which lets the compiler vectorize the
+     * loop over the cells.
+     */
+    void WriteCellRow( int aRow, int aColMin, int aColMax, int aSide, MATRIX_CELL aCell )
+    {
+        MATRIX_CELL* p = m_BoardSide[aSide] + aRow * m_Ncols;
+
+        switch( m_cellOp )
+        {
+        default:
+        case WRITE_CELL:
+            for( int col = aColMin; col <= aColMax; col++ )
+                p[col] = aCell;
+            break;
+
+        case WRITE_OR_CELL:
+            for( int col = aColMin; col <= aColMax; col++ )
+                p[col] |= aCell;
+            break;
+
+        case WRITE_XOR_CELL:
+            for( int col = aColMin; col <= aColMax; col++ )
+                p[col] ^= aCell;
+            break;
+
+        case WRITE_AND_CELL:
+            for( int col = aColMin; col <= aColMax; col++ )
+                p[col] &= aCell;
+            break;
+
+        case WRITE_ADD_CELL:
+            for( int col = aColMin; col <= aColMax; col++ )
+                p[col] += aCell;
+            break;
+        }
     }
 
     /**
@@ -32,6 +32,7 @@
 #include <tools/pcb_tool_base.h>
 #include <tools/pcb_actions.h>
 #include <connectivity/connectivity_data.h>
+#include <drc/drc_engine.h>
 
 #include <functional>
 using namespace std::placeholders;
@@ -346,6 +347,10 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
     if( !m_editModules && aCreateUndoEntry )
         frame->SaveCopyInUndoList( undoList, UNDO_REDO::UNSPECIFIED );
 
+    // Nets and netclass assignments may have changed under memoized rule resolutions
+    if( board->GetDesignSettings().m_DRCEngine )
+        board->GetDesignSettings().m_DRCEngine->ClearConstraintCache();
+
     m_toolMgr->PostEvent( { TC_MESSAGE, TA_MODEL_CHANGE, AS_GLOBAL } );
 
     if( itemsDeselected )
@@ -440,6 +445,9 @@ void BOARD_COMMIT::Revert()
     if ( !m_editModules )
         connectivity->RecalculateRatsnest();
 
+    if( board->GetDesignSettings().m_DRCEngine )
+        board->GetDesignSettings().m_DRCEngine->ClearConstraintCache();
+
     SELECTION_TOOL* selTool = m_toolMgr->GetTool<SELECTION_TOOL>();
     selTool->RebuildSelection();
 
@@ -39,6 +39,7 @@
 #include <class_pcb_target.h>
 #include <core/kicad_algo.h>
 #include <connectivity/connectivity_data.h>
+#include <drc/drc_engine.h>
 #include <kicad_string.h>
 #include <pgm_base.h>
 #include <pcbnew_settings.h>
@@ -62,6 +63,7 @@ BOARD::BOARD() :
         m_boardUse( BOARD_USE::NORMAL ),
         m_paper( PAGE_INFO::A4 ),
         m_project( nullptr ),
+        m_lastZoneFillSerial( 0 ),
         m_designSettings( new BOARD_DESIGN_SETTINGS( nullptr, "board.design_settings" ) ),
         m_NetInfo( this ),
         m_LegacyDesignSettingsLoaded( false ),
@@ -1403,6 +1405,10 @@ void BOARD::SynchronizeNetsAndNetClasses()
     bds.SetCustomDiffPairGap( defaultNetClass->GetDiffPairGap() );
     bds.SetCustomDiffPairViaGap( defaultNetClass->GetDiffPairViaGap() );
 
+    // Netclass assignments may have changed under memoized rule resolutions
+    if( bds.m_DRCEngine )
+        bds.m_DRCEngine->ClearConstraintCache();
+
     InvokeListeners( &BOARD_LISTENER::OnBoardNetSettingsChanged, *this );
 }
 
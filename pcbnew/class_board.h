@@ -25,6 +25,8 @@
 #ifndef CLASS_BOARD_H_
 #define CLASS_BOARD_H_
 
+#include <atomic>
+
 #include <board_design_settings.h>
 #include <board_item_container.h>
 #include <class_pcb_group.h>
@@ -215,6 +217,8 @@ private:
     PCB_PLOT_PARAMS         m_plotOptions;
     PROJECT*                m_project;              // project this board is a part of
 
+    std::atomic<unsigned>   m_lastZoneFillSerial;   // see NewZoneFillSerial()
+
     /**
      * All of the board design settings are stored as a JSON object inside the project file.  The
      * object itself is located here because the alternative is to require a valid project be
@@ -887,6 +891,12 @@ public:
         return NULL;
     }
 
+    /**
+     * @return a new serial identifying a zone fill of this board (see ZONE_FILL_INPUTS).
+     * Serials are only unique within a board, and only for as long as it is loaded.
+     */
+    unsigned NewZoneFillSerial() { return ++m_lastZoneFillSerial; }
+
     /**
      * @return a std::list of pointers to all board zones (possibly including zones in footprints)
      */
@@ -163,6 +163,8 @@ void ZONE_CONTAINER::InitDataFromSrcInCopyCtor( const ZONE_CONTAINER& aZone )
         m_insulatedIslands[layer] = aZone.m_insulatedIslands.at( layer );
     }
 
+    m_fillInputs              = aZone.m_fillInputs;
+
     m_borderStyle             = aZone.m_borderStyle;
     m_borderHatchPitch        = aZone.m_borderHatchPitch;
     m_borderHatchLines        = aZone.m_borderHatchLines;
@@ -200,6 +202,7 @@ bool ZONE_CONTAINER::UnFill()
 
     m_isFilled = false;
     m_fillFlags.clear();
+    m_fillInputs.clear();
 
     return change;
 }
@@ -35,6 +35,7 @@
 #include <gr_basic.h>
 #include <class_board_item.h>
 #include <board_connected_item.h>
+#include <eda_rect.h>
 #include <layers_id_colors_and_visibility.h>
 #include <geometry/shape_poly_set.h>
 #include <zone_settings.h>
@@ -49,6 +50,29 @@ class MSG_PANEL_ITEM;
 
 typedef std::vector<SEG> ZONE_SEGMENT_FILL;
 
+/**
+ * One board item a zone fill was built around, as recorded by ZONE_FILLER.
+ */
+struct ZONE_FILL_INPUT
+{
+    size_t   m_id;          ///< Hash of the item's KIID
+    size_t   m_hash;        ///< Signature of the item's geometry, net and clearance
+    unsigned m_fillSerial;  ///< For zones knocking out by their fill: the serial of that fill
+    EDA_RECT m_reach;       ///< The area within which the item can change the fill
+};
+
+/**
+ * What one layer of a zone fill was built from, so that ZONE_FILLER can later refill only
+ * the areas around the items which changed.
+ */
+struct ZONE_FILL_INPUTS
+{
+    size_t                       m_settingsHash = 0;  ///< Zone and board wide fill settings
+    unsigned                     m_serial = 0;        ///< Identifies the resulting fill
+    bool                         m_spliced = false;   ///< Fill was updated in place
+    std::vector<ZONE_FILL_INPUT> m_items;             ///< Sorted by m_id
+};
+
 /**
  * ZONE_CONTAINER
  * handles a list of polygons defining a copper zone.
@@ -211,6 +235,36 @@ public:
     }
     void SetFillFlag( PCB_LAYER_ID aLayer, bool aFlag ) { m_fillFlags[ aLayer ] = aFlag; }
 
+    /**
+     * @return what the fill of \a aLayer was built from, or nullptr if it wasn't recorded
+     * (zone not filled since loading, or unfilled since).
+     */
+    const ZONE_FILL_INPUTS* GetFillInputs( PCB_LAYER_ID aLayer ) const
+    {
+        auto it = m_fillInputs.find( aLayer );
+        return it == m_fillInputs.end() ? nullptr : &it->second;
+    }
+
+    void SetFillInputs( PCB_LAYER_ID aLayer, ZONE_FILL_INPUTS&& aInputs )
+    {
+        m_fillInputs[ aLayer ] = std::move( aInputs );
+    }
+
+    /**
+     * @return true if the fill of any layer was updated in place, and therefore only matches
+     * a full refill geometrically (see ZONE_FILLER::RefillSplicedZones()).
+     */
+    bool HasSplicedFill() const
+    {
+        for( const std::pair<const PCB_LAYER_ID, ZONE_FILL_INPUTS>& inputs : m_fillInputs )
+        {
+            if( inputs.second.m_spliced )
+                return true;
+        }
+
+        return false;
+    }
+
     bool IsFilled() const { return m_isFilled; }
     void SetIsFilled( bool isFilled ) { m_isFilled = isFilled; }
 
@@ -931,6 +985,9 @@ protected:
     /// A hash value used in zone filling calculations to see if the filled areas are up to date
     std::map<PCB_LAYER_ID, MD5_HASH>       m_filledPolysHash;
 
+    /// What the raw fill of each layer was built from (see ZONE_FILLER)
+    std::map<PCB_LAYER_ID, ZONE_FILL_INPUTS> m_fillInputs;
+
     ZONE_BORDER_DISPLAY_STYLE m_borderStyle;       // border display style, see enum above
     int                       m_borderHatchPitch;  // for DIAGONAL_EDGE, distance between 2 lines
     std::vector<SEG>          m_borderHatchLines;  // hatch lines
@@ -28,6 +28,7 @@
 #include <widgets/progress_reporter.h>
 #include <geometry/geometry_utils.h>
 #include <board_commit.h>
+#include <thread_pool.h>
 
 #include <thread>
 #include <mutex>
@@ -233,11 +234,12 @@ void CN_CONNECTIVITY_ALGO::searchConnections()
 
     if( m_itemList.IsDirty() )
     {
-        size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+        THREAD_POOL& tp = GetKiCadThreadPool();
+        size_t parallelThreadCount = std::min<size_t>( tp.GetThreadCount(),
                                                        ( dirtyItems.size() + 7 ) / 8 );
 
         std::atomic<size_t> nextItem( 0 );
-        std::vector<std::future<size_t>> returns( parallelThreadCount );
+        std::vector<std::future<size_t>> returns;
 
         auto conn_lambda =
                 [&nextItem, &dirtyItems]( CN_LIST* aItemList,
@@ -266,21 +268,24 @@ void CN_CONNECTIVITY_ALGO::searchConnections()
         {
             for( size_t ii = 0; ii < parallelThreadCount; ++ii )
             {
-                returns[ii] = std::async( std::launch::async, conn_lambda, &m_itemList,
-                                          m_progressReporter );
+                returns.push_back( tp.Submit( [&]()
+                                              {
+                                                  return conn_lambda( &m_itemList,
+                                                                      m_progressReporter );
+                                              } ) );
             }
 
-            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            if( m_progressReporter )
             {
-                // Here we balance returns with a 100ms timeout to allow UI updating
-                std::future_status status;
-                do
-                {
-                    if( m_progressReporter )
-                        m_progressReporter->KeepRefreshing();
-
-                    status = returns[ii].wait_for( std::chrono::milliseconds( 100 ) );
-                } while( status != std::future_status::ready );
+                // Keep the UI refreshing while we wait
+                tp.WaitAll( returns, [&]()
+                                     {
+                                         m_progressReporter->KeepRefreshing();
+                                     } );
+            }
+            else
+            {
+                tp.WaitAll( returns );
             }
         }
 
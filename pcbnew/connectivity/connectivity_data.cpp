@@ -36,6 +36,7 @@
 #include <connectivity/from_to_cache.h>
 
 #include <ratsnest/ratsnest_data.h>
+#include <thread_pool.h>
 
 CONNECTIVITY_DATA::CONNECTIVITY_DATA()
 {
@@ -124,12 +125,13 @@ void CONNECTIVITY_DATA::updateRatsnest()
     std::copy_if( m_nets.begin() + 1, m_nets.end(), std::back_inserter( dirty_nets ),
             [] ( RN_NET* aNet ) { return aNet->IsDirty() && aNet->GetNodeCount() > 0; } );
 
-    // We don't want to spin up a new thread for fewer than 8 nets (overhead costs)
-    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+    // We don't want to spin up a new task for fewer than 8 nets (overhead costs)
+    THREAD_POOL& tp = GetKiCadThreadPool();
+    size_t parallelThreadCount = std::min<size_t>( tp.GetThreadCount(),
             ( dirty_nets.size() + 7 ) / 8 );
 
     std::atomic<size_t> nextNet( 0 );
-    std::vector<std::future<size_t>> returns( parallelThreadCount );
+    std::vector<std::future<size_t>> returns;
 
     auto update_lambda = [&nextNet, &dirty_nets]() -> size_t
     {
@@ -139,16 +141,15 @@ void CONNECTIVITY_DATA::updateRatsnest()
         return 1;
     };
 
-    if( parallelThreadCount == 1 )
+    if( parallelThreadCount <= 1 )
         update_lambda();
     else
     {
         for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii] = std::async( std::launch::async, update_lambda );
+            returns.push_back( tp.Submit( update_lambda ) );
 
         // Finalize the ratsnest threads
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii].wait();
+        tp.WaitAll( returns );
     }
 
     #ifdef PROFILE
@@ -32,7 +32,6 @@
 #include <reporter.h>
 #include <wildcards_and_files_ext.h>
 #include <layers_id_colors_and_visibility.h>
-#include <locale_io.h>
 #include <bitmaps.h>
 #include <class_board.h>
 #include <dialog_plot.h>
@@ -812,6 +811,9 @@ void DIALOG_PLOT::Plot( wxCommandEvent& event )
     if( m_zoneFillCheck->GetValue() )
         m_parent->GetToolManager()->GetTool<ZONE_FILLER_TOOL>()->CheckAllZones( this );
 
+    // Plot the fills a full refill gives, whatever the edits which led to them
+    m_parent->GetToolManager()->GetTool<ZONE_FILLER_TOOL>()->RefillSplicedZones( this );
+
     m_plotOpts.SetAutoScale( false );
 
     switch( m_plotOpts.GetScaleSelection() )
@@ -857,6 +859,8 @@ void DIALOG_PLOT::Plot( wxCommandEvent& event )
 
     wxBusyCursor dummy;
 
+    std::vector<PLOT_JOB> jobs;
+
     for( LSEQ seq = m_plotOpts.GetLayerSelection().UIOrder();  seq;  ++seq )
     {
         PCB_LAYER_ID layer = *seq;
@@ -882,32 +886,34 @@ void DIALOG_PLOT::Plot( wxCommandEvent& event )
         wxString fullname = fn.GetFullName();
         jobfile_writer.AddGbrFile( layer, fullname );
 
-        LOCALE_IO toggle;
-
-        PLOTTER* plotter = StartPlotBoard( board, &m_plotOpts, layer, fn.GetFullPath(), wxEmptyString );
-
-        // Print diags in messages box:
-        wxString msg;
-
-        if( plotter )
-        {
-            PlotOneBoardLayer( board, plotter, layer, m_plotOpts );
-            plotter->EndPlot();
-            delete plotter->RenderSettings();
-            delete plotter;
-
-            msg.Printf( _( "Plot file \"%s\" created." ), fn.GetFullPath() );
-            reporter.Report( msg, RPT_SEVERITY_ACTION );
-        }
-        else
-        {
-            msg.Printf( _( "Unable to create file \"%s\"." ), fn.GetFullPath() );
-            reporter.Report( msg, RPT_SEVERITY_ERROR );
-        }
-
-        wxSafeYield();      // displays report message.
+        PLOT_JOB job;
+        job.m_layer = layer;
+        job.m_plotOpts = m_plotOpts;
+        job.m_fullFileName = fn.GetFullPath();
+        jobs.push_back( job );
     }
 
+    // The layers are plotted in parallel; each file is reported as soon as it is finished
+    PlotBoardLayers( board, jobs,
+            [&]( const PLOT_JOB& aJob )
+            {
+                // Print diags in messages box:
+                wxString msg;
+
+                if( aJob.m_success )
+                {
+                    msg.Printf( _( "Plot file \"%s\" created." ), aJob.m_fullFileName );
+                    reporter.Report( msg, RPT_SEVERITY_ACTION );
+                }
+                else
+                {
+                    msg.Printf( _( "Unable to create file \"%s\"." ), aJob.m_fullFileName );
+                    reporter.Report( msg, RPT_SEVERITY_ERROR );
+                }
+
+                wxSafeYield();      // displays report message.
+            } );
+
     if( m_plotOpts.GetFormat() == PLOT_FORMAT::GERBER && m_plotOpts.GetCreateGerberJobFile() )
     {
         // Pick the basename from the board file
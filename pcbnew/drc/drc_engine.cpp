@@ -30,7 +30,12 @@
 #include <drc/drc_rule.h>
 #include <drc/drc_rule_condition.h>
 #include <drc/drc_test_provider.h>
+#include <class_board.h>
 #include <class_track.h>
+#include <class_pad.h>
+#include <thread_pool.h>
+
+#include <boost/functional/hash.hpp>
 
 void drcPrintDebugMessage( int level, const wxString& msg, const char *function, int line )
 {
@@ -55,14 +60,15 @@ DRC_ENGINE::DRC_ENGINE( BOARD* aBoard, BOARD_DESIGN_SETTINGS *aSettings ) :
     m_schematicNetlist( nullptr ),
     m_rulesValid( false ),
     m_userUnits( EDA_UNITS::MILLIMETRES ),
+    m_errorLimits( DRCE_LAST + 1 ),
     m_testTracksAgainstZones( false ),
     m_reportAllTrackErrors( false ),
     m_testFootprints( false ),
     m_reporter( nullptr ),
-    m_progressReporter( nullptr )
+    m_progressReporter( nullptr ),
+    m_mainThread( std::this_thread::get_id() ),
+    m_deferReports( false )
 {
-    m_errorLimits.resize( DRCE_LAST + 1 );
-
     for( int ii = DRCE_FIRST; ii <= DRCE_LAST; ++ii )
         m_errorLimits[ ii ] = INT_MAX;
 }
@@ -568,6 +574,187 @@ void DRC_ENGINE::compileRules()
             }
         }
     }
+
+    // Work out which constraint types can have their resolution memoized.  The keepout
+    // (disallow) constraints depend on item geometry and flags, so they never can.
+    m_constraintCacheModes.clear();
+
+    for( const std::pair<const DRC_CONSTRAINT_TYPE_T,
+                         std::vector<CONSTRAINT_WITH_CONDITIONS*>*>& pair : m_constraintMap )
+    {
+        CACHE_MODE mode = CACHE_BY_NETCLASS;
+
+        if( pair.first == DRC_CONSTRAINT_TYPE_DISALLOW )
+            mode = CACHE_NONE;
+
+        for( CONSTRAINT_WITH_CONDITIONS* c : *pair.second )
+        {
+            if( c->condition )
+                mode = std::max( mode, ConditionCacheMode( c->condition->GetExpression() ) );
+        }
+
+        m_constraintCacheModes[ pair.first ] = mode;
+    }
+}
+
+
+DRC_ENGINE::CACHE_MODE DRC_ENGINE::ConditionCacheMode( const wxString& aExpression )
+{
+    // Identifiers whose values are fully determined by a RULE_SIGNATURE and the layer.  The
+    // expression compiler looks up properties and functions without regard to case.
+    static const std::set<wxString> byNetclass = { "a", "b", "l", "netclass", "type", "via_type",
+                                                   "pad_type", "isplated", "ismicrovia",
+                                                   "isblindburiedvia" };
+    static const std::set<wxString> byNet = { "net", "netname", "isdiffpair" };
+
+    CACHE_MODE mode = CACHE_BY_NETCLASS;
+    size_t     ii = 0;
+
+    while( ii < aExpression.length() )
+    {
+        wxUniChar ch = aExpression[ii];
+
+        if( ch == '\'' || ch == '"' )
+        {
+            // Skip string literals
+            size_t end = aExpression.find( ch, ii + 1 );
+            ii = ( end == wxString::npos ) ? aExpression.length() : end + 1;
+        }
+        else if( wxIsdigit( ch ) )
+        {
+            // Skip numbers, including any unit suffix
+            while( ii < aExpression.length()
+                    && ( wxIsalnum( aExpression[ii] ) || aExpression[ii] == '.' ) )
+            {
+                ++ii;
+            }
+        }
+        else if( wxIsalpha( ch ) || ch == '_' )
+        {
+            size_t start = ii;
+
+            while( ii < aExpression.length()
+                    && ( wxIsalnum( aExpression[ii] ) || aExpression[ii] == '_' ) )
+            {
+                ++ii;
+            }
+
+            wxString ident = aExpression.Mid( start, ii - start ).Lower();
+
+            if( byNet.count( ident ) )
+                mode = std::max( mode, CACHE_BY_NET );
+            else if( !byNetclass.count( ident ) )
+                return CACHE_NONE;
+        }
+        else
+        {
+            ++ii;
+        }
+    }
+
+    return mode;
+}
+
+
+void DRC_ENGINE::ClearConstraintCache()
+{
+    std::unique_lock<std::shared_timed_mutex> lock( m_constraintCacheMutex );
+
+    m_constraintCache.clear();
+    m_netclassIndices.clear();
+
+    if( !m_board )
+        return;
+
+    std::map<wxString, int> netclasses;
+
+    for( NETINFO_ITEM* net : m_board->GetNetInfo() )
+    {
+        int code = net->GetNet();
+
+        if( code < 0 )
+            continue;
+
+        if( code >= (int) m_netclassIndices.size() )
+            m_netclassIndices.resize( code + 1, -1 );
+
+        auto it = netclasses.emplace( net->GetClassName(), (int) netclasses.size() ).first;
+        m_netclassIndices[ code ] = it->second;
+    }
+}
+
+
+size_t DRC_ENGINE::CONSTRAINT_CACHE_KEY_HASH::operator()( const CONSTRAINT_CACHE_KEY& aKey ) const
+{
+    size_t seed = 0;
+
+    boost::hash_combine( seed, (int) aKey.m_constraint );
+    boost::hash_combine( seed, (int) aKey.m_layer );
+
+    for( const RULE_SIGNATURE* sig : { &aKey.m_a, &aKey.m_b } )
+    {
+        boost::hash_combine( seed, sig->m_type );
+        boost::hash_combine( seed, sig->m_net );
+        boost::hash_combine( seed, sig->m_subType );
+    }
+
+    return seed;
+}
+
+
+bool DRC_ENGINE::makeSignature( const BOARD_ITEM* aItem, CACHE_MODE aMode,
+                                RULE_SIGNATURE& aSig ) const
+{
+    aSig = { -1, -1, -1 };
+
+    if( !aItem )
+        return true;
+
+    // Zones take part in keepout handling, which looks at more than their signature
+    if( aItem->Type() == PCB_ZONE_AREA_T || aItem->Type() == PCB_FP_ZONE_AREA_T )
+        return false;
+
+    aSig.m_type = aItem->Type();
+
+    if( aItem->IsConnected() )
+    {
+        int netcode = static_cast<const BOARD_CONNECTED_ITEM*>( aItem )->GetNetCode();
+
+        if( aMode == CACHE_BY_NET )
+        {
+            aSig.m_net = netcode;
+        }
+        else
+        {
+            if( netcode < 0 || netcode >= (int) m_netclassIndices.size() )
+                return false;
+
+            aSig.m_net = m_netclassIndices[ netcode ];
+        }
+    }
+
+    if( aItem->Type() == PCB_VIA_T )
+        aSig.m_subType = (int) static_cast<const VIA*>( aItem )->GetViaType();
+    else if( aItem->Type() == PCB_PAD_T )
+        aSig.m_subType = (int) static_cast<const D_PAD*>( aItem )->GetAttribute();
+
+    return true;
+}
+
+
+bool DRC_ENGINE::makeCacheKey( DRC_CONSTRAINT_TYPE_T aConstraintId, const BOARD_ITEM* a,
+                               const BOARD_ITEM* b, PCB_LAYER_ID aLayer,
+                               CONSTRAINT_CACHE_KEY& aKey ) const
+{
+    auto it = m_constraintCacheModes.find( aConstraintId );
+
+    if( it == m_constraintCacheModes.end() || it->second == CACHE_NONE )
+        return false;
+
+    aKey.m_constraint = aConstraintId;
+    aKey.m_layer = aLayer;
+
+    return makeSignature( a, it->second, aKey.m_a ) && makeSignature( b, it->second, aKey.m_b );
 }
 
 
@@ -600,6 +787,7 @@ void DRC_ENGINE::InitEngine( const wxFileName& aRulePath )
     }
 
     m_constraintMap.clear();
+    m_constraintCacheModes.clear();
 
     try         // attempt to load full set of rules (implicit + user rules)
     {
@@ -625,6 +813,8 @@ void DRC_ENGINE::InitEngine( const wxFileName& aRulePath )
     for( int ii = DRCE_FIRST; ii < DRCE_LAST; ++ii )
         m_errorLimits[ ii ] = INT_MAX;
 
+    ClearConstraintCache();
+
     m_rulesValid = true;
 }
 
@@ -669,20 +859,86 @@ void DRC_ENGINE::RunTests( EDA_UNITS aUnits, bool aTestTracksAgainstZones,
             zone->CacheBoundingBox();
 
         module->BuildPolyCourtyards();
+
+        // Pad shapes are built lazily; do it now rather than racing on it from the providers
+        for( D_PAD* pad : module->Pads() )
+            pad->BuildEffectiveShapes( UNDEFINED_LAYER );
     }
 
+    m_mainThread = std::this_thread::get_id();
+
+    std::vector<DRC_TEST_PROVIDER*> serialProviders;
+    std::vector<DRC_TEST_PROVIDER*> concurrentProviders;
+
     for( DRC_TEST_PROVIDER* provider : m_testProviders )
     {
         if( !provider->IsEnabled() )
             continue;
 
+        if( provider->CanRunConcurrently() )
+            concurrentProviders.push_back( provider );
+        else
+            serialProviders.push_back( provider );
+    }
+
+    // Providers which update connectivity, item flags or other shared caches go first, one at
+    // a time.
+    for( DRC_TEST_PROVIDER* provider : serialProviders )
+    {
         drc_dbg( 0, "Running test provider: '%s'\n", provider->GetName() );
 
         ReportAux( wxString::Format( "Run DRC provider: '%s'", provider->GetName() ) );
 
         if( !provider->Run() )
+            return;
+    }
+
+    // The rest only read the board and can run side by side.
+    THREAD_POOL&                   tp = GetKiCadThreadPool();
+    std::vector<std::future<bool>> returns;
+
+    m_deferredReports.clear();
+    m_deferReports = true;
+
+    for( DRC_TEST_PROVIDER* provider : concurrentProviders )
+    {
+        drc_dbg( 0, "Running test provider: '%s'\n", provider->GetName() );
+
+        ReportAux( wxString::Format( "Run DRC provider: '%s'", provider->GetName() ), provider );
+
+        returns.push_back( tp.Submit(
+                [provider]()
+                {
+                    return provider->Run();
+                } ) );
+    }
+
+    if( m_progressReporter )
+        tp.WaitAll( returns, [this]() { m_progressReporter->KeepRefreshing(); } );
+    else
+        tp.WaitAll( returns );
+
+    m_deferReports = false;
+
+    // Hand the results on in provider order so the markers don't depend on thread timing.
+    // This is also where they are counted against the error limits, so that the limits keep
+    // the same violations whichever provider found its own first.  As with the serial loop,
+    // nothing is reported past a provider which was cancelled.
+    for( size_t ii = 0; ii < concurrentProviders.size(); ++ii )
+    {
+        for( DEFERRED_REPORT& report : m_deferredReports[ concurrentProviders[ii] ] )
+        {
+            if( report.m_item )
+                reportViolation( report.m_item, report.m_pos );
+            else
+                ReportAux( report.m_aux );
+        }
+
+        if( !returns[ii].get() )
             break;
     }
+
+    m_deferredReports.clear();
 }
 
 
@@ -718,12 +974,13 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
     // Local overrides take precedence
     if( aConstraintId == DRC_CONSTRAINT_TYPE_CLEARANCE )
     {
-        int overrideA = 0;
-        int overrideB = 0;
+        wxString source;
+        int      overrideA = 0;
+        int      overrideB = 0;
 
         if( connectedA && connectedA->GetLocalClearanceOverrides( nullptr ) > 0 )
         {
-            overrideA = connectedA->GetLocalClearanceOverrides( &m_msg );
+            overrideA = connectedA->GetLocalClearanceOverrides( &source );
 
             REPORT( "" )
             REPORT( wxString::Format( _( "Local override on %s; clearance: %s." ),
@@ -733,7 +990,7 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
 
         if( connectedB && connectedB->GetLocalClearanceOverrides( nullptr ) > 0 )
         {
-            overrideB = connectedB->GetLocalClearanceOverrides( &m_msg );
+            overrideB = connectedB->GetLocalClearanceOverrides( &source );
 
             REPORT( "" )
             REPORT( wxString::Format( _( "Local override on %s; clearance: %s." ),
@@ -743,7 +1000,7 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
 
         if( overrideA || overrideB )
         {
-            DRC_CONSTRAINT constraint( DRC_CONSTRAINT_TYPE_CLEARANCE, m_msg );
+            DRC_CONSTRAINT constraint( DRC_CONSTRAINT_TYPE_CLEARANCE, source );
             constraint.m_Value.SetMin( std::max( overrideA, overrideB ) );
             return constraint;
         }
@@ -933,7 +1190,7 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
 
     if( m_constraintMap.count( aConstraintId ) )
     {
-        std::vector<CONSTRAINT_WITH_CONDITIONS*>* ruleset = m_constraintMap[ aConstraintId ];
+        std::vector<CONSTRAINT_WITH_CONDITIONS*>* ruleset = m_constraintMap.at( aConstraintId );
 
         if( aReporter )
         {
@@ -945,11 +1202,37 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
         }
         else
         {
-            // Last matching rule wins, so process in reverse order and quit when match found
-            for( int ii = (int) ruleset->size() - 1; ii >= 0; --ii )
+            CONSTRAINT_CACHE_KEY key;
+            bool                 cacheable = makeCacheKey( aConstraintId, a, b, aLayer, key );
+            bool                 cached = false;
+
+            if( cacheable )
+            {
+                std::shared_lock<std::shared_timed_mutex> lock( m_constraintCacheMutex );
+                auto it = m_constraintCache.find( key );
+
+                if( it != m_constraintCache.end() )
+                {
+                    constraintRef = it->second.m_constraint;
+                    implicit = it->second.m_implicit;
+                    cached = true;
+                }
+            }
+
+            if( !cached )
             {
-                if( processConstraint( ruleset->at( ii ) ) )
-                    break;
+                // Last matching rule wins, so process in reverse order and quit when match found
+                for( int ii = (int) ruleset->size() - 1; ii >= 0; --ii )
+                {
+                    if( processConstraint( ruleset->at( ii ) ) )
+                        break;
+                }
+
+                if( cacheable )
+                {
+                    std::unique_lock<std::shared_timed_mutex> lock( m_constraintCacheMutex );
+                    m_constraintCache[ key ] = { constraintRef, implicit };
+                }
             }
         }
     }
@@ -959,10 +1242,11 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
     // rule selection paradigm is "winner takes all".
     if( constraintRef && aConstraintId == DRC_CONSTRAINT_TYPE_CLEARANCE && implicit )
     {
-        int global = constraintRef->m_Value.Min();
-        int localA = connectedA ? connectedA->GetLocalClearance( nullptr ) : 0;
-        int localB = connectedB ? connectedB->GetLocalClearance( nullptr ) : 0;
-        int clearance = global;
+        wxString source;
+        int      global = constraintRef->m_Value.Min();
+        int      localA = connectedA ? connectedA->GetLocalClearance( nullptr ) : 0;
+        int      localB = connectedB ? connectedB->GetLocalClearance( nullptr ) : 0;
+        int      clearance = global;
 
         if( localA > 0 )
         {
@@ -972,7 +1256,7 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
                                       MessageTextFromValue( UNITS, localA ) ) )
 
             if( localA > clearance )
-                clearance = connectedA->GetLocalClearance( &m_msg );
+                clearance = connectedA->GetLocalClearance( &source );
         }
 
         if( localB > 0 )
@@ -983,12 +1267,12 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
                                       MessageTextFromValue( UNITS, localB ) ) )
 
             if( localB > clearance )
-                clearance = connectedB->GetLocalClearance( &m_msg );
+                clearance = connectedB->GetLocalClearance( &source );
         }
 
         if( localA > global || localB > global )
         {
-            DRC_CONSTRAINT constraint( DRC_CONSTRAINT_TYPE_CLEARANCE, m_msg );
+            DRC_CONSTRAINT constraint( DRC_CONSTRAINT_TYPE_CLEARANCE, source );
             constraint.m_Value.SetMin( clearance );
             return constraint;
         }
@@ -996,8 +1280,13 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
 
     // fixme: return optional<drc_constraint>, let the particular test decide what to do if no matching constraint
     // is found
-    static DRC_CONSTRAINT nullConstraint( DRC_CONSTRAINT_TYPE_NULL );
-    nullConstraint.m_DisallowFlags = 0;
+    // (Initialized once and never written to again, so it's safe to share between threads.)
+    static const DRC_CONSTRAINT nullConstraint = []()
+            {
+                DRC_CONSTRAINT constraint( DRC_CONSTRAINT_TYPE_NULL );
+                constraint.m_DisallowFlags = 0;
+                return constraint;
+            }();
 
     return constraintRef ? *constraintRef : nullConstraint;
 
@@ -1009,13 +1298,31 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
 bool DRC_ENGINE::IsErrorLimitExceeded( int error_code )
 {
     assert( error_code >= 0 && error_code <= DRCE_LAST );
-    return m_errorLimits[ error_code ] <= 0;
+    return m_errorLimits[ error_code ].load() <= 0;
 }
 
 
 void DRC_ENGINE::ReportViolation( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos )
 {
-    m_errorLimits[ aItem->GetErrorCode() ] -= 1;
+    if( m_deferReports )
+    {
+        std::lock_guard<std::mutex> lock( m_reportMutex );
+        m_deferredReports[ aItem->GetViolatingTest() ].push_back( { aItem, aPos, wxEmptyString } );
+        return;
+    }
+
+    reportViolation( aItem, aPos );
+}
+
+
+void DRC_ENGINE::reportViolation( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos )
+{
+    // Only ever called on the RunTests() thread, in a deterministic order, so the limit
+    // always keeps the same violations.
+    if( IsErrorLimitExceeded( aItem->GetErrorCode() ) )
+        return;
+
+    m_errorLimits[ aItem->GetErrorCode() ].fetch_sub( 1 );
 
     if( m_violationHandler )
         m_violationHandler( aItem, aPos );
@@ -1042,11 +1349,18 @@ void DRC_ENGINE::ReportViolation( const std::shared_ptr<DRC_ITEM>& aItem, wxPoin
     }
 }
 
-void DRC_ENGINE::ReportAux ( const wxString& aStr )
+void DRC_ENGINE::ReportAux( const wxString& aStr, const DRC_TEST_PROVIDER* aSource )
 {
     if( !m_reporter )
         return;
 
+    if( m_deferReports && aSource )
+    {
+        std::lock_guard<std::mutex> lock( m_reportMutex );
+        m_deferredReports[ aSource ].push_back( { nullptr, wxPoint(), aStr } );
+        return;
+    }
+
     m_reporter->Report( aStr, RPT_SEVERITY_INFO );
 }
 
@@ -1057,6 +1371,11 @@ bool DRC_ENGINE::ReportProgress( double aProgress )
         return true;
 
     m_progressReporter->SetCurrentProgress( aProgress );
+
+    // KeepRefreshing() is only allowed on the UI thread; RunTests() does it for the others
+    if( std::this_thread::get_id() != m_mainThread )
+        return !m_progressReporter->IsCancelled();
+
     return m_progressReporter->KeepRefreshing( false );
 }
 
@@ -1067,6 +1386,10 @@ bool DRC_ENGINE::ReportPhase( const wxString& aMessage )
         return true;
 
     m_progressReporter->AdvancePhase( aMessage );
+
+    if( std::this_thread::get_id() != m_mainThread )
+        return !m_progressReporter->IsCancelled();
+
     return m_progressReporter->KeepRefreshing( false );
 }
 
@@ -24,7 +24,12 @@
 #ifndef DRC_ENGINE_H
 #define DRC_ENGINE_H
 
+#include <atomic>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
 #include <vector>
 #include <unordered_map>
 
@@ -149,6 +154,9 @@ public:
                    bool aReportAllTrackErrors = true, bool aTestFootprints = true );
 
 
+    /**
+     * @return true if no more violations of \a error_code should be reported.  Thread-safe.
+     */
     bool IsErrorLimitExceeded( int error_code );
 
     DRC_CONSTRAINT EvalRulesForItems( DRC_CONSTRAINT_TYPE_T ruleID, const BOARD_ITEM* a,
@@ -156,6 +164,30 @@ public:
                                       PCB_LAYER_ID aLayer = UNDEFINED_LAYER,
                                       REPORTER* aReporter = nullptr );
 
+    /**
+     * Discard the memoized results of EvalRulesForItems().
+     *
+     * Results are cached per item "rule signature" (item type, net or netclass, via/pad type),
+     * so this must be called whenever the board changes in a way a signature doesn't capture,
+     * such as netclass assignments.  BOARD_COMMIT does so on every push, as do undo/redo and
+     * BOARD::SynchronizeNetsAndNetClasses().
+     */
+    void ClearConstraintCache();
+
+    /// How the result of resolving a given constraint type can be memoized
+    enum CACHE_MODE
+    {
+        CACHE_BY_NETCLASS,      ///< conditions depend at most on netclass, item & via/pad type
+        CACHE_BY_NET,           ///< conditions also depend on the net itself
+        CACHE_NONE              ///< conditions depend on geometry, names, etc.
+    };
+
+    /**
+     * Classify a rule condition by what its result can depend on.  Any identifier which isn't
+     * known to be captured by an item's rule signature makes the condition uncacheable.
+     */
+    static CACHE_MODE ConditionCacheMode( const wxString& aExpression );
+
     std::vector<DRC_CONSTRAINT> QueryConstraintsById( DRC_CONSTRAINT_TYPE_T ruleID );
 
     bool HasRulesForConstraintType( DRC_CONSTRAINT_TYPE_T constraintID );
@@ -167,10 +199,26 @@ public:
 
     bool RulesValid() { return m_rulesValid; }
 
+    /**
+     * Report a violation, unless the error limit of its code has been reached.
+     *
+     * While providers run concurrently the violation is held back; it is counted against
+     * the limit, and possibly dropped, when the held back reports are replayed in provider
+     * order.  IsErrorLimitExceeded() therefore only reflects the violations reported before
+     * the concurrent providers started until they have all finished.
+     */
     void ReportViolation( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos );
+
     bool ReportProgress( double aProgress );
     bool ReportPhase( const wxString& aMessage );
-    void ReportAux( const wxString& aStr );
+
+    /**
+     * Write a line to the log reporter.
+     *
+     * @param aSource is the provider the message belongs to.  While providers run
+     *                concurrently their messages are held back and logged per provider.
+     */
+    void ReportAux( const wxString& aStr, const DRC_TEST_PROVIDER* aSource = nullptr );
 
     bool QueryWorstConstraint( DRC_CONSTRAINT_TYPE_T aRuleId, DRC_CONSTRAINT& aConstraint,
                                DRC_CONSTRAINT_QUERY_T aQueryType );
@@ -208,6 +256,62 @@ private:
     void loadTestProviders();
     DRC_RULE* createImplicitRule( const wxString& name );
 
+    void reportViolation( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos );
+
+    /**
+     * Identifies everything a cacheable rule condition can depend on.  Holds no pointers so
+     * a stale entry can never alias a newly allocated item.
+     */
+    struct RULE_SIGNATURE
+    {
+        int m_type;             ///< KICAD_T, or -1 for no item
+        int m_net;              ///< netcode or netclass index, or -1
+        int m_subType;          ///< VIATYPE or PAD_ATTR_T, or -1
+
+        bool operator==( const RULE_SIGNATURE& aOther ) const
+        {
+            return m_type == aOther.m_type && m_net == aOther.m_net
+                    && m_subType == aOther.m_subType;
+        }
+    };
+
+    struct CONSTRAINT_CACHE_KEY
+    {
+        DRC_CONSTRAINT_TYPE_T m_constraint;
+        PCB_LAYER_ID          m_layer;
+        RULE_SIGNATURE        m_a;
+        RULE_SIGNATURE        m_b;
+
+        bool operator==( const CONSTRAINT_CACHE_KEY& aOther ) const
+        {
+            return m_constraint == aOther.m_constraint && m_layer == aOther.m_layer
+                    && m_a == aOther.m_a && m_b == aOther.m_b;
+        }
+    };
+
+    struct CONSTRAINT_CACHE_KEY_HASH
+    {
+        size_t operator()( const CONSTRAINT_CACHE_KEY& aKey ) const;
+    };
+
+    struct CACHED_CONSTRAINT
+    {
+        const DRC_CONSTRAINT* m_constraint;
+        bool                  m_implicit;
+    };
+
+    bool makeSignature( const BOARD_ITEM* aItem, CACHE_MODE aMode, RULE_SIGNATURE& aSig ) const;
+
+    bool makeCacheKey( DRC_CONSTRAINT_TYPE_T aConstraintId, const BOARD_ITEM* a,
+                       const BOARD_ITEM* b, PCB_LAYER_ID aLayer, CONSTRAINT_CACHE_KEY& aKey ) const;
+
+    struct DEFERRED_REPORT
+    {
+        std::shared_ptr<DRC_ITEM> m_item;     // nullptr for a ReportAux() message
+        wxPoint                   m_pos;
+        wxString                  m_aux;
+    };
+
 protected:
     BOARD_DESIGN_SETTINGS*           m_designSettings;
     BOARD*                           m_board;
@@ -219,7 +323,7 @@ protected:
     std::vector<DRC_TEST_PROVIDER*>  m_testProviders;
 
     EDA_UNITS                        m_userUnits;
-    std::vector<int>                 m_errorLimits;
+    std::vector<std::atomic<int>>    m_errorLimits;
     bool                             m_testTracksAgainstZones;
     bool                             m_reportAllTrackErrors;
     bool                             m_testFootprints;
@@ -232,7 +336,20 @@ protected:
     REPORTER*                        m_reporter;
     PROGRESS_REPORTER*               m_progressReporter;
 
-    wxString m_msg;  // Allocating strings gets expensive enough to want to avoid it
+    // Providers may run on pool threads; only the thread which called RunTests() may touch
+    // the UI, and violations are handed to it in provider order once they've all finished.
+    std::thread::id                  m_mainThread;
+    bool                             m_deferReports;
+    std::mutex                       m_reportMutex;
+    std::map<const DRC_TEST_PROVIDER*, std::vector<DEFERRED_REPORT>> m_deferredReports;
+
+    // EvalRulesForItems() memoization
+    std::unordered_map<DRC_CONSTRAINT_TYPE_T, CACHE_MODE> m_constraintCacheModes;
+    std::vector<int>                 m_netclassIndices;     // netcode -> netclass index
+    std::shared_timed_mutex          m_constraintCacheMutex;
+    std::unordered_map<CONSTRAINT_CACHE_KEY, CACHED_CONSTRAINT,
+                       CONSTRAINT_CACHE_KEY_HASH> m_constraintCache;
+
     std::shared_ptr<KIGFX::VIEW_OVERLAY> m_debugOverlay;
 };
 
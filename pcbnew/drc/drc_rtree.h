@@ -73,6 +73,8 @@ public:
 
     ~DRC_RTREE()
     {
+        freeItems();
+
         for( auto tree : m_tree )
             delete tree;
     }
@@ -110,6 +112,24 @@ public:
         }
     }
 
+    /**
+     * Inserts an item by its bounding box on each of \a aLayers.  No shape is stored; this is
+     * for tests which only need a fast candidate lookup and do their own shape handling.
+     */
+    void insertBoundingBox( BOARD_ITEM* aItem, LSET aLayers )
+    {
+        EDA_RECT  bbox    = aItem->GetBoundingBox();
+        bbox.Normalize();
+        const int mmin[2] = { bbox.GetX(), bbox.GetY() };
+        const int mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
+
+        for( PCB_LAYER_ID layer : aLayers.Seq() )
+        {
+            m_tree[layer]->Insert( mmin, mmax, new ITEM_WITH_SHAPE( aItem, nullptr ) );
+            m_count++;
+        }
+    }
+
 #if 0
     /**
      * Function Remove()
@@ -174,6 +194,8 @@ public:
      */
     void clear()
     {
+        freeItems();
+
         for( auto tree : m_tree )
             tree->RemoveAll();
 
@@ -323,6 +345,34 @@ public:
         return count;
     }
 
+    /**
+     * Calls \a aVisitor for each item on \a aLayer whose indexed box intersects \a aRect.
+     * Items inserted with several subshapes may be visited more than once.
+     *
+     * @param aVisitor returns false to stop the search.
+     * @return the number of items visited.
+     */
+    int QueryOverlapping( PCB_LAYER_ID aLayer, const EDA_RECT& aRect,
+                          std::function<bool( BOARD_ITEM* )> aVisitor ) const
+    {
+        EDA_RECT box = aRect;
+        box.Normalize();
+
+        int min[2] = { box.GetX(),         box.GetY() };
+        int max[2] = { box.GetRight(),     box.GetBottom() };
+        int count = 0;
+
+        auto visit =
+                [&]( ITEM_WITH_SHAPE* aItem ) -> bool
+                {
+                    count++;
+                    return aVisitor( aItem->parent );
+                };
+
+        this->m_tree[aLayer]->Search( min, max, visit );
+        return count;
+    }
+
     typedef std::pair<PCB_LAYER_ID, PCB_LAYER_ID> LAYER_PAIR;
 
     struct PAIR_INFO
@@ -529,6 +579,22 @@ public:
 
 
 private:
+    void freeItems()
+    {
+        const int mmin[2] = { INT_MIN, INT_MIN };
+        const int mmax[2] = { INT_MAX, INT_MAX };
+
+        auto deleteItem =
+                []( ITEM_WITH_SHAPE* aItem ) -> bool
+                {
+                    delete aItem;
+                    return true;
+                };
+
+        for( auto tree : m_tree )
+            tree->Search( mmin, mmax, deleteItem );
+    }
+
     drc_rtree*  m_tree[PCB_LAYER_ID_COUNT];
     size_t      m_count;
 };
@@ -54,32 +54,65 @@ bool DRC_RULE_CONDITION::EvaluateFor( const BOARD_ITEM* aItemA, const BOARD_ITEM
         return false;
     }
 
-    PCB_EXPR_CONTEXT ctx( aLayer );
-    ctx.SetErrorCallback(
-            [&]( const wxString& aMessage, int aOffset )
-            {
-                if( aReporter )
+    // Conditions are evaluated millions of times during DRC, from several threads at once, so
+    // each thread reuses one context rather than building one per call.  A condition evaluated
+    // from within another one (which none of the builtins currently do) gets its own.
+    thread_local PCB_EXPR_CONTEXT threadCtx;
+    thread_local int              depth = 0;
+
+    std::unique_ptr<PCB_EXPR_CONTEXT> nestedCtx;
+
+    if( depth > 0 )
+        nestedCtx = std::make_unique<PCB_EXPR_CONTEXT>();
+
+    PCB_EXPR_CONTEXT& ctx = nestedCtx ? *nestedCtx : threadCtx;
+
+    // Restores the nesting depth, and keeps the reused context from holding on to the
+    // caller's reporter or items, however the evaluation is left.
+    struct CONTEXT_GUARD
+    {
+        CONTEXT_GUARD( PCB_EXPR_CONTEXT& aCtx, int& aDepth ) :
+                m_ctx( aCtx ),
+                m_depth( aDepth )
+        {
+            ++m_depth;
+        }
+
+        ~CONTEXT_GUARD()
+        {
+            --m_depth;
+            m_ctx.SetErrorCallback( nullptr );
+            m_ctx.SetItems( nullptr, nullptr );
+        }
+
+        PCB_EXPR_CONTEXT& m_ctx;
+        int&              m_depth;
+    } guard( ctx, depth );
+
+    ctx.SetLayer( aLayer );
+
+    if( aReporter )
+    {
+        ctx.SetErrorCallback(
+                [&]( const wxString& aMessage, int aOffset )
+                {
                     aReporter->Report( _( "ERROR:" ) + wxS( " " )+ aMessage );
-            } );
+                } );
+    }
 
     BOARD_ITEM* a = const_cast<BOARD_ITEM*>( aItemA );
     BOARD_ITEM* b = aItemB ? const_cast<BOARD_ITEM*>( aItemB ) : DELETED_BOARD_ITEM::GetInstance();
 
     ctx.SetItems( a, b );
+    bool result = m_ucode->Run( &ctx )->AsDouble() != 0.0;
 
-    if( m_ucode->Run( &ctx )->AsDouble() != 0.0 )
-    {
-        return true;
-    }
-    else if( aItemB )   // Conditions are commutative
+    if( !result && aItemB )     // Conditions are commutative
     {
         ctx.SetItems( b, a );
-
-        if( m_ucode->Run( &ctx )->AsDouble() != 0.0 )
-            return true;
+        result = m_ucode->Run( &ctx )->AsDouble() != 0.0;
     }
 
-    return false;
+    return result;
 }
 
 
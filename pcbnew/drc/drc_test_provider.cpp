@@ -29,10 +29,33 @@
 #include <class_pad.h>
 #include <class_zone.h>
 #include <pcb_text.h>
+#include <thread_pool.h>
 
 
-// A list of all basic (ie: non-compound) board geometry items
-std::vector<KICAD_T> DRC_TEST_PROVIDER::s_allBasicItems;
+// A list of all basic (ie: non-compound) board geometry items.  Built once, before any
+// provider runs, so that providers running concurrently can share it without locking.
+const std::vector<KICAD_T> DRC_TEST_PROVIDER::s_allBasicItems = []()
+{
+    std::vector<KICAD_T> types;
+
+    for( int i = 0; i < MAX_STRUCT_TYPE_ID; i++ )
+    {
+        if( i != PCB_MODULE_T && i != PCB_GROUP_T )
+            types.push_back( (KICAD_T) i );
+    }
+
+    return types;
+}();
+
+
+struct DEFERRED_VIOLATION
+{
+    std::shared_ptr<DRC_ITEM> m_item;
+    wxPoint                   m_pos;
+};
+
+// Violation buffer of the forEachIndexInParallel() chunk running on this thread, if any
+static thread_local std::vector<DEFERRED_VIOLATION>* s_chunkViolations = nullptr;
 
 
 DRC_TEST_PROVIDER::DRC_TEST_PROVIDER() :
@@ -48,7 +71,11 @@ const wxString DRC_TEST_PROVIDER::GetDescription() const { return ""; }
 void DRC_TEST_PROVIDER::reportViolation( std::shared_ptr<DRC_ITEM>& item, wxPoint aMarkerPos )
 {
     item->SetViolatingTest( this );
-    m_drcEngine->ReportViolation( item, aMarkerPos );
+
+    if( s_chunkViolations )
+        s_chunkViolations->push_back( { item, aMarkerPos } );
+    else
+        m_drcEngine->ReportViolation( item, aMarkerPos );
 }
 
 
@@ -78,7 +105,7 @@ void DRC_TEST_PROVIDER::reportAux( wxString fmt, ... )
     wxString str;
     str.PrintfV( fmt, vargs );
     va_end( vargs );
-    m_drcEngine->ReportAux( str );
+    m_drcEngine->ReportAux( str, this );
 }
 
 
@@ -90,6 +117,8 @@ EDA_UNITS DRC_TEST_PROVIDER::userUnits() const
 
 void DRC_TEST_PROVIDER::accountCheck( const DRC_RULE* ruleToTest )
 {
+    std::lock_guard<std::mutex> lock( m_statsMutex );
+
     auto it = m_stats.find( ruleToTest );
 
     if( it == m_stats.end() )
@@ -110,7 +139,7 @@ void DRC_TEST_PROVIDER::reportRuleStatistics()
     if( !m_isRuleDriven )
         return;
 
-    m_drcEngine->ReportAux( "Rule hit statistics: " );
+    m_drcEngine->ReportAux( "Rule hit statistics: ", this );
 
     for( const std::pair<const DRC_RULE* const, int>& stat : m_stats )
     {
@@ -118,7 +147,8 @@ void DRC_TEST_PROVIDER::reportRuleStatistics()
         {
             m_drcEngine->ReportAux( wxString::Format( " - rule '%s': %d hits ",
                                                       stat.first->m_Name,
-                                                      stat.second ) );
+                                                      stat.second ),
+                                    this );
         }
     }
 }
@@ -131,15 +161,6 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
     std::bitset<MAX_STRUCT_TYPE_ID> typeMask;
     int n = 0;
 
-    if( s_allBasicItems.size() == 0 )
-    {
-        for( int i = 0; i < MAX_STRUCT_TYPE_ID; i++ )
-        {
-            if( i != PCB_MODULE_T && i != PCB_GROUP_T )
-                s_allBasicItems.push_back( (KICAD_T) i );
-        }
-    }
-
     if( aTypes.size() == 0 )
     {
         for( int i = 0; i < MAX_STRUCT_TYPE_ID; i++ )
@@ -321,4 +342,63 @@ bool DRC_TEST_PROVIDER::isInvisibleText( const BOARD_ITEM* aItem ) const
     }
 
     return false;
-}
\ No newline at end of file
+}
+
+bool DRC_TEST_PROVIDER::forEachIndexInParallel( size_t aCount, int aDelta,
+                                                const std::function<void( size_t )>& aFunc )
+{
+    if( aCount == 0 )
+        return true;
+
+    THREAD_POOL& tp = GetKiCadThreadPool();
+
+    // A few chunks per thread keeps the load balanced when item costs vary a lot
+    size_t chunkCount = std::min( aCount, tp.GetThreadCount() * 4 );
+    size_t chunkSize = ( aCount + chunkCount - 1 ) / chunkCount;
+
+    std::vector<std::vector<DEFERRED_VIOLATION>> violations( chunkCount );
+    std::vector<std::future<void>>               returns;
+    std::atomic<size_t>                          done( 0 );
+    std::atomic<bool>                            cancelled( false );
+
+    for( size_t chunk = 0; chunk < chunkCount; ++chunk )
+    {
+        returns.push_back( tp.Submit(
+                [&, chunk]()
+                {
+                    std::vector<DEFERRED_VIOLATION>* previous = s_chunkViolations;
+                    s_chunkViolations = &violations[ chunk ];
+
+                    size_t last = std::min( aCount, ( chunk + 1 ) * chunkSize );
+
+                    for( size_t ii = chunk * chunkSize; ii < last && !cancelled; ++ii )
+                    {
+                        if( !reportProgress( done++, aCount, aDelta ) )
+                            cancelled = true;
+                        else
+                            aFunc( ii );
+                    }
+
+                    s_chunkViolations = previous;
+                } ) );
+    }
+
+    tp.WaitAll( returns );
+
+    // Rethrow anything thrown by aFunc
+    for( std::future<void>& ret : returns )
+        ret.get();
+
+    for( std::vector<DEFERRED_VIOLATION>& chunkViolations : violations )
+    {
+        for( DEFERRED_VIOLATION& violation : chunkViolations )
+        {
+            if( s_chunkViolations )
+                s_chunkViolations->push_back( violation );
+            else
+                m_drcEngine->ReportViolation( violation.m_item, violation.m_pos );
+        }
+    }
+
+    return !cancelled;
+}
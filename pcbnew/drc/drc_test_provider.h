@@ -29,6 +29,7 @@
 #include <class_marker_pcb.h>
 
 #include <functional>
+#include <mutex>
 #include <set>
 
 class DRC_ENGINE;
@@ -97,6 +98,16 @@ public:
         return m_isRuleDriven;
     }
 
+    /**
+     * Returns true if the provider only reads shared board state, and can therefore be run
+     * concurrently with other such providers.  Providers which update connectivity, item
+     * flags or other caches must return false; they are run on their own before the others.
+     */
+    virtual bool CanRunConcurrently() const
+    {
+        return false;
+    }
+
     bool IsEnabled() const
     {
         return m_enabled;
@@ -111,6 +122,21 @@ protected:
     int forEachGeometryItem( const std::vector<KICAD_T>& aTypes, LSET aLayers,
                              const std::function<bool(BOARD_ITEM*)>& aFunc );
 
+    /**
+     * Calls aFunc for each index in [0, aCount), split into chunks across the thread pool.
+     *
+     * Violations reported from within aFunc are buffered per chunk and passed on in index
+     * order, so the resulting markers don't depend on thread scheduling.  They only count
+     * against the engine's error limits once they are passed on, so the limits decide which
+     * of them are kept in that same order.  aFunc must not touch m_msg or other unprotected
+     * provider members.
+     *
+     * @param aDelta is the number of items between two progress reports.
+     * @return false if the user cancelled.
+     */
+    bool forEachIndexInParallel( size_t aCount, int aDelta,
+                                 const std::function<void( size_t )>& aFunc );
+
     virtual void reportAux( wxString fmt, ... );
     virtual void reportViolation( std::shared_ptr<DRC_ITEM>& item, wxPoint aMarkerPos );
     virtual bool reportProgress( int aCount, int aSize, int aDelta );
@@ -123,11 +149,12 @@ protected:
     bool isInvisibleText( const BOARD_ITEM* aItem ) const;
 
     // List of basic (ie: non-compound) geometry items
-    static std::vector<KICAD_T> s_allBasicItems;
+    static const std::vector<KICAD_T> s_allBasicItems;
 
     EDA_UNITS   userUnits() const;
     DRC_ENGINE* m_drcEngine;
     std::unordered_map<const DRC_RULE*, int> m_stats;
+    std::mutex  m_statsMutex;
     bool        m_isRuleDriven = true;
     bool        m_enabled = true;
 
@@ -63,6 +63,11 @@ public:
     virtual std::set<DRC_CONSTRAINT_TYPE_T> GetConstraintTypes() const override;
 
     int GetNumPhases() const override;
+
+    bool CanRunConcurrently() const override
+    {
+        return true;
+    }
 };
 
 
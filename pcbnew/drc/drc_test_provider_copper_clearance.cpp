@@ -36,6 +36,7 @@
 #include <drc/drc_engine.h>
 #include <drc/drc_item.h>
 #include <drc/drc_rule.h>
+#include <drc/drc_rtree.h>
 #include <drc/drc_test_provider_clearance_base.h>
 #include <class_dimension.h>
 
@@ -47,6 +48,9 @@
     - DRCE_ZONES_INTERSECT
     - DRCE_SHORTING_ITEMS
 
+    Tracks and pads are looked up through a per-layer DRC_RTREE, inflated by the worst
+    clearance, so the cost of checking an item depends on the local density only.
+
     TODO: improve zone clearance check (super slow)
 */
 
@@ -78,7 +82,21 @@ public:
 
     int GetNumPhases() const override;
 
+    bool CanRunConcurrently() const override
+    {
+        return true;
+    }
+
 private:
+    void buildCopperTree();
+
+    /**
+     * Collect the pads and tracks indexed on \a aLayer whose bounding boxes intersect
+     * \a aArea, in board order (so that violations are reported in a stable order).
+     */
+    void collectCandidates( PCB_LAYER_ID aLayer, const EDA_RECT& aArea,
+                            std::vector<D_PAD*>& aPads, std::vector<TRACK*>& aTracks ) const;
+
     void testPadClearances();
 
     void testTrackClearances();
@@ -89,8 +107,13 @@ private:
 
     void testCopperDrawItem( BOARD_ITEM* aItem );
 
-    void doTrackDrc( TRACK* aRefSeg, PCB_LAYER_ID aLayer, TRACKS::iterator aStartIt,
-                     TRACKS::iterator aEndIt );
+    /**
+     * Test a track segment against the pads, the tracks after it in the board's track list,
+     * and optionally the copper zones.
+     *
+     * @param aRefIndex is the index of \a aRefSeg in the board's track list.
+     */
+    void doTrackDrc( TRACK* aRefSeg, PCB_LAYER_ID aLayer, int aRefIndex );
 
     /**
      * Test clearance of a pad hole with the pad hole of other pads.
@@ -102,6 +125,10 @@ private:
      * for each pad for the first in list to the last in list
      */
     void doPadToPadsDrc( int aRefPadIdx, std::vector<D_PAD*>& aSortedPadsList, int aX_limit );
+
+private:
+    DRC_RTREE                                  m_copperTree;
+    std::unordered_map<const BOARD_ITEM*, int> m_itemIndex;    // position in board order
 };
 
 
@@ -123,6 +150,8 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::Run()
 
     reportAux( "Worst clearance : %d nm", m_largestClearance );
 
+    buildCopperTree();
+
     if( !reportPhase( _( "Checking pad clearances..." ) ) )
         return false;
 
@@ -145,9 +174,74 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::Run()
 
     reportRuleStatistics();
 
+    m_copperTree.clear();
+    m_itemIndex.clear();
+
     return true;
 }
 
+
+void DRC_TEST_PROVIDER_COPPER_CLEARANCE::buildCopperTree()
+{
+    static const LSET all_cu = LSET::AllCuMask();
+
+    m_copperTree.clear();
+    m_itemIndex.clear();
+
+    int idx = 0;
+
+    for( MODULE* module : m_board->Modules() )
+    {
+        for( D_PAD* pad : module->Pads() )
+        {
+            // A PTH has a plated barrel on every copper layer, flashed or not
+            if( pad->GetAttribute() == PAD_ATTRIB_PTH )
+                m_copperTree.insertBoundingBox( pad, pad->GetLayerSet() | all_cu );
+            else
+                m_copperTree.insertBoundingBox( pad, pad->GetLayerSet() );
+
+            m_itemIndex[ pad ] = idx++;
+        }
+    }
+
+    idx = 0;
+
+    for( TRACK* track : m_board->Tracks() )
+    {
+        m_copperTree.insertBoundingBox( track, track->GetLayerSet() );
+        m_itemIndex[ track ] = idx++;
+    }
+
+    reportAux( "Indexed %d copper items", (int) m_copperTree.size() );
+}
+
+
+void DRC_TEST_PROVIDER_COPPER_CLEARANCE::collectCandidates( PCB_LAYER_ID aLayer,
+                                                            const EDA_RECT& aArea,
+                                                            std::vector<D_PAD*>& aPads,
+                                                            std::vector<TRACK*>& aTracks ) const
+{
+    m_copperTree.QueryOverlapping( aLayer, aArea,
+            [&]( BOARD_ITEM* aItem ) -> bool
+            {
+                if( aItem->Type() == PCB_PAD_T )
+                    aPads.push_back( static_cast<D_PAD*>( aItem ) );
+                else
+                    aTracks.push_back( static_cast<TRACK*>( aItem ) );
+
+                return true;
+            } );
+
+    auto boardOrder =
+            [&]( const BOARD_ITEM* a, const BOARD_ITEM* b )
+            {
+                return m_itemIndex.at( a ) < m_itemIndex.at( b );
+            };
+
+    std::sort( aPads.begin(), aPads.end(), boardOrder );
+    std::sort( aTracks.begin(), aTracks.end(), boardOrder );
+}
+
 void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testCopperTextAndGraphics()
 {
     // Test copper items for clearance violations with vias, tracks and pads
@@ -207,12 +301,16 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testCopperDrawItem( BOARD_ITEM* aItem )
 
     SHAPE_RECT bboxShape( bbox.GetX(), bbox.GetY(), bbox.GetWidth(), bbox.GetHeight() );
 
+    EDA_RECT            searchArea = bbox;
+    std::vector<D_PAD*> pads;
+    std::vector<TRACK*> tracks;
+
+    searchArea.Inflate( m_largestClearance );
+    collectCandidates( layer, searchArea, pads, tracks );
+
     // Test tracks and vias
-    for( TRACK* track : m_board->Tracks() )
+    for( TRACK* track : tracks )
     {
-        if( !track->IsOnLayer( aItem->GetLayer() ) )
-            continue;
-
         SHAPE_SEGMENT trackSeg( track->GetStart(), track->GetEnd(), track->GetWidth() );
 
         // Fast test to detect a track segment candidate inside the text bounding box
@@ -248,7 +346,7 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testCopperDrawItem( BOARD_ITEM* aItem )
     }
 
     // Test pads
-    for( D_PAD* pad : m_board->GetPads() )
+    for( D_PAD* pad : pads )
     {
         if( !pad->IsOnLayer( layer ) )
             continue;
@@ -315,31 +413,26 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testTrackClearances()
 {
     // This is the number of tests between 2 calls to the progress bar
     const int delta = 25;
-    int       count = m_board->Tracks().size();
+    TRACKS&   tracks = m_board->Tracks();
+    int       count = tracks.size();
 
     reportAux( "Testing %d tracks...", count );
 
-    int ii = 0;
-
-    for( auto seg_it = m_board->Tracks().begin(); seg_it != m_board->Tracks().end(); seg_it++ )
-    {
-        if( !reportProgress( ii++, m_board->Tracks().size(), delta ) )
-            break;
-
-        // Test segment against tracks and pads, optionally against copper zones
-        for( PCB_LAYER_ID layer : (*seg_it)->GetLayerSet().Seq() )
-        {
-            doTrackDrc( *seg_it, layer, seg_it + 1, m_board->Tracks().end() );
-        }
-    }
+    forEachIndexInParallel( count, delta,
+            [&]( size_t ii )
+            {
+                // Test segment against tracks and pads, optionally against copper zones
+                for( PCB_LAYER_ID layer : tracks[ii]->GetLayerSet().Seq() )
+                    doTrackDrc( tracks[ii], layer, (int) ii );
+            } );
 }
 
 
 void DRC_TEST_PROVIDER_COPPER_CLEARANCE::doTrackDrc( TRACK* aRefSeg, PCB_LAYER_ID aLayer,
-                                                     TRACKS::iterator aStartIt,
-                                                     TRACKS::iterator aEndIt )
+                                                     int aRefIndex )
 {
     BOARD_DESIGN_SETTINGS&  bds = m_board->GetDesignSettings();
+    wxString                msg;    // Not m_msg: we run on several threads at once
 
     SHAPE_SEGMENT refSeg( aRefSeg->GetStart(), aRefSeg->GetEnd(), aRefSeg->GetWidth() );
     EDA_RECT      refSegInflatedBB = aRefSeg->GetBoundingBox();
@@ -347,76 +440,71 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::doTrackDrc( TRACK* aRefSeg, PCB_LAYER_I
 
     refSegInflatedBB.Inflate( m_largestClearance );
 
+    std::vector<D_PAD*> pads;
+    std::vector<TRACK*> tracks;
+
+    collectCandidates( aLayer, refSegInflatedBB, pads, tracks );
+
     /******************************************/
     /* Phase 1 : test DRC track to pads :     */
     /******************************************/
 
     // Compute the min distance to pads
-    for( MODULE* mod : m_board->Modules() )
+    for( D_PAD* pad : pads )
     {
         if( m_drcEngine->IsErrorLimitExceeded( DRCE_CLEARANCE ) )
             break;
 
-        // Don't preflight at the module level.  Getting a module's bounding box goes
-        // through all its pads anyway (so it's no faster), and also all its drawings
-        // (so it's in fact slower).
-
-        for( D_PAD* pad : mod->Pads() )
-        {
-            if( m_drcEngine->IsErrorLimitExceeded( DRCE_CLEARANCE ) )
-                break;
-
-            // Preflight based on bounding boxes.
-            if( !refSegInflatedBB.Intersects( pad->GetBoundingBox() ) )
-                continue;
+        // Preflight based on bounding boxes.
+        if( !refSegInflatedBB.Intersects( pad->GetBoundingBox() ) )
+            continue;
 
-            // No need to check pads with the same net as the refSeg.
-            if( pad->GetNetCode() && aRefSeg->GetNetCode() == pad->GetNetCode() )
-                continue;
+        // No need to check pads with the same net as the refSeg.
+        if( pad->GetNetCode() && aRefSeg->GetNetCode() == pad->GetNetCode() )
+            continue;
 
-            SHAPE_SEGMENT padCylinder;
-            const SHAPE* padShape;
+        SHAPE_SEGMENT padCylinder;
+        const SHAPE* padShape;
 
-            if( pad->FlashLayer( aLayer ) )
-            {
-                padShape = pad->GetEffectiveShape().get();
-            }
-            else if( pad->GetAttribute() == PAD_ATTRIB_PTH )
-            {
-                // Note: drill size represents finish size, which means the actual holes size is the
-                // plating thickness larger.
-                padCylinder = *pad->GetEffectiveHoleShape();
-                padCylinder.SetWidth( padCylinder.GetWidth() + bds.GetHolePlatingThickness() );
-                padShape = &padCylinder;
-            }
-            else
-            {
-                continue;
-            }
+        if( pad->FlashLayer( aLayer ) )
+        {
+            padShape = pad->GetEffectiveShape().get();
+        }
+        else if( pad->GetAttribute() == PAD_ATTRIB_PTH )
+        {
+            // Note: drill size represents finish size, which means the actual holes size is the
+            // plating thickness larger.
+            padCylinder = *pad->GetEffectiveHoleShape();
+            padCylinder.SetWidth( padCylinder.GetWidth() + bds.GetHolePlatingThickness() );
+            padShape = &padCylinder;
+        }
+        else
+        {
+            continue;
+        }
 
-            auto     constraint = m_drcEngine->EvalRulesForItems( DRC_CONSTRAINT_TYPE_CLEARANCE,
-                                                                  aRefSeg, pad, aLayer );
-            int      minClearance = constraint.GetValue().Min();
-            int      actual;
-            VECTOR2I pos;
+        auto     constraint = m_drcEngine->EvalRulesForItems( DRC_CONSTRAINT_TYPE_CLEARANCE,
+                                                              aRefSeg, pad, aLayer );
+        int      minClearance = constraint.GetValue().Min();
+        int      actual;
+        VECTOR2I pos;
 
-            accountCheck( constraint );
+        accountCheck( constraint );
 
-            if( padShape->Collide( &refSeg, minClearance - bds.GetDRCEpsilon(), &actual, &pos ) )
-            {
-                std::shared_ptr<DRC_ITEM> drcItem = DRC_ITEM::Create( DRCE_CLEARANCE );
+        if( padShape->Collide( &refSeg, minClearance - bds.GetDRCEpsilon(), &actual, &pos ) )
+        {
+            std::shared_ptr<DRC_ITEM> drcItem = DRC_ITEM::Create( DRCE_CLEARANCE );
 
-                m_msg.Printf( drcItem->GetErrorText() + wxS( " " ) + _( "(%s clearance %s; actual %s)" ),
-                              constraint.GetName(),
-                              MessageTextFromValue( userUnits(), minClearance ),
-                              MessageTextFromValue( userUnits(), actual ) );
+            msg.Printf( drcItem->GetErrorText() + wxS( " " ) + _( "(%s clearance %s; actual %s)" ),
+                        constraint.GetName(),
+                        MessageTextFromValue( userUnits(), minClearance ),
+                        MessageTextFromValue( userUnits(), actual ) );
 
-                drcItem->SetErrorMessage( m_msg );
-                drcItem->SetItems( aRefSeg, pad );
-                drcItem->SetViolatingRule( constraint.GetParentRule() );
+            drcItem->SetErrorMessage( msg );
+            drcItem->SetItems( aRefSeg, pad );
+            drcItem->SetViolatingRule( constraint.GetParentRule() );
 
-                reportViolation( drcItem, (wxPoint) pos );
-            }
+            reportViolation( drcItem, (wxPoint) pos );
         }
     }
 
@@ -424,13 +512,14 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::doTrackDrc( TRACK* aRefSeg, PCB_LAYER_I
     /* Phase 2: test DRC with other track segments */
     /***********************************************/
 
-    // Test the reference segment with other track segments
-    for( auto it = aStartIt; it != aEndIt; it++ )
+    // Test the reference segment with the track segments after it
+    for( TRACK* track : tracks )
     {
         if( m_drcEngine->IsErrorLimitExceeded( DRCE_CLEARANCE ) )
             break;
 
-        TRACK* track = *it;
+        if( m_itemIndex.at( track ) <= aRefIndex )
+            continue;
 
         if( track->Type() == PCB_VIA_T )
         {
@@ -482,12 +571,12 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::doTrackDrc( TRACK* aRefSeg, PCB_LAYER_I
         {
             std::shared_ptr<DRC_ITEM> drcItem = DRC_ITEM::Create( DRCE_CLEARANCE );
 
-            m_msg.Printf( drcItem->GetErrorText() + wxS( " " ) + _( "(%s clearance %s; actual %s)" ),
-                          constraint.GetName(),
-                          MessageTextFromValue( userUnits(), minClearance ),
-                          MessageTextFromValue( userUnits(), actual ) );
+            msg.Printf( drcItem->GetErrorText() + wxS( " " ) + _( "(%s clearance %s; actual %s)" ),
+                        constraint.GetName(),
+                        MessageTextFromValue( userUnits(), minClearance ),
+                        MessageTextFromValue( userUnits(), actual ) );
 
-            drcItem->SetErrorMessage( m_msg );
+            drcItem->SetErrorMessage( msg );
             drcItem->SetItems( aRefSeg, track );
             drcItem->SetViolatingRule( constraint.GetParentRule() );
 
@@ -588,12 +677,12 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::doTrackDrc( TRACK* aRefSeg, PCB_LAYER_I
                 actual = std::max( 0, actual - halfWidth );
                 std::shared_ptr<DRC_ITEM> drcItem = DRC_ITEM::Create( DRCE_CLEARANCE );
 
-                m_msg.Printf( drcItem->GetErrorText() + wxS( " " ) + _( "(%s clearance %s; actual %s)" ),
-                              constraint.GetName(),
-                              MessageTextFromValue( userUnits(), minClearance ),
-                              MessageTextFromValue( userUnits(), actual ) );
+                msg.Printf( drcItem->GetErrorText() + wxS( " " ) + _( "(%s clearance %s; actual %s)" ),
+                            constraint.GetName(),
+                            MessageTextFromValue( userUnits(), minClearance ),
+                            MessageTextFromValue( userUnits(), actual ) );
 
-                drcItem->SetErrorMessage( m_msg );
+                drcItem->SetErrorMessage( msg );
                 drcItem->SetItems( aRefSeg, zone );
                 drcItem->SetViolatingRule( constraint.GetParentRule() );
 
@@ -855,6 +944,13 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testZones()
                 if( zoneRef->GetIsRuleArea() != zoneToTest->GetIsRuleArea() )
                     continue;
 
+                // Zones too far apart to interact can skip the (expensive) outline tests
+                EDA_RECT refBBox = zoneRef->GetCachedBoundingBox();
+                refBBox.Inflate( m_largestClearance );
+
+                if( !refBBox.Intersects( zoneToTest->GetCachedBoundingBox() ) )
+                    continue;
+
                 // Examine a candidate zone: compare zoneToTest to zoneRef
 
                 // Get clearance used in zone to zone test.
@@ -68,6 +68,11 @@ public:
 
     int GetNumPhases() const override;
 
+    bool CanRunConcurrently() const override
+    {
+        return true;
+    }
+
 private:
     void addHole( const VECTOR2I& aLocation, int aRadius, BOARD_ITEM* aOwner );
 
@@ -66,6 +66,11 @@ public:
 
     int GetNumPhases() const override;
 
+    bool CanRunConcurrently() const override
+    {
+        return true;
+    }
+
 private:
     void checkVia( VIA* via, bool aExceedMicro, bool aExceedStd );
     void checkPad( D_PAD* aPad );
@@ -72,6 +72,11 @@ public:
         return 1;
     }
 
+    virtual bool CanRunConcurrently() const override
+    {
+        return true;
+    }
+
     virtual std::set<DRC_CONSTRAINT_TYPE_T> GetConstraintTypes() const override;
 
 private:
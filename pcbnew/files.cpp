@@ -23,6 +23,7 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <advanced_config.h>
 #include <confirm.h>
 #include <kicad_string.h>
 #include <gestfich.h>
@@ -51,6 +52,8 @@
 #include <project/project_local_settings.h>
 #include <plugins/cadstar/cadstar_pcb_archive_plugin.h>
 #include <dialogs/dialog_imported_layers.h>
+#include <zone_fill_cache.h>
+#include <tools/zone_filler_tool.h>
 
 
 //#define     USE_INSTRUMENTATION     1
@@ -828,6 +831,9 @@ bool PCB_EDIT_FRAME::SavePcbFile( const wxString& aFileName, bool addToHistory,
 
     GetBoard()->SynchronizeNetsAndNetClasses();
 
+    // Fills updated in place would make the saved file depend on the edit history
+    GetToolManager()->GetTool<ZONE_FILLER_TOOL>()->RefillSplicedZones( this );
+
     // Save various DRC parameters, such as violation severities (which may have been
     // edited via the DRC dialog as well as the Board Setup dialog), DRC exclusions, etc.
     SaveProjectSettings();
@@ -881,6 +887,9 @@ bool PCB_EDIT_FRAME::SavePcbFile( const wxString& aFileName, bool addToHistory,
         return false;
     }
 
+    if( ADVANCED_CFG::GetCfg().m_ZoneFillCache )
+        ZONE_FILL_CACHE::Save( GetBoard(), pcbFileName.GetFullPath() );
+
     if( !Kiface().IsSingle() )
     {
         WX_STRING_REPORTER backupReporter( &upperTxt );
@@ -933,6 +942,8 @@ bool PCB_EDIT_FRAME::SavePcbCopy( const wxString& aFileName, bool aCreateProject
 
     GetBoard()->SynchronizeNetsAndNetClasses();
 
+    GetToolManager()->GetTool<ZONE_FILLER_TOOL>()->RefillSplicedZones( this );
+
     try
     {
         PLUGIN::RELEASER    pi( IO_MGR::PluginFind( IO_MGR::KICAD_SEXP ) );
@@ -34,19 +34,33 @@
 #include <lib_id.h>
 #include <pgm_base.h>
 #include <wildcards_and_files_ext.h>
+#include <thread_pool.h>
+#include <binary_stream.h>
 #include <widgets/progress_reporter.h>
 
-#include <thread>
+#include <cstdint>
 #include <mutex>
 
 
+static const char     FP_INFO_CACHE_MAGIC[] = "KiCad footprint info cache";
+static const uint32_t FP_INFO_CACHE_VERSION = 1;
+
+
 void FOOTPRINT_INFO_IMPL::load()
 {
     FP_LIB_TABLE* fptable = m_owner->GetTable();
 
     wxASSERT( fptable );
 
-    const MODULE* footprint = fptable->GetEnumeratedFootprint( m_nickname, m_fpname );
+    const MODULE* footprint = NULL;
+
+    // Libraries parse their footprints on demand, so a broken file only shows up here.  Its
+    // error is reported with those of the library enumeration.
+    static_cast<FOOTPRINT_LIST_IMPL*>( m_owner )->CatchErrors(
+            [&]()
+            {
+                footprint = fptable->GetEnumeratedFootprint( m_nickname, m_fpname );
+            } );
 
     if( footprint == NULL ) // Should happen only with malformed/broken libraries
     {
@@ -183,24 +197,59 @@ void FOOTPRINT_LIST_IMPL::StartWorkers( FP_LIB_TABLE* aTable, wxString const* aN
     // Clear data before reading files
     m_count_finished.store( 0 );
     m_errors.clear();
-    m_list.clear();
     m_threads.clear();
     m_queue_in.clear();
     m_queue_out.clear();
 
+    std::vector<wxString>         nicknames;
+    std::map<wxString, long long> upToDate;
+
     if( aNickname )
-        m_queue_in.push( *aNickname );
+        nicknames.push_back( *aNickname );
     else
+        nicknames = aTable->GetLogicalLibs();
+
+    m_pending_timestamps.clear();
+
+    // Libraries which did not change since they were read, possibly by an earlier session
+    // through the cache file, are kept as they are.  Only the others are read again.
+    for( const wxString& nickname : nicknames )
     {
-        for( auto const& nickname : aTable->GetLogicalLibs() )
+        long long timestamp = aTable->GenerateTimestamp( &nickname );
+        auto      it = m_lib_timestamps.find( nickname );
+
+        if( it != m_lib_timestamps.end() && it->second == timestamp )
+        {
+            upToDate[ nickname ] = timestamp;
+        }
+        else
+        {
+            m_pending_timestamps[ nickname ] = timestamp;
             m_queue_in.push( nickname );
+        }
     }
 
+    FPILIST kept;
+
+    for( std::unique_ptr<FOOTPRINT_INFO>& fpinfo : m_list )
+    {
+        if( upToDate.count( fpinfo->GetLibNickname() ) )
+            kept.push_back( std::move( fpinfo ) );
+    }
+
+    m_list.swap( kept );
+    m_lib_timestamps.swap( upToDate );
+
     m_loader->m_total_libs = m_queue_in.size();
 
+    THREAD_POOL& tp = GetKiCadThreadPool();
+
     for( unsigned i = 0; i < aNThreads; ++i )
     {
-        m_threads.emplace_back( &FOOTPRINT_LIST_IMPL::loader_job, this );
+        m_threads.push_back( tp.Submit( [this]()
+                                        {
+                                            loader_job();
+                                        } ) );
     }
 }
 
@@ -212,8 +261,7 @@ void FOOTPRINT_LIST_IMPL::StopWorkers()
     // exit on their next safe loop location when this is set).  Then we need to wait
     // for all threads to finish as closing the implementation will free the queues
     // that the threads write to.
-    for( auto& i : m_threads )
-        i.join();
+    GetKiCadThreadPool().WaitAll( m_threads );
 
     m_threads.clear();
     m_queue_in.clear();
@@ -229,16 +277,13 @@ bool FOOTPRINT_LIST_IMPL::JoinWorkers()
     {
         std::lock_guard<std::mutex> lock1( m_join );
 
-        for( auto& i : m_threads )
-            i.join();
+        GetKiCadThreadPool().WaitAll( m_threads );
 
         m_threads.clear();
         m_queue_in.clear();
         m_count_finished.store( 0 );
     }
 
-    size_t total_count = m_queue_out.size();
-
     LOCALE_IO toggle_locale;
 
     // Parse the footprints in parallel. WARNING! This requires changing the locale, which is
@@ -249,11 +294,12 @@ bool FOOTPRINT_LIST_IMPL::JoinWorkers()
     // TODO: blast LOCALE_IO into the sun
 
     SYNC_QUEUE<std::unique_ptr<FOOTPRINT_INFO>> queue_parsed;
-    std::vector<std::thread>                    threads;
+    THREAD_POOL&                                tp = GetKiCadThreadPool();
+    std::vector<std::future<void>>              returns;
 
-    for( size_t ii = 0; ii < std::thread::hardware_concurrency() + 1; ++ii )
+    for( size_t ii = 0; ii < tp.GetThreadCount(); ++ii )
     {
-        threads.emplace_back( [this, &queue_parsed]() {
+        returns.push_back( tp.Submit( [this, &queue_parsed]() {
             wxString nickname;
 
             while( this->m_queue_out.pop( nickname ) && !m_cancelled )
@@ -282,6 +328,8 @@ bool FOOTPRINT_LIST_IMPL::JoinWorkers()
                     }
                 }
 
+                // The footprints were only indexed by the enumeration.  They are parsed here,
+                // on the pool, as each FOOTPRINT_INFO_IMPL loads its pad counts and doc.
                 for( unsigned jj = 0; jj < fpnames.size() && !m_cancelled; ++jj )
                 {
                     wxString fpname = fpnames[jj];
@@ -294,19 +342,20 @@ bool FOOTPRINT_LIST_IMPL::JoinWorkers()
 
                 m_count_finished.fetch_add( 1 );
             }
-        } );
+        } ) );
     }
 
-    while( !m_cancelled && (size_t)m_count_finished.load() < total_count )
-    {
-        if( m_progress_reporter && !m_progress_reporter->KeepRefreshing() )
-            m_cancelled = true;
+    tp.WaitAll( returns, [this]()
+                         {
+                             if( m_progress_reporter && !m_progress_reporter->KeepRefreshing() )
+                                 m_cancelled = true;
+                         } );
 
-        wxMilliSleep( 30 );
-    }
+    // Libraries are only known to be complete in the list if the loading ran to its end
+    if( !m_cancelled )
+        m_lib_timestamps.insert( m_pending_timestamps.begin(), m_pending_timestamps.end() );
 
-    for( auto& thr : threads )
-        thr.join();
+    m_pending_timestamps.clear();
 
     std::unique_ptr<FOOTPRINT_INFO> fpi;
 
@@ -339,76 +388,101 @@ FOOTPRINT_LIST_IMPL::~FOOTPRINT_LIST_IMPL()
 }
 
 
-void FOOTPRINT_LIST_IMPL::WriteCacheToFile( wxTextFile* aCacheFile )
+void FOOTPRINT_LIST_IMPL::WriteCacheToFile( const wxString& aFilePath )
 {
-    if( aCacheFile->Exists() )
-    {
-        if( !aCacheFile->Open() )
-            return;
+    std::map<wxString, std::vector<FOOTPRINT_INFO*>> libraries;
 
-        aCacheFile->Clear();
-    }
-    else
+    // Only the libraries which were read completely are saved
+    for( const std::pair<const wxString, long long>& lib : m_lib_timestamps )
+        libraries[ lib.first ];
+
+    for( std::unique_ptr<FOOTPRINT_INFO>& fpinfo : m_list )
     {
-        if( !aCacheFile->Create() )
-            return;
+        auto it = libraries.find( fpinfo->GetLibNickname() );
+
+        if( it != libraries.end() )
+            it->second.push_back( fpinfo.get() );
     }
 
-    aCacheFile->AddLine( wxString::Format( "%lld", m_list_timestamp ) );
+    BINARY_STREAM_WRITER out;
 
-    for( auto& fpinfo : m_list )
+    out.WriteHeader( FP_INFO_CACHE_MAGIC, FP_INFO_CACHE_VERSION );
+    out.Write<int64_t>( m_list_timestamp );
+    out.Write<uint32_t>( libraries.size() );
+
+    for( const std::pair<const wxString, std::vector<FOOTPRINT_INFO*>>& lib : libraries )
     {
-        aCacheFile->AddLine( fpinfo->GetLibNickname() );
-        aCacheFile->AddLine( fpinfo->GetName() );
-        aCacheFile->AddLine( EscapeString( fpinfo->GetDescription(), CTX_LINE ) );
-        aCacheFile->AddLine( EscapeString( fpinfo->GetKeywords(), CTX_LINE ) );
-        aCacheFile->AddLine( wxString::Format( "%d", fpinfo->GetOrderNum() ) );
-        aCacheFile->AddLine( wxString::Format( "%u", fpinfo->GetPadCount() ) );
-        aCacheFile->AddLine( wxString::Format( "%u", fpinfo->GetUniquePadCount() ) );
+        out.WriteString( TO_UTF8( lib.first ) );
+        out.Write<int64_t>( m_lib_timestamps[ lib.first ] );
+        out.Write<uint32_t>( lib.second.size() );
+
+        for( FOOTPRINT_INFO* fpinfo : lib.second )
+        {
+            out.WriteString( TO_UTF8( fpinfo->GetName() ) );
+            out.WriteString( TO_UTF8( fpinfo->GetDescription() ) );
+            out.WriteString( TO_UTF8( fpinfo->GetKeywords() ) );
+            out.Write<int32_t>( fpinfo->GetOrderNum() );
+            out.Write<uint32_t>( fpinfo->GetPadCount() );
+            out.Write<uint32_t>( fpinfo->GetUniquePadCount() );
+        }
     }
 
-    aCacheFile->Write();
-    aCacheFile->Close();
+    out.WriteFile( aFilePath );
 }
 
 
-void FOOTPRINT_LIST_IMPL::ReadCacheFromFile( wxTextFile* aCacheFile )
+void FOOTPRINT_LIST_IMPL::ReadCacheFromFile( const wxString& aFilePath )
 {
     m_list_timestamp = 0;
     m_list.clear();
+    m_lib_timestamps.clear();
 
-    try
+    BINARY_STREAM_READER in;
+
+    // Caches in an older format, including the text one, are simply ignored and rebuilt
+    if( !in.ReadFile( aFilePath ) || !in.ReadHeader( FP_INFO_CACHE_MAGIC, FP_INFO_CACHE_VERSION ) )
+        return;
+
+    long long listTimestamp = in.Read<int64_t>();
+    uint32_t  libCount = in.Read<uint32_t>();
+
+    for( uint32_t ii = 0; ii < libCount && in.Ok(); ++ii )
     {
-        if( aCacheFile->Exists() && aCacheFile->Open() )
-        {
-            aCacheFile->GetFirstLine().ToLongLong( &m_list_timestamp );
+        wxString nickname = FROM_UTF8( in.ReadString().c_str() );
+        long long timestamp = in.Read<int64_t>();
+        uint32_t  fpCount = in.Read<uint32_t>();
 
-            while( aCacheFile->GetCurrentLine() + 6 < aCacheFile->GetLineCount() )
-            {
-                wxString libNickname = aCacheFile->GetNextLine();
-                wxString name = aCacheFile->GetNextLine();
-                wxString description = UnescapeString( aCacheFile->GetNextLine() );
-                wxString keywords = UnescapeString( aCacheFile->GetNextLine() );
-                int orderNum = wxAtoi( aCacheFile->GetNextLine() );
-                unsigned int padCount = (unsigned) wxAtoi( aCacheFile->GetNextLine() );
-                unsigned int uniquePadCount = (unsigned) wxAtoi( aCacheFile->GetNextLine() );
-
-                auto* fpinfo = new FOOTPRINT_INFO_IMPL( libNickname, name, description, keywords,
-                                                        orderNum, padCount, uniquePadCount );
-                m_list.emplace_back( std::unique_ptr<FOOTPRINT_INFO>( fpinfo ) );
-            }
+        for( uint32_t jj = 0; jj < fpCount && in.Ok(); ++jj )
+        {
+            wxString     name = FROM_UTF8( in.ReadString().c_str() );
+            wxString     description = FROM_UTF8( in.ReadString().c_str() );
+            wxString     keywords = FROM_UTF8( in.ReadString().c_str() );
+            int          orderNum = in.Read<int32_t>();
+            unsigned int padCount = in.Read<uint32_t>();
+            unsigned int uniquePadCount = in.Read<uint32_t>();
+
+            auto* fpinfo = new FOOTPRINT_INFO_IMPL( nickname, name, description, keywords,
+                                                    orderNum, padCount, uniquePadCount );
+            m_list.emplace_back( std::unique_ptr<FOOTPRINT_INFO>( fpinfo ) );
         }
+
+        m_lib_timestamps[ nickname ] = timestamp;
     }
-    catch( ... )
+
+    // Whatever went wrong, invalidate the cache.  An empty list is very unlikely to be
+    // correct either.
+    if( !in.Ok() || m_list.size() == 0 )
     {
-        // whatever went wrong, invalidate the cache
-        m_list_timestamp = 0;
+        m_list.clear();
+        m_lib_timestamps.clear();
+        return;
     }
 
-    // Sanity check: an empty list is very unlikely to be correct.
-    if( m_list.size() == 0 )
-        m_list_timestamp = 0;
+    m_list_timestamp = listTimestamp;
 
-    if( aCacheFile->IsOpened() )
-        aCacheFile->Close();
+    std::sort( m_list.begin(), m_list.end(), []( std::unique_ptr<FOOTPRINT_INFO> const& lhs,
+                                                 std::unique_ptr<FOOTPRINT_INFO> const& rhs ) -> bool
+                                             {
+                                                 return *lhs < *rhs;
+                                             } );
 }
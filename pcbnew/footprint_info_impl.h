@@ -22,8 +22,9 @@
 
 #include <atomic>
 #include <functional>
+#include <future>
+#include <map>
 #include <memory>
-#include <thread>
 #include <vector>
 
 #include <footprint_info.h>
@@ -83,15 +84,19 @@ protected:
 
 class FOOTPRINT_LIST_IMPL : public FOOTPRINT_LIST
 {
-    FOOTPRINT_ASYNC_LOADER*  m_loader;
-    std::vector<std::thread> m_threads;
-    SYNC_QUEUE<wxString>     m_queue_in;
-    SYNC_QUEUE<wxString>     m_queue_out;
-    std::atomic_size_t       m_count_finished;
-    long long                m_list_timestamp;
-    PROGRESS_REPORTER*       m_progress_reporter;
-    std::atomic_bool         m_cancelled;
-    std::mutex               m_join;
+    friend class FOOTPRINT_INFO_IMPL;
+
+    FOOTPRINT_ASYNC_LOADER*        m_loader;
+    std::vector<std::future<void>> m_threads;       ///< loader jobs queued on the thread pool
+    SYNC_QUEUE<wxString>           m_queue_in;
+    SYNC_QUEUE<wxString>           m_queue_out;
+    std::atomic_size_t             m_count_finished;
+    long long                      m_list_timestamp;
+    std::map<wxString, long long>  m_lib_timestamps;    ///< of the libraries loaded in m_list
+    std::map<wxString, long long>  m_pending_timestamps; ///< of the libraries being loaded
+    PROGRESS_REPORTER*             m_progress_reporter;
+    std::atomic_bool               m_cancelled;
+    std::mutex                     m_join;
 
     /**
      * Call aFunc, pushing any IO_ERRORs and std::exceptions it throws onto m_errors.
@@ -117,8 +122,8 @@ public:
     FOOTPRINT_LIST_IMPL();
     virtual ~FOOTPRINT_LIST_IMPL();
 
-    void WriteCacheToFile( wxTextFile* aFile ) override;
-    void ReadCacheFromFile( wxTextFile* aFile ) override;
+    void WriteCacheToFile( const wxString& aFilePath ) override;
+    void ReadCacheFromFile( const wxString& aFilePath ) override;
 
     bool ReadFootprintFiles( FP_LIB_TABLE* aTable, const wxString* aNickname = nullptr,
                              PROGRESS_REPORTER* aProgressReporter = nullptr ) override;
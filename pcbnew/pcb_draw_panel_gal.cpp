@@ -41,12 +41,12 @@
 #include <pgm_base.h>
 #include <settings/settings_manager.h>
 #include <confirm.h>
+#include <thread_pool.h>
 
 #include <gal/graphics_abstraction_layer.h>
 
 #include <functional>
 #include <memory>
-#include <thread>
 using namespace std::placeholders;
 
 const LAYER_NUM GAL_LAYER_ORDER[] =
@@ -169,20 +169,17 @@ void PCB_DRAW_PANEL_GAL::DisplayBoard( BOARD* aBoard )
 
     auto zones = aBoard->Zones();
     std::atomic<size_t> next( 0 );
-    std::atomic<size_t> count_done( 0 );
-    size_t parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
+    THREAD_POOL& tp = GetKiCadThreadPool();
+    size_t parallelThreadCount = std::min<size_t>( tp.GetThreadCount(), zones.size() );
+    std::vector<std::future<void>> returns;
 
     for( size_t ii = 0; ii < parallelThreadCount; ++ii )
     {
-        std::thread t = std::thread( [ &count_done, &next, &zones ]( )
+        returns.push_back( tp.Submit( [ &next, &zones ]( )
         {
             for( size_t i = next.fetch_add( 1 ); i < zones.size(); i = next.fetch_add( 1 ) )
                 zones[i]->CacheTriangulation();
-
-            count_done++;
-        } );
-
-        t.detach();
+        } ) );
     }
 
     if( m_worksheet )
@@ -204,9 +201,8 @@ void PCB_DRAW_PANEL_GAL::DisplayBoard( BOARD* aBoard )
     for( auto marker : aBoard->Markers() )
         m_view->Add( marker );
 
-    // Finalize the triangulation threads
-    while( count_done < parallelThreadCount )
-        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    // Finalize the triangulation tasks
+    tp.WaitAll( returns );
 
     // Load zones
     for( auto zone : aBoard->Zones() )
@@ -488,6 +488,18 @@ void PCB_EXPR_BUILTIN_FUNCTIONS::RegisterAllFunctions()
 }
 
 
+TYPE_ID PCB_EXPR_CONTEXT::GetItemType( int index )
+{
+    if( !m_itemTypeKnown[index] )
+    {
+        m_itemTypes[index] = TYPE_HASH( *m_items[index] );
+        m_itemTypeKnown[index] = true;
+    }
+
+    return m_itemTypes[index];
+}
+
+
 BOARD_ITEM* PCB_EXPR_VAR_REF::GetObject( const LIBEVAL::CONTEXT* aCtx ) const
 {
     wxASSERT( dynamic_cast<const PCB_EXPR_CONTEXT*>( aCtx ) );
@@ -535,37 +547,50 @@ LIBEVAL::VALUE PCB_EXPR_VAR_REF::GetValue( LIBEVAL::CONTEXT* aCtx )
         return PCB_LAYER_VALUE( context->GetLayer() );
     }
 
-    BOARD_ITEM* item  = const_cast<BOARD_ITEM*>( GetObject( aCtx ) );
-    auto        it = m_matchingTypes.find( TYPE_HASH( *item ) );
+    LIBEVAL::VALUE value;
+    FetchValue( aCtx, &value );
+    return value;
+}
+
+
+void PCB_EXPR_VAR_REF::FetchValue( LIBEVAL::CONTEXT* aCtx, LIBEVAL::VALUE* aResult )
+{
+    static const wxString undefined( "UNDEFINED" );
+
+    PCB_EXPR_CONTEXT* context = static_cast<PCB_EXPR_CONTEXT*>( aCtx );
 
-    if( it == m_matchingTypes.end() )
+    if( m_itemIndex == 2 )
+    {
+        aResult->Set( (double) context->GetLayer() );
+        return;
+    }
+
+    BOARD_ITEM*    item = context->GetItem( m_itemIndex );
+    PROPERTY_BASE* prop = findProperty( context->GetItemType( m_itemIndex ) );
+
+    if( !prop )
     {
         // Don't force user to type "A.Type == 'via' && A.Via_Type == 'buried'" when the
         // simplier "A.Via_Type == 'buried'" is perfectly clear.  Instead, return an undefined
         // value when the property doesn't appear on a particular object.
 
-        return LIBEVAL::VALUE( "UNDEFINED" );
+        aResult->Set( undefined );
+    }
+    else if( m_type == LIBEVAL::VT_NUMERIC )
+    {
+        aResult->Set( (double) item->Get<int>( prop ) );
+    }
+    else if( !m_isEnum )
+    {
+        aResult->Set( item->Get<wxString>( prop ) );
     }
     else
     {
-        if( m_type == LIBEVAL::VT_NUMERIC )
-            return LIBEVAL::VALUE( (double) item->Get<int>( it->second ) );
-        else
-        {
-            wxString str;
+        wxString     str;
+        const wxAny& any = item->Get( prop );
 
-            if( !m_isEnum )
-            {
-                str = item->Get<wxString>( it->second );
-            }
-            else
-            {
-                const wxAny& any = item->Get( it->second );
-                any.GetAs<wxString>( &str );
-            }
-
-            return LIBEVAL::VALUE( str );
-        }
+        any.GetAs<wxString>( &str );
+        aResult->Set( str );
     }
 }
 
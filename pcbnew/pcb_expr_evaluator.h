@@ -54,14 +54,15 @@ public:
     PCB_EXPR_CONTEXT( PCB_LAYER_ID aLayer = UNDEFINED_LAYER ) :
             m_layer( aLayer )
     {
-        m_items[0] = nullptr;
-        m_items[1] = nullptr;
+        SetItems( nullptr, nullptr );
     }
 
     void SetItems( BOARD_ITEM* a, BOARD_ITEM* b = nullptr )
     {
         m_items[0] = a;
         m_items[1] = b;
+        m_itemTypeKnown[0] = false;
+        m_itemTypeKnown[1] = false;
     }
 
     BOARD_ITEM* GetItem( int index ) const
@@ -69,6 +70,17 @@ public:
         return m_items[index];
     }
 
+    /**
+     * @return the TYPE_HASH of item \a index.  This is computed once per SetItems() so that
+     *         several property references to the same item don't each pay for it.
+     */
+    TYPE_ID GetItemType( int index );
+
+    void SetLayer( PCB_LAYER_ID aLayer )
+    {
+        m_layer = aLayer;
+    }
+
     PCB_LAYER_ID GetLayer() const
     {
         return m_layer;
@@ -76,6 +88,8 @@ public:
 
 private:
     BOARD_ITEM*  m_items[2];
+    TYPE_ID      m_itemTypes[2];
+    bool         m_itemTypeKnown[2];
     PCB_LAYER_ID m_layer;
 };
 
@@ -101,18 +115,41 @@ public:
 
     void AddAllowedClass( TYPE_ID type_hash, PROPERTY_BASE* prop )
     {
-        m_matchingTypes[type_hash] = prop;
+        for( std::pair<TYPE_ID, PROPERTY_BASE*>& entry : m_matchingTypes )
+        {
+            if( entry.first == type_hash )
+            {
+                entry.second = prop;
+                return;
+            }
+        }
+
+        m_matchingTypes.emplace_back( type_hash, prop );
     }
 
     virtual LIBEVAL::VALUE GetValue( LIBEVAL::CONTEXT* aCtx ) override;
 
+    virtual void FetchValue( LIBEVAL::CONTEXT* aCtx, LIBEVAL::VALUE* aResult ) override;
+
     BOARD_ITEM* GetObject( const LIBEVAL::CONTEXT* aCtx ) const;
 
 private:
-    std::unordered_map<TYPE_ID, PROPERTY_BASE*> m_matchingTypes;
-    int                                         m_itemIndex;
-    LIBEVAL::VAR_TYPE_T                         m_type;
-    bool                                        m_isEnum;
+    PROPERTY_BASE* findProperty( TYPE_ID aType ) const
+    {
+        for( const std::pair<TYPE_ID, PROPERTY_BASE*>& entry : m_matchingTypes )
+        {
+            if( entry.first == aType )
+                return entry.second;
+        }
+
+        return nullptr;
+    }
+
+    // Only a handful of classes share any one property, so a flat list beats a hash map
+    std::vector<std::pair<TYPE_ID, PROPERTY_BASE*>> m_matchingTypes;
+    int                                             m_itemIndex;
+    LIBEVAL::VAR_TYPE_T                             m_type;
+    bool                                            m_isEnum;
 };
 
 
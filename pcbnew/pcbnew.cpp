@@ -337,7 +337,7 @@ bool IFACE::OnKifaceStart( PGM_BASE* aProgram, int aCtlBits )
     InitSettings( new PCBNEW_SETTINGS );
     aProgram->GetSettingsManager().RegisterSettings( KifaceSettings() );
 
-    start_common( aCtlBits );
+    start_common( aProgram, aCtlBits );
 
     wxFileName fn = FP_LIB_TABLE::GetGlobalTableFileName();
 
@@ -491,6 +491,43 @@ bool PLOT_CONTROLLER::PlotLayer()
 }
 
 
+bool PLOT_CONTROLLER::PlotLayers( const std::vector<PCB_LAYER_ID>& aLayers,
+                                  const wxString& aSheetDesc )
+{
+    ClosePlot();
+
+    wxString   outputDirName = GetPlotOptions().GetOutputDirectory();
+    wxFileName outputDir = wxFileName::DirName( outputDirName );
+    wxString   boardFilename = m_board->GetFileName();
+
+    if( !EnsureFileDirectoryExists( &outputDir, boardFilename ) )
+        return false;
+
+    std::vector<PLOT_JOB> jobs;
+
+    for( PCB_LAYER_ID layer : aLayers )
+    {
+        wxFileName fn( boardFilename );
+        wxString   fileExt = GetDefaultPlotExtension( GetPlotOptions().GetFormat() );
+
+        if( GetPlotOptions().GetFormat() == PLOT_FORMAT::GERBER
+                && GetPlotOptions().GetUseGerberProtelExtensions() )
+            fileExt = GetGerberProtelExtension( layer );
+
+        BuildPlotFileName( &fn, outputDir.GetPath(), m_board->GetLayerName( layer ), fileExt );
+
+        PLOT_JOB job;
+        job.m_layer = layer;
+        job.m_plotOpts = GetPlotOptions();
+        job.m_fullFileName = fn.GetFullPath();
+        job.m_sheetDesc = aSheetDesc;
+        jobs.push_back( job );
+    }
+
+    return PlotBoardLayers( m_board, jobs ) == (int) jobs.size();
+}
+
+
 void PLOT_CONTROLLER::SetColorMode( bool aColorMode )
 {
     if( !m_plotter )
@@ -29,6 +29,8 @@
 #ifndef PCBPLOT_H_
 #define PCBPLOT_H_
 
+#include <functional>
+#include <vector>
 #include <layers_id_colors_and_visibility.h>
 #include <math/util.h> // for KiROUND
 #include <pad_shapes.h>
@@ -155,6 +157,30 @@ PLOTTER* StartPlotBoard( BOARD* aBoard,
                          const wxString& aFullFileName,
                          const wxString& aSheetDesc );
 
+/**
+ * A plot job for PlotBoardLayers(): one layer plotted to one file.
+ */
+struct PLOT_JOB
+{
+    PCB_LAYER_ID    m_layer;
+    PCB_PLOT_PARAMS m_plotOpts;         ///< The plot options, including the format
+    wxString        m_fullFileName;
+    wxString        m_sheetDesc;
+    bool            m_success = false;  ///< Set by PlotBoardLayers()
+};
+
+/**
+ * Function PlotBoardLayers
+ * plots a list of jobs, each one with its own plotter, in parallel on the thread pool.
+ * Zones must be filled before, and the board must not be modified while plotting.
+ * @param aBoard = the board to plot
+ * @param aJobs = the jobs to run. m_success is set for each job
+ * @param aJobDone = if not null, called on the calling thread for each job once it is finished
+ * @return the number of files created
+ */
+int PlotBoardLayers( BOARD* aBoard, std::vector<PLOT_JOB>& aJobs,
+                     const std::function<void( const PLOT_JOB& )>& aJobDone = nullptr );
+
 /**
  * Function PlotOneBoardLayer
  * main function to plot one copper or technical layer.
@@ -48,6 +48,8 @@
 #include <pcbplot.h>
 #include <pcb_painter.h>
 #include <gbr_metadata.h>
+#include <locale_io.h>
+#include <thread_pool.h>
 
 /*
  * Plot a solder mask layer.  Solder mask layers have a minimum thickness value and cannot be
@@ -277,65 +279,78 @@ void PlotStandardLayer( BOARD *aBoard, PLOTTER* aPlotter, LSET aLayerMask,
             // Now offset the pad size by margin + width_adj
             wxSize padPlotsSize = pad->GetSize() + margin * 2 + wxSize( width_adj, width_adj );
 
-            // Store these parameters that can be modified to plot inflated/deflated pads shape
-            PAD_SHAPE_T padShape = pad->GetShape();
-            wxSize      padSize = pad->GetSize();
-            wxSize      padDelta = pad->GetDelta(); // has meaning only for trapezoidal pads
-            double      padCornerRadius = pad->GetRoundRectCornerRadius();
-
             // Don't draw a null size item :
             if( padPlotsSize.x <= 0 || padPlotsSize.y <= 0 )
                 continue;
 
+            // The board pads are never modified here, because several layers can be plotted
+            // at the same time (see PlotBoardLayers()). A pad to inflate or deflate is plotted
+            // from a copy.
+            if( margin.x == 0 && margin.y == 0 && width_adj == 0 )
+            {
+                if( aPlotOpt.GetSkipPlotNPTH_Pads() &&
+                    ( aPlotOpt.GetDrillMarksType() == PCB_PLOT_PARAMS::NO_DRILL_SHAPE ) &&
+                    ( pad->GetShape() == PAD_SHAPE_CIRCLE || pad->GetShape() == PAD_SHAPE_OVAL ) &&
+                    ( pad->GetSize() == pad->GetDrillSize() ) &&
+                    ( pad->GetAttribute() == PAD_ATTRIB_NPTH ) )
+                    continue;
+
+                itemplotter.PlotPad( pad, color, padPlotMode );
+                continue;
+            }
+
+            D_PAD  dummy( *pad );
+            wxSize padSize = pad->GetSize();
+            wxSize padDelta = pad->GetDelta(); // has meaning only for trapezoidal pads
+
             switch( pad->GetShape() )
             {
             case PAD_SHAPE_CIRCLE:
             case PAD_SHAPE_OVAL:
-                pad->SetSize( padPlotsSize );
+                dummy.SetSize( padPlotsSize );
 
                 if( aPlotOpt.GetSkipPlotNPTH_Pads() &&
                     ( aPlotOpt.GetDrillMarksType() == PCB_PLOT_PARAMS::NO_DRILL_SHAPE ) &&
-                    ( pad->GetSize() == pad->GetDrillSize() ) &&
-                    ( pad->GetAttribute() == PAD_ATTRIB_NPTH ) )
+                    ( dummy.GetSize() == dummy.GetDrillSize() ) &&
+                    ( dummy.GetAttribute() == PAD_ATTRIB_NPTH ) )
                     break;
 
-                itemplotter.PlotPad( pad, color, padPlotMode );
+                itemplotter.PlotPad( &dummy, color, padPlotMode );
                 break;
 
             case PAD_SHAPE_RECT:
-                pad->SetSize( padPlotsSize );
+                dummy.SetSize( padPlotsSize );
 
                 if( margin.x > 0 )
                 {
-                    pad->SetShape( PAD_SHAPE_ROUNDRECT );
-                    pad->SetRoundRectCornerRadius( margin.x );
+                    dummy.SetShape( PAD_SHAPE_ROUNDRECT );
+                    dummy.SetRoundRectCornerRadius( margin.x );
                 }
 
-                itemplotter.PlotPad( pad, color, padPlotMode );
+                itemplotter.PlotPad( &dummy, color, padPlotMode );
                 break;
 
             case PAD_SHAPE_TRAPEZOID:
             {
                 wxSize scale( padPlotsSize.x / padSize.x, padPlotsSize.y / padSize.y );
-                pad->SetDelta( wxSize( padDelta.x * scale.x, padDelta.y * scale.y ) );
-                pad->SetSize( padPlotsSize );
+                dummy.SetDelta( wxSize( padDelta.x * scale.x, padDelta.y * scale.y ) );
+                dummy.SetSize( padPlotsSize );
 
-                itemplotter.PlotPad( pad, color, padPlotMode );
+                itemplotter.PlotPad( &dummy, color, padPlotMode );
             }
                 break;
 
             case PAD_SHAPE_ROUNDRECT:
             case PAD_SHAPE_CHAMFERED_RECT:
                 // Chamfer and rounding are stored as a percent and so don't need scaling
-                pad->SetSize( padPlotsSize );
-                itemplotter.PlotPad( pad, color, padPlotMode );
+                dummy.SetSize( padPlotsSize );
+                itemplotter.PlotPad( &dummy, color, padPlotMode );
                 break;
 
             case PAD_SHAPE_CUSTOM:
             {
                 // inflate/deflate a custom shape is a bit complex.
                 // so build a similar pad shape, and inflate/deflate the polygonal shape
-                D_PAD dummy( *pad );
                 SHAPE_POLY_SET shape;
                 pad->MergePrimitivesAsPolygon( &shape, UNDEFINED_LAYER );
                 // Shape polygon can have holes so use InflateWithLinkedHoles(), not Inflate()
@@ -356,12 +371,6 @@ void PlotStandardLayer( BOARD *aBoard, PLOTTER* aPlotter, LSET aLayerMask,
             }
                 break;
             }
-
-            // Restore the pad parameters modified by the plot code
-            pad->SetSize( padSize );
-            pad->SetDelta( padDelta );
-            pad->SetShape( padShape );
-            pad->SetRoundRectCornerRadius( padCornerRadius );
         }
 
         aPlotter->EndBlock( NULL );
@@ -1129,3 +1138,97 @@ PLOTTER* StartPlotBoard( BOARD *aBoard, PCB_PLOT_PARAMS *aPlotOpts, int aLayer,
     delete plotter;
     return NULL;
 }
+
+
+int PlotBoardLayers( BOARD* aBoard, std::vector<PLOT_JOB>& aJobs,
+                     const std::function<void( const PLOT_JOB& )>& aJobDone )
+{
+    // The locale is global: it is set once here for all the plotting threads
+    LOCALE_IO toggle;
+
+    // The pad shapes are cached, and built on first use. Build them now, so that the plotting
+    // threads share them and never modify the board.
+    for( MODULE* module : aBoard->Modules() )
+    {
+        for( D_PAD* pad : module->Pads() )
+        {
+            if( pad->IsDirty() )
+                pad->BuildEffectiveShapes( UNDEFINED_LAYER );
+        }
+    }
+
+    THREAD_POOL& tp = GetKiCadThreadPool();
+    size_t parallelThreadCount = std::min<size_t>( tp.GetThreadCount(), aJobs.size() );
+
+    std::atomic<size_t> nextJob( 0 );
+    std::atomic<int> successCount( 0 );
+    std::vector<std::future<size_t>> returns;
+
+    // Finished jobs, waiting to be reported on the calling thread
+    std::mutex          doneMutex;
+    std::vector<size_t> doneJobs;
+
+    auto report_done = [&]()
+    {
+        std::vector<size_t> done;
+
+        {
+            std::lock_guard<std::mutex> lock( doneMutex );
+            done.swap( doneJobs );
+        }
+
+        for( size_t ii : done )
+            aJobDone( aJobs[ii] );
+    };
+
+    auto plot_lambda = [&]() -> size_t
+    {
+        for( size_t ii = nextJob++; ii < aJobs.size(); ii = nextJob++ )
+        {
+            PLOT_JOB& job = aJobs[ii];
+            PLOTTER*  plotter = StartPlotBoard( aBoard, &job.m_plotOpts, job.m_layer,
+                                                job.m_fullFileName, job.m_sheetDesc );
+
+            job.m_success = plotter != nullptr;
+
+            if( plotter )
+            {
+                PlotOneBoardLayer( aBoard, plotter, job.m_layer, job.m_plotOpts );
+                plotter->EndPlot();
+                delete plotter->RenderSettings();
+                delete plotter;
+
+                successCount++;
+            }
+
+            if( aJobDone )
+            {
+                std::lock_guard<std::mutex> lock( doneMutex );
+                doneJobs.push_back( ii );
+            }
+        }
+
+        return 1;
+    };
+
+    if( parallelThreadCount <= 1 )
+    {
+        plot_lambda();
+    }
+    else
+    {
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns.push_back( tp.Submit( plot_lambda ) );
+
+        // Finalize the threads, reporting the jobs as they finish
+        if( aJobDone )
+            tp.WaitAll( returns, report_done );
+        else
+            tp.WaitAll( returns );
+    }
+
+    if( aJobDone )
+        report_done();
+
+    return successCount;
+}
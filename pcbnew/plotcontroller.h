@@ -30,6 +30,7 @@
 #ifndef PLOTCONTROLLER_H_
 #define PLOTCONTROLLER_H_
 
+#include <vector>
 #include <pcb_plot_params.h>
 #include <layers_id_colors_and_visibility.h>
 
@@ -83,6 +84,16 @@ public:
      */
     bool PlotLayer();
 
+    /**
+     * Plot each layer of aLayers to its own file, in the format of the plot options.
+     * The layers are plotted in parallel, and the files are named from the board file
+     * name and the layer names, like the files of the plot dialog.
+     * The current plot, if any, is closed first.
+     * @return true if all the files were created
+     */
+    bool PlotLayers( const std::vector<PCB_LAYER_ID>& aLayers,
+                     const wxString& aSheetDesc = wxEmptyString );
+
     /**
      * @return the current plot full filename, set by OpenPlotfile
      */
@@ -39,6 +39,7 @@
 #include <confirm.h>
 #include <locale_io.h>
 #include <zones.h>
+#include <zone_fill_cache.h>
 #include <plugins/kicad/kicad_plugin.h>
 #include <plugins/kicad/pcb_parser.h>
 #include <pcbnew_settings.h>
@@ -46,6 +47,10 @@
 #include <convert_basic_shapes_to_polygon.h>    // for enum RECT_CHAMFER_POSITIONS definition
 #include <kiface_i.h>
 #include <wx_filename.h>
+#include <list>
+#include <map>
+#include <mutex>
+#include <thread>
 
 using namespace PCB_KEYS_T;
 
@@ -57,11 +62,19 @@ using namespace PCB_KEYS_T;
  * that contain a single module per file.  This class is a helper only for the
  * footprint portion of the PLUGIN API, and only for the #PCB_IO plugin.  It is
  * private to this implementation file so it is not placed into a header.
+ *
+ * The module is only parsed when it is first asked for, so an item can hold no module.
+ * It is shared with the callers of FP_CACHE::GetModule(), so that releasing it from the
+ * cache does not free it under a caller still using it.
  */
 class FP_CACHE_ITEM
 {
-    WX_FILENAME             m_filename;
-    std::unique_ptr<MODULE> m_module;
+    friend class FP_CACHE;
+
+    WX_FILENAME                           m_filename;
+    std::shared_ptr<MODULE>               m_module;
+    size_t                                m_size;     // Memory estimate of a parsed m_module
+    std::list<FP_CACHE_ITEM*>::iterator   m_lruPos;   // Position in FP_CACHE::m_lru if parsed
 
 public:
     FP_CACHE_ITEM( MODULE* aModule, const WX_FILENAME& aFileName );
@@ -73,7 +86,8 @@ public:
 
 FP_CACHE_ITEM::FP_CACHE_ITEM( MODULE* aModule, const WX_FILENAME& aFileName ) :
     m_filename( aFileName ),
-    m_module( aModule )
+    m_module( aModule ),
+    m_size( 0 )
 { }
 
 
@@ -82,6 +96,11 @@ typedef MODULE_MAP::iterator                        MODULE_ITER;
 typedef MODULE_MAP::const_iterator                  MODULE_CITER;
 
 
+/// Size of the footprint files whose modules are kept parsed in a FP_CACHE.  The parsed
+/// modules take several times the size of their files.
+static const size_t FP_CACHE_BUDGET = 16 * 1024 * 1024;
+
+
 class FP_CACHE
 {
     PCB_IO*         m_owner;            // Plugin object that owns the cache.
@@ -89,18 +108,38 @@ class FP_CACHE
     wxString        m_lib_raw_path;     // For quick comparisons.
     MODULE_MAP      m_modules;          // Map of footprint file name per MODULE*.
 
+    std::list<FP_CACHE_ITEM*> m_lru;    // Items holding a parsed module, most recently used
+                                        // first.
+    size_t          m_lru_size;         // Sum of the m_size of the items in m_lru.
+
+    std::mutex      m_mutex;            // Guards the parsing of modules and m_lru, as
+                                        // footprints can be loaded from several threads.
+    std::map<std::thread::id, std::shared_ptr<const MODULE>> m_held;
+                                        // Last module passed to Hold() by each thread.
+
     bool            m_cache_dirty;      // Stored separately because it's expensive to check
                                         // m_cache_timestamp against all the files.
     long long       m_cache_timestamp;  // A hash of the timestamps for all the footprint
                                         // files.
 
+    /**
+     * Move \a aItem to the front of the LRU list, adding it if it was not there, and release
+     * the least recently used modules until the cache fits in #FP_CACHE_BUDGET.
+     */
+    void touch( FP_CACHE_ITEM* aItem );
+
+    /**
+     * Read the size of the footprint file of \a aItem, the memory estimate of its module.
+     */
+    void updateSize( FP_CACHE_ITEM* aItem );
+
 public:
     FP_CACHE( PCB_IO* aOwner, const wxString& aLibraryPath );
 
     wxString    GetPath() const { return m_lib_raw_path; }
     bool        IsWritable() const { return m_lib_path.IsOk() && m_lib_path.IsDirWritable(); }
     bool        Exists() const { return m_lib_path.IsOk() && m_lib_path.DirExists(); }
-    MODULE_MAP& GetModules() { return m_modules; }
+    const MODULE_MAP& GetModules() const { return m_modules; }
 
     // Most all functions in this class throw IO_ERROR exceptions.  There are no
     // error codes nor user interface calls from here, nor in any PLUGIN.
@@ -109,12 +148,47 @@ public:
     /**
      * Save the footprint cache or a single module from it to disk
      *
+     * Footprints which were never parsed are not rewritten, their files are unchanged.
+     *
      * @param aModule if set, save only this module, otherwise, save the full library
      */
     void Save( MODULE* aModule = NULL );
 
+    /**
+     * Build the index of the library from the footprint file names.  No file is parsed.
+     */
     void Load();
 
+    /**
+     * Return the module of \a aFootprintName, parsing its file if it is not in memory.
+     *
+     * The module is shared: it stays valid as long as the caller holds it, even once the
+     * cache has released it.
+     *
+     * @return the module, or NULL if the library has no footprint \a aFootprintName.
+     * @throw IO_ERROR if the footprint file cannot be parsed.
+     */
+    std::shared_ptr<const MODULE> GetModule( const wxString& aFootprintName );
+
+    /**
+     * Keep \a aModule alive for the callers which only get a plain pointer to it.  The
+     * module is held for the calling thread until its next call to this function, or until
+     * the cache is deleted.
+     *
+     * @return the plain pointer to \a aModule.
+     */
+    const MODULE* Hold( const std::shared_ptr<const MODULE>& aModule );
+
+    /**
+     * Add \a aModule, owned by the cache from now on, to be saved in \a aFileName.
+     */
+    void Insert( const wxString& aFootprintName, MODULE* aModule, const WX_FILENAME& aFileName );
+
+    /**
+     * Drop \a aFootprintName from the cache without touching its file.
+     */
+    void Erase( const wxString& aFootprintName );
+
     void Remove( const wxString& aFootprintName );
 
     /**
@@ -149,13 +223,57 @@ FP_CACHE::FP_CACHE( PCB_IO* aOwner, const wxString& aLibraryPath )
     m_owner = aOwner;
     m_lib_raw_path = aLibraryPath;
     m_lib_path.SetPath( aLibraryPath );
+    m_lru_size = 0;
     m_cache_timestamp = 0;
     m_cache_dirty = true;
 }
 
 
+void FP_CACHE::touch( FP_CACHE_ITEM* aItem )
+{
+    if( aItem->m_lruPos != m_lru.end() )
+    {
+        m_lru.splice( m_lru.begin(), m_lru, aItem->m_lruPos );
+    }
+    else
+    {
+        m_lru.push_front( aItem );
+        aItem->m_lruPos = m_lru.begin();
+        m_lru_size += aItem->m_size;
+    }
+
+    // Never release aItem itself, its module is about to be used
+    while( m_lru_size > FP_CACHE_BUDGET && m_lru.size() > 1 )
+    {
+        FP_CACHE_ITEM* oldest = m_lru.back();
+
+        m_lru.pop_back();
+        m_lru_size -= oldest->m_size;
+
+        oldest->m_module.reset();
+        oldest->m_lruPos = m_lru.end();
+    }
+}
+
+
+void FP_CACHE::updateSize( FP_CACHE_ITEM* aItem )
+{
+    wxULongLong size = wxFileName::GetSize( aItem->m_filename.GetFullPath() );
+
+    if( aItem->m_lruPos != m_lru.end() )
+        m_lru_size -= aItem->m_size;
+
+    aItem->m_size = size == wxInvalidSize ? 0 : (size_t) size.GetValue();
+
+    if( aItem->m_lruPos != m_lru.end() )
+        m_lru_size += aItem->m_size;
+}
+
+
 void FP_CACHE::Save( MODULE* aModule )
 {
+    std::lock_guard<std::mutex> lock( m_mutex );
+
     m_cache_timestamp = 0;
 
     if( !m_lib_path.DirExists() && !m_lib_path.Mkdir() )
@@ -177,6 +295,12 @@ void FP_CACHE::Save( MODULE* aModule )
 
         WX_FILENAME fn = it->second->GetFileName();
 
+        if( !it->second->GetModule() )
+        {
+            m_cache_timestamp += fn.GetTimestamp();
+            continue;
+        }
+
         wxString tempFileName =
 #ifdef USE_TMP_FILE
         wxFileName::CreateTempFileName( fn.GetPath() );
@@ -210,6 +334,7 @@ void FP_CACHE::Save( MODULE* aModule )
             THROW_IO_ERROR( msg );
         }
 #endif
+        updateSize( it->second );
         m_cache_timestamp += fn.GetTimestamp();
     }
 
@@ -224,7 +349,6 @@ void FP_CACHE::Save( MODULE* aModule )
 void FP_CACHE::Load()
 {
     m_cache_dirty = false;
-    m_cache_timestamp = 0;
 
     wxDir dir( m_lib_raw_path );
 
@@ -236,6 +360,10 @@ void FP_CACHE::Load()
         THROW_IO_ERROR( msg );
     }
 
+    // Use the same hash as IsModified(), and take it before listing the files so that a file
+    // added in between makes the cache look modified rather than going unnoticed.
+    m_cache_timestamp = GetTimestamp( m_lib_path.GetFullPath() );
+
     wxString fullName;
     wxString fileSpec = wxT( "*." ) + KiCadFootprintFileExtension;
 
@@ -245,39 +373,88 @@ void FP_CACHE::Load()
 
     if( dir.GetFirst( &fullName, fileSpec ) )
     {
-        wxString cacheError;
-
         do
         {
             fn.SetFullName( fullName );
 
-            // Queue I/O errors so only files that fail to parse don't get loaded.
-            try
-            {
-                FILE_LINE_READER    reader( fn.GetFullPath() );
+            FP_CACHE_ITEM* item = new FP_CACHE_ITEM( nullptr, fn );
 
-                m_owner->m_parser->SetLineReader( &reader );
+            item->m_lruPos = m_lru.end();
+            m_modules.insert( fn.GetName(), item );
+        } while( dir.GetNext( &fullName ) );
+    }
+}
 
-                MODULE*     footprint = (MODULE*) m_owner->m_parser->Parse();
-                wxString    fpName = fn.GetName();
 
-                footprint->SetFPID( LIB_ID( wxEmptyString, fpName ) );
-                m_modules.insert( fpName, new FP_CACHE_ITEM( footprint, fn ) );
+std::shared_ptr<const MODULE> FP_CACHE::GetModule( const wxString& aFootprintName )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
 
-                m_cache_timestamp += fn.GetTimestamp();
-            }
-            catch( const IO_ERROR& ioe )
-            {
-                if( !cacheError.IsEmpty() )
-                    cacheError += "\n\n";
+    MODULE_ITER it = m_modules.find( aFootprintName );
 
-                cacheError += ioe.What();
-            }
-        } while( dir.GetNext( &fullName ) );
+    if( it == m_modules.end() )
+        return nullptr;
+
+    FP_CACHE_ITEM* item = it->second;
+
+    if( !item->m_module )
+    {
+        FILE_LINE_READER reader( item->m_filename.GetFullPath() );
+
+        m_owner->m_parser->SetLineReader( &reader );
+
+        MODULE* footprint = (MODULE*) m_owner->m_parser->Parse();
+
+        footprint->SetFPID( LIB_ID( wxEmptyString, aFootprintName ) );
+        item->m_module.reset( footprint );
+        updateSize( item );
+    }
+
+    touch( item );
+
+    return item->m_module;
+}
+
+
+const MODULE* FP_CACHE::Hold( const std::shared_ptr<const MODULE>& aModule )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    m_held[ std::this_thread::get_id() ] = aModule;
+    return aModule.get();
+}
+
+
+void FP_CACHE::Insert( const wxString& aFootprintName, MODULE* aModule,
+                       const WX_FILENAME& aFileName )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    FP_CACHE_ITEM* item = new FP_CACHE_ITEM( aModule, aFileName );
 
-        if( !cacheError.IsEmpty() )
-            THROW_IO_ERROR( cacheError );
+    // The size is only known once the module is saved
+    item->m_lruPos = m_lru.end();
+    m_modules.insert( aFootprintName, item );
+    touch( item );
+}
+
+
+void FP_CACHE::Erase( const wxString& aFootprintName )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    MODULE_ITER it = m_modules.find( aFootprintName );
+
+    if( it == m_modules.end() )
+        return;
+
+    if( it->second->m_lruPos != m_lru.end() )
+    {
+        m_lru_size -= it->second->m_size;
+        m_lru.erase( it->second->m_lruPos );
     }
+
+    m_modules.erase( it );
 }
 
 
@@ -295,7 +472,7 @@ void FP_CACHE::Remove( const wxString& aFootprintName )
 
     // Remove the module from the cache and delete the module file from the library.
     wxString fullPath = it->second->GetFileName().GetFullPath();
-    m_modules.erase( aFootprintName );
+    Erase( aFootprintName );
     wxRemoveFile( fullPath );
 }
 
@@ -2054,14 +2231,21 @@ PCB_IO::~PCB_IO()
 
 BOARD* PCB_IO::Load( const wxString& aFileName, BOARD* aAppendToMe, const PROPERTIES* aProperties )
 {
-    FILE_LINE_READER reader( aFileName );
+    BUFFERED_FILE_LINE_READER reader( aFileName );
 
     BOARD* board = DoLoad( reader, aAppendToMe, aProperties );
 
     // Give the filename to the board if it's new
     if( !aAppendToMe )
+    {
         board->SetFileName( aFileName );
 
+        // Restore the zone fill data which the board file doesn't hold.  Done here so that
+        // every way of loading a board (editor, scripting, plotting, DRC) gets it.
+        if( ADVANCED_CFG::GetCfg().m_ZoneFillCache )
+            ZONE_FILL_CACHE::Load( board, aFileName );
+    }
+
     return board;
 }
 
@@ -2072,6 +2256,7 @@ BOARD* PCB_IO::DoLoad( LINE_READER& aReader, BOARD* aAppendToMe, const PROPERTIE
 
     m_parser->SetLineReader( &aReader );
     m_parser->SetBoard( aAppendToMe );
+    m_parser->SetParallelLoad( ADVANCED_CFG::GetCfg().m_ParallelBoardLoad );
 
     BOARD* board;
 
@@ -2154,10 +2339,10 @@ void PCB_IO::FootprintEnumerate( wxArrayString& aFootprintNames, const wxString&
 }
 
 
-const MODULE* PCB_IO::getFootprint( const wxString& aLibraryPath,
-                                    const wxString& aFootprintName,
-                                    const PROPERTIES* aProperties,
-                                    bool checkModified )
+std::shared_ptr<const MODULE> PCB_IO::getFootprint( const wxString& aLibraryPath,
+                                                    const wxString& aFootprintName,
+                                                    const PROPERTIES* aProperties,
+                                                    bool checkModified )
 {
     LOCALE_IO   toggle;     // toggles on, then off, the C locale.
 
@@ -2172,14 +2357,7 @@ const MODULE* PCB_IO::getFootprint( const wxString& aLibraryPath,
         // do nothing with the error
     }
 
-    const MODULE_MAP& mods = m_cache->GetModules();
-
-    MODULE_CITER it = mods.find( aFootprintName );
-
-    if( it == mods.end() )
-        return nullptr;
-
-    return it->second->GetModule();
+    return m_cache->GetModule( aFootprintName );
 }
 
 
@@ -2187,7 +2365,11 @@ const MODULE* PCB_IO::GetEnumeratedFootprint( const wxString& aLibraryPath,
                                               const wxString& aFootprintName,
                                               const PROPERTIES* aProperties )
 {
-    return getFootprint( aLibraryPath, aFootprintName, aProperties, false );
+    std::shared_ptr<const MODULE> footprint = getFootprint( aLibraryPath, aFootprintName,
+                                                            aProperties, false );
+
+    // The cache may release the module at any time, so it holds it for the caller
+    return m_cache->Hold( footprint );
 }
 
 
@@ -2210,7 +2392,8 @@ bool PCB_IO::FootprintExists( const wxString& aLibraryPath, const wxString& aFoo
 MODULE* PCB_IO::FootprintLoad( const wxString& aLibraryPath, const wxString& aFootprintName,
                                const PROPERTIES* aProperties )
 {
-    const MODULE* footprint = getFootprint( aLibraryPath, aFootprintName, aProperties, true );
+    std::shared_ptr<const MODULE> footprint = getFootprint( aLibraryPath, aFootprintName,
+                                                            aProperties, true );
     return footprint ? (MODULE*) footprint->Duplicate() : nullptr;
 }
 
@@ -2251,8 +2434,6 @@ void PCB_IO::FootprintSave( const wxString& aLibraryPath, const MODULE* aFootpri
 
     wxString footprintName = aFootprint->GetFPID().GetLibItemName();
 
-    MODULE_MAP& mods = m_cache->GetModules();
-
     // Quietly overwrite module and delete module file from path for any by same name.
     wxFileName fn( aLibraryPath, aFootprint->GetFPID().GetLibItemName(),
                    KiCadFootprintFileExtension );
@@ -2287,12 +2468,12 @@ void PCB_IO::FootprintSave( const wxString& aLibraryPath, const MODULE* aFootpri
 
     wxString fullPath = fn.GetFullPath();
     wxString fullName = fn.GetFullName();
-    MODULE_CITER it = mods.find( footprintName );
+    MODULE_CITER it = m_cache->GetModules().find( footprintName );
 
-    if( it != mods.end() )
+    if( it != m_cache->GetModules().end() )
     {
         wxLogTrace( traceKicadPcbPlugin, wxT( "Removing footprint file '%s'." ), fullPath );
-        mods.erase( footprintName );
+        m_cache->Erase( footprintName );
         wxRemoveFile( fullPath );
     }
 
@@ -2314,7 +2495,7 @@ void PCB_IO::FootprintSave( const wxString& aLibraryPath, const MODULE* aFootpri
     }
 
     wxLogTrace( traceKicadPcbPlugin, wxT( "Creating s-expr footprint file '%s'." ), fullPath );
-    mods.insert( footprintName, new FP_CACHE_ITEM( module, WX_FILENAME( fn.GetPath(), fullName ) ) );
+    m_cache->Insert( footprintName, module, WX_FILENAME( fn.GetPath(), fullName ) );
     m_cache->Save( module );
 }
 
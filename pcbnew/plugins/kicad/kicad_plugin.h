@@ -26,6 +26,7 @@
 #define KICAD_PLUGIN_H_
 
 #include <io_mgr.h>
+#include <memory>
 #include <string>
 #include <layers_id_colors_and_visibility.h>
 
@@ -232,8 +233,10 @@ protected:
 
     void validateCache( const wxString& aLibraryPath, bool checkModified = true );
 
-    const MODULE* getFootprint( const wxString& aLibraryPath, const wxString& aFootprintName,
-                  const PROPERTIES* aProperties, bool checkModified );
+    std::shared_ptr<const MODULE> getFootprint( const wxString& aLibraryPath,
+                                                const wxString& aFootprintName,
+                                                const PROPERTIES* aProperties,
+                                                bool checkModified );
 
     void init( const PROPERTIES* aProperties );
 
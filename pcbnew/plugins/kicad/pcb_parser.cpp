@@ -28,6 +28,7 @@
  */
 
 #include <cerrno>
+#include <cstdint>
 #include <common.h>
 #include <confirm.h>
 #include <macros.h>
@@ -54,10 +55,35 @@
 #include <plugins/kicad/pcb_parser.h>
 #include <convert_basic_shapes_to_polygon.h>    // for RECT_CHAMFER_POSITIONS definition
 #include <template_fieldnames.h>
+#include <thread_pool.h>
 
 using namespace PCB_KEYS_T;
 
 
+/**
+ * Thrown by a section parser on a worker thread when a section needs to modify the board,
+ * so that its batch is parsed again on the loading thread.
+ */
+struct NEEDS_SERIAL_PARSE
+{
+};
+
+
+/**
+ * Reads the text of a SECTION_BATCH, numbering its lines from the line the batch started on
+ * in the board file.
+ */
+class SECTION_LINE_READER : public STRING_LINE_READER
+{
+public:
+    SECTION_LINE_READER( const std::string& aText, const wxString& aSource, int aFirstLine ) :
+            STRING_LINE_READER( aText, aSource )
+    {
+        m_lineNum = aFirstLine - 1;
+    }
+};
+
+
 void PCB_PARSER::init()
 {
     m_showLegacyZoneWarning = true;
@@ -136,13 +162,68 @@ void PCB_PARSER::pushValueIntoMap( int aIndex, int aValue )
 }
 
 
+bool ParseDecimal( const char* aText, double* aResult )
+{
+    static const double powersOfTen[] =
+    {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char* cp = aText;
+    bool        negative = false;
+    bool        sawPoint = false;
+    uint64_t    mantissa = 0;
+    int         digits = 0;
+    int         fractionDigits = 0;
+
+    if( *cp == '-' || *cp == '+' )
+        negative = *cp++ == '-';
+
+    for( ; ; ++cp )
+    {
+        if( *cp >= '0' && *cp <= '9' )
+        {
+            if( ++digits > 19 )     // would overflow the mantissa
+                return false;
+
+            mantissa = mantissa * 10 + ( *cp - '0' );
+
+            if( sawPoint )
+                fractionDigits++;
+        }
+        else if( *cp == '.' && !sawPoint )
+        {
+            sawPoint = true;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if( *cp != '\0' || digits == 0 || fractionDigits > 22 || mantissa > ( 1ULL << 53 ) )
+        return false;
+
+    double value = (double) mantissa / powersOfTen[fractionDigits];
+
+    *aResult = negative ? -value : value;
+    return true;
+}
+
+
 double PCB_PARSER::parseDouble()
 {
+    double fval;
+
+    if( ParseDecimal( CurText(), &fval ) )
+        return fval;
+
     char* tmp;
 
     errno = 0;
 
-    double fval = strtod( CurText(), &tmp );
+    fval = strtod( CurText(), &tmp );
 
     if( errno )
     {
@@ -545,6 +626,7 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
 {
     T token;
     std::map<wxString, wxString> properties;
+    SECTION_BATCHES batches;
 
     parseHeader();
 
@@ -558,6 +640,36 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
         if( token == T_page && m_requiredVersion <= 20200119 )
             token = T_paper;
 
+        switch( token )
+        {
+        case T_gr_arc:
+        case T_gr_circle:
+        case T_gr_curve:
+        case T_gr_rect:
+        case T_gr_line:
+        case T_gr_poly:
+        case T_gr_text:
+        case T_dimension:
+        case T_module:
+        case T_segment:
+        case T_arc:
+        case T_via:
+        case T_zone:
+        case T_target:
+            if( m_parallelLoad )
+            {
+                captureBoardItem( batches );
+                continue;
+            }
+
+            break;
+
+        default:
+            // Everything else reads or modifies the board (or m_groupInfos), so the items
+            // before it must be in place first.
+            flushSectionBatches( batches );
+        }
+
         switch( token )
         {
         case T_general:
@@ -593,58 +705,17 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
             m_board->m_LegacyNetclassesLoaded = true;
             break;
 
-        case T_gr_arc:
-        case T_gr_circle:
-        case T_gr_curve:
-        case T_gr_rect:
-        case T_gr_line:
-        case T_gr_poly:
-            m_board->Add( parsePCB_SHAPE(), ADD_MODE::APPEND );
-            break;
-
-        case T_gr_text:
-            m_board->Add( parsePCB_TEXT(), ADD_MODE::APPEND );
-            break;
-
-        case T_dimension:
-            m_board->Add( parseDIMENSION(), ADD_MODE::APPEND );
-            break;
-
-        case T_module:
-            m_board->Add( parseMODULE(), ADD_MODE::APPEND );
-            break;
-
-        case T_segment:
-            m_board->Add( parseTRACK(), ADD_MODE::APPEND );
-            break;
-
-        case T_arc:
-            m_board->Add( parseARC(), ADD_MODE::APPEND );
-            break;
-
         case T_group:
             parseGROUP( m_board );
             break;
 
-        case T_via:
-            m_board->Add( parseVIA(), ADD_MODE::APPEND );
-            break;
-
-        case T_zone:
-            m_board->Add( parseZONE_CONTAINER( m_board ), ADD_MODE::APPEND );
-            break;
-
-        case T_target:
-            m_board->Add( parsePCB_TARGET(), ADD_MODE::APPEND );
-            break;
-
         default:
-            wxString err;
-            err.Printf( _( "Unknown token \"%s\"" ), FromUTF8() );
-            THROW_PARSE_ERROR( err, CurSource(), CurLine(), CurLineNumber(), CurOffset() );
+            m_board->Add( parseBoardItem( token ), ADD_MODE::APPEND );
         }
     }
 
+    flushSectionBatches( batches );
+
     m_board->SetProperties( properties );
 
     if( m_undefinedLayers.size() > 0 )
@@ -730,6 +801,232 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
 }
 
 
+BOARD_ITEM* PCB_PARSER::parseBoardItem( T aToken )
+{
+    switch( aToken )
+    {
+    case T_gr_arc:
+    case T_gr_circle:
+    case T_gr_curve:
+    case T_gr_rect:
+    case T_gr_line:
+    case T_gr_poly:
+        return parsePCB_SHAPE();
+
+    case T_gr_text:
+        return parsePCB_TEXT();
+
+    case T_dimension:
+        return parseDIMENSION();
+
+    case T_module:
+        return parseMODULE();
+
+    case T_segment:
+        return parseTRACK();
+
+    case T_arc:
+        return parseARC();
+
+    case T_via:
+        return parseVIA();
+
+    case T_zone:
+        return parseZONE_CONTAINER( m_board );
+
+    case T_target:
+        return parsePCB_TARGET();
+
+    default:
+        wxString err;
+        err.Printf( _( "Unknown token \"%s\"" ), FromUTF8() );
+        THROW_PARSE_ERROR( err, CurSource(), CurLine(), CurLineNumber(), CurOffset() );
+    }
+}
+
+
+PCB_PARSER::SECTION_BATCH::~SECTION_BATCH()
+{
+    for( BOARD_ITEM* item : m_items )
+        delete item;
+}
+
+
+PCB_PARSER::SECTION_BATCHES::~SECTION_BATCHES()
+{
+    // Only non-empty if the load is being abandoned because of an exception.  Batches still
+    // queued are claimed so their tasks do nothing; those being parsed must be finished with
+    // the parser before it goes away.
+    for( std::shared_ptr<SECTION_BATCH>& batch : *this )
+    {
+        if( !batch->Claim() )
+            batch->m_done.wait();
+    }
+}
+
+
+void PCB_PARSER::captureBoardItem( SECTION_BATCHES& aBatches )
+{
+    // Large enough to amortize the setup of a parser per batch, small enough that typical
+    // boards still make plenty of batches to share out
+    const size_t batchSize = 256 * 1024;
+
+    if( aBatches.empty() || aBatches.back()->m_submitted )
+    {
+        aBatches.push_back( std::make_shared<SECTION_BATCH>() );
+        aBatches.back()->m_source = CurSource();
+    }
+
+    std::shared_ptr<SECTION_BATCH>& batch = aBatches.back();
+    int                             line = CurLineNumber();
+
+    if( batch->m_text.empty() )
+        batch->m_firstLine = line;
+    else if( line > batch->m_lastLine )
+        batch->m_text.append( line - batch->m_lastLine, '\n' );
+    else
+        batch->m_text += ' ';
+
+    CaptureCurrentList( batch->m_text );
+    batch->m_lastLine = CurLineNumber();
+
+    if( batch->m_text.size() >= batchSize )
+        submitSectionBatch( batch );
+}
+
+
+void PCB_PARSER::submitSectionBatch( const std::shared_ptr<SECTION_BATCH>& aBatch )
+{
+    aBatch->m_submitted = true;
+
+    // The task's own future isn't needed: the batch reports through m_parsed
+    GetKiCadThreadPool().Submit( [this, aBatch]()
+                                 {
+                                     if( aBatch->Claim() )
+                                         runSectionBatch( aBatch.get() );
+                                 } );
+}
+
+
+void PCB_PARSER::runSectionBatch( SECTION_BATCH* aBatch )
+{
+    try
+    {
+        parseSectionBatch( aBatch, true );
+        aBatch->m_parsed.set_value();
+    }
+    catch( ... )
+    {
+        aBatch->m_parsed.set_exception( std::current_exception() );
+    }
+}
+
+
+void PCB_PARSER::parseSectionBatch( SECTION_BATCH* aBatch, bool aOnWorker )
+{
+    SECTION_LINE_READER reader( aBatch->m_text, aBatch->m_source, aBatch->m_firstLine );
+    PCB_PARSER          parser( &reader );
+
+    // Nothing below is modified by the loading thread while batches are being parsed
+    parser.m_board = m_board;
+    parser.m_layerIndices = m_layerIndices;
+    parser.m_layerMasks = m_layerMasks;
+    parser.m_netCodes = m_netCodes;
+    parser.m_tooRecent = m_tooRecent;
+    parser.m_requiredVersion = m_requiredVersion;
+    parser.m_resetKIIDs = m_resetKIIDs;
+    parser.m_showLegacyZoneWarning = m_showLegacyZoneWarning;
+    parser.m_sectionParser = aOnWorker;
+
+    for( T token = parser.NextTok();  token != T_EOF;  token = parser.NextTok() )
+    {
+        if( token != T_LEFT )
+            parser.Expecting( T_LEFT );
+
+        aBatch->m_items.push_back( parser.parseBoardItem( parser.NextTok() ) );
+    }
+
+    aBatch->m_undefinedLayers = std::move( parser.m_undefinedLayers );
+    aBatch->m_resetKIIDMap = std::move( parser.m_resetKIIDMap );
+    aBatch->m_groupInfos = std::move( parser.m_groupInfos );
+
+    if( !aOnWorker )
+    {
+        // Zones may have added nets
+        m_netCodes = std::move( parser.m_netCodes );
+        m_showLegacyZoneWarning = parser.m_showLegacyZoneWarning;
+    }
+}
+
+
+void PCB_PARSER::flushSectionBatches( SECTION_BATCHES& aBatches )
+{
+    if( aBatches.empty() )
+        return;
+
+    // Parse the batches no worker has got round to here, in the same way a worker would,
+    // rather than waiting for the pool to start them.
+    for( std::shared_ptr<SECTION_BATCH>& batch : aBatches )
+    {
+        if( batch->Claim() )
+            runSectionBatch( batch.get() );
+    }
+
+    // Nothing may modify the board while a worker could still be reading it.  Any batch not
+    // yet finished is being parsed by a worker right now.
+    for( std::shared_ptr<SECTION_BATCH>& batch : aBatches )
+        batch->m_done.wait();
+
+    bool netsChanged = false;
+
+    for( std::shared_ptr<SECTION_BATCH>& batch : aBatches )
+    {
+        bool parsed = true;
+
+        try
+        {
+            batch->m_done.get();
+        }
+        catch( ... )
+        {
+            parsed = false;
+        }
+
+        // Batches parsed on a worker after a previous batch added nets may have resolved
+        // net codes differently, so they are parsed again too.
+        if( !parsed || netsChanged )
+        {
+            for( BOARD_ITEM* item : batch->m_items )
+                delete item;
+
+            batch->m_items.clear();
+            batch->m_undefinedLayers.clear();
+            batch->m_resetKIIDMap.clear();
+            batch->m_groupInfos.clear();
+
+            unsigned netCount = m_board->GetNetCount();
+
+            parseSectionBatch( batch.get(), false );
+
+            netsChanged |= m_board->GetNetCount() != netCount;
+        }
+
+        for( BOARD_ITEM* item : batch->m_items )
+            m_board->Add( item, ADD_MODE::APPEND );
+
+        batch->m_items.clear();
+
+        m_undefinedLayers.insert( batch->m_undefinedLayers.begin(),
+                                  batch->m_undefinedLayers.end() );
+        m_resetKIIDMap.insert( batch->m_resetKIIDMap.begin(), batch->m_resetKIIDMap.end() );
+        m_groupInfos.insert( m_groupInfos.end(), batch->m_groupInfos.begin(),
+                             batch->m_groupInfos.end() );
+    }
+
+    aBatches.clear();
+}
+
+
 void PCB_PARSER::resolveGroups( BOARD_ITEM* aParent )
 {
     auto getItem = [&]( const KIID& aId )
@@ -4419,6 +4716,9 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER( BOARD_ITEM_CONTAINER* aParent )
 
                     if( token == T_segment )    // deprecated
                     {
+                        if( m_sectionParser )
+                            throw NEEDS_SERIAL_PARSE();
+
                         // SEGMENT fill mode no longer supported.  Make sure user is OK with converting them.
                         if( m_showLegacyZoneWarning )
                         {
@@ -4794,6 +5094,9 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER( BOARD_ITEM_CONTAINER* aParent )
             zone->SetNetCode( net->GetNet() );
         else    // Not existing net: add a new net to keep trace of the zone netname
         {
+            if( m_sectionParser )
+                throw NEEDS_SERIAL_PARSE();
+
             int newnetcode = m_board->GetNetCount();
             net = new NETINFO_ITEM( m_board, netnameFromfile, newnetcode );
             m_board->Add( net );
@@ -36,6 +36,9 @@
 #include <math/util.h>                           // KiROUND, Clamp
 #include <pcb_lexer.h>
 
+#include <atomic>
+#include <future>
+#include <memory>
 #include <unordered_map>
 
 
@@ -85,6 +88,10 @@ class PCB_PARSER : public PCB_LEXER
 
     bool                m_showLegacyZoneWarning;
 
+    bool                m_parallelLoad;     ///< parse board items on the thread pool
+    bool                m_sectionParser;    ///< parsing a batch of sections on a worker thread;
+                                            ///< must not modify m_board
+
     // Group membership info refers to other Uuids in the file.
     // We don't want to rely on group declarations being last in the file, so
     // we store info about the group declarations here during parsing and then resolve
@@ -99,6 +106,53 @@ class PCB_PARSER : public PCB_LEXER
 
     std::vector<GROUP_INFO> m_groupInfos;
 
+    /**
+     * A run of consecutive top-level board item sections, captured as raw text while
+     * loading in parallel, and the results of parsing it.  The text is padded with newlines
+     * so that line numbers match the file's.
+     *
+     * A batch is parsed by whichever claims it first: a pool worker, or the loading thread
+     * when it needs the items.  So the loading thread only ever waits for batches a worker
+     * is already parsing, and never runs other tasks while it waits.
+     */
+    struct SECTION_BATCH
+    {
+        SECTION_BATCH() :
+                m_done( m_parsed.get_future() )
+        {}
+
+        ~SECTION_BATCH();
+
+        /// @return true if the caller is now the one to parse the batch
+        bool Claim()
+        {
+            return !m_claimed.exchange( true );
+        }
+
+        std::string              m_text;
+        wxString                 m_source;
+        int                      m_firstLine = 0;
+        int                      m_lastLine = 0;
+        bool                     m_submitted = false;
+        std::atomic<bool>        m_claimed{ false };
+        std::promise<void>       m_parsed;      ///< set by whoever claimed the batch
+        std::future<void>        m_done;
+
+        std::vector<BOARD_ITEM*> m_items;
+        std::set<wxString>       m_undefinedLayers;
+        KIID_MAP                 m_resetKIIDMap;
+        std::vector<GROUP_INFO>  m_groupInfos;
+    };
+
+    /**
+     * The batches of a load.  Queued tasks keep their batch alive, but not the parser, so if
+     * the load is abandoned this waits for any batch a worker is in the middle of parsing.
+     */
+    struct SECTION_BATCHES : public std::vector<std::shared_ptr<SECTION_BATCH>>
+    {
+        ~SECTION_BATCHES();
+    };
+
     ///> Converts net code using the mapping table if available,
     ///> otherwise returns unchanged net code if < 0 or if is is out of range
     inline int getNetCode( int aNetCode )
@@ -184,6 +238,44 @@ class PCB_PARSER : public PCB_LEXER
     BOARD*          parseBOARD();
     void            parseGROUP( BOARD_ITEM* aParent );
 
+    /**
+     * Parse one of the top-level board sections which hold a single board item (tracks,
+     * footprints, zones, graphics...).
+     *
+     * @return the new item, not yet added to m_board.
+     */
+    BOARD_ITEM*     parseBoardItem( PCB_KEYS_T::T aToken );
+
+    /**
+     * Append the current board item section to the last of \a aBatches (starting a new
+     * batch if needed), and queue the batch on the thread pool once it is large enough.
+     */
+    void            captureBoardItem( SECTION_BATCHES& aBatches );
+
+    void            submitSectionBatch( const std::shared_ptr<SECTION_BATCH>& aBatch );
+
+    /**
+     * Parse \a aBatch, which the caller has claimed, reporting the outcome through its
+     * m_parsed promise.
+     */
+    void            runSectionBatch( SECTION_BATCH* aBatch );
+
+    /**
+     * Parse the sections of \a aBatch with a new parser sharing this parser's layer and net
+     * maps.
+     *
+     * @param aOnWorker is true when called on a pool thread, in which case sections needing
+     *                  to modify the board throw rather than being parsed.
+     */
+    void            parseSectionBatch( SECTION_BATCH* aBatch, bool aOnWorker );
+
+    /**
+     * Parse or wait for all of \a aBatches and add their items to the board in file order.
+     * Batches which failed on a worker are parsed again on this thread, so errors and board
+     * changes are exactly those of a serial load.
+     */
+    void            flushSectionBatches( SECTION_BATCHES& aBatches );
+
     /**
      * Function parseBOARD_unchecked
      * Parse a module, but do not replace PARSE_ERROR with FUTURE_FORMAT_ERROR automatically.
@@ -351,7 +443,9 @@ public:
     PCB_PARSER( LINE_READER* aReader = NULL ) :
         PCB_LEXER( aReader ),
         m_board( 0 ),
-        m_resetKIIDs( false )
+        m_resetKIIDs( false ),
+        m_parallelLoad( false ),
+        m_sectionParser( false )
     {
         init();
     }
@@ -380,6 +474,15 @@ public:
             m_resetKIIDs = true;
     }
 
+    /**
+     * Enable parsing the items of boards on the thread pool.  The board is identical to the
+     * one built by a serial load.
+     */
+    void SetParallelLoad( bool aEnable )
+    {
+        m_parallelLoad = aEnable;
+    }
+
     BOARD_ITEM* Parse();
     /**
      * Function parseMODULE
@@ -406,4 +509,17 @@ public:
 };
 
 
+/**
+ * Parse a plain decimal number such as "-12.3456" (no exponent) without going through strtod().
+ *
+ * This is Clinger's fast path: while the digits fit in 53 bits and there are at most 22 of
+ * them after the point, both the digits and the power of ten are exact doubles, so a single
+ * correctly rounded division gives exactly what strtod() would in the "C" locale.  Coordinates
+ * in board files are always in this form.
+ *
+ * @return false if \a aText is in some other form, in which case strtod() must be used.
+ */
+bool ParseDecimal( const char* aText, double* aResult );
+
+
 #endif    // _PCBNEW_PARSER_H_
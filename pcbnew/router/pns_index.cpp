@@ -19,6 +19,8 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+
 #include "pns_index.h"
 #include "pns_router.h"
 
@@ -34,11 +36,14 @@ void INDEX::Add( ITEM* aItem )
 
     for( int i = range.Start(); i <= range.End(); ++i )
     {
+        if( !m_subIndices[i] )
+            m_subIndices[i] = std::make_unique<ITEM_SHAPE_INDEX>();
+
         if( !ROUTER::GetInstance()->GetInterface()->IsOnLayer( aItem, i ) )
         {
             if( aItem->AlternateShape() )
             {
-                m_subIndices[i].Add( aItem, aItem->AlternateShape()->BBox() );
+                m_subIndices[i]->Add( aItem, aItem->AlternateShape()->BBox() );
             }
             else
             {
@@ -46,13 +51,13 @@ void INDEX::Add( ITEM* aItem )
                             aItem->Parent()->GetClass(),
                             aItem->Anchor( 0 ).x,
                             aItem->Anchor( 0 ).y );
-                m_subIndices[i].Add( aItem );
+                m_subIndices[i]->Add( aItem );
             }
 
         }
         else
         {
-            m_subIndices[i].Add( aItem );
+            m_subIndices[i]->Add( aItem );
         }
     }
 
@@ -72,13 +77,21 @@ void INDEX::Remove( ITEM* aItem )
         return;
 
     for( int i = range.Start(); i <= range.End(); ++i )
-        m_subIndices[i].Remove( aItem );
+    {
+        if( m_subIndices[i] )
+            m_subIndices[i]->Remove( aItem );
+    }
 
     m_allItems.erase( aItem );
     int net = aItem->Net();
 
-    if( net >= 0 && m_netMap.find( net ) != m_netMap.end() )
-        m_netMap[net].remove( aItem );
+    auto netItems = m_netMap.find( net );
+
+    if( net >= 0 && netItems != m_netMap.end() )
+    {
+        NET_ITEMS_LIST& items = netItems->second;
+        items.erase( std::remove( items.begin(), items.end(), aItem ), items.end() );
+    }
 }
 
 
@@ -91,10 +104,12 @@ void INDEX::Replace( ITEM* aOldItem, ITEM* aNewItem )
 
 INDEX::NET_ITEMS_LIST* INDEX::GetItemsForNet( int aNet )
 {
-    if( m_netMap.find( aNet ) == m_netMap.end() )
+    auto netItems = m_netMap.find( aNet );
+
+    if( netItems == m_netMap.end() )
         return NULL;
 
-    return &m_netMap[aNet];
+    return &netItems->second;
 }
 
 };
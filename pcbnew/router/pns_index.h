@@ -22,15 +22,16 @@
 #ifndef __PNS_INDEX_H
 #define __PNS_INDEX_H
 
-#include <deque>
-#include <list>
-#include <map>
+#include <memory>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include <layers_id_colors_and_visibility.h>
 #include <geometry/shape_index.h>
 
 #include "pns_item.h"
+#include "pns_stats.h"
 
 namespace PNS {
 
@@ -40,12 +41,13 @@ namespace PNS {
  *
  * Custom spatial index, holding our board items and allowing for very fast searches. Items
  * are assigned to separate R-Tree subindices depending on their type and spanned layers, reducing
- * overlap and improving search time.
+ * overlap and improving search time. The subindices are only allocated for the layers holding
+ * items, as a branch usually holds a few items on one or two layers.
  **/
 class INDEX
 {
 public:
-    typedef std::list<ITEM*>            NET_ITEMS_LIST;
+    typedef std::vector<ITEM*>          NET_ITEMS_LIST;
     typedef SHAPE_INDEX<ITEM*>          ITEM_SHAPE_INDEX;
     typedef std::unordered_set<ITEM*>   ITEM_SET;
 
@@ -122,8 +124,8 @@ private:
     template <class Visitor>
     int querySingle( std::size_t aIndex, const SHAPE* aShape, int aMinDistance, Visitor& aVisitor ) const;
 
-    std::deque<ITEM_SHAPE_INDEX> m_subIndices;
-    std::map<int, NET_ITEMS_LIST> m_netMap;
+    std::vector<std::unique_ptr<ITEM_SHAPE_INDEX>> m_subIndices;
+    std::unordered_map<int, NET_ITEMS_LIST> m_netMap;
     ITEM_SET m_allItems;
 };
 
@@ -131,16 +133,17 @@ private:
 template<class Visitor>
 int INDEX::querySingle( std::size_t aIndex, const SHAPE* aShape, int aMinDistance, Visitor& aVisitor ) const
 {
-    if( aIndex >= m_subIndices.size() )
+    if( aIndex >= m_subIndices.size() || !m_subIndices[aIndex] )
         return 0;
 
-    return m_subIndices[aIndex].Query( aShape, aMinDistance, aVisitor);
+    return m_subIndices[aIndex]->Query( aShape, aMinDistance, aVisitor);
 }
 
 template<class Visitor>
 int INDEX::Query( const ITEM* aItem, int aMinDistance, Visitor& aVisitor ) const
 {
-    int total = 0;
+    STATS::TIMER timer( STATS::INDEX_QUERY );
+    int          total = 0;
 
     const LAYER_RANGE& layers = aItem->Layers();
 
@@ -153,7 +156,8 @@ int INDEX::Query( const ITEM* aItem, int aMinDistance, Visitor& aVisitor ) const
 template<class Visitor>
 int INDEX::Query( const SHAPE* aShape, int aMinDistance, Visitor& aVisitor ) const
 {
-    int total = 0;
+    STATS::TIMER timer( STATS::INDEX_QUERY );
+    int          total = 0;
 
     for( std::size_t i = 0; i < m_subIndices.size(); ++i )
         total += querySingle( i, aShape, aMinDistance, aVisitor );
@@ -0,0 +1,263 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <new>
+
+#include "pns_joint_map.h"
+
+namespace PNS {
+
+// Joints allocated at once when a map grows one joint at a time
+static const size_t JOINT_BLOCK_SIZE = 256;
+
+// Smallest table allocated
+static const size_t MIN_SLOT_COUNT = 16;
+
+char JOINT_MAP::s_tombstone;
+
+
+JOINT_MAP::JOINT_MAP() :
+    m_mask( 0 ),
+    m_count( 0 ),
+    m_tombstones( 0 ),
+    m_lastBlockSize( 0 ),
+    m_lastBlockUsed( 0 )
+{
+}
+
+
+JOINT_MAP::JOINT_MAP( const JOINT_MAP& aOther ) :
+    JOINT_MAP()
+{
+    copyFrom( aOther );
+}
+
+
+JOINT_MAP::~JOINT_MAP()
+{
+    clear();
+}
+
+
+JOINT_MAP& JOINT_MAP::operator=( const JOINT_MAP& aOther )
+{
+    if( this != &aOther )
+    {
+        clear();
+        copyFrom( aOther );
+    }
+
+    return *this;
+}
+
+
+void JOINT_MAP::copyFrom( const JOINT_MAP& aOther )
+{
+    if( aOther.m_count == 0 )
+        return;
+
+    // All the copies go to a single block, sized to fit
+    m_blocks.emplace_back( new STORAGE[aOther.m_count] );
+    m_lastBlockSize = aOther.m_count;
+    m_lastBlockUsed = 0;
+
+    rehash( aOther.m_count );
+
+    aOther.ForEach( [&]( const JOINT& aJoint )
+                    {
+                        Insert( aJoint );
+                    } );
+}
+
+
+size_t JOINT_MAP::hash( const JOINT::HASH_TAG& aTag )
+{
+    // JOINT_TAG_HASH leaves the low bits of nearby positions correlated, which makes long probe
+    // sequences with a power-of-two table. Mix the bits of the whole tag instead.
+    uint64_t h = (uint64_t) (uint32_t) aTag.pos.x;
+
+    h = h * 0x9E3779B97F4A7C15ULL + (uint32_t) aTag.pos.y;
+    h = h * 0x9E3779B97F4A7C15ULL + (uint32_t) aTag.net;
+    h ^= h >> 29;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 32;
+
+    return (size_t) h;
+}
+
+
+void* JOINT_MAP::allocate()
+{
+    if( !m_freeList.empty() )
+    {
+        void* storage = m_freeList.back();
+        m_freeList.pop_back();
+        return storage;
+    }
+
+    if( m_blocks.empty() || m_lastBlockUsed == m_lastBlockSize )
+    {
+        m_blocks.emplace_back( new STORAGE[JOINT_BLOCK_SIZE] );
+        m_lastBlockSize = JOINT_BLOCK_SIZE;
+        m_lastBlockUsed = 0;
+    }
+
+    return &m_blocks.back()[m_lastBlockUsed++];
+}
+
+
+void JOINT_MAP::rehash( size_t aCount )
+{
+    size_t slotCount = MIN_SLOT_COUNT;
+
+    // Keep the load factor under 1/2
+    while( slotCount < 2 * aCount )
+        slotCount *= 2;
+
+    std::vector<JOINT*> slots( slotCount, nullptr );
+
+    m_mask = slotCount - 1;
+
+    for( JOINT* joint : m_slots )
+    {
+        if( !joint || joint == tombstone() )
+            continue;
+
+        size_t i = slotIndex( joint->Tag() );
+
+        while( slots[i] )
+            i = ( i + 1 ) & m_mask;
+
+        slots[i] = joint;
+    }
+
+    m_slots.swap( slots );
+    m_tombstones = 0;
+}
+
+
+JOINT* JOINT_MAP::Insert( const JOINT& aJoint )
+{
+    // Rehash before the table gets 3/4 full, counting the tombstones, which slow down the
+    // lookups just like the joints do
+    if( 4 * ( m_count + m_tombstones + 1 ) > 3 * m_slots.size() )
+        rehash( m_count + 1 );
+
+    JOINT* joint = new( allocate() ) JOINT( aJoint );
+    size_t i = slotIndex( joint->Tag() );
+
+    while( m_slots[i] && m_slots[i] != tombstone() )
+        i = ( i + 1 ) & m_mask;
+
+    if( m_slots[i] == tombstone() )
+        m_tombstones--;
+
+    m_slots[i] = joint;
+    m_count++;
+
+    return joint;
+}
+
+
+void JOINT_MAP::Erase( JOINT* aJoint )
+{
+    if( m_slots.empty() )
+        return;
+
+    for( size_t i = slotIndex( aJoint->Tag() ); m_slots[i]; i = ( i + 1 ) & m_mask )
+    {
+        if( m_slots[i] != aJoint )
+            continue;
+
+        // A free slot can only be reused if it doesn't break the probe sequence of another joint
+        if( !m_slots[( i + 1 ) & m_mask] )
+        {
+            m_slots[i] = nullptr;
+        }
+        else
+        {
+            m_slots[i] = tombstone();
+            m_tombstones++;
+        }
+
+        aJoint->~JOINT();
+        m_freeList.push_back( aJoint );
+        m_count--;
+        return;
+    }
+
+    assert( false );
+}
+
+
+JOINT* JOINT_MAP::FindOverlapping( const JOINT::HASH_TAG& aTag, const LAYER_RANGE& aLayers ) const
+{
+    if( m_slots.empty() )
+        return nullptr;
+
+    for( size_t i = slotIndex( aTag ); m_slots[i]; i = ( i + 1 ) & m_mask )
+    {
+        JOINT* joint = m_slots[i];
+
+        if( joint != tombstone() && joint->Tag() == aTag && joint->Layers().Overlaps( aLayers ) )
+            return joint;
+    }
+
+    return nullptr;
+}
+
+
+bool JOINT_MAP::Contains( const JOINT::HASH_TAG& aTag ) const
+{
+    if( m_slots.empty() )
+        return false;
+
+    for( size_t i = slotIndex( aTag ); m_slots[i]; i = ( i + 1 ) & m_mask )
+    {
+        if( m_slots[i] != tombstone() && m_slots[i]->Tag() == aTag )
+            return true;
+    }
+
+    return false;
+}
+
+
+void JOINT_MAP::clear()
+{
+    for( JOINT* joint : m_slots )
+    {
+        if( joint && joint != tombstone() )
+            joint->~JOINT();
+    }
+
+    m_slots.clear();
+    m_blocks.clear();
+    m_freeList.clear();
+
+    m_mask = 0;
+    m_count = 0;
+    m_tombstones = 0;
+    m_lastBlockSize = 0;
+    m_lastBlockUsed = 0;
+}
+
+}
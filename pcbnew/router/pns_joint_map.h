@@ -0,0 +1,140 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_JOINT_MAP_H
+#define __PNS_JOINT_MAP_H
+
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "pns_joint.h"
+
+namespace PNS {
+
+/**
+ * JOINT_MAP
+ *
+ * Hash table of the joints of a NODE. Several joints may share a tag (position and net), as
+ * long as their layers do not overlap.
+ *
+ * The table is a flat array of pointers with open addressing and linear probing, and the
+ * joints themselves are stored in blocks of memory owned by the map. Branching a node copies
+ * its joints into a single block, and killing it frees the blocks in bulk, instead of
+ * allocating and freeing every joint separately. Pointers to joints stay valid until the
+ * joints are erased.
+ **/
+class JOINT_MAP
+{
+public:
+    JOINT_MAP();
+    JOINT_MAP( const JOINT_MAP& aOther );
+    ~JOINT_MAP();
+
+    JOINT_MAP& operator=( const JOINT_MAP& aOther );
+
+    ///> Stores a copy of aJoint and returns it.
+    JOINT* Insert( const JOINT& aJoint );
+
+    ///> Removes a joint stored in this map.
+    void Erase( JOINT* aJoint );
+
+    ///> Returns a joint with the given tag overlapping aLayers, or nullptr if there is none.
+    JOINT* FindOverlapping( const JOINT::HASH_TAG& aTag, const LAYER_RANGE& aLayers ) const;
+
+    ///> Returns true if the map holds any joint with the given tag.
+    bool Contains( const JOINT::HASH_TAG& aTag ) const;
+
+    ///> Calls aFunc on each joint with the given tag.
+    template <class FUNC>
+    void ForEachWithTag( const JOINT::HASH_TAG& aTag, FUNC aFunc ) const
+    {
+        if( m_slots.empty() )
+            return;
+
+        for( size_t i = slotIndex( aTag ); m_slots[i]; i = ( i + 1 ) & m_mask )
+        {
+            if( m_slots[i] != tombstone() && m_slots[i]->Tag() == aTag )
+                aFunc( *m_slots[i] );
+        }
+    }
+
+    ///> Calls aFunc on each joint of the map, in no particular order.
+    template <class FUNC>
+    void ForEach( FUNC aFunc ) const
+    {
+        for( JOINT* joint : m_slots )
+        {
+            if( joint && joint != tombstone() )
+                aFunc( *joint );
+        }
+    }
+
+    size_t size() const
+    {
+        return m_count;
+    }
+
+    bool empty() const
+    {
+        return m_count == 0;
+    }
+
+    void clear();
+
+private:
+    typedef std::aligned_storage<sizeof( JOINT ), alignof( JOINT )>::type STORAGE;
+
+    ///> Marks the slots of erased joints, so that probe sequences continue past them.
+    static JOINT* tombstone()
+    {
+        return reinterpret_cast<JOINT*>( &s_tombstone );
+    }
+
+    static size_t hash( const JOINT::HASH_TAG& aTag );
+
+    size_t slotIndex( const JOINT::HASH_TAG& aTag ) const
+    {
+        return hash( aTag ) & m_mask;
+    }
+
+    ///> Returns storage for a new joint, reusing the storage of erased joints first.
+    void* allocate();
+
+    ///> Resizes the table to hold at least aCount joints, dropping the tombstones.
+    void rehash( size_t aCount );
+
+    void copyFrom( const JOINT_MAP& aOther );
+
+    static char                             s_tombstone;
+
+    std::vector<JOINT*>                     m_slots;
+    size_t                                  m_mask;
+    size_t                                  m_count;
+    size_t                                  m_tombstones;
+
+    std::vector<std::unique_ptr<STORAGE[]>> m_blocks;
+    size_t                                  m_lastBlockSize;
+    size_t                                  m_lastBlockUsed;
+    std::vector<void*>                      m_freeList;
+};
+
+}
+
+#endif    // __PNS_JOINT_MAP_H
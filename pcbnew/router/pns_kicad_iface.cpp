@@ -226,10 +226,11 @@ bool PNS_PCBNEW_RULE_RESOLVER::QueryConstraint( PNS::CONSTRAINT_TYPE aType,
             return false; // should not happen
     }
 
-    // A track being routed may not have a BOARD_ITEM associated yet.
-    static TRACK dummyTrack( m_board );
-    static ARC   dummyArc( m_board );
-    static VIA   dummyVia( m_board );
+    // A track being routed may not have a BOARD_ITEM associated yet.  The walkaround queries
+    // the rules from several threads, so each one has its own stand-ins.
+    static thread_local TRACK dummyTrack( m_board );
+    static thread_local ARC   dummyArc( m_board );
+    static thread_local VIA   dummyVia( m_board );
 
     const BOARD_ITEM* parentA = aItemA ? aItemA->Parent() : nullptr;
     const BOARD_ITEM* parentB = aItemB ? aItemB->Parent() : nullptr;
@@ -56,14 +56,17 @@ void LOGGER::Save( const std::string& aFilename )
 
     wxLogTrace( "PNS", "Saving to '%s' [%p]", aFilename.c_str(), f );
 
-    for( const auto evt : m_events )
+    if( !f )
+        return;
+
+    for( const EVENT_ENTRY& evt : m_events )
     {
-        uint64_t id = 0;
-        if( evt.item && evt.item->Parent() )
-        {
-            const char* idString = evt.item->Parent()->m_Uuid.AsString().c_str();
-            fprintf( f, "event %d %d %d %s\n", evt.type, evt.p.x, evt.p.y, idString );
-        }
+        wxString id = "null";
+
+        if( evt.uuid != niluuid )
+            id = evt.uuid.AsString();
+
+        fprintf( f, "event %d %d %d %s\n", evt.type, evt.p.x, evt.p.y, (const char*) id.c_str() );
     }
 
     fclose( f );
@@ -72,11 +75,9 @@ void LOGGER::Save( const std::string& aFilename )
 
 void LOGGER::Log( LOGGER::EVENT_TYPE evt, VECTOR2I pos, const ITEM* item )
 {
-    LOGGER::EVENT_ENTRY ent;
-
-    ent.type = evt;
-    ent.p = pos;
-    ent.item = item;
+    // Don't default-construct the UUID, which would generate a random one for each event
+    LOGGER::EVENT_ENTRY ent = { pos, evt, item && item->Parent() ? item->Parent()->m_Uuid
+                                                                 : niluuid };
 
     m_events.push_back( ent );
 
@@ -27,6 +27,7 @@
 #include <string>
 #include <sstream>
 
+#include <kiid.h>
 #include <math/vector2d.h>
 
 class SHAPE_LINE_CHAIN;
@@ -48,15 +49,21 @@ public:
         EVT_ABORT
     };
 
+    ///> The item of an event is recorded by the UUID of its parent board item, which outlives
+    ///> the router item (niluuid if the event has no item).
     struct EVENT_ENTRY {
         VECTOR2I p;
         EVENT_TYPE type;
-        const ITEM* item;
+        KIID uuid;
     };
 
     LOGGER();
     ~LOGGER();
 
+    /**
+     * Writes the events to aFilename, one per line, as "event <type> <x> <y> <uuid>", with
+     * "null" for events without an item.
+     */
     void Save( const std::string& aFilename );
     void Clear();
     void Log( EVENT_TYPE evt, VECTOR2I pos, const ITEM* item = nullptr );
@@ -19,6 +19,7 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <vector>
 #include <cassert>
 #include <utility>
@@ -109,7 +110,7 @@ NODE* NODE::Branch()
 
     wxLogTrace( "PNS", "NODE::branch %p (parent %p)", child, this );
 
-    m_children.insert( child );
+    m_children.push_back( child );
 
     child->m_depth = m_depth + 1;
     child->m_parent = this;
@@ -121,8 +122,6 @@ NODE* NODE::Branch()
     // joints, overridden item maps and pointers to stored items.
     if( !isRoot() )
     {
-        JOINT_MAP::iterator j;
-
         for( ITEM* item : *m_index )
             child->m_index->Add( item );
 
@@ -142,7 +141,9 @@ void NODE::unlinkParent()
     if( isRoot() )
         return;
 
-    m_parent->m_children.erase( this );
+    std::vector<NODE*>& siblings = m_parent->m_children;
+
+    siblings.erase( std::remove( siblings.begin(), siblings.end(), this ), siblings.end() );
 }
 
 
@@ -716,27 +717,9 @@ void NODE::rebuildJoint( JOINT* aJoint, ITEM* aItem )
     tag.net = net;
     tag.pos = aJoint->Pos();
 
-    bool split;
-    do
-    {
-        split = false;
-        auto range = m_joints.equal_range( tag );
-
-        if( range.first == m_joints.end() )
-            break;
-
-        // find and remove all joints containing the via to be removed
-
-        for( auto f = range.first; f != range.second; ++f )
-        {
-            if( aItem->LayersOverlap( &f->second ) )
-            {
-                m_joints.erase( f );
-                split = true;
-                break;
-            }
-        }
-    } while( split );
+    // find and remove all joints containing the via to be removed
+    while( JOINT* f = m_joints.FindOverlapping( tag, aItem->Layers() ) )
+        m_joints.Erase( f );
 
     // and re-link them, using the former via's link list
     for(ITEM* link : links)
@@ -1035,26 +1018,12 @@ JOINT* NODE::FindJoint( const VECTOR2I& aPos, int aLayer, int aNet )
     tag.net = aNet;
     tag.pos = aPos;
 
-    JOINT_MAP::iterator f = m_joints.find( tag ), end = m_joints.end();
+    const JOINT_MAP* joints = &m_joints;
 
-    if( f == end && !isRoot() )
-    {
-        end = m_root->m_joints.end();
-        f = m_root->m_joints.find( tag );    // m_root->FindJoint(aPos, aLayer, aNet);
-    }
-
-    if( f == end )
-        return NULL;
-
-    while( f != end )
-    {
-        if( f->second.Layers().Overlaps( aLayer ) )
-            return &f->second;
+    if( !isRoot() && !m_joints.Contains( tag ) )
+        joints = &m_root->m_joints;
 
-        ++f;
-    }
-
-    return NULL;
+    return joints->FindOverlapping( tag, LAYER_RANGE( aLayer ) );
 }
 
 
@@ -1072,47 +1041,26 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
     tag.pos = aPos;
     tag.net = aNet;
 
-    // try to find the joint in this node.
-    JOINT_MAP::iterator f = m_joints.find( tag );
-
-    std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range;
-
-    // not found and we are not root? find in the root and copy results here.
-    if( f == m_joints.end() && !isRoot() )
+    // not found in this node and we are not root? find in the root and copy results here.
+    if( !isRoot() && !m_joints.Contains( tag ) )
     {
-        range = m_root->m_joints.equal_range( tag );
-
-        for( f = range.first; f != range.second; ++f )
-            m_joints.insert( *f );
+        m_root->m_joints.ForEachWithTag( tag,
+                                         [&]( const JOINT& aJoint )
+                                         {
+                                             m_joints.Insert( aJoint );
+                                         } );
     }
 
     // now insert and combine overlapping joints
     JOINT jt( aPos, aLayers, aNet );
 
-    bool merged;
-
-    do
+    while( JOINT* f = m_joints.FindOverlapping( tag, aLayers ) )
     {
-        merged  = false;
-        range   = m_joints.equal_range( tag );
-
-        if( range.first == m_joints.end() )
-            break;
-
-        for( f = range.first; f != range.second; ++f )
-        {
-            if( aLayers.Overlaps( f->second.Layers() ) )
-            {
-                jt.Merge( f->second );
-                m_joints.erase( f );
-                merged = true;
-                break;
-            }
-        }
+        jt.Merge( *f );
+        m_joints.Erase( f );
     }
-    while( merged );
 
-    return m_joints.insert( TagJointPair( tag, jt ) )->second;
+    return *m_joints.Insert( jt );
 }
 
 
@@ -1244,7 +1192,7 @@ void NODE::GetUpdatedItems( ITEM_VECTOR& aRemoved, ITEM_VECTOR& aAdded )
 void NODE::releaseChildren()
 {
     // copy the kids as the NODE destructor erases the item from the parent node.
-    std::set<NODE*> kids = m_children;
+    std::vector<NODE*> kids = m_children;
 
     for( NODE* node : kids )
     {
@@ -1415,29 +1363,27 @@ int NODE::QueryJoints( const BOX2I& aBox,
 
     aJoints.clear();
 
-    for( auto j = m_joints.begin(); j != m_joints.end(); ++j )
-    {
-        if ( aBox.Contains(j->second.Pos()) && j->second.LinkCount ( aKindMask ) )
-        {
-            aJoints.push_back( &j->second );
-            n++;
-
-        }
-    }
+    m_joints.ForEach( [&]( JOINT& aJoint )
+                      {
+                          if( aBox.Contains( aJoint.Pos() ) && aJoint.LinkCount( aKindMask ) )
+                          {
+                              aJoints.push_back( &aJoint );
+                              n++;
+                          }
+                      } );
 
     if ( isRoot() )
         return n;
 
-    for( auto j = m_root->m_joints.begin(); j != m_root->m_joints.end(); ++j )
-    {
-        if( ! Overrides( &j->second) )
-        {   if ( aBox.Contains(j->second.Pos()) && j->second.LinkCount ( aKindMask ) )
-            {
-                aJoints.push_back( &j->second );
-                n++;
-            }
-        }
-    }
+    m_root->m_joints.ForEach( [&]( JOINT& aJoint )
+                              {
+                                  if( !Overrides( &aJoint ) && aBox.Contains( aJoint.Pos() )
+                                          && aJoint.LinkCount( aKindMask ) )
+                                  {
+                                      aJoints.push_back( &aJoint );
+                                      n++;
+                                  }
+                              } );
 
     return n;
 
@@ -36,6 +36,7 @@
 
 #include "pns_item.h"
 #include "pns_joint.h"
+#include "pns_joint_map.h"
 #include "pns_itemset.h"
 
 namespace PNS {
@@ -462,8 +463,6 @@ public:
 
 private:
     struct DEFAULT_OBSTACLE_VISITOR;
-    typedef std::unordered_multimap<JOINT::HASH_TAG, JOINT, JOINT::JOINT_TAG_HASH> JOINT_MAP;
-    typedef JOINT_MAP::value_type TagJointPair;
 
     /// nodes are not copyable
     NODE( const NODE& aB );
@@ -526,7 +525,7 @@ private:
     NODE* m_root;
 
     ///> list of nodes branched from this one
-    std::set<NODE*> m_children;
+    std::vector<NODE*> m_children;
 
     ///> hash of root's items that have been changed in this node
     std::unordered_set<ITEM*> m_override;
@@ -36,6 +36,7 @@
 #include "pns_utils.h"
 #include "pns_router.h"
 #include "pns_debug_decorator.h"
+#include "pns_stats.h"
 
 
 namespace PNS {
@@ -598,6 +599,8 @@ bool OPTIMIZER::mergeFull( LINE* aLine )
 
 bool OPTIMIZER::Optimize( LINE* aLine, LINE* aResult )
 {
+    STATS::TIMER timer( STATS::OPTIMIZER );
+
     if( !aResult )
         aResult = aLine;
     else
@@ -154,6 +154,9 @@ bool ROUTER::StartDragging( const VECTOR2I& aP, ITEM_SET aStartItems, int aDragM
     m_dragger->SetMode( aDragMode );
     m_dragger->SetWorld( m_world.get() );
     m_dragger->SetLogger( m_logger );
+
+    if( m_logger )
+        m_logger->Log( LOGGER::EVT_START_DRAG, aP, aStartItems.Size() ? aStartItems[0] : nullptr );
     m_dragger->SetDebugDecorator ( m_iface->GetDebugDecorator () );
 
     if( m_dragger->Start ( aP, aStartItems ) )
@@ -34,6 +34,7 @@
 #include "pns_via.h"
 #include "pns_utils.h"
 #include "pns_router.h"
+#include "pns_stats.h"
 #include "pns_topology.h"
 
 #include "time_limit.h"
@@ -1209,6 +1210,7 @@ SHOVE::SHOVE_STATUS SHOVE::shoveIteration( int aIter )
  */
 SHOVE::SHOVE_STATUS SHOVE::shoveMainLoop()
 {
+    STATS::TIMER timer( STATS::SHOVE );
     SHOVE_STATUS st = SH_OK;
 
     m_affectedArea = OPT_BOX2I();
@@ -1243,6 +1245,8 @@ SHOVE::SHOVE_STATUS SHOVE::shoveMainLoop()
         }
     }
 
+    STATS::AddIterations( STATS::SHOVE, m_iter );
+
     return st;
 }
 
@@ -0,0 +1,72 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pns_stats.h"
+
+namespace PNS {
+
+std::atomic<bool>    STATS::s_enabled( false );
+std::atomic<int64_t> STATS::s_calls[STATS::COUNTER_COUNT];
+std::atomic<int64_t> STATS::s_nsecs[STATS::COUNTER_COUNT];
+std::atomic<int64_t> STATS::s_iterations[STATS::COUNTER_COUNT];
+
+
+void STATS::Reset()
+{
+    for( int ii = 0; ii < COUNTER_COUNT; ++ii )
+    {
+        s_calls[ii] = 0;
+        s_nsecs[ii] = 0;
+        s_iterations[ii] = 0;
+    }
+}
+
+
+void STATS::AddCall( COUNTER aCounter, int64_t aNsecs )
+{
+    s_calls[aCounter].fetch_add( 1, std::memory_order_relaxed );
+    s_nsecs[aCounter].fetch_add( aNsecs, std::memory_order_relaxed );
+}
+
+
+void STATS::AddIterations( COUNTER aCounter, int aIterations )
+{
+    if( IsEnabled() )
+        s_iterations[aCounter].fetch_add( aIterations, std::memory_order_relaxed );
+}
+
+
+int64_t STATS::Calls( COUNTER aCounter )
+{
+    return s_calls[aCounter];
+}
+
+
+int64_t STATS::Iterations( COUNTER aCounter )
+{
+    return s_iterations[aCounter];
+}
+
+
+double STATS::Msecs( COUNTER aCounter )
+{
+    return s_nsecs[aCounter] / 1e6;
+}
+
+}
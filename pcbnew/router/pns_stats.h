@@ -0,0 +1,112 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_STATS_H
+#define __PNS_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace PNS {
+
+/**
+ * STATS
+ *
+ * Counts the calls, time and iterations of the routing algorithms, for benchmarks (see the
+ * pns_replay utility of qa_pcbnew_tools). Counting is off by default, and then costs a flag
+ * test per counted call.
+ *
+ * Times are inclusive (the time of a shove includes the index queries it makes) and summed
+ * over the threads walking around obstacles.
+ **/
+class STATS
+{
+public:
+    enum COUNTER
+    {
+        SHOVE = 0,
+        WALKAROUND,
+        OPTIMIZER,
+        INDEX_QUERY,
+        COUNTER_COUNT
+    };
+
+    static void Enable( bool aEnable )
+    {
+        s_enabled.store( aEnable, std::memory_order_relaxed );
+    }
+
+    static bool IsEnabled()
+    {
+        return s_enabled.load( std::memory_order_relaxed );
+    }
+
+    ///> Zeroes all the counters.
+    static void Reset();
+
+    static void AddCall( COUNTER aCounter, int64_t aNsecs );
+    static void AddIterations( COUNTER aCounter, int aIterations );
+
+    static int64_t Calls( COUNTER aCounter );
+    static int64_t Iterations( COUNTER aCounter );
+    static double Msecs( COUNTER aCounter );
+
+    /**
+     * Counts a call and its time, from its construction to its destruction.
+     */
+    class TIMER
+    {
+    public:
+        TIMER( COUNTER aCounter ) :
+            m_counter( aCounter ),
+            m_enabled( IsEnabled() )
+        {
+            if( m_enabled )
+                m_start = CLOCK::now();
+        }
+
+        ~TIMER()
+        {
+            if( m_enabled )
+            {
+                auto duration = CLOCK::now() - m_start;
+                AddCall( m_counter,
+                         std::chrono::duration_cast<std::chrono::nanoseconds>( duration ).count() );
+            }
+        }
+
+    private:
+        using CLOCK = std::chrono::steady_clock;
+
+        COUNTER           m_counter;
+        bool              m_enabled;
+        CLOCK::time_point m_start;
+    };
+
+private:
+    static std::atomic<bool>    s_enabled;
+    static std::atomic<int64_t> s_calls[COUNTER_COUNT];
+    static std::atomic<int64_t> s_nsecs[COUNTER_COUNT];
+    static std::atomic<int64_t> s_iterations[COUNTER_COUNT];
+};
+
+}
+
+#endif    // __PNS_STATS_H
@@ -23,11 +23,15 @@
 
 #include <geometry/shape_line_chain.h>
 
+#include <advanced_config.h>
+#include <thread_pool.h>
+
 #include "pns_walkaround.h"
 #include "pns_optimizer.h"
 #include "pns_utils.h"
 #include "pns_router.h"
 #include "pns_debug_decorator.h"
+#include "pns_stats.h"
 
 namespace PNS {
 
@@ -52,11 +56,13 @@ NODE::OPT_OBSTACLE WALKAROUND::nearestObstacle( const LINE& aPath )
 }
 
 
-WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
-                                                              bool aWindingDirection )
+WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath, bool aWindingDirection,
+                                                      int aIteration, DEBUG_DECORATOR* aDbg )
 {
     OPT<OBSTACLE>& current_obs =
         aWindingDirection ? m_currentObstacle[0] : m_currentObstacle[1];
+    int& recursiveBlockageCount =
+        aWindingDirection ? m_recursiveBlockageCount[0] : m_recursiveBlockageCount[1];
 
     if( !current_obs )
         return DONE;
@@ -69,9 +75,9 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
 
         if( ( current_obs->m_hull ).PointInside( last ) || ( current_obs->m_hull ).PointOnEdge( last ) )
         {
-            m_recursiveBlockageCount++;
+            recursiveBlockageCount++;
 
-            if( m_recursiveBlockageCount < 3 )
+            if( recursiveBlockageCount < 3 )
                 aPath.Line().Append( current_obs->m_hull.NearestPoint( last ) );
             else
             {
@@ -83,18 +89,15 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
 
     aPath.Walkaround( current_obs->m_hull, path_pre[0], path_walk[0],
                       path_post[0], aWindingDirection );
-    aPath.Walkaround( current_obs->m_hull, path_pre[1], path_walk[1],
-                      path_post[1], !aWindingDirection );
 
     if( !aPath.Walkaround( current_obs->m_hull, path_pre[1], path_walk[1],
                       path_post[1], !aWindingDirection ) )
         return STUCK;
-    auto l =aPath.CLine();
 
 #if 0
     if( m_logger )
     {
-        m_logger->NewGroup( aWindingDirection ? "walk-cw" : "walk-ccw", m_iteration );
+        m_logger->NewGroup( aWindingDirection ? "walk-cw" : "walk-ccw", aIteration );
         m_logger->Log( &path_walk[0], 0, "path_walk" );
         m_logger->Log( &path_pre[0], 1, "path_pre" );
         m_logger->Log( &path_post[0], 4, "path_post" );
@@ -103,13 +106,13 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
     }
 #endif
 
-    if ( Dbg() )
+    if ( aDbg )
     {
         char name[128];
-        snprintf(name, sizeof(name), "hull-%s-%d", aWindingDirection ? "cw" : "ccw", m_iteration );
-        Dbg()->AddLine( current_obs->m_hull, 0, 1, name);
-        snprintf(name, sizeof(name), "path-%s-%d", aWindingDirection ? "cw" : "ccw", m_iteration );
-        Dbg()->AddLine( aPath.CLine(), 1, 1, name );
+        snprintf(name, sizeof(name), "hull-%s-%d", aWindingDirection ? "cw" : "ccw", aIteration );
+        aDbg->AddLine( current_obs->m_hull, 0, 1, name);
+        snprintf(name, sizeof(name), "path-%s-%d", aWindingDirection ? "cw" : "ccw", aIteration );
+        aDbg->AddLine( aPath.CLine(), 1, 1, name );
     }
 
     int len_pre = path_walk[0].Length();
@@ -157,7 +160,7 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
 
 
 
-bool clipToLoopStart( SHAPE_LINE_CHAIN& l )
+bool clipToLoopStart( SHAPE_LINE_CHAIN& l, DEBUG_DECORATOR* aDbg )
 {
     auto ip = l.SelfIntersecting();
 
@@ -170,8 +173,8 @@ bool clipToLoopStart( SHAPE_LINE_CHAIN& l )
 
         int pidx2 = tail.Split( ip->p );
 
-        auto dbg = ROUTER::GetInstance()->GetInterface()->GetDebugDecorator();
-        dbg->AddPoint( ip->p, 5 );
+        if( aDbg )
+            aDbg->AddPoint( ip->p, 5 );
 
         l = lead;
         l.Append( tail.Slice( 0, pidx2 ) );
@@ -184,12 +187,77 @@ bool clipToLoopStart( SHAPE_LINE_CHAIN& l )
 
 
 
+bool WALKAROUND::stepDirection( int aDir, bool aClipLoops, std::atomic<int>* aStopAfter,
+                                DEBUG_DECORATOR* aDbg )
+{
+    DIRECTION& dir = m_direction[aDir];
+
+    if( dir.m_status != IN_PROGRESS || dir.m_steps >= m_iterationLimit )
+        return false;
+
+    if( aStopAfter && dir.m_steps > aStopAfter->load() )
+        return false;
+
+    dir.m_status = singleStep( dir.m_path, aDir == 0, dir.m_steps, aDbg );
+
+    if( aClipLoops && clipToLoopStart( dir.m_path.Line(), aDbg ) )
+        dir.m_status = ALMOST_DONE;
+
+    if( aStopAfter && dir.m_status == DONE )
+    {
+        int stopAfter = aStopAfter->load();
+
+        while( dir.m_steps < stopAfter
+                && !aStopAfter->compare_exchange_weak( stopAfter, dir.m_steps ) )
+            ;
+    }
+
+    dir.m_steps++;
+
+    return true;
+}
+
+
+void WALKAROUND::walkBothDirections( bool aClipLoops, std::atomic<int>* aStopAfter )
+{
+    THREAD_POOL& tp = GetKiCadThreadPool();
+
+    bool concurrent = m_direction[0].m_status == IN_PROGRESS
+                      && m_direction[1].m_status == IN_PROGRESS
+                      && tp.GetThreadCount() > 1
+                      && !ADVANCED_CFG::GetCfg().m_ShowRouterDebugGraphics;
+
+    if( !concurrent )
+    {
+        while( stepDirection( 0, aClipLoops, aStopAfter, Dbg() )
+                | stepDirection( 1, aClipLoops, aStopAfter, Dbg() ) )
+            ;
+    }
+    else
+    {
+        std::vector<std::future<void>> returns;
+
+        returns.push_back( tp.Submit(
+                [&]()
+                {
+                    while( stepDirection( 0, aClipLoops, aStopAfter, nullptr ) )
+                        ;
+                } ) );
+
+        while( stepDirection( 1, aClipLoops, aStopAfter, nullptr ) )
+            ;
+
+        tp.WaitAll( returns );
+    }
+
+    STATS::AddIterations( STATS::WALKAROUND, m_direction[0].m_steps + m_direction[1].m_steps );
+}
+
+
 const WALKAROUND::RESULT WALKAROUND::Route( const LINE& aInitialPath )
 {
-    LINE path_cw( aInitialPath ), path_ccw( aInitialPath );
-    WALKAROUND_STATUS s_cw = IN_PROGRESS, s_ccw = IN_PROGRESS;
-    SHAPE_LINE_CHAIN best_path;
-    RESULT result;
+    STATS::TIMER timer( STATS::WALKAROUND );
+    RESULT       result;
 
     // special case for via-in-the-middle-of-track placement
     if( aInitialPath.PointCount() <= 1 )
@@ -203,70 +271,37 @@ const WALKAROUND::RESULT WALKAROUND::Route( const LINE& aInitialPath )
     start( aInitialPath );
 
     m_currentObstacle[0] = m_currentObstacle[1] = nearestObstacle( aInitialPath );
-    m_recursiveBlockageCount = 0;
+    m_recursiveBlockageCount[0] = m_recursiveBlockageCount[1] = 0;
 
-    result.lineCw = aInitialPath;
-    result.lineCcw = aInitialPath;
+    for( DIRECTION& dir : m_direction )
+    {
+        dir.m_path = aInitialPath;
+        dir.m_status = IN_PROGRESS;
+        dir.m_steps = 0;
+    }
 
     if( m_forceWinding )
     {
-        s_cw = m_forceCw ? IN_PROGRESS : STUCK;
-        s_ccw = m_forceCw ? STUCK : IN_PROGRESS;
+        m_direction[0].m_status = m_forceCw ? IN_PROGRESS : STUCK;
+        m_direction[1].m_status = m_forceCw ? STUCK : IN_PROGRESS;
         m_forceSingleDirection = true;
     } else {
         m_forceSingleDirection = false;
     }
 
-    while( m_iteration < m_iterationLimit )
-    {
-        if( s_cw != STUCK )
-            s_cw = singleStep( path_cw, true );
-
-        if( s_ccw != STUCK )
-            s_ccw = singleStep( path_ccw, false );
-
-        auto old = path_cw.CLine();
-
-        if( clipToLoopStart( path_cw.Line() ))
-        {
-            s_cw = ALMOST_DONE;
-        }
-
-        if( clipToLoopStart( path_ccw.Line() ))
-        {
-            s_ccw = ALMOST_DONE;
-        }
-
-
-        if( s_cw != IN_PROGRESS )
-        {
-            result.lineCw = path_cw;
-            result.statusCw = s_cw;
-        }
-
-        if( s_ccw != IN_PROGRESS )
-        {
-            result.lineCcw = path_ccw;
-            result.statusCcw = s_ccw;
-        }
-
-        if( s_cw != IN_PROGRESS && s_ccw != IN_PROGRESS )
-            break;
+    // Each direction walks until it is done, stuck or clipped to its first loop
+    walkBothDirections( true, nullptr );
 
-        m_iteration++;
-    }
+    result.lineCw = m_direction[0].m_path;
+    result.statusCw = m_direction[0].m_status;
+    result.lineCcw = m_direction[1].m_path;
+    result.statusCcw = m_direction[1].m_status;
 
-    if( s_cw == IN_PROGRESS )
-    {
-        result.lineCw = path_cw;
+    if( result.statusCw == IN_PROGRESS )
         result.statusCw = ALMOST_DONE;
-    }
 
-    if( s_ccw == IN_PROGRESS )
-    {
-        result.lineCcw = path_ccw;
+    if( result.statusCcw == IN_PROGRESS )
         result.statusCcw = ALMOST_DONE;
-    }
 
     result.lineCw.Line().Simplify();
     result.lineCcw.Line().Simplify();
@@ -299,9 +334,8 @@ const WALKAROUND::RESULT WALKAROUND::Route( const LINE& aInitialPath )
 WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
         LINE& aWalkPath, bool aOptimize )
 {
-    LINE path_cw( aInitialPath ), path_ccw( aInitialPath );
+    STATS::TIMER      timer( STATS::WALKAROUND );
     WALKAROUND_STATUS s_cw = IN_PROGRESS, s_ccw = IN_PROGRESS;
-    SHAPE_LINE_CHAIN best_path;
 
     // special case for via-in-the-middle-of-track placement
     if( aInitialPath.PointCount() <= 1 )
@@ -316,7 +350,7 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
     start( aInitialPath );
 
     m_currentObstacle[0] = m_currentObstacle[1] = nearestObstacle( aInitialPath );
-    m_recursiveBlockageCount = 0;
+    m_recursiveBlockageCount[0] = m_recursiveBlockageCount[1] = 0;
 
     aWalkPath = aInitialPath;
 
@@ -329,13 +363,31 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
         m_forceSingleDirection = false;
     }
 
-    while( m_iteration < m_iterationLimit )
-    {
-        if( s_cw != STUCK )
-            s_cw = singleStep( path_cw, true );
+    m_direction[0] = { aInitialPath, s_cw, 0 };
+    m_direction[1] = { aInitialPath, s_ccw, 0 };
 
-        if( s_ccw != STUCK )
-            s_ccw = singleStep( path_ccw, false );
+    // Unless the longer path is wanted, the first direction to get done wins: the walk stops
+    // at that step
+    std::atomic<int> stopAfter( m_iterationLimit );
+
+    walkBothDirections( false, m_forceLongerPath ? nullptr : &stopAfter );
+
+    const LINE& path_cw = m_direction[0].m_path;
+    const LINE& path_ccw = m_direction[1].m_path;
+
+    // The status of a direction at a given step of a lock step walk of both directions
+    auto statusAt =
+            []( const DIRECTION& aDir, int aStep ) -> WALKAROUND_STATUS
+            {
+                return aStep + 1 >= aDir.m_steps ? aDir.m_status : IN_PROGRESS;
+            };
+
+    int iteration = 0;
+
+    for( ; iteration < m_iterationLimit; iteration++ )
+    {
+        s_cw = statusAt( m_direction[0], iteration );
+        s_ccw = statusAt( m_direction[1], iteration );
 
         if( ( s_cw == DONE && s_ccw == DONE ) || ( s_cw == STUCK && s_ccw == STUCK ) )
         {
@@ -359,11 +411,9 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
             aWalkPath = path_ccw;
             break;
         }
-
-        m_iteration++;
     }
 
-    if( m_iteration == m_iterationLimit )
+    if( iteration == m_iterationLimit )
     {
         int len_cw  = path_cw.CLine().Length();
         int len_ccw = path_ccw.CLine().Length();
@@ -22,6 +22,7 @@
 #ifndef __PNS_WALKAROUND_H
 #define __PNS_WALKAROUND_H
 
+#include <atomic>
 #include <set>
 
 #include "pns_line.h"
@@ -49,7 +50,7 @@ public:
         m_itemMask = ITEM::ANY_T;
 
         // Initialize other members, to avoid uninitialized variables.
-        m_recursiveBlockageCount = 0;
+        m_recursiveBlockageCount[0] = m_recursiveBlockageCount[1] = 0;
         m_recursiveCollision[0] = m_recursiveCollision[1] = false;
         m_iteration = 0;
         m_forceCw = false;
@@ -140,14 +141,48 @@ public:
     const RESULT Route( const LINE& aInitialPath );
 
 private:
+    ///> The walk in one direction (0 is clockwise, 1 counter-clockwise)
+    struct DIRECTION
+    {
+        LINE              m_path;
+        WALKAROUND_STATUS m_status;
+        int               m_steps;
+    };
+
     void start( const LINE& aInitialPath );
 
-    WALKAROUND_STATUS singleStep( LINE& aPath, bool aWindingDirection );
+    WALKAROUND_STATUS singleStep( LINE& aPath, bool aWindingDirection, int aIteration,
+                                  DEBUG_DECORATOR* aDbg );
     NODE::OPT_OBSTACLE nearestObstacle( const LINE& aPath );
 
+    /**
+     * Takes one step of the walk in direction \a aDir, unless it is over (not in progress
+     * any more, at the iteration limit or past \a aStopAfter).
+     *
+     * @param aClipLoops tells if loops are clipped after each step (the walk is then almost
+     *                   done)
+     * @param aStopAfter if not null, is lowered to the step at which a direction gets done,
+     *                   and the walk stops after that step
+     * @return true if a step was taken
+     */
+    bool stepDirection( int aDir, bool aClipLoops, std::atomic<int>* aStopAfter,
+                        DEBUG_DECORATOR* aDbg );
+
+    /**
+     * Walks both directions (from the paths and statuses set in m_direction) until they are
+     * over.
+     *
+     * The two directions only read the world, so they are walked concurrently on the thread
+     * pool when both are needed; otherwise (or when the router debug graphics are shown, as
+     * the debug decorators are not thread safe) they are walked in lock step.  The result is
+     * the same either way.
+     */
+    void walkBothDirections( bool aClipLoops, std::atomic<int>* aStopAfter );
+
     NODE* m_world;
 
-    int m_recursiveBlockageCount;
+    DIRECTION m_direction[2];
+    int m_recursiveBlockageCount[2];
     int m_iteration;
     int m_iterationLimit;
     int m_itemMask;
@@ -169,6 +169,9 @@ void DRC_TOOL::RunTests( PROGRESS_REPORTER* aProgressReporter, bool aTestTracksA
         zoneFiller->CheckAllZones( m_drcDialog, aProgressReporter );
     }
 
+    // Check the fills a full refill gives, whatever the edits which led to them
+    zoneFiller->RefillSplicedZones( m_drcDialog, aProgressReporter );
+
     m_drcEngine->SetWorksheet( m_editFrame->GetCanvas()->GetWorksheet() );
 
     if( aTestFootprints && !Kiface().IsSingle() )
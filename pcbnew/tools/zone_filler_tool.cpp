@@ -86,6 +86,36 @@ void ZONE_FILLER_TOOL::CheckAllZones( wxWindow* aCaller, PROGRESS_REPORTER* aRep
 }
 
 
+void ZONE_FILLER_TOOL::RefillSplicedZones( wxWindow* aCaller, PROGRESS_REPORTER* aReporter )
+{
+    bool spliced = false;
+
+    for( ZONE_CONTAINER* zone : board()->Zones() )
+        spliced |= zone->HasSplicedFill();
+
+    if( !spliced )
+        return;
+
+    BOARD_COMMIT commit( this );
+
+    ZONE_FILLER filler( board(), &commit );
+
+    if( aReporter )
+        filler.SetProgressReporter( aReporter );
+    else
+        filler.InstallNewProgressReporter( aCaller, _( "Finishing Zone Fills" ), 3 );
+
+    // The fills only change vertex for vertex, so this is neither an undoable edit nor a
+    // modification of the board
+    if( filler.RefillSplicedZones( aCaller ) )
+        commit.Push( _( "Fill Zone(s)" ), false, false );
+    else
+        commit.Revert();
+
+    canvas()->Refresh();
+}
+
+
 void ZONE_FILLER_TOOL::singleShotRefocus( wxIdleEvent& )
 {
     canvas()->SetFocus();
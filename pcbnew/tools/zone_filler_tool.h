@@ -49,6 +49,13 @@ public:
     void CheckAllZones( wxWindow* aCaller, PROGRESS_REPORTER* aReporter = nullptr );
     void FillAllZones( wxWindow* aCaller, PROGRESS_REPORTER* aReporter = nullptr );
 
+    /**
+     * Refill the zones whose fills were updated in place since they were last filled as a
+     * whole (see ZONE_FILLER::RefillSplicedZones()).  Called before fills are saved, plotted
+     * or checked, which must not depend on the edit history.
+     */
+    void RefillSplicedZones( wxWindow* aCaller, PROGRESS_REPORTER* aReporter = nullptr );
+
     int ZoneFill( const TOOL_EVENT& aEvent );
     int ZoneFillAll( const TOOL_EVENT& aEvent );
     int ZoneUnfill( const TOOL_EVENT& aEvent );
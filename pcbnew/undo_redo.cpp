@@ -36,6 +36,7 @@ using namespace std::placeholders;
 #include <class_dimension.h>
 #include <origin_viewitem.h>
 #include <connectivity/connectivity_data.h>
+#include <drc/drc_engine.h>
 #include <pcbnew_settings.h>
 #include <tool/tool_manager.h>
 #include <tool/actions.h>
@@ -594,6 +595,10 @@ void PCB_BASE_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool
     selTool->RebuildSelection();
 
     GetBoard()->SanitizeNetcodes();
+
+    // Nets and netclass assignments may have changed under memoized rule resolutions
+    if( GetBoard()->GetDesignSettings().m_DRCEngine )
+        GetBoard()->GetDesignSettings().m_DRCEngine->ClearConstraintCache();
 }
 
 
@@ -0,0 +1,366 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <wx/filename.h>
+
+#include <binary_stream.h>
+#include <build_version.h>
+#include <class_board.h>
+#include <class_zone.h>
+#include <kicad_string.h>
+#include <wildcards_and_files_ext.h>
+#include <zone_filler.h>
+#include "zone_fill_cache.h"
+
+
+static const char     CACHE_MAGIC[] = "KiCad zone fill cache";
+static const uint32_t CACHE_VERSION = 1;
+
+typedef SHAPE_POLY_SET::TRIANGULATED_POLYGON TRIANGULATED_POLYGON;
+
+
+static void writePolys( BINARY_STREAM_WRITER& aOut, const SHAPE_POLY_SET& aPolys )
+{
+    aOut.Write<uint32_t>( aPolys.OutlineCount() );
+
+    for( int ii = 0; ii < aPolys.OutlineCount(); ++ii )
+    {
+        const SHAPE_POLY_SET::POLYGON& poly = aPolys.CPolygon( ii );
+
+        aOut.Write<uint32_t>( poly.size() );
+
+        for( const SHAPE_LINE_CHAIN& chain : poly )
+        {
+            aOut.Write<uint32_t>( chain.PointCount() );
+
+            for( int jj = 0; jj < chain.PointCount(); ++jj )
+            {
+                aOut.Write<int32_t>( chain.CPoint( jj ).x );
+                aOut.Write<int32_t>( chain.CPoint( jj ).y );
+            }
+        }
+    }
+}
+
+
+static void readPolys( BINARY_STREAM_READER& aIn, SHAPE_POLY_SET& aPolys )
+{
+    uint32_t polyCount = aIn.Read<uint32_t>();
+
+    for( uint32_t ii = 0; ii < polyCount && aIn.Ok(); ++ii )
+    {
+        uint32_t chainCount = aIn.Read<uint32_t>();
+
+        for( uint32_t jj = 0; jj < chainCount && aIn.Ok(); ++jj )
+        {
+            SHAPE_LINE_CHAIN chain;
+            uint32_t         pointCount = aIn.Read<uint32_t>();
+
+            for( uint32_t kk = 0; kk < pointCount && aIn.Ok(); ++kk )
+            {
+                int32_t x = aIn.Read<int32_t>();
+                int32_t y = aIn.Read<int32_t>();
+                chain.Append( x, y );
+            }
+
+            chain.SetClosed( true );
+
+            if( jj == 0 )
+                aPolys.AddOutline( chain );
+            else
+                aPolys.AddHole( chain );
+        }
+    }
+}
+
+
+wxString ZONE_FILL_CACHE::CacheFileName( const wxString& aBoardFileName )
+{
+    wxFileName fn( aBoardFileName );
+    fn.SetExt( ZoneFillCacheFileExtension );
+    return fn.GetFullPath();
+}
+
+
+bool ZONE_FILL_CACHE::Save( BOARD* aBoard, const wxString& aBoardFileName )
+{
+    std::vector<std::pair<ZONE_CONTAINER*, PCB_LAYER_ID>> entries;
+
+    for( ZONE_CONTAINER* zone : aBoard->Zones() )
+    {
+        if( zone->GetIsRuleArea() )
+            continue;
+
+        for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
+        {
+            // Entries are keyed by the hash of the filled areas, which is only known (without
+            // computing it again) when they are triangulated
+            if( zone->HasFilledPolysForLayer( layer )
+                    && zone->GetFilledPolysList( layer ).IsTriangulationUpToDate() )
+            {
+                entries.emplace_back( zone, layer );
+            }
+        }
+    }
+
+    BINARY_STREAM_WRITER out;
+
+    out.WriteHeader( CACHE_MAGIC, CACHE_VERSION );
+    out.WriteString( TO_UTF8( GetBuildVersion() ) );
+    out.Write<uint32_t>( entries.size() );
+
+    for( const std::pair<ZONE_CONTAINER*, PCB_LAYER_ID>& entry : entries )
+    {
+        ZONE_CONTAINER*         zone = entry.first;
+        PCB_LAYER_ID            layer = entry.second;
+        const SHAPE_POLY_SET&   filled = zone->GetFilledPolysList( layer );
+        const ZONE_FILL_INPUTS* inputs = zone->GetFillInputs( layer );
+
+        out.WriteString( TO_UTF8( zone->m_Uuid.AsString() ) );
+        out.Write<int32_t>( layer );
+        out.WriteString( filled.GetHash().Format() );
+
+        out.Write<uint32_t>( filled.TriangulatedPolyCount() );
+
+        for( unsigned ii = 0; ii < filled.TriangulatedPolyCount(); ++ii )
+        {
+            const TRIANGULATED_POLYGON* tri = filled.TriangulatedPolygon( ii );
+
+            out.Write<uint32_t>( tri->GetVertexCount() );
+
+            for( size_t jj = 0; jj < tri->GetVertexCount(); ++jj )
+            {
+                out.Write<int32_t>( tri->GetVertex( jj ).x );
+                out.Write<int32_t>( tri->GetVertex( jj ).y );
+            }
+
+            out.Write<uint32_t>( tri->GetTriangleCount() );
+
+            for( const TRIANGULATED_POLYGON::TRI& triangle : tri->Triangles() )
+            {
+                out.Write<int32_t>( triangle.a );
+                out.Write<int32_t>( triangle.b );
+                out.Write<int32_t>( triangle.c );
+            }
+        }
+
+        out.Write<uint8_t>( inputs != nullptr );
+
+        if( inputs )
+        {
+            out.Write<uint64_t>( inputs->m_settingsHash );
+            out.Write<uint32_t>( inputs->m_serial );
+            out.Write<uint32_t>( inputs->m_items.size() );
+
+            for( const ZONE_FILL_INPUT& item : inputs->m_items )
+            {
+                out.Write<uint64_t>( item.m_id );
+                out.Write<uint64_t>( item.m_hash );
+                out.Write<uint32_t>( item.m_fillSerial );
+                out.Write<int32_t>( item.m_reach.GetX() );
+                out.Write<int32_t>( item.m_reach.GetY() );
+                out.Write<int32_t>( item.m_reach.GetWidth() );
+                out.Write<int32_t>( item.m_reach.GetHeight() );
+            }
+
+            writePolys( out, zone->RawPolysList( layer ) );
+        }
+    }
+
+    return out.WriteFile( CacheFileName( aBoardFileName ) );
+}
+
+
+int ZONE_FILL_CACHE::Load( BOARD* aBoard, const wxString& aBoardFileName )
+{
+    BINARY_STREAM_READER in;
+
+    if( !in.ReadFile( CacheFileName( aBoardFileName ) )
+            || !in.ReadHeader( CACHE_MAGIC, CACHE_VERSION ) )
+    {
+        return 0;
+    }
+
+    // Item signatures are only stable within a build
+    if( in.ReadString() != std::string( TO_UTF8( GetBuildVersion() ) ) )
+        return 0;
+
+    struct ENTRY
+    {
+        ZONE_CONTAINER*                                    m_zone;
+        PCB_LAYER_ID                                       m_layer;
+        std::vector<std::unique_ptr<TRIANGULATED_POLYGON>> m_triangulation;
+        bool                                               m_hasInputs;
+        ZONE_FILL_INPUTS                                   m_inputs;
+        SHAPE_POLY_SET                                     m_rawPolys;
+    };
+
+    std::map<wxString, ZONE_CONTAINER*> zones;
+    std::vector<ENTRY>                  entries;
+    uint32_t                            entryCount = in.Read<uint32_t>();
+
+    for( ZONE_CONTAINER* zone : aBoard->Zones() )
+        zones[ zone->m_Uuid.AsString() ] = zone;
+
+    // Read everything first: a damaged file is ignored as a whole
+    for( uint32_t ii = 0; ii < entryCount && in.Ok(); ++ii )
+    {
+        ENTRY entry;
+
+        wxString    uuid = FROM_UTF8( in.ReadString().c_str() );
+        int32_t     layer = in.Read<int32_t>();
+        std::string filledHash = in.ReadString();
+        uint32_t    triCount = in.Read<uint32_t>();
+
+        entry.m_zone = zones.count( uuid ) ? zones[ uuid ] : nullptr;
+        entry.m_layer = ToLAYER_ID( layer );
+
+        for( uint32_t jj = 0; jj < triCount && in.Ok(); ++jj )
+        {
+            entry.m_triangulation.push_back( std::make_unique<TRIANGULATED_POLYGON>() );
+            TRIANGULATED_POLYGON* tri = entry.m_triangulation.back().get();
+
+            uint32_t vertexCount = in.Read<uint32_t>();
+
+            for( uint32_t kk = 0; kk < vertexCount && in.Ok(); ++kk )
+            {
+                int32_t x = in.Read<int32_t>();
+                int32_t y = in.Read<int32_t>();
+                tri->AddVertex( VECTOR2I( x, y ) );
+            }
+
+            uint32_t triangleCount = in.Read<uint32_t>();
+
+            for( uint32_t kk = 0; kk < triangleCount && in.Ok(); ++kk )
+            {
+                int32_t a = in.Read<int32_t>();
+                int32_t b = in.Read<int32_t>();
+                int32_t c = in.Read<int32_t>();
+
+                if( a < 0 || b < 0 || c < 0 || (uint32_t) a >= vertexCount
+                        || (uint32_t) b >= vertexCount || (uint32_t) c >= vertexCount )
+                {
+                    return 0;
+                }
+
+                tri->AddTriangle( a, b, c );
+            }
+        }
+
+        entry.m_hasInputs = in.Read<uint8_t>() != 0;
+
+        if( entry.m_hasInputs )
+        {
+            entry.m_inputs.m_settingsHash = in.Read<uint64_t>();
+            entry.m_inputs.m_serial = in.Read<uint32_t>();
+
+            uint32_t itemCount = in.Read<uint32_t>();
+
+            for( uint32_t jj = 0; jj < itemCount && in.Ok(); ++jj )
+            {
+                ZONE_FILL_INPUT item;
+
+                item.m_id = in.Read<uint64_t>();
+                item.m_hash = in.Read<uint64_t>();
+                item.m_fillSerial = in.Read<uint32_t>();
+
+                int32_t x = in.Read<int32_t>();
+                int32_t y = in.Read<int32_t>();
+                int32_t w = in.Read<int32_t>();
+                int32_t h = in.Read<int32_t>();
+
+                item.m_reach = EDA_RECT( wxPoint( x, y ), wxSize( w, h ) );
+                entry.m_inputs.m_items.push_back( item );
+            }
+
+            readPolys( in, entry.m_rawPolys );
+        }
+
+        if( !in.Ok() )
+            return 0;
+
+        // The board was changed since the cache was written, or the zone's fill was
+        if( !entry.m_zone || !entry.m_zone->GetLayerSet().test( entry.m_layer )
+                || !entry.m_zone->HasFilledPolysForLayer( entry.m_layer )
+                || entry.m_zone->GetFilledPolysList( entry.m_layer ).GetHash().Format()
+                        != filledHash )
+        {
+            continue;
+        }
+
+        entries.push_back( std::move( entry ) );
+    }
+
+    if( !in.Ok() )
+        return 0;
+
+    // Fill serials are only unique within a session, so give the restored fills new ones.
+    // References to fills which were not restored get serials matching no fill, so that
+    // ZONE_FILLER takes these fills as changed.
+    std::map<unsigned, unsigned> serials;
+
+    for( ENTRY& entry : entries )
+    {
+        if( entry.m_hasInputs )
+        {
+            unsigned serial = aBoard->NewZoneFillSerial();
+            serials[ entry.m_inputs.m_serial ] = serial;
+            entry.m_inputs.m_serial = serial;
+        }
+    }
+
+    for( ENTRY& entry : entries )
+    {
+        ZONE_CONTAINER* zone = entry.m_zone;
+
+        if( !entry.m_triangulation.empty() )
+        {
+            SHAPE_POLY_SET filled = zone->GetFilledPolysList( entry.m_layer );
+            filled.SetTriangulation( std::move( entry.m_triangulation ) );
+            zone->SetFilledPolysList( entry.m_layer, filled );
+        }
+
+        if( entry.m_hasInputs )
+        {
+            for( ZONE_FILL_INPUT& item : entry.m_inputs.m_items )
+            {
+                if( item.m_fillSerial == 0 || item.m_fillSerial == UNRECORDED_FILL )
+                    continue;
+
+                auto it = serials.find( item.m_fillSerial );
+                item.m_fillSerial = it != serials.end() ? it->second
+                                                        : aBoard->NewZoneFillSerial();
+            }
+
+            zone->SetRawPolysList( entry.m_layer, entry.m_rawPolys );
+            zone->SetFillInputs( entry.m_layer, std::move( entry.m_inputs ) );
+        }
+    }
+
+    return (int) entries.size();
+}
@@ -0,0 +1,67 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef ZONE_FILL_CACHE_H
+#define ZONE_FILL_CACHE_H
+
+#include <wx/string.h>
+
+class BOARD;
+
+
+/**
+ * A cache file kept next to a board file, holding the zone fill data which is not saved in
+ * the board but is expensive to rebuild:
+ *  - the triangulation of the filled areas, otherwise rebuilt for display when the board is
+ *    opened;
+ *  - the raw fills and what they were built from (see ZONE_FILL_INPUTS), which let
+ *    ZONE_FILLER keep or update the fills instead of rebuilding them.
+ *
+ * Each entry is keyed by its zone and layer, and is only used if the filled areas loaded from
+ * the board are identical to the ones it was written for.  Whether the fill is still up to
+ * date with the rest of the board is left to ZONE_FILLER, which compares the recorded inputs
+ * with the current ones.
+ */
+class ZONE_FILL_CACHE
+{
+public:
+    /**
+     * @return the name of the cache file for \a aBoardFileName.
+     */
+    static wxString CacheFileName( const wxString& aBoardFileName );
+
+    /**
+     * Write the cache file for \a aBoard, just saved as \a aBoardFileName.
+     * @return true if the file was written.
+     */
+    static bool Save( BOARD* aBoard, const wxString& aBoardFileName );
+
+    /**
+     * Apply the cache file of \a aBoardFileName (if any) to \a aBoard, just loaded from it.
+     * Missing, outdated or damaged cache files are ignored.
+     * @return the number of zone layers which were restored from the cache.
+     */
+    static int Load( BOARD* aBoard, const wxString& aBoardFileName );
+};
+
+#endif // ZONE_FILL_CACHE_H
@@ -23,15 +23,19 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
-#include <thread>
 #include <algorithm>
+#include <atomic>
 #include <future>
+#include <functional>
+#include <map>
+#include <mutex>
 
 #include <advanced_config.h>
 #include <class_board.h>
 #include <class_zone.h>
 #include <class_module.h>
 #include <fp_shape.h>
+#include <fp_text.h>
 #include <pcb_shape.h>
 #include <pcb_text.h>
 #include <class_pcb_target.h>
@@ -39,6 +43,8 @@
 #include <connectivity/connectivity_data.h>
 #include <convert_basic_shapes_to_polygon.h>
 #include <board_commit.h>
+#include <hash_eda.h>
+#include <thread_pool.h>
 #include <widgets/progress_reporter.h>
 #include <geometry/shape_poly_set.h>
 #include <geometry/convex_hull.h>
@@ -57,7 +63,9 @@ ZONE_FILLER::ZONE_FILLER(  BOARD* aBoard, COMMIT* aCommit ) :
         m_commit( aCommit ),
         m_progressReporter( nullptr ),
         m_maxError( ARC_HIGH_DEF ),
-        m_worstClearance( 0 )
+        m_worstClearance( 0 ),
+        m_boardOutlineHash( 0 ),
+        m_allowSplicing( true )
 {
     // To enable add "DebugZoneFiller=1" to kicad_advanced settings file.
     m_debugZoneFiller = ADVANCED_CFG::GetCfg().m_DebugZoneFiller;
@@ -89,6 +97,9 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*>& aZones, bool aCheck, wxWin
     std::vector<std::pair<ZONE_CONTAINER*, PCB_LAYER_ID>> toFill;
     std::vector<CN_ZONE_ISOLATED_ISLAND_LIST> islandsList;
 
+    // What the current fills were built from, for those which can be updated in place
+    std::map<std::pair<ZONE_CONTAINER*, PCB_LAYER_ID>, ZONE_FILL_INPUTS> previousFills;
+
     std::shared_ptr<CONNECTIVITY_DATA> connectivity = m_board->GetConnectivity();
     std::unique_lock<std::mutex> lock( connectivity->GetLock(), std::try_to_lock );
 
@@ -111,12 +122,28 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*>& aZones, bool aCheck, wxWin
     m_boardOutline.RemoveAllContours();
     m_brdOutlinesValid = m_board->GetBoardPolygonOutlines( m_boardOutline );
 
+    m_boardOutlineHash = hash_val( m_brdOutlinesValid );
+
+    for( auto it = m_boardOutline.CIterateWithHoles(); it; it++ )
+        hash_combine( m_boardOutlineHash, it->x, it->y );
+
+    m_initialFillSerials.clear();
+    m_changedFillAreas.clear();
+
     // Update and cache zone bounding boxes and pad effective shapes so that we don't have to
     // make them thread-safe.
     for( ZONE_CONTAINER* zone : m_board->Zones() )
     {
         zone->CacheBoundingBox();
         m_worstClearance = std::max( m_worstClearance, zone->GetLocalClearance() );
+
+        for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
+        {
+            const ZONE_FILL_INPUTS* inputs = zone->GetFillInputs( layer );
+
+            m_initialFillSerials[ { zone->m_Uuid.Hash(), layer } ] = inputs ? inputs->m_serial
+                                                                            : UNRECORDED_FILL;
+        }
     }
 
     for( MODULE* module : m_board->Modules() )
@@ -162,6 +189,17 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*>& aZones, bool aCheck, wxWin
 
         islandsList.emplace_back( CN_ZONE_ISOLATED_ISLAND_LIST( zone ) );
 
+        // Keep what the current fill was built from: if only a few items changed since, only
+        // the areas around them need to be refilled
+        if( zone->IsFilled() && zone->GetFillVersion() == bds.m_ZoneFillVersion )
+        {
+            for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
+            {
+                if( const ZONE_FILL_INPUTS* inputs = zone->GetFillInputs( layer ) )
+                    previousFills[ { zone, layer } ] = *inputs;
+            }
+        }
+
         // Remove existing fill first to prevent drawing invalid polygons
         // on some platforms
         zone->UnFill();
@@ -169,19 +207,20 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*>& aZones, bool aCheck, wxWin
         zone->SetFillVersion( bds.m_ZoneFillVersion );
     }
 
-    size_t cores = std::thread::hardware_concurrency();
+    THREAD_POOL&        tp = GetKiCadThreadPool();
     std::atomic<size_t> nextItem;
 
+    // Items are knocked out of a zone if their bounding box intersects the zone's one inflated
+    // by this much (see buildCopperItemClearances())
+    int knockoutMargin = m_worstClearance
+                            + Millimeter2iu( ADVANCED_CFG::GetCfg().m_ExtraClearance );
+
     auto check_fill_dependency =
             [&]( ZONE_CONTAINER* aZone, PCB_LAYER_ID aLayer, ZONE_CONTAINER* aOtherZone ) -> bool
             {
                 // Check to see if we have to knock-out the filled areas of a higher-priority
                 // zone.  If so we have to wait until said zone is filled before we can fill.
 
-                // If the other zone is already filled then we're good-to-go
-                if( aOtherZone->GetFillFlag( aLayer ) )
-                    return false;
-
                 // Even if keepouts exclude copper pours the exclusion is by outline, not by
                 // filled area, so we're good-to-go here too.
                 if( aOtherZone->GetIsRuleArea() )
@@ -201,100 +240,184 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*>& aZones, bool aCheck, wxWin
                 // A higher priority zone is found: if we intersect and it's not filled yet
                 // then we have to wait.
                 EDA_RECT inflatedBBox = aZone->GetCachedBoundingBox();
-                inflatedBBox.Inflate( m_worstClearance );
+                inflatedBBox.Inflate( knockoutMargin );
 
                 return inflatedBBox.Intersects( aOtherZone->GetCachedBoundingBox() );
             };
 
-    auto fill_lambda =
-            [&]( PROGRESS_REPORTER* aReporter )
-            {
-                size_t num = 0;
+    // Build the dependency graph of the fills.  A fill only depends on the fills of the same
+    // layer it knocks out, so each one can start as soon as these are done rather than
+    // waiting for a whole round of fills to complete, and a large fill only holds up the fills
+    // which actually need it.  The graph is the same whatever the number of threads, and so
+    // are the fills.
+    std::vector<std::vector<size_t>> dependents( toFill.size() );
+    std::vector<size_t>              pendingDependencies( toFill.size(), 0 );
+    std::map<PCB_LAYER_ID, std::vector<size_t>> fillsByLayer;
+
+    for( size_t ii = 0; ii < toFill.size(); ++ii )
+        fillsByLayer[ toFill[ii].second ].push_back( ii );
 
-                for( size_t i = nextItem++; i < toFill.size(); i = nextItem++ )
+    for( const std::pair<const PCB_LAYER_ID, std::vector<size_t>>& layerFills : fillsByLayer )
+    {
+        for( size_t ii : layerFills.second )
+        {
+            for( size_t jj : layerFills.second )
+            {
+                if( toFill[ii].first != toFill[jj].first
+                        && check_fill_dependency( toFill[ii].first, layerFills.first,
+                                                  toFill[jj].first ) )
                 {
-                    PCB_LAYER_ID    layer = toFill[i].second;
-                    ZONE_CONTAINER* zone = toFill[i].first;
-                    bool            canFill = true;
+                    dependents[jj].push_back( ii );
+                    pendingDependencies[ii]++;
+                }
+            }
+        }
+    }
 
-                    // Check for any fill dependencies.  If our zone needs to be clipped by
-                    // another zone then we can't fill until that zone is filled.
-                    for( ZONE_CONTAINER* otherZone : aZones )
-                    {
-                        if( otherZone == zone )
-                            continue;
+    // Among the fills which are ready to run, run the higher priority ones first as they are
+    // the ones others wait for, and then the larger ones first so that they don't end up
+    // running alone at the end.
+    auto runsAfter =
+            [&]( size_t a, size_t b ) -> bool
+            {
+                const ZONE_CONTAINER* zoneA = toFill[a].first;
+                const ZONE_CONTAINER* zoneB = toFill[b].first;
 
-                        if( check_fill_dependency( zone, layer, otherZone ) )
-                        {
-                            canFill = false;
-                            break;
-                        }
-                    }
+                if( zoneA->GetPriority() != zoneB->GetPriority() )
+                    return zoneA->GetPriority() < zoneB->GetPriority();
 
-                    if( m_progressReporter && m_progressReporter->IsCancelled() )
-                        break;
+                double areaA = (double) zoneA->GetCachedBoundingBox().GetWidth()
+                                    * zoneA->GetCachedBoundingBox().GetHeight();
+                double areaB = (double) zoneB->GetCachedBoundingBox().GetWidth()
+                                    * zoneB->GetCachedBoundingBox().GetHeight();
 
-                    if( !canFill )
-                        continue;
+                if( areaA != areaB )
+                    return areaA < areaB;
 
-                    // Now we're ready to fill.
-                    SHAPE_POLY_SET rawPolys, finalPolys;
-                    fillSingleZone( zone, layer, rawPolys, finalPolys );
+                if( toFill[a].second != toFill[b].second )
+                    return toFill[a].second > toFill[b].second;
 
-                    std::unique_lock<std::mutex> zoneLock( zone->GetLock() );
+                return a > b;
+            };
 
-                    zone->SetRawPolysList( layer, rawPolys );
-                    zone->SetFilledPolysList( layer, finalPolys );
-                    zone->SetFillFlag( layer, true );
+    std::mutex          readyLock;
+    std::vector<size_t> readyFills;     // heap ordered by runsAfter()
+    size_t              remainingFills = toFill.size();
+    std::promise<void>  allFilled;
+    std::future<void>   allFilledFuture = allFilled.get_future();
 
-                    if( m_progressReporter )
-                        m_progressReporter->AdvanceProgress();
+    auto fill_one =
+            [&]( size_t i )
+            {
+                PCB_LAYER_ID    layer = toFill[i].second;
+                ZONE_CONTAINER* zone = toFill[i].first;
 
-                    num++;
+                if( m_progressReporter && m_progressReporter->IsCancelled() )
+                    return;
+
+                SHAPE_POLY_SET   rawPolys, finalPolys;
+                ZONE_FILL_INPUTS inputs;
+                auto             previous = previousFills.find( toFill[i] );
+
+                if( zone->IsOnCopperLayer() )
+                    collectFillInputs( zone, layer, inputs );
+
+                if( previous == previousFills.end()
+                        || !updateSingleZone( zone, layer, previous->second, inputs,
+                                              rawPolys, finalPolys ) )
+                {
+                    fillSingleZone( zone, layer, rawPolys, finalPolys );
+                    inputs.m_serial = m_board->NewZoneFillSerial();
+
+                    std::lock_guard<std::mutex> changesLock( m_changedFillAreasLock );
+                    m_changedFillAreas[ layer ].emplace_back( zone,
+                                                              zone->GetCachedBoundingBox() );
                 }
 
-                return num;
+                std::unique_lock<std::mutex> zoneLock( zone->GetLock() );
+
+                zone->SetRawPolysList( layer, rawPolys );
+                zone->SetFilledPolysList( layer, finalPolys );
+                zone->SetFillInputs( layer, std::move( inputs ) );
+                zone->SetFillFlag( layer, true );
+
+                if( m_progressReporter )
+                    m_progressReporter->AdvanceProgress();
             };
 
-    while( !toFill.empty() )
-    {
-        size_t parallelThreadCount = std::min( cores, toFill.size() );
-        std::vector<std::future<size_t>> returns( parallelThreadCount );
+    // One task is queued for each fill which becomes ready; it runs the best fill ready at
+    // the time it starts.
+    std::function<void()> fill_task =
+            [&]()
+            {
+                size_t i;
 
-        nextItem = 0;
+                {
+                    std::lock_guard<std::mutex> guard( readyLock );
+                    std::pop_heap( readyFills.begin(), readyFills.end(), runsAfter );
+                    i = readyFills.back();
+                    readyFills.pop_back();
+                }
 
-        if( parallelThreadCount <= 1 )
-            fill_lambda( m_progressReporter );
-        else
-        {
-            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-                returns[ii] = std::async( std::launch::async, fill_lambda, m_progressReporter );
+                // Once cancelled the remaining fills are skipped, but still go through the
+                // graph so that the wait below ends
+                fill_one( i );
+
+                size_t newlyReady = 0;
+                bool   done = false;
 
-            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            {
-                // Here we balance returns with a 100ms timeout to allow UI updating
-                std::future_status status;
-                do
                 {
-                    if( m_progressReporter )
-                        m_progressReporter->KeepRefreshing();
+                    std::lock_guard<std::mutex> guard( readyLock );
+
+                    for( size_t dependent : dependents[i] )
+                    {
+                        if( --pendingDependencies[dependent] == 0 )
+                        {
+                            readyFills.push_back( dependent );
+                            std::push_heap( readyFills.begin(), readyFills.end(), runsAfter );
+                            newlyReady++;
+                        }
+                    }
+
+                    done = --remainingFills == 0;
+                }
+
+                for( size_t ii = 0; ii < newlyReady; ++ii )
+                    tp.Submit( fill_task );
+
+                // Nothing of this frame may be touched once this is set
+                if( done )
+                    allFilled.set_value();
+            };
+
+    if( toFill.empty() )
+    {
+        allFilled.set_value();
+    }
+    else
+    {
+        std::lock_guard<std::mutex> guard( readyLock );
 
-                    status = returns[ii].wait_for( std::chrono::milliseconds( 100 ) );
-                } while( status != std::future_status::ready );
+        for( size_t ii = 0; ii < toFill.size(); ++ii )
+        {
+            if( pendingDependencies[ii] == 0 )
+            {
+                readyFills.push_back( ii );
+                std::push_heap( readyFills.begin(), readyFills.end(), runsAfter );
             }
         }
 
-        toFill.erase( std::remove_if( toFill.begin(), toFill.end(),
-                      [&] ( const std::pair<ZONE_CONTAINER*, PCB_LAYER_ID> pair ) -> bool
-                      {
-                          return pair.first->GetFillFlag( pair.second );
-                      } ),
-                      toFill.end() );
-
-        if( m_progressReporter && m_progressReporter->IsCancelled() )
-            break;
+        for( size_t ii = 0; ii < readyFills.size(); ++ii )
+            tp.Submit( fill_task );
     }
 
+    // Keep the UI refreshing while we wait
+    tp.Wait( allFilledFuture, [&]()
+                              {
+                                  if( m_progressReporter )
+                                      m_progressReporter->KeepRefreshing();
+                              } );
+
     // Now update the connectivity to check for copper islands
     if( m_progressReporter )
     {
@@ -322,75 +445,126 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*>& aZones, bool aCheck, wxWin
         zone->SetIsFilled( true );
     }
 
-    // Now remove insulated copper islands
+    // Now remove insulated copper islands, and then islands outside the board edge.  Each
+    // zone only touches its own fills here, so zones are processed in parallel.
+    std::map<ZONE_CONTAINER*, CN_ZONE_ISOLATED_ISLAND_LIST*> zoneIslands;
+
     for( CN_ZONE_ISOLATED_ISLAND_LIST& zone : islandsList )
-    {
-        for( PCB_LAYER_ID layer : zone.m_zone->GetLayerSet().Seq() )
-        {
-            if( m_debugZoneFiller && LSET::InternalCuMask().Contains( layer ) )
-                continue;
+        zoneIslands[ zone.m_zone ] = &zone;
 
-            if( !zone.m_islands.count( layer ) )
-                continue;
+    auto remove_islands =
+            [&]( ZONE_CONTAINER* aZone )
+            {
+                auto it = zoneIslands.find( aZone );
+
+                for( PCB_LAYER_ID layer : aZone->GetLayerSet().Seq() )
+                {
+                    if( it == zoneIslands.end() )
+                        break;
 
-            std::vector<int>& islands = zone.m_islands.at( layer );
+                    if( m_debugZoneFiller && LSET::InternalCuMask().Contains( layer ) )
+                        continue;
 
-            // The list of polygons to delete must be explored from last to first in list,
-            // to allow deleting a polygon from list without breaking the remaining of the list
-            std::sort( islands.begin(), islands.end(), std::greater<int>() );
+                    if( !it->second->m_islands.count( layer ) )
+                        continue;
 
-            SHAPE_POLY_SET      poly = zone.m_zone->GetFilledPolysList( layer );
-            long long int       minArea = zone.m_zone->GetMinIslandArea();
-            ISLAND_REMOVAL_MODE mode    = zone.m_zone->GetIslandRemovalMode();
+                    std::vector<int>& islands = it->second->m_islands.at( layer );
 
-            for( int idx : islands )
-            {
-                SHAPE_LINE_CHAIN& outline = poly.Outline( idx );
-
-                if( mode == ISLAND_REMOVAL_MODE::ALWAYS )
-                    poly.DeletePolygon( idx );
-                else if ( mode == ISLAND_REMOVAL_MODE::AREA && outline.Area() < minArea )
-                    poly.DeletePolygon( idx );
-                else
-                    zone.m_zone->SetIsIsland( layer, idx );
-            }
+                    // The list of polygons to delete must be explored from last to first in
+                    // list, to allow deleting a polygon from list without breaking the
+                    // remaining of the list
+                    std::sort( islands.begin(), islands.end(), std::greater<int>() );
 
-            zone.m_zone->SetFilledPolysList( layer, poly );
-            zone.m_zone->CalculateFilledArea();
+                    SHAPE_POLY_SET      poly = aZone->GetFilledPolysList( layer );
+                    long long int       minArea = aZone->GetMinIslandArea();
+                    ISLAND_REMOVAL_MODE mode    = aZone->GetIslandRemovalMode();
 
-            if( m_progressReporter && m_progressReporter->IsCancelled() )
-                return false;
-        }
-    }
+                    for( int idx : islands )
+                    {
+                        SHAPE_LINE_CHAIN& outline = poly.Outline( idx );
 
-    // Now remove islands outside the board edge
-    for( ZONE_CONTAINER* zone : aZones )
-    {
-        LSET zoneCopperLayers = zone->GetLayerSet() & LSET::AllCuMask( MAX_CU_LAYERS );
+                        if( mode == ISLAND_REMOVAL_MODE::ALWAYS )
+                            poly.DeletePolygon( idx );
+                        else if ( mode == ISLAND_REMOVAL_MODE::AREA && outline.Area() < minArea )
+                            poly.DeletePolygon( idx );
+                        else
+                            aZone->SetIsIsland( layer, idx );
+                    }
 
-        for( PCB_LAYER_ID layer : zoneCopperLayers.Seq() )
-        {
-            if( m_debugZoneFiller && LSET::InternalCuMask().Contains( layer ) )
-                continue;
+                    aZone->SetFilledPolysList( layer, poly );
+                    aZone->CalculateFilledArea();
+
+                    if( m_progressReporter && m_progressReporter->IsCancelled() )
+                        return;
+                }
+
+                LSET zoneCopperLayers = aZone->GetLayerSet() & LSET::AllCuMask( MAX_CU_LAYERS );
+
+                for( PCB_LAYER_ID layer : zoneCopperLayers.Seq() )
+                {
+                    if( m_debugZoneFiller && LSET::InternalCuMask().Contains( layer ) )
+                        continue;
+
+                    SHAPE_POLY_SET poly = aZone->GetFilledPolysList( layer );
+
+                    for( int ii = poly.OutlineCount() - 1; ii >= 0; ii-- )
+                    {
+                        std::vector<SHAPE_LINE_CHAIN>& island = poly.Polygon( ii );
+
+                        if( island.empty()
+                                || !m_boardOutline.Contains( island.front().CPoint( 0 ) ) )
+                        {
+                            poly.DeletePolygon( ii );
+                        }
+                    }
 
-            SHAPE_POLY_SET poly = zone->GetFilledPolysList( layer );
+                    aZone->SetFilledPolysList( layer, poly );
+                    aZone->CalculateFilledArea();
 
-            for( int ii = poly.OutlineCount() - 1; ii >= 0; ii-- )
+                    if( m_progressReporter && m_progressReporter->IsCancelled() )
+                        return;
+                }
+            };
+
+    auto islands_lambda =
+            [&]() -> size_t
             {
-                std::vector<SHAPE_LINE_CHAIN>& island = poly.Polygon( ii );
+                size_t num = 0;
 
-                if( island.empty() || !m_boardOutline.Contains( island.front().CPoint( 0 ) ) )
-                    poly.DeletePolygon( ii );
-            }
+                for( size_t i = nextItem++; i < aZones.size(); i = nextItem++ )
+                {
+                    if( m_progressReporter && m_progressReporter->IsCancelled() )
+                        break;
 
-            zone->SetFilledPolysList( layer, poly );
-            zone->CalculateFilledArea();
+                    remove_islands( aZones[i] );
+                    num++;
+                }
 
-            if( m_progressReporter && m_progressReporter->IsCancelled() )
-                return false;
-        }
+                return num;
+            };
+
+    nextItem = 0;
+
+    size_t islandThreadCount = std::min( tp.GetThreadCount(), aZones.size() );
+    std::vector<std::future<size_t>> islandReturns;
+
+    if( islandThreadCount <= 1 )
+        islands_lambda();
+    else
+    {
+        for( size_t ii = 0; ii < islandThreadCount; ++ii )
+            islandReturns.push_back( tp.Submit( islands_lambda ) );
+
+        tp.WaitAll( islandReturns, [&]()
+                                   {
+                                       if( m_progressReporter )
+                                           m_progressReporter->KeepRefreshing();
+                                   } );
     }
 
+    if( m_progressReporter && m_progressReporter->IsCancelled() )
+        return false;
+
     if( aCheck )
     {
         bool outOfDate = false;
@@ -456,33 +630,27 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*>& aZones, bool aCheck, wxWin
                 return num;
             };
 
-    size_t parallelThreadCount = std::min( cores, islandsList.size() );
-    std::vector<std::future<size_t>> returns( parallelThreadCount );
+    size_t parallelThreadCount = std::min( tp.GetThreadCount(), islandsList.size() );
+    std::vector<std::future<size_t>> returns;
 
     if( parallelThreadCount <= 1 )
         tri_lambda( m_progressReporter );
     else
     {
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii] = std::async( std::launch::async, tri_lambda, m_progressReporter );
-
         for( size_t ii = 0; ii < parallelThreadCount; ++ii )
         {
-            // Here we balance returns with a 100ms timeout to allow UI updating
-            std::future_status status;
-            do
-            {
-                if( m_progressReporter )
-                {
-                    m_progressReporter->KeepRefreshing();
-
-                    if( m_progressReporter->IsCancelled() )
-                        break;
-                }
-
-                status = returns[ii].wait_for( std::chrono::milliseconds( 100 ) );
-            } while( status != std::future_status::ready );
+            returns.push_back( tp.Submit( [&]()
+                                          {
+                                              return tri_lambda( m_progressReporter );
+                                          } ) );
         }
+
+        // Keep the UI refreshing while we wait; the workers stop early on cancellation
+        tp.WaitAll( returns, [&]()
+                             {
+                                 if( m_progressReporter )
+                                     m_progressReporter->KeepRefreshing();
+                             } );
     }
 
     if( m_progressReporter )
@@ -652,7 +820,7 @@ void ZONE_FILLER::addKnockout( BOARD_ITEM* aItem, PCB_LAYER_ID aLayer, int aGap,
  * in spokes, which must be done later.
  */
 void ZONE_FILLER::knockoutThermalReliefs( const ZONE_CONTAINER* aZone, PCB_LAYER_ID aLayer,
-                                          SHAPE_POLY_SET& aFill )
+                                          const EDA_RECT& aArea, SHAPE_POLY_SET& aFill )
 {
     SHAPE_POLY_SET holes;
 
@@ -670,6 +838,12 @@ void ZONE_FILLER::knockoutThermalReliefs( const ZONE_CONTAINER* aZone, PCB_LAYER
             if( !hasThermalConnection( pad, aZone ) )
                 continue;
 
+            EDA_RECT reliefBBox = pad->GetBoundingBox();
+            reliefBBox.Inflate( aZone->GetThermalReliefGap( pad ) );
+
+            if( !reliefBBox.Intersects( aArea ) )
+                continue;
+
             // If the pad isn't on the current layer but has a hole, knock out a thermal relief
             // for the hole.
             if( !pad->IsOnLayer( aLayer ) )
@@ -694,7 +868,7 @@ void ZONE_FILLER::knockoutThermalReliefs( const ZONE_CONTAINER* aZone, PCB_LAYER
  * not connected to it.
  */
 void ZONE_FILLER::buildCopperItemClearances( const ZONE_CONTAINER* aZone, PCB_LAYER_ID aLayer,
-                                             SHAPE_POLY_SET& aHoles )
+                                             const EDA_RECT& aArea, SHAPE_POLY_SET& aHoles )
 {
     long ticker = 0;
 
@@ -716,7 +890,7 @@ void ZONE_FILLER::buildCopperItemClearances( const ZONE_CONTAINER* aZone, PCB_LA
 
     BOARD_DESIGN_SETTINGS& bds = m_board->GetDesignSettings();
     int                    zone_clearance = aZone->GetLocalClearance();
-    EDA_RECT               zone_boundingbox = aZone->GetCachedBoundingBox();
+    EDA_RECT               zone_boundingbox = aArea;
 
     // Items outside the zone bounding box are skipped, so it needs to be inflated by the
     // largest clearance value found in the netclasses and rules
@@ -846,6 +1020,9 @@ void ZONE_FILLER::buildCopperItemClearances( const ZONE_CONTAINER* aZone, PCB_LA
                 if( !aItem->IsOnLayer( aLayer ) && !aItem->IsOnLayer( Edge_Cuts ) )
                     return;
 
+                if( !inReach( aItem->GetBoundingBox(), worstEdgeGap, zone_boundingbox ) )
+                    return;
+
                 if( aItem->GetBoundingBox().Intersects( zone_boundingbox ) )
                 {
                     int gap = evalRulesForItems( DRC_CONSTRAINT_TYPE_CLEARANCE, aZone, aItem,
@@ -956,8 +1133,6 @@ void ZONE_FILLER::buildCopperItemClearances( const ZONE_CONTAINER* aZone, PCB_LA
             }
         }
     }
-
-    aHoles.Simplify( SHAPE_POLY_SET::PM_FAST );
 }
 
 
@@ -1032,7 +1207,7 @@ bool ZONE_FILLER::computeRawFilledArea( const ZONE_CONTAINER* aZone,
                                         PCB_LAYER_ID aLayer, PCB_LAYER_ID aDebugLayer,
                                         const SHAPE_POLY_SET& aSmoothedOutline,
                                         const SHAPE_POLY_SET& aMaxExtents,
-                                        SHAPE_POLY_SET& aRawPolys )
+                                        const EDA_RECT& aArea, SHAPE_POLY_SET& aRawPolys )
 {
     m_maxError = m_board->GetDesignSettings().m_MaxError;
 
@@ -1065,19 +1240,38 @@ bool ZONE_FILLER::computeRawFilledArea( const ZONE_CONTAINER* aZone,
     if( m_progressReporter && m_progressReporter->IsCancelled() )
         return false;
 
-    knockoutThermalReliefs( aZone, aLayer, aRawPolys );
+    knockoutThermalReliefs( aZone, aLayer, aArea, aRawPolys );
     DUMP_POLYS_TO_COPPER_LAYER( aRawPolys, In2_Cu, "minus-thermal-reliefs" );
 
     if( m_progressReporter && m_progressReporter->IsCancelled() )
         return false;
 
-    buildCopperItemClearances( aZone, aLayer, clearanceHoles );
+    buildCopperItemClearances( aZone, aLayer, aArea, clearanceHoles );
+
+    if( m_clearanceHolesObserver )
+        m_clearanceHolesObserver( aZone, aLayer, aRawPolys, clearanceHoles );
+
+    // There are often thousands of holes, which are much faster to merge by groups, in
+    // parallel.  The result rounds intersections differently though, so it's optional.
+    if( ADVANCED_CFG::GetCfg().m_ZoneFillMergeByGroups )
+    {
+        clearanceHoles.SimplifyByGroups( SHAPE_POLY_SET::PM_FAST,
+                []( std::vector<std::function<void()>>& aTasks )
+                {
+                    GetKiCadThreadPool().RunAll( aTasks );
+                } );
+    }
+    else
+    {
+        clearanceHoles.Simplify( SHAPE_POLY_SET::PM_FAST );
+    }
+
     DUMP_POLYS_TO_COPPER_LAYER( clearanceHoles, In3_Cu, "clearance-holes" );
 
     if( m_progressReporter && m_progressReporter->IsCancelled() )
         return false;
 
-    buildThermalSpokes( aZone, aLayer, thermalSpokes );
+    buildThermalSpokes( aZone, aLayer, aArea, thermalSpokes );
 
     if( m_progressReporter && m_progressReporter->IsCancelled() )
         return false;
@@ -1102,47 +1296,78 @@ bool ZONE_FILLER::computeRawFilledArea( const ZONE_CONTAINER* aZone,
     if( m_progressReporter && m_progressReporter->IsCancelled() )
         return false;
 
-    // Spoke-end-testing is hugely expensive so we generate cached bounding-boxes to speed
-    // things up a bit.
+    // Spoke-end-testing is hugely expensive so we generate cached bounding-boxes and a grid
+    // of the contours to speed things up.
     testAreas.BuildBBoxCaches();
-    int interval = 0;
+    testAreas.EnableContainsCache();
 
-    SHAPE_POLY_SET debugSpokes;
+    // Spokes are tested in chunks, in parallel for zones with many of them.  The spokes to
+    // keep are then added in their original order so the result doesn't depend on threading.
+    static const size_t SPOKE_TEST_CHUNK = 256;
+    std::vector<char>   keepSpoke( thermalSpokes.size(), 0 );
+
+    auto testSpokes =
+            [&]( size_t aFirst, size_t aLast ) -> size_t
+            {
+                if( m_progressReporter && m_progressReporter->IsCancelled() )
+                    return 0;
 
-    for( const SHAPE_LINE_CHAIN& spoke : thermalSpokes )
+                for( size_t ii = aFirst; ii < aLast; ++ii )
+                {
+                    const SHAPE_LINE_CHAIN& spoke = thermalSpokes[ii];
+                    const VECTOR2I&         testPt = spoke.CPoint( 3 );
+
+                    // Hit-test against zone body
+                    if( testAreas.Contains( testPt, -1, 1, USE_BBOX_CACHES ) )
+                    {
+                        keepSpoke[ii] = 1;
+                        continue;
+                    }
+
+                    // Hit-test against other spokes
+                    for( const SHAPE_LINE_CHAIN& other : thermalSpokes )
+                    {
+                        if( &other != &spoke && other.PointInside( testPt, 1, USE_BBOX_CACHES ) )
+                        {
+                            keepSpoke[ii] = 1;
+                            break;
+                        }
+                    }
+                }
+
+                return aLast - aFirst;
+            };
+
+    THREAD_POOL&                     tp = GetKiCadThreadPool();
+    std::vector<std::future<size_t>> returns;
+
+    for( size_t first = SPOKE_TEST_CHUNK; first < thermalSpokes.size(); first += SPOKE_TEST_CHUNK )
     {
-        const VECTOR2I& testPt = spoke.CPoint( 3 );
+        size_t last = std::min( first + SPOKE_TEST_CHUNK, thermalSpokes.size() );
 
-        // Hit-test against zone body
-        if( testAreas.Contains( testPt, -1, 1, USE_BBOX_CACHES ) )
-        {
-            if( m_debugZoneFiller )
-                debugSpokes.AddOutline( spoke );
+        returns.push_back( tp.Submit( [&testSpokes, first, last]()
+                                      {
+                                          return testSpokes( first, last );
+                                      } ) );
+    }
 
-            aRawPolys.AddOutline( spoke );
-            continue;
-        }
+    testSpokes( 0, std::min( SPOKE_TEST_CHUNK, thermalSpokes.size() ) );
+    tp.WaitAll( returns );
 
-        if( interval++ > 400 )
-        {
-            if( m_progressReporter && m_progressReporter->IsCancelled() )
-                return false;
+    if( m_progressReporter && m_progressReporter->IsCancelled() )
+        return false;
 
-            interval = 0;
-        }
+    SHAPE_POLY_SET debugSpokes;
 
-        // Hit-test against other spokes
-        for( const SHAPE_LINE_CHAIN& other : thermalSpokes )
-        {
-            if( &other != &spoke && other.PointInside( testPt, 1, USE_BBOX_CACHES  ) )
-            {
-                if( m_debugZoneFiller )
-                    debugSpokes.AddOutline( spoke );
+    for( size_t ii = 0; ii < thermalSpokes.size(); ++ii )
+    {
+        if( !keepSpoke[ii] )
+            continue;
 
-                aRawPolys.AddOutline( spoke );
-                break;
-            }
-        }
+        if( m_debugZoneFiller )
+            debugSpokes.AddOutline( thermalSpokes[ii] );
+
+        aRawPolys.AddOutline( thermalSpokes[ii] );
     }
 
     DUMP_POLYS_TO_COPPER_LAYER( debugSpokes, In7_Cu, "spokes" );
@@ -1233,7 +1458,8 @@ bool ZONE_FILLER::fillSingleZone( ZONE_CONTAINER* aZone, PCB_LAYER_ID aLayer,
 
     if( aZone->IsOnCopperLayer() )
     {
-        if( computeRawFilledArea( aZone, aLayer, debugLayer, smoothedPoly, maxExtents, aRawPolys ) )
+        if( computeRawFilledArea( aZone, aLayer, debugLayer, smoothedPoly, maxExtents,
+                                  aZone->GetCachedBoundingBox(), aRawPolys ) )
             aZone->SetNeedRefill( false );
 
         aFinalPolys = aRawPolys;
@@ -1275,13 +1501,539 @@ bool ZONE_FILLER::fillSingleZone( ZONE_CONTAINER* aZone, PCB_LAYER_ID aLayer,
 }
 
 
+static SHAPE_LINE_CHAIN rectangleOutline( const EDA_RECT& aRect )
+{
+    SHAPE_LINE_CHAIN outline;
+
+    outline.Append( aRect.GetLeft(), aRect.GetTop() );
+    outline.Append( aRect.GetRight(), aRect.GetTop() );
+    outline.Append( aRect.GetRight(), aRect.GetBottom() );
+    outline.Append( aRect.GetLeft(), aRect.GetBottom() );
+    outline.SetClosed( true );
+
+    return outline;
+}
+
+
+void ZONE_FILLER::collectFillInputs( const ZONE_CONTAINER* aZone, PCB_LAYER_ID aLayer,
+                                     ZONE_FILL_INPUTS& aInputs )
+{
+    // Absolute positions, and the reference and value texts which are knocked out too
+    const int flags = HASH_POS | HASH_ROT | HASH_LAYER | HASH_NET | HASH_REF | HASH_VALUE
+                      | HASH_FILL;
+
+    BOARD_DESIGN_SETTINGS& bds = m_board->GetDesignSettings();
+    int                    extra_margin = Millimeter2iu( ADVANCED_CFG::GetCfg().m_ExtraClearance );
+    int                    epsilon = KiROUND( IU_PER_MM * 0.04 );
+    EDA_RECT               zone_boundingbox = aZone->GetCachedBoundingBox();
+
+    // Same item selection as buildCopperItemClearances()
+    zone_boundingbox.Inflate( m_worstClearance + extra_margin );
+
+    aInputs.m_settingsHash = hash_eda( aZone, flags );
+    hash_combine( aInputs.m_settingsHash, aLayer, bds.m_MaxError, bds.m_ZoneFillVersion,
+                  bds.GetHolePlatingThickness(), m_worstClearance, extra_margin,
+                  m_boardOutlineHash );
+
+    aInputs.m_items.clear();
+
+    MODULE  dummymodule( m_board );
+    D_PAD   dummypad( &dummymodule );
+
+    auto evalRulesForItems =
+            [&]( DRC_CONSTRAINT_TYPE_T aConstraint, const BOARD_ITEM* a, const BOARD_ITEM* b,
+                 PCB_LAYER_ID aCtLayer ) -> int
+            {
+                DRC_CONSTRAINT c = bds.m_DRCEngine->EvalRulesForItems( aConstraint, a, b, aCtLayer );
+                return c.Value().HasMin() ? c.Value().Min() : 0;
+            };
+
+    auto inReach =
+            []( EDA_RECT aBox, int aGap, const EDA_RECT& aArea ) -> bool
+            {
+                aBox.Inflate( aGap );
+                return aBox.Intersects( aArea );
+            };
+
+    auto addInput =
+            [&]( const BOARD_ITEM* aItem, EDA_RECT aReach, int aGap, size_t aHash,
+                 unsigned aFillSerial )
+            {
+                aReach.Inflate( aGap );
+
+                if( aReach.Intersects( zone_boundingbox ) )
+                    aInputs.m_items.push_back( { aItem->m_Uuid.Hash(), aHash, aFillSerial, aReach } );
+            };
+
+    // Resolving clearances is the expensive part, so first drop the items which are out of
+    // reach even at the worst clearance.  Most items of a board are, for any one zone.
+    DRC_CONSTRAINT worstEdgeConstraint;
+
+    bds.m_DRCEngine->QueryWorstConstraint( DRC_CONSTRAINT_TYPE_EDGE_CLEARANCE,
+                                           worstEdgeConstraint, DRCCQ_LARGEST_MINIMUM );
+
+    int worstGap = m_worstClearance + extra_margin + bds.GetHolePlatingThickness();
+    int worstEdgeGap = std::max( worstGap, worstEdgeConstraint.Value().HasMin()
+                                                   ? worstEdgeConstraint.Value().Min() : 0 );
+
+    // Pads: clearances, thermal reliefs and spokes
+    //
+    for( MODULE* module : m_board->Modules() )
+    {
+        for( D_PAD* pad : module->Pads() )
+        {
+            D_PAD* knockout = pad;
+
+            if( !pad->FlashLayer( aLayer ) )
+            {
+                if( pad->GetDrillSize().x == 0 && pad->GetDrillSize().y == 0 )
+                    continue;
+
+                setupDummyPadForHole( pad, dummypad );
+                knockout = &dummypad;
+            }
+
+            int thermalGap = aZone->GetThermalReliefGap( pad );
+            int knockoutThermalGap = aZone->GetThermalReliefGap( knockout );
+            int worstPadGap = std::max( { worstGap, thermalGap + epsilon, knockoutThermalGap,
+                                          aZone->GetLocalClearance() } );
+
+            if( !inReach( pad->GetBoundingBox(), worstPadGap, zone_boundingbox ) )
+                continue;
+
+            int gap;
+
+            if( knockout->GetNetCode() > 0 && knockout->GetNetCode() == aZone->GetNetCode() )
+            {
+                gap = std::max( aZone->GetLocalClearance(), knockoutThermalGap );
+            }
+            else
+            {
+                gap = evalRulesForItems( DRC_CONSTRAINT_TYPE_CLEARANCE, aZone, knockout, aLayer );
+            }
+
+            size_t hash = hash_eda( pad, flags );
+
+            hash_combine( hash, pad->FlashLayer( aLayer ), aZone->GetPadConnection( knockout ),
+                          gap, knockoutThermalGap, thermalGap,
+                          aZone->GetThermalReliefSpokeWidth( pad ) );
+
+            addInput( pad, pad->GetBoundingBox(), std::max( gap, thermalGap + epsilon ), hash, 0 );
+        }
+    }
+
+    // Tracks and vias which are not connected to the zone
+    //
+    for( TRACK* track : m_board->Tracks() )
+    {
+        if( !track->IsOnLayer( aLayer ) )
+            continue;
+
+        if( track->GetNetCode() == aZone->GetNetCode()  && ( aZone->GetNetCode() != 0) )
+            continue;
+
+        if( !inReach( track->GetBoundingBox(), worstGap, zone_boundingbox ) )
+            continue;
+
+        int    gap = evalRulesForItems( DRC_CONSTRAINT_TYPE_CLEARANCE, aZone, track, aLayer );
+        size_t hash = hash_eda( track, flags );
+
+        gap += extra_margin;
+        hash_combine( hash, gap );
+
+        if( track->Type() == PCB_VIA_T )
+        {
+            // Unflashed vias are knocked out by their hole, which can be plated a bit larger
+            hash_combine( hash, static_cast<VIA*>( track )->FlashLayer( aLayer ) );
+            gap += bds.GetHolePlatingThickness();
+        }
+
+        addInput( track, track->GetBoundingBox(), gap, hash, 0 );
+    }
+
+    // Graphic items
+    //
+    auto addGraphic =
+            [&]( BOARD_ITEM* aItem )
+            {
+                switch( aItem->Type() )
+                {
+                case PCB_SHAPE_T:
+                case PCB_TEXT_T:
+                case PCB_FP_SHAPE_T:
+                case PCB_FP_TEXT_T:
+                    break;
+
+                default:
+                    // Not knocked out by addKnockout()
+                    return;
+                }
+
+                if( !aItem->IsOnLayer( aLayer ) && !aItem->IsOnLayer( Edge_Cuts ) )
+                    return;
+
+                if( !inReach( aItem->GetBoundingBox(), worstEdgeGap, zone_boundingbox ) )
+                    return;
+
+                int    gap = evalRulesForItems( DRC_CONSTRAINT_TYPE_CLEARANCE, aZone, aItem,
+                                                aLayer );
+                size_t hash = hash_eda( aItem, flags );
+
+                if( aItem->IsOnLayer( Edge_Cuts ) )
+                {
+                    gap = std::max( gap, evalRulesForItems( DRC_CONSTRAINT_TYPE_EDGE_CLEARANCE,
+                                                            aZone, aItem, Edge_Cuts ) );
+                }
+
+                // Footprint text angles are relative to the footprint
+                if( aItem->Type() == PCB_FP_TEXT_T )
+                    hash_combine( hash, static_cast<FP_TEXT*>( aItem )->GetDrawRotation() );
+
+                hash_combine( hash, gap );
+                addInput( aItem, aItem->GetBoundingBox(), gap, hash, 0 );
+            };
+
+    for( MODULE* module : m_board->Modules() )
+    {
+        addGraphic( &module->Reference() );
+        addGraphic( &module->Value() );
+
+        for( BOARD_ITEM* item : module->GraphicalItems() )
+            addGraphic( item );
+    }
+
+    for( BOARD_ITEM* item : m_board->Drawings() )
+        addGraphic( item );
+
+    // Other zones: knocked out with clearance, or subtracted by outline (see
+    // buildCopperItemClearances() and subtractHigherPriorityZones())
+    //
+    auto addZone =
+            [&]( ZONE_CONTAINER* aOther )
+            {
+                if( aOther == aZone || !aOther->GetLayerSet().test( aLayer ) )
+                    return;
+
+                bool higherPriority = aOther->GetPriority() > aZone->GetPriority();
+                bool sameNet = aOther->GetNetCode() == aZone->GetNetCode();
+                bool knockout = ( !sameNet && higherPriority )
+                                    || ( aOther->GetIsRuleArea()
+                                         && aOther->GetDoNotAllowCopperPour() );
+
+                if( !knockout && !( sameNet && higherPriority ) )
+                    return;
+
+                if( !inReach( aOther->GetCachedBoundingBox(), worstGap, zone_boundingbox ) )
+                    return;
+
+                size_t   hash = hash_eda( aOther, flags );
+                int      gap = 0;
+                unsigned fillSerial = 0;
+
+                if( knockout && !aOther->GetIsRuleArea() )
+                {
+                    gap = evalRulesForItems( DRC_CONSTRAINT_TYPE_CLEARANCE, aZone, aOther,
+                                             aLayer );
+
+                    // 6.0 knocks out the other zone's fill rather than its outline
+                    if( bds.m_ZoneFillVersion != 5 )
+                    {
+                        std::unique_lock<std::mutex> otherLock( aOther->GetLock() );
+                        const ZONE_FILL_INPUTS*      otherFill = aOther->GetFillInputs( aLayer );
+
+                        fillSerial = otherFill ? otherFill->m_serial : UNRECORDED_FILL;
+                    }
+                }
+
+                hash_combine( hash, knockout, gap );
+                addInput( aOther, aOther->GetCachedBoundingBox(), gap, hash, fillSerial );
+            };
+
+    for( ZONE_CONTAINER* otherZone : m_board->Zones() )
+        addZone( otherZone );
+
+    for( MODULE* module : m_board->Modules() )
+    {
+        for( ZONE_CONTAINER* otherZone : module->Zones() )
+            addZone( otherZone );
+    }
+
+    std::sort( aInputs.m_items.begin(), aInputs.m_items.end(),
+               []( const ZONE_FILL_INPUT& lhs, const ZONE_FILL_INPUT& rhs )
+               {
+                   return lhs.m_id < rhs.m_id || ( lhs.m_id == rhs.m_id && lhs.m_hash < rhs.m_hash );
+               } );
+}
+
+
+bool ZONE_FILLER::findChangedAreas( const ZONE_CONTAINER* aZone, PCB_LAYER_ID aLayer,
+                                    const ZONE_FILL_INPUTS& aPrevious,
+                                    const ZONE_FILL_INPUTS& aCurrent,
+                                    std::vector<EDA_RECT>& aAreas )
+{
+    // Hatch patterns are laid out over the whole zone, and non-copper zones don't depend on
+    // other items (and are cheap to refill anyway)
+    if( m_debugZoneFiller || aZone->GetFillMode() != ZONE_FILL_MODE::POLYGONS
+            || !aZone->IsOnCopperLayer() )
+    {
+        return false;
+    }
+
+    if( aPrevious.m_settingsHash != aCurrent.m_settingsHash )
+        return false;
+
+    // A zone knocking out by its fill may have been refilled since; if so the whole of it has
+    // to be taken as changed.  Changes made to it by this Fill() are published separately.
+    auto fillChangedBefore =
+            [&]( const ZONE_FILL_INPUT& aInput ) -> bool
+            {
+                if( aInput.m_fillSerial == 0 )
+                    return false;
+
+                auto it = m_initialFillSerials.find( { aInput.m_id, aLayer } );
+                unsigned initialSerial = it != m_initialFillSerials.end() ? it->second
+                                                                          : UNRECORDED_FILL;
+
+                return aInput.m_fillSerial != initialSerial;
+            };
+
+    auto prev = aPrevious.m_items.begin();
+    auto cur = aCurrent.m_items.begin();
+
+    while( prev != aPrevious.m_items.end() || cur != aCurrent.m_items.end() )
+    {
+        if( cur == aCurrent.m_items.end()
+                || ( prev != aPrevious.m_items.end() && prev->m_id < cur->m_id ) )
+        {
+            // Removed item
+            aAreas.push_back( prev->m_reach );
+            ++prev;
+        }
+        else if( prev == aPrevious.m_items.end() || cur->m_id < prev->m_id )
+        {
+            // Added item
+            aAreas.push_back( cur->m_reach );
+            ++cur;
+        }
+        else
+        {
+            if( prev->m_hash != cur->m_hash )
+            {
+                aAreas.push_back( prev->m_reach );
+                aAreas.push_back( cur->m_reach );
+            }
+            else if( fillChangedBefore( *prev ) )
+            {
+                aAreas.push_back( cur->m_reach );
+            }
+
+            ++prev;
+            ++cur;
+        }
+    }
+
+    int extra_margin = Millimeter2iu( ADVANCED_CFG::GetCfg().m_ExtraClearance );
+
+    {
+        std::lock_guard<std::mutex> lock( m_changedFillAreasLock );
+
+        for( const std::pair<const ZONE_CONTAINER*, EDA_RECT>& change : m_changedFillAreas[aLayer] )
+        {
+            if( change.first == aZone || change.first->GetNetCode() == aZone->GetNetCode()
+                    || change.first->GetPriority() <= aZone->GetPriority() )
+            {
+                continue;
+            }
+
+            EDA_RECT area = change.second;
+            area.Inflate( m_worstClearance + extra_margin );
+            aAreas.push_back( area );
+        }
+    }
+
+    // Refilling many or large areas is no faster than refilling the zone
+    EDA_RECT zoneBBox = aZone->GetCachedBoundingBox();
+    double   changedArea = 0.0;
+
+    aAreas.erase( std::remove_if( aAreas.begin(), aAreas.end(),
+                                  [&]( const EDA_RECT& aArea )
+                                  {
+                                      return !aArea.Intersects( zoneBBox );
+                                  } ),
+                  aAreas.end() );
+
+    for( const EDA_RECT& area : aAreas )
+    {
+        EDA_RECT inflated = area;
+        inflated.Inflate( 4 * aZone->GetMinThickness() );
+        changedArea += inflated.GetArea();
+    }
+
+    return aAreas.size() <= 64 && changedArea < zoneBBox.GetArea() / 2;
+}
+
+
+bool ZONE_FILLER::refillAreas( const ZONE_CONTAINER* aZone, PCB_LAYER_ID aLayer,
+                               std::vector<EDA_RECT>& aAreas, SHAPE_POLY_SET& aRawPolys )
+{
+    SHAPE_POLY_SET* boardOutline = m_brdOutlinesValid ? &m_boardOutline : nullptr;
+    SHAPE_POLY_SET  maxExtents;
+    SHAPE_POLY_SET  smoothedPoly;
+
+    if( !aZone->BuildSmoothedPoly( maxExtents, aLayer, boardOutline, &smoothedPoly ) )
+        return false;
+
+    // Pruning features narrower than the minimum width (and the spoke tests, which are done
+    // on the pruned fill) can change the fill up to one min width away from a change.
+    int minWidth = aZone->GetMinThickness();
+    int epsilon = KiROUND( IU_PER_MM * 0.04 );
+
+    for( EDA_RECT& area : aAreas )
+        area.Inflate( 2 * minWidth );
+
+    // Whether thermal spokes are kept depends on the fill around their ends, so the reliefs
+    // of pads reaching into a changed area are refilled as a whole.
+    std::vector<EDA_RECT> reliefs;
+
+    for( MODULE* module : m_board->Modules() )
+    {
+        for( D_PAD* pad : module->Pads() )
+        {
+            if( !hasThermalConnection( pad, aZone ) )
+                continue;
+
+            EDA_RECT relief = pad->GetBoundingBox();
+            relief.Inflate( aZone->GetThermalReliefGap( pad ) + epsilon + 2 * minWidth );
+
+            for( const EDA_RECT& area : aAreas )
+            {
+                if( relief.Intersects( area ) )
+                {
+                    reliefs.push_back( relief );
+                    break;
+                }
+            }
+        }
+    }
+
+    aAreas.insert( aAreas.end(), reliefs.begin(), reliefs.end() );
+
+    // The fill is recomputed over a window a bit larger than the changed areas, as the edges
+    // of the window itself disturb the fill near them.
+    SHAPE_POLY_SET changed;
+    SHAPE_POLY_SET window;
+    EDA_RECT       windowBBox;
+
+    for( const EDA_RECT& area : aAreas )
+    {
+        EDA_RECT inflated = area;
+        inflated.Inflate( 2 * minWidth + epsilon );
+
+        changed.AddOutline( rectangleOutline( area ) );
+        window.AddOutline( rectangleOutline( inflated ) );
+
+        if( &area == &aAreas.front() )
+            windowBBox = inflated;
+        else
+            windowBBox.Merge( inflated );
+    }
+
+    changed.Simplify( SHAPE_POLY_SET::PM_FAST );
+    window.Simplify( SHAPE_POLY_SET::PM_FAST );
+
+    smoothedPoly.BooleanIntersection( window, SHAPE_POLY_SET::PM_FAST );
+
+    SHAPE_POLY_SET localPolys;
+
+    if( !computeRawFilledArea( aZone, aLayer, UNDEFINED_LAYER, smoothedPoly, maxExtents,
+                               windowBBox, localPolys ) )
+    {
+        return false;
+    }
+
+    localPolys.Unfracture( SHAPE_POLY_SET::PM_FAST );
+    localPolys.BooleanIntersection( changed, SHAPE_POLY_SET::PM_FAST );
+
+    aRawPolys.Unfracture( SHAPE_POLY_SET::PM_FAST );
+    aRawPolys.BooleanSubtract( changed, SHAPE_POLY_SET::PM_FAST );
+    aRawPolys.BooleanAdd( localPolys, SHAPE_POLY_SET::PM_FAST );
+    aRawPolys.Fracture( SHAPE_POLY_SET::PM_FAST );
+
+    return true;
+}
+
+
+bool ZONE_FILLER::RefillSplicedZones( wxWindow* aParent )
+{
+    bool spliced = false;
+
+    for( ZONE_CONTAINER* zone : m_board->Zones() )
+        spliced |= zone->HasSplicedFill();
+
+    if( !spliced )
+        return true;
+
+    // All zones go through Fill(): those built from a fill which is refilled here see its
+    // serial change, and are refilled too.  The others are kept as they are.
+    std::vector<ZONE_CONTAINER*> zones = m_board->Zones();
+
+    m_allowSplicing = false;
+    bool ok = Fill( zones, false, aParent );
+    m_allowSplicing = true;
+
+    return ok;
+}
+
+
+bool ZONE_FILLER::updateSingleZone( ZONE_CONTAINER* aZone, PCB_LAYER_ID aLayer,
+                                    const ZONE_FILL_INPUTS& aPrevious, ZONE_FILL_INPUTS& aInputs,
+                                    SHAPE_POLY_SET& aRawPolys, SHAPE_POLY_SET& aFinalPolys )
+{
+    std::vector<EDA_RECT> changedAreas;
+
+    if( !findChangedAreas( aZone, aLayer, aPrevious, aInputs, changedAreas ) )
+        return false;
+
+    if( !m_allowSplicing && ( aPrevious.m_spliced || !changedAreas.empty() ) )
+        return false;
+
+    aRawPolys = aZone->RawPolysList( aLayer );
+
+    if( changedAreas.empty() )
+    {
+        aInputs.m_serial = aPrevious.m_serial;
+        aInputs.m_spliced = aPrevious.m_spliced;
+    }
+    else
+    {
+        if( !refillAreas( aZone, aLayer, changedAreas, aRawPolys ) )
+            return false;
+
+        aInputs.m_serial = m_board->NewZoneFillSerial();
+        aInputs.m_spliced = true;
+
+        std::lock_guard<std::mutex> lock( m_changedFillAreasLock );
+
+        for( const EDA_RECT& area : changedAreas )
+            m_changedFillAreas[ aLayer ].emplace_back( aZone, area );
+    }
+
+    // Copper fills are not shrunk for drawing (see fillSingleZone())
+    aFinalPolys = aRawPolys;
+    aZone->SetNeedRefill( false );
+
+    return true;
+}
+
+
 /**
  * Function buildThermalSpokes
  */
 void ZONE_FILLER::buildThermalSpokes( const ZONE_CONTAINER* aZone, PCB_LAYER_ID aLayer,
+                                      const EDA_RECT& aArea,
                                       std::deque<SHAPE_LINE_CHAIN>& aSpokesList )
 {
-    auto zoneBB = aZone->GetCachedBoundingBox();
+    EDA_RECT zoneBB = aArea;
     int  zone_clearance = aZone->GetLocalClearance();
     int  biggest_clearance = m_board->GetDesignSettings().GetBiggestClearanceValue();
     biggest_clearance = std::max( biggest_clearance, zone_clearance );
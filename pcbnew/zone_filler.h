@@ -26,6 +26,10 @@
 #ifndef __ZONE_FILLER_H
 #define __ZONE_FILLER_H
 
+#include <functional>
+#include <limits>
+#include <map>
+#include <mutex>
 #include <vector>
 #include <class_zone.h>
 
@@ -35,6 +39,9 @@ class COMMIT;
 class SHAPE_POLY_SET;
 class SHAPE_LINE_CHAIN;
 
+/// Fill serial of a zone whose fill was not built (or was unfilled) since the board was loaded
+static const unsigned UNRECORDED_FILL = std::numeric_limits<unsigned>::max();
+
 
 class ZONE_FILLER
 {
@@ -47,8 +54,35 @@ public:
     bool Fill( std::vector<ZONE_CONTAINER*>& aZones, bool aCheck = false,
                wxWindow* aParent = nullptr );
 
+    /**
+     * Refill the board zones whose fills were updated in place by splicing refilled areas
+     * into them, along with any zone whose fill was built from such a fill.
+     *
+     * A spliced fill matches a full refill geometrically, but not vertex for vertex.  This
+     * brings the fills back to what a full refill gives, so that what is saved or plotted
+     * only depends on the board, not on how it was edited.  Other fills are kept.
+     *
+     * @return false if the zones could not be refilled.
+     */
+    bool RefillSplicedZones( wxWindow* aParent = nullptr );
+
     bool IsDebug() const { return m_debugZoneFiller; }
 
+    /// Called from the filling threads with the outline of each zone layer (less its thermal
+    /// reliefs) and its clearance holes, before they are merged and subtracted
+    typedef std::function<void( const ZONE_CONTAINER* aZone, PCB_LAYER_ID aLayer,
+                                const SHAPE_POLY_SET& aOutline, const SHAPE_POLY_SET& aHoles )>
+            CLEARANCE_HOLES_OBSERVER;
+
+    /**
+     * Set a function to call with the clearance holes of each fill.  Used to capture real
+     * polygon workloads for benchmarks.
+     */
+    void SetClearanceHolesObserver( const CLEARANCE_HOLES_OBSERVER& aObserver )
+    {
+        m_clearanceHolesObserver = aObserver;
+    }
+
 private:
 
     void addKnockout( D_PAD* aPad, PCB_LAYER_ID aLayer, int aGap, SHAPE_POLY_SET& aHoles );
@@ -57,10 +91,10 @@ private:
                       SHAPE_POLY_SET& aHoles );
 
     void knockoutThermalReliefs( const ZONE_CONTAINER* aZone, PCB_LAYER_ID aLayer,
-                                 SHAPE_POLY_SET& aFill );
+                                 const EDA_RECT& aArea, SHAPE_POLY_SET& aFill );
 
     void buildCopperItemClearances( const ZONE_CONTAINER* aZone, PCB_LAYER_ID aLayer,
-                                    SHAPE_POLY_SET& aHoles );
+                                    const EDA_RECT& aArea, SHAPE_POLY_SET& aHoles );
 
     void subtractHigherPriorityZones( const ZONE_CONTAINER* aZone, PCB_LAYER_ID aLayer,
                                       SHAPE_POLY_SET& aRawFill );
@@ -75,19 +109,56 @@ private:
      * BuildFilledSolidAreasPolygons() call this function just after creating the
      *  filled copper area polygon (without clearance areas
      * @param aPcb: the current board
+     * @param aArea: only items around this area are taken into account (the zone's bounding
+     * box, or a window of it when only part of the fill is rebuilt)
      */
     bool computeRawFilledArea( const ZONE_CONTAINER* aZone,
                                PCB_LAYER_ID aLayer, PCB_LAYER_ID aDebugLayer,
                                const SHAPE_POLY_SET& aSmoothedOutline,
                                const SHAPE_POLY_SET& aMaxExtents,
-                               SHAPE_POLY_SET& aRawPolys );
+                               const EDA_RECT& aArea, SHAPE_POLY_SET& aRawPolys );
 
     /**
      * Function buildThermalSpokes
-     * Constructs a list of all thermal spokes for the given zone.
+     * Constructs a list of all thermal spokes for the given zone around \a aArea.
      */
     void buildThermalSpokes( const ZONE_CONTAINER* aZone, PCB_LAYER_ID aLayer,
-                             std::deque<SHAPE_LINE_CHAIN>& aSpokes );
+                             const EDA_RECT& aArea, std::deque<SHAPE_LINE_CHAIN>& aSpokes );
+
+    /**
+     * Record what the fill of \a aZone on \a aLayer is built from: the zone and board wide
+     * fill settings, and a signature of each item which knocks out of or connects to it.
+     */
+    void collectFillInputs( const ZONE_CONTAINER* aZone, PCB_LAYER_ID aLayer,
+                            ZONE_FILL_INPUTS& aInputs );
+
+    /**
+     * Compare what the previous fill of \a aZone was built from with its current inputs.
+     * @param aAreas is filled with the areas in which the fill can have changed since.
+     * @return false if the zone has to be refilled as a whole.
+     */
+    bool findChangedAreas( const ZONE_CONTAINER* aZone, PCB_LAYER_ID aLayer,
+                           const ZONE_FILL_INPUTS& aPrevious, const ZONE_FILL_INPUTS& aCurrent,
+                           std::vector<EDA_RECT>& aAreas );
+
+    /**
+     * Rebuild the fill of \a aZone within \a aAreas only, and splice the result into the
+     * previous raw fill held in \a aRawPolys.
+     * @param aAreas holds the changed areas; on return it holds the areas which were refilled.
+     * @return false if the areas could not be refilled.
+     */
+    bool refillAreas( const ZONE_CONTAINER* aZone, PCB_LAYER_ID aLayer,
+                      std::vector<EDA_RECT>& aAreas, SHAPE_POLY_SET& aRawPolys );
+
+    /**
+     * Bring the fill of \a aZone on \a aLayer up to date from its previous fill, either
+     * keeping it or refilling the areas which changed (see findChangedAreas()).  Unless
+     * m_allowSplicing is set only an unchanged fill which was not spliced is kept.
+     * @return false if the zone has to be refilled as a whole.
+     */
+    bool updateSingleZone( ZONE_CONTAINER* aZone, PCB_LAYER_ID aLayer,
+                           const ZONE_FILL_INPUTS& aPrevious, ZONE_FILL_INPUTS& aInputs,
+                           SHAPE_POLY_SET& aRawPolys, SHAPE_POLY_SET& aFinalPolys );
 
     /**
      * Build the filled solid areas polygons from zone outlines (stored in m_Poly)
@@ -126,8 +197,20 @@ private:
 
     int                   m_maxError;
     int                   m_worstClearance;
+    size_t                m_boardOutlineHash;
+
+    /// Fill serials of the board zones when Fill() started, keyed by zone KIID and layer
+    std::map<std::pair<size_t, PCB_LAYER_ID>, unsigned>  m_initialFillSerials;
 
+    /// Areas in which zone fills changed during Fill(), for lower priority zones to refill
+    std::map<PCB_LAYER_ID, std::vector<std::pair<const ZONE_CONTAINER*, EDA_RECT>>>
+                          m_changedFillAreas;
+    std::mutex            m_changedFillAreasLock;
+
+    bool                  m_allowSplicing;      // false to refill changed zones as a whole
     bool                  m_debugZoneFiller;
+
+    CLEARANCE_HOLES_OBSERVER m_clearanceHolesObserver;
 };
 
 #endif
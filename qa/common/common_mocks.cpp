@@ -46,7 +46,7 @@ static struct IFACE : public KIFACE_I
 {
     bool OnKifaceStart( PGM_BASE* aProgram, int aCtlBits ) override
     {
-        return start_common( aCtlBits );
+        return start_common( aProgram, aCtlBits );
     }
 
     wxWindow* CreateWindow( wxWindow* aParent, int aClassId, KIWAY* aKiway, int aCtlBits = 0 ) override
@@ -0,0 +1,178 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_binary_stream.cpp
+ * Test suite for BINARY_STREAM_WRITER and BINARY_STREAM_READER.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include <binary_stream.h>
+
+
+static const char     TEST_MAGIC[] = "KiCad test stream";
+static const uint32_t TEST_VERSION = 3;
+
+
+/**
+ * Write a stream with one of each kind of value
+ */
+static BINARY_STREAM_WRITER makeStream()
+{
+    BINARY_STREAM_WRITER out;
+
+    out.WriteHeader( TEST_MAGIC, TEST_VERSION );
+    out.Write<int32_t>( -123456 );
+    out.Write<uint64_t>( 0x0123456789ABCDEFULL );
+    out.WriteString( "" );
+    out.Write<uint8_t>( 1 );
+    out.WriteString( "A string \xC2\xB5 with UTF-8" );
+    out.Write<int64_t>( -1 );
+
+    return out;
+}
+
+
+/**
+ * Read back what makeStream() wrote, checking the values as long as the reader is Ok()
+ */
+static void readStream( BINARY_STREAM_READER& aIn )
+{
+    if( !aIn.ReadHeader( TEST_MAGIC, TEST_VERSION ) )
+        return;
+
+    int32_t     a = aIn.Read<int32_t>();
+    uint64_t    b = aIn.Read<uint64_t>();
+    std::string c = aIn.ReadString();
+    uint8_t     d = aIn.Read<uint8_t>();
+    std::string e = aIn.ReadString();
+    int64_t     f = aIn.Read<int64_t>();
+
+    if( aIn.Ok() )
+    {
+        BOOST_CHECK_EQUAL( a, -123456 );
+        BOOST_CHECK_EQUAL( b, 0x0123456789ABCDEFULL );
+        BOOST_CHECK_EQUAL( c, "" );
+        BOOST_CHECK_EQUAL( d, 1 );
+        BOOST_CHECK_EQUAL( e, "A string \xC2\xB5 with UTF-8" );
+        BOOST_CHECK_EQUAL( f, -1 );
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE( BinaryStream )
+
+
+BOOST_AUTO_TEST_CASE( RoundTrip )
+{
+    wxString fileName = wxFileName::CreateTempFileName( "binary_stream" );
+
+    BOOST_REQUIRE( makeStream().WriteFile( fileName ) );
+
+    BINARY_STREAM_READER in;
+
+    BOOST_REQUIRE( in.ReadFile( fileName ) );
+    readStream( in );
+    BOOST_CHECK( in.Ok() );
+
+    // Nothing is left behind by the save
+    wxFileName tempFile( fileName );
+    tempFile.SetFullName( "." + tempFile.GetFullName() + "$" );
+    BOOST_CHECK( !tempFile.FileExists() );
+
+    // Reading past the end fails, and keeps failing
+    in.Read<uint8_t>();
+    BOOST_CHECK( !in.Ok() );
+    BOOST_CHECK_EQUAL( in.ReadString(), "" );
+    BOOST_CHECK( !in.Ok() );
+
+    wxRemoveFile( fileName );
+
+    BOOST_CHECK( !in.ReadFile( fileName ) );
+    BOOST_CHECK( !in.Ok() );
+}
+
+
+BOOST_AUTO_TEST_CASE( VersionMismatch )
+{
+    BINARY_STREAM_WRITER     out = makeStream();
+    const std::vector<char>& data = out.Data();
+
+    BINARY_STREAM_READER newer( data );
+    BOOST_CHECK( !newer.ReadHeader( TEST_MAGIC, TEST_VERSION + 1 ) );
+    BOOST_CHECK( !newer.Ok() );
+
+    BINARY_STREAM_READER other( data );
+    BOOST_CHECK( !other.ReadHeader( "KiCad other stream", TEST_VERSION ) );
+    BOOST_CHECK( !other.Ok() );
+
+    // A text file, such as an older cache, is not mistaken for a stream
+    std::string          text = "1234567\nsome text\n";
+    BINARY_STREAM_READER textIn( std::vector<char>( text.begin(), text.end() ) );
+    BOOST_CHECK( !textIn.ReadHeader( TEST_MAGIC, TEST_VERSION ) );
+}
+
+
+/**
+ * Every truncation of a stream must be found, at the latest on its last value
+ */
+BOOST_AUTO_TEST_CASE( Truncated )
+{
+    BINARY_STREAM_WRITER     out = makeStream();
+    const std::vector<char>& data = out.Data();
+
+    for( size_t size = 0; size < data.size(); ++size )
+    {
+        BOOST_TEST_CONTEXT( "Size " << size )
+        {
+            BINARY_STREAM_READER in( std::vector<char>( data.begin(), data.begin() + size ) );
+
+            readStream( in );
+            BOOST_CHECK( !in.Ok() );
+        }
+    }
+
+    // Also once written to a file
+    wxString fileName = wxFileName::CreateTempFileName( "binary_stream" );
+
+    {
+        wxFFile file( fileName, "wb" );
+        BOOST_REQUIRE( file.IsOpened() );
+        file.Write( data.data(), data.size() / 2 );
+    }
+
+    BINARY_STREAM_READER in;
+
+    BOOST_REQUIRE( in.ReadFile( fileName ) );
+    readStream( in );
+    BOOST_CHECK( !in.Ok() );
+
+    wxRemoveFile( fileName );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
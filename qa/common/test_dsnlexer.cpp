@@ -0,0 +1,291 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for DSNLEXER keyword lookup and tokenising, and for BUFFERED_FILE_LINE_READER,
+ * each checked against the simpler implementation it replaces.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include <dsnlexer.h>
+#include <richio.h>
+
+
+/**
+ * A keyword table big enough to have plenty of hash collisions, sorted like the generated
+ * ones are.
+ */
+struct KEYWORD_TABLE
+{
+    KEYWORD_TABLE()
+    {
+        for( const char* word : { "at", "layer", "layers", "net", "net_name", "pad", "pads",
+                                  "segment", "via", "width", "x", "xy", "zone" } )
+        {
+            m_names.push_back( word );
+        }
+
+        for( int ii = 0; ii < 400; ++ii )
+            m_names.push_back( "kw" + std::to_string( ii ) );
+
+        std::sort( m_names.begin(), m_names.end() );
+
+        for( const std::string& name : m_names )
+            m_keywords.push_back( { name.c_str(), (int) m_keywords.size() } );
+    }
+
+    /**
+     * The lookup DSNLEXER used to do, by binary search over the sorted table
+     */
+    int Find( const std::string& aText ) const
+    {
+        auto it = std::lower_bound( m_keywords.begin(), m_keywords.end(), aText,
+                                    []( const KEYWORD& aKeyword, const std::string& aName )
+                                    {
+                                        return strcmp( aKeyword.name, aName.c_str() ) < 0;
+                                    } );
+
+        if( it != m_keywords.end() && aText == it->name )
+            return it->token;
+
+        return DSN_SYMBOL;
+    }
+
+    std::vector<std::string> m_names;
+    std::vector<KEYWORD>     m_keywords;
+};
+
+
+struct TOKEN
+{
+    int         m_tok;
+    std::string m_text;
+};
+
+
+static std::vector<TOKEN> lexAll( DSNLEXER& aLexer )
+{
+    std::vector<TOKEN> tokens;
+    int                tok;
+
+    while( ( tok = aLexer.NextTok() ) != DSN_EOF )
+        tokens.push_back( { tok, aLexer.CurText() } );
+
+    return tokens;
+}
+
+
+BOOST_AUTO_TEST_SUITE( DsnLexer )
+
+
+/**
+ * Every keyword, and a good number of words which are nearly keywords, must resolve just as
+ * a binary search of the keyword table would.
+ */
+BOOST_AUTO_TEST_CASE( KeywordLookup )
+{
+    KEYWORD_TABLE            table;
+    std::vector<std::string> words;
+
+    for( const std::string& name : table.m_names )
+    {
+        words.push_back( name );
+        words.push_back( name + "s" );
+
+        if( name.length() > 1 )
+            words.push_back( name.substr( 0, name.length() - 1 ) );
+
+        words.push_back( "_" + name );
+
+        std::string upper = name;
+        std::transform( upper.begin(), upper.end(), upper.begin(), ::toupper );
+        words.push_back( upper );
+    }
+
+    std::string input;
+
+    for( const std::string& word : words )
+        input += word + " ";
+
+    DSNLEXER           lexer( table.m_keywords.data(), table.m_keywords.size(), input );
+    std::vector<TOKEN> tokens = lexAll( lexer );
+
+    BOOST_REQUIRE_EQUAL( tokens.size(), words.size() );
+
+    for( size_t ii = 0; ii < words.size(); ++ii )
+    {
+        BOOST_TEST_CONTEXT( "'" << words[ii] << "'" )
+        {
+            BOOST_CHECK_EQUAL( tokens[ii].m_text, words[ii] );
+            BOOST_CHECK_EQUAL( tokens[ii].m_tok, table.Find( words[ii] ) );
+        }
+    }
+}
+
+
+/**
+ * Bare tokens and quoted strings are now copied a run at a time; the text must be what a
+ * character by character copy gave.
+ */
+BOOST_AUTO_TEST_CASE( TokenText )
+{
+    KEYWORD_TABLE table;
+
+    const std::string input =
+            "(layer F.Cu)(at 1.5 -2.25 +90)\n"
+            "(net 3 \"Net-(U1-Pad2)\")\n"
+            "(net_name \"with \\\"quotes\\\" and \\\\ and \\n newline\")\n"
+            "(x \"\")(xy \"tail\\\\\")\n"
+            "\"a long quoted run of plain characters, long enough to span several appends\"\n";
+
+    const std::vector<TOKEN> expected = {
+        { DSN_LEFT, "(" },
+        { table.Find( "layer" ), "layer" },
+        { DSN_SYMBOL, "F.Cu" },
+        { DSN_RIGHT, ")" },
+        { DSN_LEFT, "(" },
+        { table.Find( "at" ), "at" },
+        { DSN_NUMBER, "1.5" },
+        { DSN_NUMBER, "-2.25" },
+        { DSN_NUMBER, "+90" },
+        { DSN_RIGHT, ")" },
+        { DSN_LEFT, "(" },
+        { table.Find( "net" ), "net" },
+        { DSN_NUMBER, "3" },
+        { DSN_STRING, "Net-(U1-Pad2)" },
+        { DSN_RIGHT, ")" },
+        { DSN_LEFT, "(" },
+        { table.Find( "net_name" ), "net_name" },
+        { DSN_STRING, "with \"quotes\" and \\ and \n newline" },
+        { DSN_RIGHT, ")" },
+        { DSN_LEFT, "(" },
+        { table.Find( "x" ), "x" },
+        { DSN_STRING, "" },
+        { DSN_RIGHT, ")" },
+        { DSN_LEFT, "(" },
+        { table.Find( "xy" ), "xy" },
+        { DSN_STRING, "tail\\" },
+        { DSN_RIGHT, ")" },
+        { DSN_STRING, "a long quoted run of plain characters, long enough to span several appends" },
+    };
+
+    DSNLEXER           lexer( table.m_keywords.data(), table.m_keywords.size(), input );
+    std::vector<TOKEN> tokens = lexAll( lexer );
+
+    BOOST_REQUIRE_EQUAL( tokens.size(), expected.size() );
+
+    for( size_t ii = 0; ii < expected.size(); ++ii )
+    {
+        BOOST_TEST_CONTEXT( "Token " << ii )
+        {
+            BOOST_CHECK_EQUAL( tokens[ii].m_tok, expected[ii].m_tok );
+            BOOST_CHECK_EQUAL( tokens[ii].m_text, expected[ii].m_text );
+        }
+    }
+}
+
+
+/**
+ * BUFFERED_FILE_LINE_READER must hand out exactly the lines FILE_LINE_READER does, and so
+ * lex to exactly the same tokens.
+ */
+BOOST_AUTO_TEST_CASE( BufferedReaderMatchesFileReader )
+{
+    KEYWORD_TABLE table;
+
+    const std::vector<std::string> contents = {
+        "",
+        "(layer F.Cu)",
+        "(layer F.Cu)\n(net 1 \"GND\")\n",
+        "(at 1 2)\r\n(at 3 4)\r\n\r\n(via)",
+        "\n\n\n",
+        "(net_name \"" + std::string( 50000, 'n' ) + "\")\n(x)\n",
+    };
+
+    for( size_t ii = 0; ii < contents.size(); ++ii )
+    {
+        wxString fileName = wxFileName::CreateTempFileName( "dsnlexer" );
+
+        {
+            wxFFile file( fileName, "wb" );
+            BOOST_REQUIRE( file.IsOpened() );
+            file.Write( contents[ii].data(), contents[ii].size() );
+        }
+
+        BOOST_TEST_CONTEXT( "Contents " << ii )
+        {
+            FILE_LINE_READER          fileReader( fileName );
+            BUFFERED_FILE_LINE_READER bufferedReader( fileName );
+
+            while( true )
+            {
+                char* fileLine = fileReader.ReadLine();
+                char* bufferedLine = bufferedReader.ReadLine();
+
+                BOOST_REQUIRE_EQUAL( fileLine == nullptr, bufferedLine == nullptr );
+
+                if( !fileLine )
+                    break;
+
+                BOOST_CHECK_EQUAL( fileReader.Length(), bufferedReader.Length() );
+                BOOST_CHECK_EQUAL( fileReader.LineNumber(), bufferedReader.LineNumber() );
+                BOOST_CHECK_EQUAL( std::string( fileLine, fileReader.Length() ),
+                                   std::string( bufferedLine, bufferedReader.Length() ) );
+            }
+        }
+
+        BOOST_TEST_CONTEXT( "Contents " << ii << " lexed" )
+        {
+            FILE_LINE_READER          fileReader( fileName );
+            BUFFERED_FILE_LINE_READER bufferedReader( fileName );
+
+            DSNLEXER fileLexer( table.m_keywords.data(), table.m_keywords.size(), &fileReader );
+            DSNLEXER bufferedLexer( table.m_keywords.data(), table.m_keywords.size(),
+                                    &bufferedReader );
+
+            std::vector<TOKEN> fileTokens = lexAll( fileLexer );
+            std::vector<TOKEN> bufferedTokens = lexAll( bufferedLexer );
+
+            BOOST_REQUIRE_EQUAL( fileTokens.size(), bufferedTokens.size() );
+
+            for( size_t jj = 0; jj < fileTokens.size(); ++jj )
+            {
+                BOOST_CHECK_EQUAL( fileTokens[jj].m_tok, bufferedTokens[jj].m_tok );
+                BOOST_CHECK_EQUAL( fileTokens[jj].m_text, bufferedTokens[jj].m_text );
+            }
+        }
+
+        wxRemoveFile( fileName );
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,223 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_thread_pool.cpp
+ * Test suite for THREAD_POOL.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <thread_pool.h>
+
+#include <atomic>
+#include <numeric>
+
+
+BOOST_AUTO_TEST_SUITE( ThreadPool )
+
+
+/**
+ * Check that results come back through the futures
+ */
+BOOST_AUTO_TEST_CASE( Results )
+{
+    THREAD_POOL tp( 4 );
+
+    BOOST_CHECK_EQUAL( tp.GetThreadCount(), 4 );
+
+    std::vector<std::future<int>> returns;
+
+    for( int ii = 0; ii < 100; ++ii )
+    {
+        returns.push_back( tp.Submit( [ii]()
+                                      {
+                                          return ii * ii;
+                                      } ) );
+    }
+
+    for( int ii = 0; ii < 100; ++ii )
+    {
+        tp.Wait( returns[ii] );
+        BOOST_CHECK_EQUAL( returns[ii].get(), ii * ii );
+    }
+}
+
+
+/**
+ * Check that exceptions thrown by a task are delivered to the waiter
+ */
+BOOST_AUTO_TEST_CASE( Exceptions )
+{
+    THREAD_POOL tp( 2 );
+
+    std::future<void> ret = tp.Submit( []()
+                                       {
+                                           throw std::runtime_error( "oops" );
+                                       } );
+
+    tp.Wait( ret );
+    BOOST_CHECK_THROW( ret.get(), std::runtime_error );
+}
+
+
+/**
+ * Tasks which wait on their own sub-tasks must not deadlock, even on a single worker
+ */
+BOOST_AUTO_TEST_CASE( NestedTasks )
+{
+    THREAD_POOL tp( 1 );
+
+    std::future<int> outer = tp.Submit( [&tp]()
+            {
+                std::vector<std::future<int>> inner;
+
+                for( int ii = 1; ii <= 10; ++ii )
+                {
+                    inner.push_back( tp.Submit( [ii]()
+                                                {
+                                                    return ii;
+                                                } ) );
+                }
+
+                tp.WaitAll( inner );
+
+                int sum = 0;
+
+                for( std::future<int>& ret : inner )
+                    sum += ret.get();
+
+                return sum;
+            } );
+
+    tp.Wait( outer );
+    BOOST_CHECK_EQUAL( outer.get(), 55 );
+}
+
+
+/**
+ * Tasks submitted with a cancelled canceller are skipped
+ */
+BOOST_AUTO_TEST_CASE( Cancellation )
+{
+    THREAD_POOL      tp( 2 );
+    TASK_CANCELLER   canceller;
+    std::atomic<int> ran( 0 );
+
+    canceller.Cancel();
+
+    std::vector<std::future<void>> returns;
+
+    for( int ii = 0; ii < 10; ++ii )
+    {
+        returns.push_back( tp.Submit( [&ran]()
+                                      {
+                                          ran++;
+                                      },
+                                      canceller ) );
+    }
+
+    tp.WaitAll( returns );
+
+    BOOST_CHECK_EQUAL( ran.load(), 0 );
+
+    for( std::future<void>& ret : returns )
+        BOOST_CHECK_THROW( ret.get(), TASK_CANCELLED );
+}
+
+
+/**
+ * Check the keep-alive callback path used by UI threads
+ */
+BOOST_AUTO_TEST_CASE( KeepAlive )
+{
+    THREAD_POOL       tp( 2 );
+    std::atomic<bool> release( false );
+
+    std::future<int> ret = tp.Submit( [&release]()
+                                      {
+                                          while( !release )
+                                              std::this_thread::yield();
+
+                                          return 42;
+                                      } );
+
+    int calls = 0;
+
+    tp.Wait( ret, [&]()
+                  {
+                      if( ++calls == 2 )
+                          release = true;
+                  } );
+
+    BOOST_CHECK_GE( calls, 2 );
+    BOOST_CHECK_EQUAL( ret.get(), 42 );
+}
+
+
+/**
+ * Threads outside the pool (such as the UI thread) block on the futures, they never run
+ * queued tasks which may belong to someone else
+ */
+BOOST_AUTO_TEST_CASE( WaiterDoesNotRunTasks )
+{
+    THREAD_POOL                    tp( 1 );
+    std::thread::id                waiter = std::this_thread::get_id();
+    std::atomic<int>               ranOnWaiter( 0 );
+    std::vector<std::future<void>> returns;
+
+    for( int ii = 0; ii < 50; ++ii )
+    {
+        returns.push_back( tp.Submit( [&]()
+                                      {
+                                          if( std::this_thread::get_id() == waiter )
+                                              ranOnWaiter++;
+
+                                          std::this_thread::sleep_for(
+                                                  std::chrono::microseconds( 100 ) );
+                                      } ) );
+    }
+
+    BOOST_CHECK( !tp.IsWorkerThread() );
+
+    tp.WaitAll( returns );
+
+    BOOST_CHECK_EQUAL( ranOnWaiter.load(), 0 );
+}
+
+
+/**
+ * A kiface is handed the pool of its hosting program
+ */
+BOOST_AUTO_TEST_CASE( HostPool )
+{
+    THREAD_POOL host( 2 );
+
+    SetKiCadThreadPool( &host );
+    BOOST_CHECK_EQUAL( &GetKiCadThreadPool(), &host );
+
+    SetKiCadThreadPool( nullptr );
+    BOOST_CHECK_NE( &GetKiCadThreadPool(), &host );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
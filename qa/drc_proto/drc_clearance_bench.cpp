@@ -0,0 +1,177 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file drc_clearance_bench.cpp
+ * Times the copper clearance provider on synthetic boards of increasing size.  With the
+ * spatial index the time per item should stay roughly flat as the board grows.
+ *
+ * usage: drc_clearance_bench [item-count...]
+ */
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <common.h>
+#include <profile.h>
+
+#include <wx/filename.h>
+#include <wx/init.h>
+
+#include <property_mgr.h>
+#include <pgm_base.h>
+
+#include <pcbnew/class_board.h>
+#include <pcbnew/class_module.h>
+#include <pcbnew/class_pad.h>
+#include <pcbnew/class_track.h>
+#include <pcbnew/drc/drc_engine.h>
+#include <pcbnew/drc/drc_item.h>
+#include <pcbnew/drc/drc_test_provider.h>
+
+
+/**
+ * Fill a board with a grid of short tracks (alternating between F.Cu and B.Cu) and SMD
+ * pads, spread over a few dozen nets so that most neighbours need a clearance check.
+ */
+static std::unique_ptr<BOARD> createSyntheticBoard( int aItemCount )
+{
+    const int pitch = Millimeter2iu( 1.0 );
+    const int netCount = 64;
+    const int columns = (int) std::ceil( std::sqrt( (double) aItemCount ) );
+
+    std::unique_ptr<BOARD>     board = std::make_unique<BOARD>();
+    std::vector<NETINFO_ITEM*> nets;
+
+    for( int ii = 1; ii <= netCount; ++ii )
+    {
+        NETINFO_ITEM* net = new NETINFO_ITEM( board.get(), wxString::Format( "N%d", ii ), ii );
+        board->Add( net );
+        nets.push_back( net );
+    }
+
+    for( int ii = 0; ii < aItemCount; ++ii )
+    {
+        wxPoint       pos( ( ii % columns ) * pitch, ( ii / columns ) * pitch );
+        NETINFO_ITEM* net = nets[ ii % netCount ];
+
+        if( ii % 4 == 0 )
+        {
+            MODULE* module = new MODULE( board.get() );
+            D_PAD*  pad = new D_PAD( module );
+
+            module->SetPosition( pos );
+
+            pad->SetAttribute( PAD_ATTRIB_SMD );
+            pad->SetLayerSet( D_PAD::SMDMask() );
+            pad->SetShape( PAD_SHAPE_RECT );
+            pad->SetSize( wxSize( pitch / 2, pitch / 2 ) );
+            pad->SetPos0( wxPoint( 0, 0 ) );
+            pad->SetPosition( pos );
+            pad->SetNet( net );
+
+            module->Add( pad );
+            board->Add( module );
+        }
+        else
+        {
+            TRACK* track = new TRACK( board.get() );
+
+            // Ends close to the next cell, so some neighbours end up in violation
+            track->SetStart( pos );
+            track->SetEnd( pos + wxPoint( pitch * 3 / 4, 0 ) );
+            track->SetWidth( pitch / 5 );
+            track->SetLayer( ( ii % 2 ) ? F_Cu : B_Cu );
+            track->SetNet( net );
+
+            board->Add( track );
+        }
+    }
+
+    return board;
+}
+
+
+static void runBenchmark( int aItemCount )
+{
+    std::unique_ptr<BOARD>      board = createSyntheticBoard( aItemCount );
+    std::shared_ptr<DRC_ENGINE> drcEngine( new DRC_ENGINE );
+    int                         violations = 0;
+
+    board->GetDesignSettings().m_DRCEngine = drcEngine;
+
+    drcEngine->SetBoard( board.get() );
+    drcEngine->SetDesignSettings( &board->GetDesignSettings() );
+    drcEngine->SetViolationHandler(
+            [&]( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos )
+            {
+                violations++;
+            } );
+
+    drcEngine->InitEngine( wxFileName() );
+
+    for( DRC_TEST_PROVIDER* provider : drcEngine->GetTestProviders() )
+        provider->Enable( provider->GetName() == "clearance" );
+
+    PROF_COUNTER timer;
+
+    drcEngine->RunTests();
+
+    timer.Stop();
+
+    printf( "%8d items: %10.1f ms, %6.2f us/item, %d violations\n",
+            aItemCount,
+            timer.msecs(),
+            timer.msecs() * 1000.0 / aItemCount,
+            violations );
+}
+
+
+int main( int argc, char** argv )
+{
+    wxInitialize( argc, argv );
+
+    Pgm().InitPgm();
+
+    PROPERTY_MANAGER& propMgr = PROPERTY_MANAGER::Instance();
+    propMgr.Rebuild();
+
+    std::vector<int> sizes;
+
+    for( int ii = 1; ii < argc; ++ii )
+        sizes.push_back( atoi( argv[ii] ) );
+
+    if( sizes.empty() )
+        sizes = { 12500, 25000, 50000, 100000 };
+
+    for( int size : sizes )
+        runBenchmark( size );
+
+    Pgm().Destroy();
+
+    wxUninitialize();
+
+    return 0;
+}
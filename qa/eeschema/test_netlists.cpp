@@ -26,7 +26,10 @@
 #include <netlist_reader/pcb_netlist.h>
 #include <project.h>
 #include <sch_io_mgr.h>
+#include <sch_line.h>
+#include <sch_screen.h>
 #include <sch_sheet.h>
+#include <sch_text.h>
 #include <schematic.h>
 #include <settings/settings_manager.h>
 #include <wildcards_and_files_ext.h>
@@ -46,14 +49,25 @@ public:
 
     wxString getNetlistFileName( bool aTest = false );
 
+    ///> Name of the netlist written by a full recalculation in incremental tests
+    wxString getFullNetlistFileName();
+
     void writeNetlist();
 
+    void writeNetlist( const wxString& aFileName );
+
     void compareNetlists();
 
+    void compareNetlists( const wxString& aGoldenFile, const wxString& aTestFile );
+
+    void checkIncrementalUpdate( const wxString& aEdit );
+
     void cleanup();
 
     void doNetlistTest( const wxString& aBaseName );
 
+    void doIncrementalNetlistTest( const wxString& aBaseName );
+
     ///> Schematic to load
     SCHEMATIC m_schematic;
 
@@ -133,28 +147,52 @@ wxString TEST_NETLISTS_FIXTURE::getNetlistFileName( bool aTest )
 }
 
 
+wxString TEST_NETLISTS_FIXTURE::getFullNetlistFileName()
+{
+    wxFileName netFile = m_schematic.Prj().GetProjectFullName();
+
+    netFile.SetName( netFile.GetName() + "_full" );
+    netFile.SetExt( NetlistFileExtension );
+
+    return netFile.GetFullPath();
+}
+
+
 void TEST_NETLISTS_FIXTURE::writeNetlist()
+{
+    writeNetlist( getNetlistFileName( true ) );
+}
+
+
+void TEST_NETLISTS_FIXTURE::writeNetlist( const wxString& aFileName )
 {
     auto exporter = std::make_unique<NETLIST_EXPORTER_KICAD>( &m_schematic );
-    BOOST_REQUIRE_EQUAL( exporter->WriteNetlist( getNetlistFileName( true ), 0 ), true );
+    BOOST_REQUIRE_EQUAL( exporter->WriteNetlist( aFileName, 0 ), true );
 }
 
 
 void TEST_NETLISTS_FIXTURE::compareNetlists()
+{
+    compareNetlists( getNetlistFileName(), getNetlistFileName( true ) );
+}
+
+
+void TEST_NETLISTS_FIXTURE::compareNetlists( const wxString& aGoldenFile,
+                                             const wxString& aTestFile )
 {
     NETLIST golden;
     NETLIST test;
 
     {
         std::unique_ptr<NETLIST_READER> netlistReader(
-                NETLIST_READER::GetNetlistReader( &golden, getNetlistFileName(), wxEmptyString ) );
+                NETLIST_READER::GetNetlistReader( &golden, aGoldenFile, wxEmptyString ) );
 
         BOOST_REQUIRE_NO_THROW( netlistReader->LoadNetlist() );
     }
 
     {
         std::unique_ptr<NETLIST_READER> netlistReader( NETLIST_READER::GetNetlistReader(
-                &test, getNetlistFileName( true ), wxEmptyString ) );
+                &test, aTestFile, wxEmptyString ) );
 
         BOOST_REQUIRE_NO_THROW( netlistReader->LoadNetlist() );
     }
@@ -208,6 +246,132 @@ void TEST_NETLISTS_FIXTURE::doNetlistTest( const wxString& aBaseName )
 }
 
 
+void TEST_NETLISTS_FIXTURE::checkIncrementalUpdate( const wxString& aEdit )
+{
+    SCH_SHEET_LIST sheets = m_schematic.GetSheets();
+
+    BOOST_TEST_CONTEXT( aEdit )
+    {
+        m_schematic.ConnectionGraph()->Recalculate( sheets );
+        writeNetlist( getNetlistFileName( true ) );
+
+        m_schematic.ConnectionGraph()->Recalculate( sheets, true );
+        writeNetlist( getFullNetlistFileName() );
+
+        compareNetlists( getFullNetlistFileName(), getNetlistFileName( true ) );
+    }
+}
+
+
+void TEST_NETLISTS_FIXTURE::doIncrementalNetlistTest( const wxString& aBaseName )
+{
+    loadSchematic( aBaseName );
+
+    SCH_SHEET_LIST sheets = m_schematic.GetSheets();
+    SCH_SCREENS    screens( m_schematic.Root() );
+
+    checkIncrementalUpdate( "No change" );
+
+    // Delete a wire of each sheet, then put them all back
+    std::vector<std::pair<SCH_SCREEN*, SCH_ITEM*>> deletedWires;
+
+    for( SCH_SCREEN* screen = screens.GetFirst(); screen; screen = screens.GetNext() )
+    {
+        for( SCH_ITEM* item : screen->Items().OfType( SCH_LINE_T ) )
+        {
+            if( static_cast<SCH_LINE*>( item )->IsWire() )
+            {
+                deletedWires.emplace_back( screen, item );
+                break;
+            }
+        }
+    }
+
+    for( const std::pair<SCH_SCREEN*, SCH_ITEM*>& wire : deletedWires )
+    {
+        wire.first->Remove( wire.second );
+        checkIncrementalUpdate( "Wire deleted" );
+    }
+
+    for( const std::pair<SCH_SCREEN*, SCH_ITEM*>& wire : deletedWires )
+    {
+        wire.second->SetConnectivityDirty();
+        wire.first->Append( wire.second );
+        checkIncrementalUpdate( "Wire added" );
+    }
+
+    // Rename a global label everywhere it appears
+    wxString globalName;
+
+    for( SCH_SCREEN* screen = screens.GetFirst(); screen && globalName.IsEmpty();
+         screen = screens.GetNext() )
+    {
+        for( SCH_ITEM* item : screen->Items().OfType( SCH_GLOBAL_LABEL_T ) )
+        {
+            globalName = static_cast<SCH_TEXT*>( item )->GetText();
+            break;
+        }
+    }
+
+    if( !globalName.IsEmpty() )
+    {
+        for( SCH_SCREEN* screen = screens.GetFirst(); screen; screen = screens.GetNext() )
+        {
+            for( SCH_ITEM* item : screen->Items().OfType( SCH_GLOBAL_LABEL_T ) )
+            {
+                SCH_TEXT* label = static_cast<SCH_TEXT*>( item );
+
+                if( label->GetText() == globalName )
+                {
+                    label->SetText( "RENAMED_" + globalName );
+                    label->SetConnectivityDirty();
+                }
+            }
+        }
+
+        checkIncrementalUpdate( "Global label renamed" );
+    }
+
+    // Rename a hierarchical label and its sheet pin, which are on different sheets
+    for( const SCH_SHEET_PATH& sheet : sheets )
+    {
+        if( sheet.size() < 2 )
+            continue;
+
+        SCH_HIERLABEL* label = nullptr;
+        SCH_SHEET_PIN* pin = nullptr;
+
+        for( SCH_ITEM* item : sheet.LastScreen()->Items().OfType( SCH_HIER_LABEL_T ) )
+        {
+            label = static_cast<SCH_HIERLABEL*>( item );
+
+            for( SCH_SHEET_PIN* sheetPin : sheet.Last()->GetPins() )
+            {
+                if( sheetPin->GetText() == label->GetText() )
+                    pin = sheetPin;
+            }
+
+            if( pin )
+                break;
+        }
+
+        if( !pin )
+            continue;
+
+        label->SetText( "RENAMED_" + label->GetText() );
+        label->SetConnectivityDirty();
+        pin->SetText( label->GetText() );
+        pin->SetConnectivityDirty();
+
+        checkIncrementalUpdate( "Hierarchical label renamed" );
+        break;
+    }
+
+    wxRemoveFile( getFullNetlistFileName() );
+    cleanup();
+}
+
+
 BOOST_FIXTURE_TEST_SUITE( Netlists, TEST_NETLISTS_FIXTURE )
 
 
@@ -253,5 +417,19 @@ BOOST_AUTO_TEST_CASE( BusJunctions )
 }
 
 
+/**
+ * Edit the schematics as the editor would, and check the netlist after each incremental
+ * update of the connectivity is the one a full recalculation gives
+ */
+BOOST_AUTO_TEST_CASE( IncrementalEdits )
+{
+    for( const char* name : { "test_global_promotion", "video", "complex_hierarchy",
+                              "bus_junctions" } )
+    {
+        doIncrementalNetlistTest( name );
+    }
+}
+
+
 
 BOOST_AUTO_TEST_SUITE_END()
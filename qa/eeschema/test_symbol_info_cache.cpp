@@ -0,0 +1,210 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for SYMBOL_INFO_CACHE, the symbol library index
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <cstring>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include <class_libentry.h>
+#include <lib_pin.h>
+#include <symbol_info_cache.h>
+
+
+/**
+ * A few symbols: with several units and pins, a power symbol and a symbol derived from
+ * another one
+ */
+class SYMBOL_INFO_CACHE_FIXTURE
+{
+public:
+    SYMBOL_INFO_CACHE_FIXTURE() :
+            m_opamp( "OpAmp" ),
+            m_power( "GND" ),
+            m_derived( "OpAmp_Alt", &m_opamp )
+    {
+        m_opamp.SetDescription( "Dual operational amplifier" );
+        m_opamp.SetKeyWords( "dual opamp" );
+        m_opamp.GetFootprintField().SetText( "Package_SO:SOIC-8" );
+        m_opamp.SetUnitCount( 2 );
+
+        for( int ii = 0; ii < 8; ++ii )
+            m_opamp.AddDrawItem( new LIB_PIN( &m_opamp ) );
+
+        m_power.SetPower();
+        m_power.AddDrawItem( new LIB_PIN( &m_power ) );
+
+        m_derived.SetDescription( "Same amplifier, other vendor" );
+
+        m_cacheFile = wxFileName::CreateTempFileName( "sym_info_cache" );
+    }
+
+    ~SYMBOL_INFO_CACHE_FIXTURE()
+    {
+        wxRemoveFile( m_cacheFile );
+    }
+
+    std::vector<LIB_PART*> symbols() { return { &m_opamp, &m_power, &m_derived }; }
+
+    /**
+     * Check \a aIndexed is what the index should hold for symbols()
+     */
+    void checkIndexed( std::vector<SYMBOL_INFO>* aIndexed )
+    {
+        BOOST_REQUIRE( aIndexed );
+        BOOST_REQUIRE_EQUAL( aIndexed->size(), 3u );
+
+        std::vector<LIB_PART*> parts = symbols();
+
+        for( size_t ii = 0; ii < parts.size(); ++ii )
+        {
+            SYMBOL_INFO& info = ( *aIndexed )[ii];
+            LIB_PART*    part = parts[ii];
+
+            BOOST_TEST_CONTEXT( part->GetName() )
+            {
+                BOOST_CHECK( info.GetLibId() == LIB_ID( "Lib", part->GetName() ) );
+                BOOST_CHECK( info.GetDescription() == part->GetDescription() );
+                BOOST_CHECK( info.GetSearchText() == part->GetSearchText() );
+                BOOST_CHECK_EQUAL( info.IsRoot(), part->IsRoot() );
+                BOOST_CHECK_EQUAL( info.IsPower(), part->IsPower() );
+                BOOST_CHECK_EQUAL( info.GetUnitCount(), part->GetUnitCount() );
+            }
+        }
+
+        // Derived symbols have the pins of their parent
+        BOOST_CHECK_EQUAL( ( *aIndexed )[0].GetPinCount(), 8 );
+        BOOST_CHECK_EQUAL( ( *aIndexed )[1].GetPinCount(), 1 );
+        BOOST_CHECK_EQUAL( ( *aIndexed )[2].GetPinCount(), 8 );
+    }
+
+    LIB_PART m_opamp;
+    LIB_PART m_power;
+    LIB_PART m_derived;
+    wxString m_cacheFile;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( SymbolInfoCache, SYMBOL_INFO_CACHE_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( RoundTrip )
+{
+    SYMBOL_INFO_CACHE cache;
+
+    cache.SetLibrary( "Lib", 1234, symbols() );
+    checkIndexed( cache.GetLibrary( "Lib", 1234 ) );
+
+    // An index of another version of the library is of no use
+    BOOST_CHECK( !cache.GetLibrary( "Lib", 1235 ) );
+    BOOST_CHECK( !cache.GetLibrary( "OtherLib", 1234 ) );
+
+    cache.WriteCacheToFile( m_cacheFile );
+
+    SYMBOL_INFO_CACHE restored;
+    restored.ReadCacheFromFile( m_cacheFile );
+
+    checkIndexed( restored.GetLibrary( "Lib", 1234 ) );
+    BOOST_CHECK( !restored.GetLibrary( "Lib", 1235 ) );
+}
+
+
+BOOST_AUTO_TEST_CASE( VersionMismatch )
+{
+    SYMBOL_INFO_CACHE cache;
+
+    cache.SetLibrary( "Lib", 1234, symbols() );
+    cache.WriteCacheToFile( m_cacheFile );
+
+    std::vector<char> data;
+
+    {
+        wxFFile file( m_cacheFile, "rb" );
+        data.resize( file.Length() );
+        BOOST_REQUIRE_EQUAL( file.Read( data.data(), data.size() ), data.size() );
+    }
+
+    // The version follows the magic string and its length
+    uint32_t magicLength;
+    memcpy( &magicLength, data.data(), sizeof( magicLength ) );
+    data[ sizeof( magicLength ) + magicLength ]++;
+
+    {
+        wxFFile file( m_cacheFile, "wb" );
+        BOOST_REQUIRE( file.IsOpened() );
+        file.Write( data.data(), data.size() );
+    }
+
+    SYMBOL_INFO_CACHE restored;
+    restored.ReadCacheFromFile( m_cacheFile );
+
+    BOOST_CHECK( !restored.GetLibrary( "Lib", 1234 ) );
+}
+
+
+BOOST_AUTO_TEST_CASE( Truncated )
+{
+    SYMBOL_INFO_CACHE cache;
+
+    cache.SetLibrary( "Lib", 1234, symbols() );
+    cache.WriteCacheToFile( m_cacheFile );
+
+    std::vector<char> data;
+
+    {
+        wxFFile file( m_cacheFile, "rb" );
+        data.resize( file.Length() );
+        BOOST_REQUIRE_EQUAL( file.Read( data.data(), data.size() ), data.size() );
+    }
+
+    for( size_t size : { (size_t) 0, (size_t) 10, data.size() / 2, data.size() - 1 } )
+    {
+        BOOST_TEST_CONTEXT( "Truncated to " << size )
+        {
+            wxString truncatedFile = wxFileName::CreateTempFileName( "sym_info_cache" );
+
+            {
+                wxFFile file( truncatedFile, "wb" );
+                BOOST_REQUIRE( file.IsOpened() );
+                file.Write( data.data(), size );
+            }
+
+            SYMBOL_INFO_CACHE restored;
+            restored.ReadCacheFromFile( truncatedFile );
+
+            BOOST_CHECK( !restored.GetLibrary( "Lib", 1234 ) );
+
+            wxRemoveFile( truncatedFile );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
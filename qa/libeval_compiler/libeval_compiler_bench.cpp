@@ -0,0 +1,139 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file libeval_compiler_bench.cpp
+ * Times UCODE::Run() on a few typical DRC rule conditions.
+ *
+ * Each expression is evaluated both with a new context per evaluation (as
+ * DRC_RULE_CONDITION::EvaluateFor() does) and with one context reused for every evaluation.
+ * Only the public compiler/context API is used, so the same file can be built against older
+ * trees to compare evaluators.
+ *
+ * usage: libeval_compiler_bench [iterations]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <profile.h>
+
+#include <class_board.h>
+#include <class_track.h>
+
+#include <pcb_expr_evaluator.h>
+
+
+static const char* const s_expressions[] =
+{
+    "1",
+    "(1mm + 2mm) * 3 > 5mm",
+    "A.NetClass == 'HV'",
+    "A.NetClass == 'HV' && B.NetClass != 'HV'",
+    "A.Type == 'Track' && A.Width > 0.2mm",
+    "A.NetName == '/D*' || B.NetName == '/D*'",
+    "L == 'F.Cu' && A.isPlated()",
+    nullptr
+};
+
+
+static double timeRun( PCB_EXPR_UCODE& aUcode, BOARD_ITEM* aItemA, BOARD_ITEM* aItemB,
+                       int aIterations, bool aReuseContext, double* aChecksum )
+{
+    PCB_EXPR_CONTEXT reused( F_Cu );
+    PROF_COUNTER     timer;
+
+    reused.SetItems( aItemA, aItemB );
+
+    for( int ii = 0; ii < aIterations; ++ii )
+    {
+        if( aReuseContext )
+        {
+            *aChecksum += aUcode.Run( &reused )->AsDouble();
+        }
+        else
+        {
+            PCB_EXPR_CONTEXT ctx( F_Cu );
+            ctx.SetItems( aItemA, aItemB );
+            *aChecksum += aUcode.Run( &ctx )->AsDouble();
+        }
+    }
+
+    timer.Stop();
+
+    return timer.msecs() * 1e6 / aIterations;
+}
+
+
+int main( int argc, char* argv[] )
+{
+    int iterations = argc > 1 ? atoi( argv[1] ) : 1000000;
+
+    PROPERTY_MANAGER& propMgr = PROPERTY_MANAGER::Instance();
+    propMgr.Rebuild();
+
+    BOARD         brd;
+    NETCLASSPTR   hvClass( new NETCLASS( "HV" ) );
+    NETINFO_ITEM* net1 = new NETINFO_ITEM( &brd, "/D0", 1 );
+    NETINFO_ITEM* net2 = new NETINFO_ITEM( &brd, "/CLK", 2 );
+
+    brd.Add( net1 );
+    brd.Add( net2 );
+    net1->SetClass( hvClass );
+
+    TRACK trackA( &brd );
+    TRACK trackB( &brd );
+
+    trackA.SetNet( net1 );
+    trackA.SetWidth( Millimeter2iu( 0.25 ) );
+    trackA.SetLayer( F_Cu );
+    trackB.SetNet( net2 );
+    trackB.SetWidth( Millimeter2iu( 0.15 ) );
+    trackB.SetLayer( F_Cu );
+
+    double checksum = 0.0;
+
+    printf( "%-45s %14s %14s\n", "expression", "new ctx ns/op", "reused ns/op" );
+
+    for( int ii = 0; s_expressions[ii]; ++ii )
+    {
+        PCB_EXPR_COMPILER compiler;
+        PCB_EXPR_UCODE    ucode;
+        PCB_EXPR_CONTEXT  preflightContext( F_Cu );
+
+        if( !compiler.Compile( s_expressions[ii], &ucode, &preflightContext ) )
+        {
+            printf( "%-45s failed to compile\n", s_expressions[ii] );
+            continue;
+        }
+
+        double fresh = timeRun( ucode, &trackA, &trackB, iterations, false, &checksum );
+        double reused = timeRun( ucode, &trackA, &trackB, iterations, true, &checksum );
+
+        printf( "%-45s %14.1f %14.1f\n", s_expressions[ii], fresh, reused );
+    }
+
+    // Keeps the evaluations from being optimized away
+    printf( "checksum: %g\n", checksum );
+
+    return 0;
+}
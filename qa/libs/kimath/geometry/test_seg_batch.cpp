@@ -0,0 +1,188 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <random>
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <geometry/seg_batch.h>
+
+
+/**
+ * The linear scan the batch queries must match: first segment with the smallest distance
+ * below the bound.
+ */
+template <typename QUERY>
+static SEG_BATCH::RESULT referenceNearest( const SEG_BATCH& aBatch, const QUERY& aQuery,
+                                           size_t aFirst, size_t aLast, SEG::ecoord aBound )
+{
+    SEG_BATCH::RESULT result = { VECTOR2I::ECOORD_MAX, -1 };
+
+    for( size_t ii = aFirst; ii < aLast; ++ii )
+    {
+        SEG::ecoord dist = aBatch.Get( ii ).SquaredDistance( aQuery );
+
+        if( dist < aBound )
+        {
+            aBound = dist;
+            result = { dist, static_cast<int>( ii ) };
+        }
+    }
+
+    return result;
+}
+
+
+/**
+ * Random segments at a given scale, with some zero length and duplicated segments to get
+ * ties between the distances.
+ */
+static SEG_BATCH randomBatch( std::mt19937& aRng, int aCount, int aScale, int aMaxLength )
+{
+    std::uniform_int_distribution<int> coord( -aScale, aScale );
+    std::uniform_int_distribution<int> length( -aMaxLength, aMaxLength );
+    std::uniform_int_distribution<int> kind( 0, 9 );
+    SEG_BATCH                          batch;
+
+    for( int ii = 0; ii < aCount; ++ii )
+    {
+        int k = kind( aRng );
+
+        if( k == 0 && ii > 0 )
+        {
+            batch.Append( batch.Get( aRng() % ii ) );
+        }
+        else
+        {
+            VECTOR2I a( coord( aRng ), coord( aRng ) );
+            VECTOR2I b = k == 1 ? a : a + VECTOR2I( length( aRng ), length( aRng ) );
+
+            batch.Append( SEG( a, b ) );
+        }
+    }
+
+    return batch;
+}
+
+
+static bool sameResult( const SEG_BATCH::RESULT& aA, const SEG_BATCH::RESULT& aB )
+{
+    return aA.m_squaredDistance == aB.m_squaredDistance && aA.m_index == aB.m_index;
+}
+
+
+BOOST_AUTO_TEST_SUITE( SegBatch )
+
+
+BOOST_AUTO_TEST_CASE( Empty )
+{
+    SEG_BATCH batch;
+
+    BOOST_CHECK_EQUAL( batch.Nearest( VECTOR2I( 0, 0 ) ).m_index, -1 );
+    BOOST_CHECK_EQUAL( batch.Nearest( SEG( 0, 0, 10, 10 ) ).m_index, -1 );
+
+    batch.Append( SEG( 0, 0, 10, 0 ) );
+
+    // Nothing is closer than a zero bound
+    BOOST_CHECK_EQUAL( batch.Nearest( VECTOR2I( 5, 0 ), 0, 1, 0 ).m_index, -1 );
+    BOOST_CHECK_EQUAL( batch.Nearest( VECTOR2I( 5, 3 ), 0, 1, 10 ).m_squaredDistance, 9 );
+}
+
+
+/**
+ * Every instruction set must report the same distances and indices as SEG::SquaredDistance()
+ * scans, on random segments from a few units up to the scale of a large board.
+ */
+BOOST_AUTO_TEST_CASE( MatchesLinearScan )
+{
+    const SEG_BATCH::SIMD_LEVEL initialLevel = SEG_BATCH::GetSimdLevel();
+    const SEG_BATCH::SIMD_LEVEL levels[] = { SEG_BATCH::SIMD_LEVEL::SCALAR,
+                                             SEG_BATCH::SIMD_LEVEL::SSE2,
+                                             SEG_BATCH::SIMD_LEVEL::AVX2 };
+
+    const struct
+    {
+        int m_scale;
+        int m_maxLength;
+    } scales[] = { { 20, 5 }, { 100000, 1000 }, { 100000, 100000 }, { 500000000, 10000000 } };
+
+    for( SEG_BATCH::SIMD_LEVEL level : levels )
+    {
+        if( level > SEG_BATCH::SupportedSimdLevel() )
+            continue;
+
+        SEG_BATCH::SetSimdLevel( level );
+        BOOST_TEST_CONTEXT( "SIMD level " << static_cast<int>( level ) )
+        {
+            std::mt19937 rng( 42 );
+
+            for( const auto& scale : scales )
+            {
+                SEG_BATCH batch = randomBatch( rng, 300, scale.m_scale, scale.m_maxLength );
+
+                std::uniform_int_distribution<int> coord( -scale.m_scale, scale.m_scale );
+                std::uniform_int_distribution<int> length( -scale.m_maxLength,
+                                                           scale.m_maxLength );
+                std::uniform_int_distribution<size_t> index( 0, batch.Size() );
+
+                for( int ii = 0; ii < 200; ++ii )
+                {
+                    size_t first = index( rng );
+                    size_t last = index( rng );
+
+                    if( first > last )
+                        std::swap( first, last );
+
+                    // Sometimes the query is one of the segments, or one of their ends
+                    VECTOR2I p( coord( rng ), coord( rng ) );
+
+                    if( ii % 7 == 0 && batch.Size() )
+                        p = batch.Get( rng() % batch.Size() ).B;
+
+                    SEG s( p, p + VECTOR2I( length( rng ), length( rng ) ) );
+
+                    if( ii % 11 == 0 && batch.Size() )
+                        s = batch.Get( rng() % batch.Size() );
+
+                    SEG::ecoord bound = VECTOR2I::ECOORD_MAX;
+
+                    if( ii % 3 == 0 )
+                        bound = batch.Get( rng() % batch.Size() ).SquaredDistance( p );
+
+                    BOOST_CHECK( sameResult( batch.Nearest( p, first, last, bound ),
+                                             referenceNearest( batch, p, first, last, bound ) ) );
+                    BOOST_CHECK( sameResult( batch.Nearest( s, first, last, bound ),
+                                             referenceNearest( batch, s, first, last, bound ) ) );
+                    BOOST_CHECK( sameResult( batch.Nearest( p ),
+                                             referenceNearest( batch, p, 0, batch.Size(),
+                                                               VECTOR2I::ECOORD_MAX ) ) );
+                }
+            }
+        }
+    }
+
+    SEG_BATCH::SetSimdLevel( initialLevel );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -23,6 +23,7 @@
 
 #include <geometry/shape_arc.h>
 #include <geometry/shape_line_chain.h>
+#include <math/util.h>
 
 #include <unit_test_utils/geometry.h>
 #include <unit_test_utils/numeric.h>
@@ -59,4 +60,110 @@ BOOST_AUTO_TEST_CASE( ArcToPolyline )
 }
 
 
+/**
+ * A closed, wavy chain long enough to use the segment index
+ */
+static SHAPE_LINE_CHAIN wavyRing( int aPointCount, int aRadius, int aWave )
+{
+    SHAPE_LINE_CHAIN chain;
+
+    for( int ii = 0; ii < aPointCount; ++ii )
+    {
+        double angle = 2.0 * M_PI * ii / aPointCount;
+        double r = aRadius + ( ii % 2 ? aWave : -aWave );
+
+        chain.Append( KiROUND( r * cos( angle ) ), KiROUND( r * sin( angle ) ) );
+    }
+
+    chain.SetClosed( true );
+    return chain;
+}
+
+
+/**
+ * Check the queries using the segment index against the linear scans of
+ * SHAPE_LINE_CHAIN_BASE
+ */
+static void checkIndexedQueries( const SHAPE_LINE_CHAIN& aChain, int aRange )
+{
+    const SHAPE_LINE_CHAIN_BASE& base = aChain;
+
+    for( int x = -aRange; x <= aRange; x += aRange / 23 )
+    {
+        for( int y = -aRange; y <= aRange; y += aRange / 19 )
+        {
+            VECTOR2I pt( x, y );
+            VECTOR2I end( x + aRange / 7, y - aRange / 11 );
+            SEG      seg( pt, end );
+
+            BOOST_TEST_CONTEXT( "Point " << pt << ", segment " << seg )
+            {
+                BOOST_CHECK_EQUAL( aChain.PointInside( pt ), base.PointInside( pt ) );
+                BOOST_CHECK_EQUAL( aChain.PointInside( pt, 1000 ), base.PointInside( pt, 1000 ) );
+                BOOST_CHECK_EQUAL( aChain.EdgeContainingPoint( pt, 5000 ),
+                                   base.EdgeContainingPoint( pt, 5000 ) );
+                BOOST_CHECK_EQUAL( aChain.SquaredDistance( pt ), base.SquaredDistance( pt ) );
+                BOOST_CHECK_EQUAL( aChain.SquaredDistance( pt, true ),
+                                   base.SquaredDistance( pt, true ) );
+
+                for( int clearance : { 0, 1000, 20000 } )
+                {
+                    int      actual = -1, baseActual = -1;
+                    VECTOR2I location, baseLocation;
+
+                    BOOST_CHECK_EQUAL( aChain.Collide( pt, clearance, &actual, &location ),
+                                       base.SHAPE_LINE_CHAIN_BASE::Collide( pt, clearance,
+                                                                            &baseActual,
+                                                                            &baseLocation ) );
+                    BOOST_CHECK_EQUAL( actual, baseActual );
+                    BOOST_CHECK_EQUAL( location, baseLocation );
+
+                    actual = baseActual = -1;
+
+                    BOOST_CHECK_EQUAL( aChain.Collide( seg, clearance, &actual, &location ),
+                                       base.SHAPE_LINE_CHAIN_BASE::Collide( seg, clearance,
+                                                                            &baseActual,
+                                                                            &baseLocation ) );
+                    BOOST_CHECK_EQUAL( actual, baseActual );
+                    BOOST_CHECK_EQUAL( location, baseLocation );
+
+                    BOOST_CHECK_EQUAL( aChain.Collide( seg, clearance, nullptr, &location ),
+                                       base.SHAPE_LINE_CHAIN_BASE::Collide( seg, clearance,
+                                                                            nullptr,
+                                                                            &baseLocation ) );
+                    BOOST_CHECK_EQUAL( location, baseLocation );
+                }
+            }
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( SegmentIndex )
+{
+    SHAPE_LINE_CHAIN chain = wavyRing( 1000, 1000000, 30000 );
+
+    BOOST_REQUIRE_GE( chain.SegmentCount(), SHAPE_LINE_CHAIN::SEGMENT_INDEX_MIN_SEGMENTS );
+
+    checkIndexedQueries( chain, 1200000 );
+
+    // The index must follow the modifications of the chain
+    chain.Move( VECTOR2I( 300000, -200000 ) );
+    checkIndexedQueries( chain, 1200000 );
+
+    chain.SetPoint( 10, VECTOR2I( 0, 0 ) );
+    chain.Remove( 500, 600 );
+    checkIndexedQueries( chain, 1200000 );
+
+    chain.SetClosed( false );
+    checkIndexedQueries( chain, 1200000 );
+
+    // Copies don't share the index of the original
+    SHAPE_LINE_CHAIN copy = chain;
+    chain.Rotate( M_PI / 3 );
+    checkIndexedQueries( chain, 1200000 );
+    checkIndexedQueries( copy, 1200000 );
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -22,6 +22,8 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <random>
+
 #include <unit_test_utils/unit_test_utils.h>
 
 #include <geometry/shape_line_chain.h>
@@ -29,6 +31,59 @@
 
 #include "fixtures_geometry.h"
 
+
+/**
+ * A set of a few islands with many holes, made of random squares and octagons, like the
+ * clearance holes of a zone fill.
+ */
+static SHAPE_POLY_SET randomHoleyPolySet( std::mt19937& aRng )
+{
+    std::uniform_int_distribution<int> coord( 0, 100000 );
+    std::uniform_int_distribution<int> size( 200, 3000 );
+    SHAPE_POLY_SET                     islands;
+    SHAPE_POLY_SET                     holes;
+
+    for( int ii = 0; ii < 3; ii++ )
+    {
+        SHAPE_LINE_CHAIN outline;
+        int              x = ii * 35000;
+
+        outline.Append( x, 0 );
+        outline.Append( x + 30000, 0 );
+        outline.Append( x + 30000, 100000 );
+        outline.Append( x, 100000 );
+        outline.SetClosed( true );
+        islands.AddOutline( outline );
+    }
+
+    for( int ii = 0; ii < 500; ii++ )
+    {
+        SHAPE_LINE_CHAIN hole;
+        VECTOR2I         c( coord( aRng ), coord( aRng ) );
+        int              r = size( aRng );
+
+        if( ii % 2 )
+        {
+            hole.Append( c.x - r, c.y - r );
+            hole.Append( c.x + r, c.y - r );
+            hole.Append( c.x + r, c.y + r );
+            hole.Append( c.x - r, c.y + r );
+        }
+        else
+        {
+            for( int jj = 0; jj < 8; jj++ )
+                hole.Append( c + VECTOR2I( r, 0 ).Rotate( jj * M_PI / 4 ) );
+        }
+
+        hole.SetClosed( true );
+        holes.AddOutline( hole );
+    }
+
+    islands.BooleanSubtract( holes, SHAPE_POLY_SET::PM_FAST );
+    return islands;
+}
+
+
 /**
  * Fixture for the Collision test suite. It contains an instance of the common data and two
  * vectors containing colliding and non-colliding points.
@@ -209,4 +264,74 @@ BOOST_AUTO_TEST_CASE( CollideVertexWithClearance )
     }
 }
 
+/**
+ * Contains() and Collide() must give the same results with and without the contour grid, and
+ * the grid must follow the modifications of the set.
+ */
+BOOST_AUTO_TEST_CASE( ContainsCache )
+{
+    std::mt19937                       rng( 42 );
+    std::uniform_int_distribution<int> coord( -1000, 106000 );
+    SHAPE_POLY_SET                     reference = randomHoleyPolySet( rng );
+    SHAPE_POLY_SET                     cached = reference;
+
+    BOOST_CHECK( !cached.IsContainsCacheEnabled() );
+    cached.EnableContainsCache();
+    BOOST_CHECK( cached.IsContainsCacheEnabled() );
+    BOOST_CHECK( SHAPE_POLY_SET( cached ).IsContainsCacheEnabled() );
+
+    auto checkPoint =
+            [&]( const VECTOR2I& aP )
+            {
+                BOOST_TEST_CONTEXT( "Point " << aP.x << ", " << aP.y )
+                {
+                    BOOST_CHECK_EQUAL( cached.Contains( aP ), reference.Contains( aP ) );
+                    BOOST_CHECK_EQUAL( cached.Contains( aP, 1 ), reference.Contains( aP, 1 ) );
+
+                    for( int clearance : { 0, 100, 1000 } )
+                    {
+                        int      cachedActual = -1, referenceActual = -1;
+                        VECTOR2I cachedLocation, referenceLocation;
+
+                        BOOST_CHECK_EQUAL( cached.Collide( aP, clearance, &cachedActual,
+                                                           &cachedLocation ),
+                                           reference.Collide( aP, clearance, &referenceActual,
+                                                              &referenceLocation ) );
+                        BOOST_CHECK_EQUAL( cachedActual, referenceActual );
+                        BOOST_CHECK_EQUAL( cachedLocation, referenceLocation );
+                    }
+                }
+            };
+
+    auto checkPoints =
+            [&]()
+            {
+                for( int ii = 0; ii < 500; ii++ )
+                    checkPoint( VECTOR2I( coord( rng ), coord( rng ) ) );
+
+                // On the contours
+                for( auto it = reference.CIterateWithHoles(); it; it++ )
+                {
+                    if( it.GetIndex().m_vertex % 5 == 0 )
+                        checkPoint( *it );
+                }
+            };
+
+    BOOST_CHECK( reference.HoleCount( 0 ) > 10 );
+    checkPoints();
+
+    // Modifications drop the grid
+    reference.Move( VECTOR2I( 500, -700 ) );
+    cached.Move( VECTOR2I( 500, -700 ) );
+    checkPoints();
+
+    reference.Outline( 1 ).Move( VECTOR2I( 0, 20000 ) );
+    cached.Outline( 1 ).Move( VECTOR2I( 0, 20000 ) );
+    checkPoints();
+
+    reference.DeletePolygon( 0 );
+    cached.DeletePolygon( 0 );
+    checkPoints();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,200 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file shape_line_chain_bench.cpp
+ * Times line chain vs line chain collisions, as done by DRC and the router between a zone
+ * outline and an arc-heavy track, with the segment index of SHAPE_LINE_CHAIN and with the
+ * linear scans of SHAPE_LINE_CHAIN_BASE.
+ *
+ * usage: kimath_shape_line_chain_bench [iterations]
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include <profile.h>
+
+#include <geometry/shape_arc.h>
+#include <geometry/shape_line_chain.h>
+#include <math/util.h>
+
+
+/**
+ * Forwards to a SHAPE_LINE_CHAIN, hiding it from the index: queries go through the linear
+ * scans of SHAPE_LINE_CHAIN_BASE.
+ */
+class LINEAR_CHAIN : public SHAPE_LINE_CHAIN_BASE
+{
+public:
+    LINEAR_CHAIN( const SHAPE_LINE_CHAIN& aChain ) :
+            SHAPE_LINE_CHAIN_BASE( SH_LINE_CHAIN ),
+            m_chain( aChain )
+    {
+    }
+
+    SHAPE* Clone() const override { return nullptr; }
+    const BOX2I BBox( int aClearance = 0 ) const override { return m_chain.BBox( aClearance ); }
+    void Rotate( double aAngle, const VECTOR2I& aCenter = { 0, 0 } ) override {}
+    void Move( const VECTOR2I& aVector ) override {}
+    bool IsSolid() const override { return false; }
+
+    const VECTOR2I GetPoint( int aIndex ) const override { return m_chain.CPoint( aIndex ); }
+    const SEG GetSegment( int aIndex ) const override { return m_chain.CSegment( aIndex ); }
+    size_t GetPointCount() const override { return m_chain.PointCount(); }
+    size_t GetSegmentCount() const override { return m_chain.SegmentCount(); }
+    bool IsClosed() const override { return m_chain.IsClosed(); }
+
+private:
+    const SHAPE_LINE_CHAIN& m_chain;
+};
+
+
+/**
+ * A zone-like outline: a closed ring with a fine zig-zag edge
+ */
+static SHAPE_LINE_CHAIN zoneOutline( int aPointCount, int aRadius )
+{
+    SHAPE_LINE_CHAIN chain;
+
+    for( int ii = 0; ii < aPointCount; ++ii )
+    {
+        double angle = 2.0 * M_PI * ii / aPointCount;
+        double r = aRadius + ( ii % 2 ? 5000 : -5000 );
+
+        chain.Append( KiROUND( r * cos( angle ) ), KiROUND( r * sin( angle ) ) );
+    }
+
+    chain.SetClosed( true );
+    return chain;
+}
+
+
+/**
+ * A track made of arcs outside the outline, coming within aGap of it
+ */
+static SHAPE_LINE_CHAIN arcTrack( int aRadius, int aGap )
+{
+    SHAPE_LINE_CHAIN chain;
+
+    for( int ii = 0; ii < 8; ++ii )
+    {
+        // Short steps along the outline, so that the links between arcs don't cross it
+        double   angle = ii * 400000.0 / aRadius;
+        VECTOR2I center( aRadius + aGap + 200000, 0 );
+        VECTOR2I start = center - VECTOR2I( 200000, 0 );
+
+        SHAPE_ARC arc( center.Rotate( angle ), start.Rotate( angle ), 90.0 );
+        chain.Append( arc );
+    }
+
+    return chain;
+}
+
+
+/**
+ * Call aA.Collide( segment ) for each segment of aB, as shape_collisions.cpp does
+ */
+static bool collide( const SHAPE_LINE_CHAIN_BASE& aA, const SHAPE_LINE_CHAIN_BASE& aB,
+                     int aClearance, int* aActual )
+{
+    bool collided = false;
+
+    for( size_t ii = 0; ii < aB.GetSegmentCount(); ii++ )
+    {
+        int actual = 0;
+
+        if( aA.Collide( aB.GetSegment( ii ), aClearance, &actual ) )
+        {
+            *aActual = collided ? std::min( *aActual, actual ) : actual;
+            collided = true;
+        }
+    }
+
+    return collided;
+}
+
+
+static double timeCollide( const SHAPE_LINE_CHAIN_BASE& aA, const SHAPE_LINE_CHAIN_BASE& aB,
+                           int aClearance, int aIterations, int* aChecksum )
+{
+    PROF_COUNTER timer;
+
+    for( int ii = 0; ii < aIterations; ++ii )
+    {
+        int actual = -1;
+
+        if( collide( aA, aB, aClearance, &actual ) )
+            *aChecksum += actual;
+    }
+
+    timer.Stop();
+
+    return timer.msecs() * 1e3 / aIterations;
+}
+
+
+int main( int argc, char* argv[] )
+{
+    int iterations = argc > 1 ? atoi( argv[1] ) : 100;
+    int checksum = 0;
+
+    const int radius = 50000000;
+    const int clearance = 200000;
+
+    printf( "%10s %10s %10s %16s %16s\n", "outline", "track", "gap", "indexed us/op",
+            "linear us/op" );
+
+    for( int pointCount : { 100, 1000, 10000, 100000 } )
+    {
+        SHAPE_LINE_CHAIN outline = zoneOutline( pointCount, radius );
+        LINEAR_CHAIN     linearOutline( outline );
+
+        for( int gap : { clearance / 2, clearance * 10 } )
+        {
+            SHAPE_LINE_CHAIN track = arcTrack( radius, gap );
+            int              indexedActual = -1;
+            int              linearActual = -1;
+
+            // Results must not depend on the index
+            if( collide( outline, track, clearance, &indexedActual )
+                        != collide( linearOutline, track, clearance, &linearActual )
+                    || indexedActual != linearActual )
+            {
+                printf( "results differ for %d points, gap %d\n", pointCount, gap );
+                return 1;
+            }
+
+            double indexed = timeCollide( outline, track, clearance, iterations, &checksum );
+            double linear = timeCollide( linearOutline, track, clearance, iterations, &checksum );
+
+            printf( "%10d %10d %10d %16.1f %16.1f\n", pointCount, track.SegmentCount(), gap,
+                    indexed, linear );
+        }
+    }
+
+    // Keeps the collisions from being optimized away
+    printf( "checksum: %d\n", checksum );
+
+    return 0;
+}
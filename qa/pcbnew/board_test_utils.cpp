@@ -25,6 +25,17 @@
 
 #include <pcbnew_utils/board_file_utils.h>
 
+#include <wx/filename.h>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <netinfo.h>
+#include <drc/drc_engine.h>
+#include <geometry/shape_poly_set.h>
+
 // For the temp directory logic: can be std::filesystem in C++17
 #include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
@@ -50,4 +61,107 @@ void BOARD_DUMPER::DumpBoardToFile( BOARD& aBoard, const std::string& aName ) co
     ::KI_TEST::DumpBoardToFile( aBoard, path.string() );
 }
 
+
+static void addZone( BOARD* aBoard, PCB_LAYER_ID aLayer, NETINFO_ITEM* aNet, unsigned aPriority,
+                     const wxPoint& aStart, const wxPoint& aEnd )
+{
+    ZONE_CONTAINER* zone = new ZONE_CONTAINER( aBoard );
+
+    zone->SetLayer( aLayer );
+    zone->SetNetCode( aNet->GetNet() );
+    zone->SetPriority( aPriority );
+    zone->SetLocalClearance( Millimeter2iu( 0.3 ) );
+    zone->SetMinThickness( Millimeter2iu( 0.25 ) );
+    zone->SetPadConnection( ZONE_CONNECTION::THERMAL );
+    zone->SetThermalReliefGap( Millimeter2iu( 0.5 ) );
+    zone->SetThermalReliefSpokeWidth( Millimeter2iu( 0.5 ) );
+
+    zone->Outline()->NewOutline();
+    zone->AppendCorner( aStart, -1 );
+    zone->AppendCorner( wxPoint( aEnd.x, aStart.y ), -1 );
+    zone->AppendCorner( aEnd, -1 );
+    zone->AppendCorner( wxPoint( aStart.x, aEnd.y ), -1 );
+
+    aBoard->Add( zone, ADD_MODE::APPEND );
+}
+
+
+std::unique_ptr<BOARD> MakeZoneFillBoard()
+{
+    std::unique_ptr<BOARD> board = std::make_unique<BOARD>();
+    BOARD_DESIGN_SETTINGS& bds = board->GetDesignSettings();
+
+    board->SetCopperLayerCount( 2 );
+
+    NETINFO_ITEM* gnd = new NETINFO_ITEM( board.get(), "GND", 1 );
+    NETINFO_ITEM* vcc = new NETINFO_ITEM( board.get(), "VCC", 2 );
+    NETINFO_ITEM* sig = new NETINFO_ITEM( board.get(), "SIG", 3 );
+
+    board->Add( gnd );
+    board->Add( vcc );
+    board->Add( sig );
+
+    auto mm = []( double x, double y )
+              {
+                  return wxPoint( Millimeter2iu( x ), Millimeter2iu( y ) );
+              };
+
+    addZone( board.get(), F_Cu, gnd, 0, mm( 0, 0 ), mm( 60, 40 ) );
+    addZone( board.get(), F_Cu, vcc, 1, mm( 30, 15 ), mm( 55, 30 ) );
+    addZone( board.get(), B_Cu, gnd, 0, mm( 0, 0 ), mm( 60, 40 ) );
+    addZone( board.get(), B_Cu, vcc, 1, mm( 5, 20 ), mm( 25, 35 ) );
+
+    for( int ii = 0; ii < 8; ++ii )
+    {
+        TRACK* track = new TRACK( board.get() );
+        track->SetLayer( ii % 2 ? B_Cu : F_Cu );
+        track->SetWidth( Millimeter2iu( 0.25 + 0.05 * ii ) );
+        track->SetStart( mm( 3 + 7 * ii, 3 ) );
+        track->SetEnd( mm( 6 + 7 * ii, 17 ) );
+        track->SetNetCode( sig->GetNet() );
+        board->Add( track, ADD_MODE::APPEND );
+    }
+
+    MODULE* module = new MODULE( board.get() );
+    module->SetReference( "J1" );
+    board->Add( module );
+
+    for( int ii = 0; ii < 6; ++ii )
+    {
+        D_PAD* pad = new D_PAD( module );
+        pad->SetName( wxString::Format( "%d", ii + 1 ) );
+        pad->SetAttribute( PAD_ATTRIB_PTH );
+        pad->SetLayerSet( D_PAD::PTHMask() );
+        pad->SetShape( ii % 2 ? PAD_SHAPE_RECT : PAD_SHAPE_CIRCLE );
+        pad->SetSize( wxSize( Millimeter2iu( 1.7 ), Millimeter2iu( 1.7 ) ) );
+        pad->SetDrillSize( wxSize( Millimeter2iu( 1.0 ), Millimeter2iu( 1.0 ) ) );
+        pad->SetPosition( mm( 10 + 8 * ii, 22.5 ) );
+        pad->SetNetCode( ( ii % 3 == 0 ? gnd : ii % 3 == 1 ? vcc : sig )->GetNet() );
+        module->Add( pad );
+    }
+
+    bds.m_DRCEngine = std::make_shared<DRC_ENGINE>( board.get(), &bds );
+    bds.m_DRCEngine->InitEngine( wxFileName() );
+
+    board->BuildConnectivity();
+
+    return board;
+}
+
+
+double PolySetArea( const SHAPE_POLY_SET& aPolys )
+{
+    double area = 0.0;
+
+    for( int ii = 0; ii < aPolys.OutlineCount(); ++ii )
+    {
+        area += std::abs( aPolys.COutline( ii ).Area() );
+
+        for( int jj = 0; jj < aPolys.HoleCount( ii ); ++jj )
+            area -= std::abs( aPolys.CHole( ii, jj ).Area() );
+    }
+
+    return area;
+}
+
 } // namespace KI_TEST
\ No newline at end of file
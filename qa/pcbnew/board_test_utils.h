@@ -29,10 +29,12 @@
 #ifndef QA_PCBNEW_BOARD_TEST_UTILS__H
 #define QA_PCBNEW_BOARD_TEST_UTILS__H
 
+#include <memory>
 #include <string>
 
 class BOARD;
 class BOARD_ITEM;
+class SHAPE_POLY_SET;
 
 
 namespace KI_TEST
@@ -58,6 +60,20 @@ public:
     const bool m_dump_boards;
 };
 
+
+/**
+ * Build a small board for zone fill tests: overlapping zones of different priorities and
+ * nets on both outer layers, with tracks and through hole pads to knock out of them and to
+ * connect to them.  The board has a DRC engine with the default rules, and its zones are not
+ * filled.
+ */
+std::unique_ptr<BOARD> MakeZoneFillBoard();
+
+/**
+ * @return the area of \a aPolys, holes excluded.
+ */
+double PolySetArea( const SHAPE_POLY_SET& aPolys );
+
 } // namespace KI_TEST
 
 #endif // QA_PCBNEW_BOARD_TEST_UTILS__H
\ No newline at end of file
@@ -0,0 +1,265 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <wx/ffile.h>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+#include <netinfo.h>
+#include <property_mgr.h>
+#include <reporter.h>
+#include <drc/drc_engine.h>
+#include <drc/drc_rule.h>
+
+
+BOOST_AUTO_TEST_SUITE( DrcConstraintCache )
+
+
+struct CACHE_MODE_CASE
+{
+    std::string            m_expression;
+    DRC_ENGINE::CACHE_MODE m_expected;
+};
+
+
+/**
+ * Check the rule conditions are classified by the most specific thing they depend on
+ */
+BOOST_AUTO_TEST_CASE( ConditionClassification )
+{
+    const std::vector<CACHE_MODE_CASE> cases = {
+        { "", DRC_ENGINE::CACHE_BY_NETCLASS },
+        { "A.NetClass == 'Power'", DRC_ENGINE::CACHE_BY_NETCLASS },
+        { "a.netclass == 'Power' || B.netclass == 'Power'", DRC_ENGINE::CACHE_BY_NETCLASS },
+        { "A.Type == 'Via' && A.Via_Type != 'Micro'", DRC_ENGINE::CACHE_BY_NETCLASS },
+        { "A.Pad_Type == 'SMD' && !A.isPlated()", DRC_ENGINE::CACHE_BY_NETCLASS },
+        { "A.isMicroVia() || A.isBlindBuriedVia()", DRC_ENGINE::CACHE_BY_NETCLASS },
+        { "L == 'F.Cu'", DRC_ENGINE::CACHE_BY_NETCLASS },
+        // Words inside string literals and unit suffixes aren't identifiers
+        { "A.NetClass == 'Width insideArea'", DRC_ENGINE::CACHE_BY_NETCLASS },
+        { "A.Net == 3", DRC_ENGINE::CACHE_BY_NET },
+        { "A.NetName == 'GND'", DRC_ENGINE::CACHE_BY_NET },
+        { "A.netname == \"GND\"", DRC_ENGINE::CACHE_BY_NET },
+        { "A.isDiffPair()", DRC_ENGINE::CACHE_BY_NET },
+        { "A.NetClass == 'HS' && A.isDiffPair()", DRC_ENGINE::CACHE_BY_NET },
+        { "A.insideArea('Keepout')", DRC_ENGINE::CACHE_NONE },
+        { "A.insideCourtyard('U1')", DRC_ENGINE::CACHE_NONE },
+        { "A.memberOf('Group')", DRC_ENGINE::CACHE_NONE },
+        { "A.fromTo('U1-1', 'U2-1')", DRC_ENGINE::CACHE_NONE },
+        { "A.existsOnLayer('B.Cu')", DRC_ENGINE::CACHE_NONE },
+        { "A.Width > 0.3mm", DRC_ENGINE::CACHE_NONE },
+        { "A.Reference == 'U1'", DRC_ENGINE::CACHE_NONE },
+        { "A.NetName == 'GND' && A.Width > 1mm", DRC_ENGINE::CACHE_NONE },
+    };
+
+    for( const CACHE_MODE_CASE& c : cases )
+    {
+        BOOST_TEST_CONTEXT( c.m_expression )
+        {
+            BOOST_CHECK_EQUAL( DRC_ENGINE::ConditionCacheMode( c.m_expression ), c.m_expected );
+        }
+    }
+}
+
+
+/**
+ * A small board whose items share rule signatures in every way that matters: same netclass
+ * but different nets, same net but different widths, etc.
+ */
+static std::unique_ptr<BOARD> makeBoard()
+{
+    std::unique_ptr<BOARD> board = std::make_unique<BOARD>();
+    BOARD_DESIGN_SETTINGS& bds = board->GetDesignSettings();
+
+    board->SetCopperLayerCount( 4 );
+
+    NETCLASSPTR power = std::make_shared<NETCLASS>( "Power" );
+    power->SetClearance( Millimeter2iu( 0.5 ) );
+    power->SetTrackWidth( Millimeter2iu( 0.8 ) );
+    bds.GetNetClasses().Add( power );
+
+    std::vector<NETINFO_ITEM*> nets;
+    int                        netcode = 1;
+
+    for( const char* name : { "GND", "VCC", "SIG+", "SIG-", "CLK" } )
+    {
+        NETINFO_ITEM* net = new NETINFO_ITEM( board.get(), name, netcode++ );
+        board->Add( net );
+        nets.push_back( net );
+    }
+
+    nets[0]->SetClass( power );
+    nets[1]->SetClass( power );
+
+    int x = 0;
+
+    for( NETINFO_ITEM* net : nets )
+    {
+        for( double width : { 0.2, 0.4 } )
+        {
+            TRACK* track = new TRACK( board.get() );
+            track->SetLayer( F_Cu );
+            track->SetWidth( Millimeter2iu( width ) );
+            track->SetStart( wxPoint( x, 0 ) );
+            track->SetEnd( wxPoint( x, Millimeter2iu( 5 ) ) );
+            track->SetNetCode( net->GetNet() );
+            board->Add( track, ADD_MODE::APPEND );
+            x += Millimeter2iu( 2 );
+        }
+
+        for( VIATYPE type : { VIATYPE::THROUGH, VIATYPE::MICROVIA } )
+        {
+            VIA* via = new VIA( board.get() );
+            via->SetViaType( type );
+            via->SetLayerPair( F_Cu, type == VIATYPE::THROUGH ? B_Cu : In1_Cu );
+            via->SetPosition( wxPoint( x, 0 ) );
+            via->SetNetCode( net->GetNet() );
+            board->Add( via, ADD_MODE::APPEND );
+            x += Millimeter2iu( 2 );
+        }
+    }
+
+    MODULE* module = new MODULE( board.get() );
+    board->Add( module );
+
+    for( int ii = 0; ii < 4; ++ii )
+    {
+        D_PAD* pad = new D_PAD( module );
+        pad->SetAttribute( ii % 2 ? PAD_ATTRIB_SMD : PAD_ATTRIB_PTH );
+        pad->SetLayerSet( ii % 2 ? D_PAD::SMDMask() : D_PAD::PTHMask() );
+        pad->SetPosition( wxPoint( x, 0 ) );
+        pad->SetNetCode( nets[ ii ]->GetNet() );
+        module->Add( pad );
+        x += Millimeter2iu( 2 );
+    }
+
+    return board;
+}
+
+
+/**
+ * Resolve every constraint for every pair of items twice through the memoized path (so the
+ * second round is served from the cache), and check it matches a resolution which bypasses
+ * the cache.
+ */
+BOOST_AUTO_TEST_CASE( CachedMatchesUncached )
+{
+    PROPERTY_MANAGER::Instance().Rebuild();
+
+    std::unique_ptr<BOARD> board = makeBoard();
+
+    // One constraint type per cache mode
+    const std::string rules =
+            "(version 20200610)\n"
+            "(rule \"power to via\" (constraint clearance (min 0.6mm))\n"
+            "    (condition \"A.NetClass == 'Power' && B.Type == 'Via'\"))\n"
+            "(rule \"positive side\" (constraint hole_clearance (min 0.7mm))\n"
+            "    (condition \"A.NetName == 'SIG+' || A.isDiffPair() && A.Type == 'Pad'\"))\n"
+            "(rule \"wide tracks\" (constraint track_width (min 0.35mm))\n"
+            "    (condition \"A.Width > 0.3mm\"))\n";
+
+    wxFileName rulesFile( wxFileName::CreateTempFileName( "drc_cache" ) );
+    {
+        wxFFile file( rulesFile.GetFullPath(), "wb" );
+        BOOST_REQUIRE( file.IsOpened() );
+        file.Write( rules );
+    }
+
+    DRC_ENGINE drcEngine( board.get(), &board->GetDesignSettings() );
+    drcEngine.InitEngine( rulesFile );
+    wxRemoveFile( rulesFile.GetFullPath() );
+
+    BOOST_REQUIRE( drcEngine.RulesValid() );
+
+    std::vector<BOARD_ITEM*> items;
+
+    for( TRACK* track : board->Tracks() )
+        items.push_back( track );
+
+    for( MODULE* module : board->Modules() )
+    {
+        for( D_PAD* pad : module->Pads() )
+            items.push_back( pad );
+    }
+
+    const std::vector<DRC_CONSTRAINT_TYPE_T> types = { DRC_CONSTRAINT_TYPE_CLEARANCE,
+                                                       DRC_CONSTRAINT_TYPE_HOLE_CLEARANCE,
+                                                       DRC_CONSTRAINT_TYPE_TRACK_WIDTH };
+
+    std::vector<BOARD_ITEM*> others = items;
+    others.push_back( nullptr );
+
+    for( int round = 0; round < 2; ++round )
+    {
+        for( DRC_CONSTRAINT_TYPE_T type : types )
+        {
+            for( size_t ii = 0; ii < items.size(); ++ii )
+            {
+                for( size_t jj = 0; jj < others.size(); ++jj )
+                {
+                    for( PCB_LAYER_ID layer : { UNDEFINED_LAYER, F_Cu } )
+                    {
+                        BOARD_ITEM*    a = items[ii];
+                        BOARD_ITEM*    b = others[jj];
+                        DRC_CONSTRAINT cached = drcEngine.EvalRulesForItems( type, a, b, layer );
+                        DRC_CONSTRAINT uncached = drcEngine.EvalRulesForItems( type, a, b, layer,
+                                                            &NULL_REPORTER::GetInstance() );
+
+                        BOOST_TEST_CONTEXT( "Round " << round << ", constraint " << type
+                                            << ", items " << ii << " / " << jj
+                                            << ", layer " << layer )
+                        {
+                            BOOST_CHECK( cached.GetParentRule() == uncached.GetParentRule() );
+                            BOOST_CHECK_EQUAL( cached.GetValue().Min(), uncached.GetValue().Min() );
+                            BOOST_CHECK_EQUAL( cached.GetValue().Max(), uncached.GetValue().Max() );
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // A rule must actually have distinguished items sharing a netclass, and items sharing a net
+    auto ruleName =
+            [&]( DRC_CONSTRAINT_TYPE_T aType, BOARD_ITEM* aItem ) -> wxString
+            {
+                DRC_CONSTRAINT c = drcEngine.EvalRulesForItems( aType, aItem );
+                return c.GetParentRule() ? c.GetParentRule()->m_Name : wxString();
+            };
+
+    TRACK* narrowSigP = board->Tracks()[8];
+    TRACK* narrowSigN = board->Tracks()[12];
+    TRACK* wideSigP = board->Tracks()[9];
+
+    BOOST_CHECK( ruleName( DRC_CONSTRAINT_TYPE_HOLE_CLEARANCE, narrowSigP ) == "positive side" );
+    BOOST_CHECK( ruleName( DRC_CONSTRAINT_TYPE_HOLE_CLEARANCE, narrowSigN ) != "positive side" );
+    BOOST_CHECK( ruleName( DRC_CONSTRAINT_TYPE_TRACK_WIDTH, wideSigP ) == "wide tracks" );
+    BOOST_CHECK( ruleName( DRC_CONSTRAINT_TYPE_TRACK_WIDTH, narrowSigP ) != "wide tracks" );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,273 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <cstring>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include <class_module.h>
+#include <class_pad.h>
+#include <footprint_info_impl.h>
+#include <fp_lib_table.h>
+#include <locale_io.h>
+#include <richio.h>
+#include <plugins/kicad/kicad_plugin.h>
+#include <plugins/kicad/pcb_parser.h>
+
+
+/**
+ * A footprint library written to a temporary directory: footprints with different pad
+ * counts and docs, and one file which does not parse
+ */
+struct FOOTPRINT_LIBRARY_FIXTURE
+{
+    FOOTPRINT_LIBRARY_FIXTURE()
+    {
+        wxFileName tempFile( wxFileName::CreateTempFileName( "fp_list" ) );
+        wxRemoveFile( tempFile.GetFullPath() );
+
+        m_libPath = tempFile.GetFullPath() + ".pretty";
+        BOOST_REQUIRE( wxFileName::Mkdir( m_libPath ) );
+
+        PCB_IO io;
+
+        for( int ii = 0; ii < 12; ++ii )
+        {
+            MODULE module( nullptr );
+            wxString name = wxString::Format( "FP_%d", ii );
+
+            module.SetFPID( LIB_ID( wxEmptyString, name ) );
+            module.SetDescription( wxString::Format( "Footprint number %d", ii ) );
+            module.SetKeywords( ii % 2 ? "odd" : "even" );
+
+            for( int jj = 0; jj < ii; ++jj )
+            {
+                D_PAD* pad = new D_PAD( &module );
+
+                pad->SetAttribute( jj % 3 ? PAD_ATTRIB_SMD : PAD_ATTRIB_PTH );
+                pad->SetLayerSet( jj % 3 ? D_PAD::SMDMask() : D_PAD::PTHMask() );
+                pad->SetSize( wxSize( Millimeter2iu( 1 ), Millimeter2iu( 1 ) ) );
+                pad->SetPosition( wxPoint( jj * Millimeter2iu( 2 ), 0 ) );
+
+                // Some pads share a name, to tell the unique pad count from the pad count
+                pad->SetName( wxString::Format( "%d", jj / 2 + 1 ) );
+                module.Add( pad );
+            }
+
+            // A mounting hole, left out of the pad counts
+            D_PAD* hole = new D_PAD( &module );
+            hole->SetAttribute( PAD_ATTRIB_NPTH );
+            hole->SetLayerSet( D_PAD::UnplatedHoleMask() );
+            hole->SetSize( wxSize( Millimeter2iu( 3 ), Millimeter2iu( 3 ) ) );
+            hole->SetDrillSize( wxSize( Millimeter2iu( 3 ), Millimeter2iu( 3 ) ) );
+            module.Add( hole );
+
+            io.FootprintSave( m_libPath, &module );
+            m_names.push_back( name );
+        }
+
+        wxFFile broken( wxFileName( m_libPath, "Broken.kicad_mod" ).GetFullPath(), "wb" );
+        BOOST_REQUIRE( broken.IsOpened() );
+        broken.Write( wxString( "(module Broken (layer F.Cu) (pad 1 smd rect (at" ) );
+    }
+
+    ~FOOTPRINT_LIBRARY_FIXTURE()
+    {
+        wxFileName::Rmdir( m_libPath, wxPATH_RMDIR_RECURSIVE );
+    }
+
+    /**
+     * Parse the footprint file of \a aName, as the library used to when it was enumerated
+     */
+    std::unique_ptr<MODULE> parseFootprint( const wxString& aName )
+    {
+        LOCALE_IO        toggle;
+        FILE_LINE_READER reader( wxFileName( m_libPath, aName, "kicad_mod" ).GetFullPath() );
+        PCB_PARSER       parser( &reader );
+
+        return std::unique_ptr<MODULE>( static_cast<MODULE*>( parser.Parse() ) );
+    }
+
+    wxString              m_libPath;
+    std::vector<wxString> m_names;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( FootprintList, FOOTPRINT_LIBRARY_FIXTURE )
+
+
+/**
+ * The footprints are only parsed when the list loads their metadata.  It must be what
+ * parsing every file up front gives, and the file which does not parse must be reported.
+ */
+BOOST_AUTO_TEST_CASE( LazyMatchesEager )
+{
+    FP_LIB_TABLE table;
+    table.InsertRow( new FP_LIB_TABLE_ROW( "TestLib", m_libPath, "KiCad", wxEmptyString ) );
+
+    FOOTPRINT_LIST_IMPL list;
+    list.ReadFootprintFiles( &table );
+
+    BOOST_CHECK_EQUAL( list.GetCount(), m_names.size() + 1 );
+    BOOST_REQUIRE_EQUAL( list.GetErrorCount(), 1u );
+    BOOST_CHECK( list.PopError()->What().Contains( "Broken" ) );
+
+    for( const wxString& name : m_names )
+    {
+        BOOST_TEST_CONTEXT( name )
+        {
+            FOOTPRINT_INFO*         info = list.GetModuleInfo( "TestLib", name );
+            std::unique_ptr<MODULE> eager = parseFootprint( name );
+
+            BOOST_REQUIRE( info );
+            BOOST_CHECK_EQUAL( info->GetPadCount(), eager->GetPadCount( DO_NOT_INCLUDE_NPTH ) );
+            BOOST_CHECK_EQUAL( info->GetUniquePadCount(),
+                               eager->GetUniquePadCount( DO_NOT_INCLUDE_NPTH ) );
+            BOOST_CHECK( info->GetDescription() == eager->GetDescription() );
+            BOOST_CHECK( info->GetKeywords() == eager->GetKeywords() );
+        }
+    }
+
+    FOOTPRINT_INFO* broken = list.GetModuleInfo( "TestLib", "Broken" );
+
+    BOOST_REQUIRE( broken );
+    BOOST_CHECK_EQUAL( broken->GetPadCount(), 0u );
+}
+
+
+/**
+ * A footprint loaded from the library is a copy of the parsed one, and a footprint saved
+ * to it reads back the same, whether it was ever parsed or not.
+ */
+BOOST_AUTO_TEST_CASE( LoadAndSave )
+{
+    PCB_IO io;
+
+    std::unique_ptr<MODULE> loaded( io.FootprintLoad( m_libPath, "FP_5" ) );
+    std::unique_ptr<MODULE> eager = parseFootprint( "FP_5" );
+
+    BOOST_REQUIRE( loaded );
+    BOOST_CHECK_EQUAL( loaded->GetPadCount(), eager->GetPadCount() );
+    BOOST_CHECK( loaded->GetDescription() == eager->GetDescription() );
+
+    BOOST_CHECK( !io.FootprintLoad( m_libPath, "No_Such_Footprint" ) );
+    BOOST_CHECK_THROW( io.GetEnumeratedFootprint( m_libPath, "Broken" ), IO_ERROR );
+
+    loaded->SetDescription( "Changed" );
+    io.FootprintSave( m_libPath, loaded.get() );
+
+    BOOST_CHECK( parseFootprint( "FP_5" )->GetDescription() == "Changed" );
+    BOOST_CHECK( parseFootprint( "FP_6" )->GetDescription() == "Footprint number 6" );
+
+    PCB_IO        otherIo;
+    const MODULE* enumerated = otherIo.GetEnumeratedFootprint( m_libPath, "FP_5" );
+
+    BOOST_REQUIRE( enumerated );
+    BOOST_CHECK( enumerated->GetDescription() == "Changed" );
+}
+
+
+/**
+ * The cache file restores the list as it was saved, and a damaged or out of date cache file
+ * restores nothing.
+ */
+BOOST_AUTO_TEST_CASE( CacheFile )
+{
+    FP_LIB_TABLE table;
+    table.InsertRow( new FP_LIB_TABLE_ROW( "TestLib", m_libPath, "KiCad", wxEmptyString ) );
+
+    FOOTPRINT_LIST_IMPL list;
+    list.ReadFootprintFiles( &table );
+
+    wxString cacheFile = wxFileName::CreateTempFileName( "fp_list_cache" );
+    list.WriteCacheToFile( cacheFile );
+
+    FOOTPRINT_LIST_IMPL restored;
+    restored.ReadCacheFromFile( cacheFile );
+
+    BOOST_REQUIRE_EQUAL( restored.GetCount(), list.GetCount() );
+
+    for( unsigned ii = 0; ii < list.GetCount(); ++ii )
+    {
+        FOOTPRINT_INFO& expected = list.GetItem( ii );
+        FOOTPRINT_INFO& actual = restored.GetItem( ii );
+
+        BOOST_TEST_CONTEXT( expected.GetName() )
+        {
+            BOOST_CHECK( actual.GetName() == expected.GetName() );
+            BOOST_CHECK( actual.GetLibNickname() == expected.GetLibNickname() );
+            BOOST_CHECK( actual.GetDescription() == expected.GetDescription() );
+            BOOST_CHECK( actual.GetKeywords() == expected.GetKeywords() );
+            BOOST_CHECK_EQUAL( actual.GetPadCount(), expected.GetPadCount() );
+            BOOST_CHECK_EQUAL( actual.GetUniquePadCount(), expected.GetUniquePadCount() );
+        }
+    }
+
+    std::vector<char> data;
+    {
+        wxFFile file( cacheFile, "rb" );
+        data.resize( file.Length() );
+        BOOST_REQUIRE_EQUAL( file.Read( data.data(), data.size() ), data.size() );
+    }
+
+    auto writeCache =
+            [&]( const std::vector<char>& aData )
+            {
+                wxFFile file( cacheFile, "wb" );
+                BOOST_REQUIRE( file.IsOpened() );
+                file.Write( aData.data(), aData.size() );
+            };
+
+    // Truncated anywhere, including in the middle of the last footprint
+    for( size_t size : { (size_t) 0, (size_t) 10, data.size() / 2, data.size() - 1 } )
+    {
+        BOOST_TEST_CONTEXT( "Truncated to " << size )
+        {
+            writeCache( std::vector<char>( data.begin(), data.begin() + size ) );
+
+            FOOTPRINT_LIST_IMPL truncated;
+            truncated.ReadCacheFromFile( cacheFile );
+            BOOST_CHECK_EQUAL( truncated.GetCount(), 0u );
+        }
+    }
+
+    // Another version of the format: the version follows the magic string and its length
+    std::vector<char> otherVersion = data;
+    uint32_t          magicLength;
+
+    memcpy( &magicLength, otherVersion.data(), sizeof( magicLength ) );
+    otherVersion[ sizeof( magicLength ) + magicLength ]++;
+    writeCache( otherVersion );
+
+    FOOTPRINT_LIST_IMPL mismatched;
+    mismatched.ReadCacheFromFile( cacheFile );
+    BOOST_CHECK_EQUAL( mismatched.GetCount(), 0u );
+
+    wxRemoveFile( cacheFile );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
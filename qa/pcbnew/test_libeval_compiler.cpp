@@ -178,4 +178,117 @@ BOOST_AUTO_TEST_CASE( IntrospectedProperties )
     }
 }
 
+/**
+ * A variable which reads as a fixed number, so the code using it can't be constant-folded
+ */
+class FIXED_VAR_REF : public LIBEVAL::VAR_REF
+{
+public:
+    FIXED_VAR_REF( double aValue ) : m_value( aValue ) {}
+
+    LIBEVAL::VAR_TYPE_T GetType() const override { return LIBEVAL::VT_NUMERIC; }
+    LIBEVAL::VALUE GetValue( LIBEVAL::CONTEXT* aCtx ) override { return VAL( m_value ); }
+
+private:
+    double m_value;
+};
+
+
+/**
+ * Code which pushes many values before reducing them needs a deeper stack than a context
+ * starts with.  Run it several times on one context, as DRC does.
+ */
+BOOST_AUTO_TEST_CASE( DeepStack )
+{
+    const int depth = 200;
+
+    LIBEVAL::UCODE   ucode;
+    LIBEVAL::CONTEXT context;
+
+    for( int ii = 1; ii <= depth; ++ii )
+        ucode.AddOp( new LIBEVAL::UOP( TR_UOP_PUSH_VAR, std::make_unique<FIXED_VAR_REF>( ii ) ) );
+
+    for( int ii = 1; ii < depth; ++ii )
+        ucode.AddOp( new LIBEVAL::UOP( TR_OP_ADD, std::unique_ptr<LIBEVAL::VALUE>() ) );
+
+    for( int run = 0; run < 3; ++run )
+    {
+        LIBEVAL::VALUE* result = ucode.Run( &context );
+
+        BOOST_CHECK( !context.IsErrorPending() );
+        BOOST_CHECK_EQUAL( result->AsDouble(), depth * ( depth + 1 ) / 2.0 );
+    }
+}
+
+/**
+ * Build code from a postfix list of numbers and operators.  Numbers are pushed as constants
+ * when aFold is set, so that they can be folded, and through variables otherwise.
+ */
+static void buildUcode( LIBEVAL::UCODE& aUcode, const std::vector<std::pair<int, double>>& aCode,
+                        bool aFold )
+{
+    for( const std::pair<int, double>& op : aCode )
+    {
+        if( op.first != TR_UOP_PUSH_VALUE )
+            aUcode.AddOp( new LIBEVAL::UOP( op.first, std::unique_ptr<LIBEVAL::VALUE>() ) );
+        else if( aFold )
+            aUcode.AddOp( new LIBEVAL::UOP( op.first, std::make_unique<VAL>( op.second ) ) );
+        else
+            aUcode.AddOp( new LIBEVAL::UOP( TR_UOP_PUSH_VAR,
+                                            std::make_unique<FIXED_VAR_REF>( op.second ) ) );
+    }
+}
+
+
+/**
+ * Folding constants must not lose errors: code with constant parts has to report the same
+ * errors, and give the same result, as the same code with nothing to fold.
+ */
+BOOST_AUTO_TEST_CASE( FoldingKeepsErrors )
+{
+    const int N = TR_UOP_PUSH_VALUE;
+
+    const std::vector<std::vector<std::pair<int, double>>> cases = {
+        { { N, 1 }, { N, 2 }, { TR_OP_ADD, 0 } },
+        { { N, 1 }, { N, 2 }, { TR_OP_ADD, 0 }, { N, 4 }, { TR_OP_MUL, 0 } },
+        { { N, 1 }, { TR_OP_BOOL_NOT, 0 }, { N, 0 }, { TR_OP_BOOL_OR, 0 } },
+        // Stray operators, which only fail when run
+        { { N, 1 }, { N, 2 }, { TR_OP_ADD, 0 }, { TR_OP_SUB, 0 } },
+        { { N, 2 }, { N, 3 }, { TR_OP_MUL, 0 }, { TR_OP_ADD, 0 }, { TR_OP_BOOL_NOT, 0 } },
+        { { N, 5 }, { TR_OP_SUB, 0 }, { N, 2 }, { TR_OP_MUL, 0 } },
+        { { TR_OP_BOOL_NOT, 0 } },
+    };
+
+    for( const std::vector<std::pair<int, double>>& code : cases )
+    {
+        LIBEVAL::UCODE        folded, unfolded;
+        std::vector<wxString> foldedErrors, unfoldedErrors;
+        LIBEVAL::CONTEXT      foldedCtx, unfoldedCtx;
+
+        buildUcode( folded, code, true );
+        buildUcode( unfolded, code, false );
+
+        foldedCtx.SetErrorCallback(
+                [&]( const wxString& aMessage, int aOffset )
+                {
+                    foldedErrors.push_back( aMessage );
+                } );
+
+        unfoldedCtx.SetErrorCallback(
+                [&]( const wxString& aMessage, int aOffset )
+                {
+                    unfoldedErrors.push_back( aMessage );
+                } );
+
+        double foldedResult = folded.Run( &foldedCtx )->AsDouble();
+        double unfoldedResult = unfolded.Run( &unfoldedCtx )->AsDouble();
+
+        BOOST_TEST_MESSAGE( "Folded:\n" << folded.Dump().ToStdString() );
+
+        BOOST_CHECK_EQUAL( foldedCtx.IsErrorPending(), unfoldedCtx.IsErrorPending() );
+        BOOST_CHECK( foldedErrors == unfoldedErrors );
+        BOOST_CHECK_EQUAL( foldedResult, unfoldedResult );
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,204 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <clocale>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#include <plugins/kicad/pcb_parser.h>
+
+
+BOOST_AUTO_TEST_SUITE( PcbParser )
+
+
+/**
+ * @return true if \a aA and \a aB are the same double, down to the sign of zero
+ */
+static bool sameBits( double aA, double aB )
+{
+    return memcmp( &aA, &aB, sizeof( double ) ) == 0;
+}
+
+
+/**
+ * Check ParseDecimal() either declines \a aText or gives exactly what strtod() does
+ */
+static void checkAgainstStrtod( const std::string& aText )
+{
+    double fast = 0.0;
+    char*  end;
+    double reference = strtod( aText.c_str(), &end );
+
+    BOOST_TEST_CONTEXT( "'" << aText << "'" )
+    {
+        if( ParseDecimal( aText.c_str(), &fast ) )
+        {
+            BOOST_CHECK( *end == '\0' );
+            BOOST_CHECK( sameBits( fast, reference ) );
+        }
+    }
+}
+
+
+struct DECIMAL_CASE
+{
+    std::string m_text;
+    bool        m_fast;     ///< expected to take the fast path
+};
+
+
+BOOST_AUTO_TEST_CASE( DecimalForms )
+{
+    std::setlocale( LC_NUMERIC, "C" );
+
+    const std::vector<DECIMAL_CASE> cases = {
+        { "0", true },
+        { "-0", true },
+        { "-0.0", true },
+        { "12.5", true },
+        { "-12.3456", true },
+        { "+1.5", true },
+        { ".5", true },
+        { "5.", true },
+        { "0.1", true },
+        { "123456.123456", true },
+        { "9007199254740992", true },       // 2^53
+        { "0.0000000000000001", true },
+        // Exponents are left to strtod()
+        { "1e5", false },
+        { "1E-3", false },
+        { "-2.5e+10", false },
+        // Mantissas too long to be exact
+        { "9007199254740993", false },
+        { "12345678901234567890", false },
+        { "0.00000000000000000000001", false },
+        { "3.14159265358979323846", false },
+        // Not plain decimals at all
+        { "", false },
+        { "-", false },
+        { "+", false },
+        { ".", false },
+        { "1.2.3", false },
+        { "1,5", false },
+        { " 1", false },
+        { "0x10", false },
+        { "inf", false },
+        { "nan", false },
+    };
+
+    for( const DECIMAL_CASE& c : cases )
+    {
+        double value;
+
+        BOOST_TEST_CONTEXT( "'" << c.m_text << "'" )
+        {
+            BOOST_CHECK_EQUAL( ParseDecimal( c.m_text.c_str(), &value ), c.m_fast );
+        }
+
+        checkAgainstStrtod( c.m_text );
+    }
+}
+
+
+/**
+ * Random decimals in the shapes found in board files must match strtod() bit for bit
+ */
+BOOST_AUTO_TEST_CASE( RandomDecimals )
+{
+    std::setlocale( LC_NUMERIC, "C" );
+
+    std::mt19937 rng( 42 );
+    int          fastCount = 0;
+
+    for( int ii = 0; ii < 100000; ++ii )
+    {
+        std::string text;
+        int         intDigits = rng() % 9;
+        int         fracDigits = rng() % 13;
+
+        if( rng() % 3 == 0 )
+            text += '-';
+        else if( rng() % 10 == 0 )
+            text += '+';
+
+        for( int jj = 0; jj < intDigits; ++jj )
+            text += char( '0' + rng() % 10 );
+
+        if( fracDigits || rng() % 2 )
+        {
+            text += '.';
+
+            for( int jj = 0; jj < fracDigits; ++jj )
+                text += char( '0' + rng() % 10 );
+        }
+
+        double value;
+
+        if( ParseDecimal( text.c_str(), &value ) )
+            fastCount++;
+
+        checkAgainstStrtod( text );
+    }
+
+    // Nearly all of these should have taken the fast path
+    BOOST_CHECK_GT( fastCount, 90000 );
+}
+
+
+/**
+ * The board parser switches to the "C" locale around strtod(), but ParseDecimal() must not
+ * need to: a decimal point is a point whatever the locale says.
+ */
+BOOST_AUTO_TEST_CASE( LocaleIndependent )
+{
+    const char* commaLocales[] = { "de_DE.UTF-8", "de_DE.utf8", "fr_FR.UTF-8", "fr_FR.utf8",
+                                   "German_Germany.1252" };
+    bool        haveCommaLocale = false;
+
+    for( const char* name : commaLocales )
+    {
+        if( std::setlocale( LC_NUMERIC, name ) )
+        {
+            haveCommaLocale = true;
+            break;
+        }
+    }
+
+    double value = 0.0;
+
+    BOOST_CHECK( ParseDecimal( "-12.375", &value ) );
+    BOOST_CHECK_EQUAL( value, -12.375 );
+
+    BOOST_CHECK( !ParseDecimal( "-12,375", &value ) );
+
+    if( !haveCommaLocale )
+        BOOST_TEST_MESSAGE( "No locale with a decimal comma installed; checked \"C\" only" );
+
+    std::setlocale( LC_NUMERIC, "C" );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,150 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <algorithm>
+
+#include <wx/filename.h>
+#include <wx/textfile.h>
+
+#include <class_board.h>
+#include <pcbplot.h>
+#include <zone_filler.h>
+
+#include "board_test_utils.h"
+
+
+BOOST_AUTO_TEST_SUITE( PlotBoardLayers )
+
+
+/**
+ * @return the lines of the file \a aFileName, leaving out those holding the creation date,
+ * which differs from one plot to the next
+ */
+static std::vector<wxString> readPlotFile( const wxString& aFileName )
+{
+    std::vector<wxString> lines;
+    wxTextFile            file;
+
+    BOOST_REQUIRE( file.Open( aFileName ) );
+
+    for( size_t ii = 0; ii < file.GetLineCount(); ++ii )
+    {
+        const wxString& line = file.GetLine( ii );
+
+        if( line.Contains( "CreationDate" ) || line.Contains( "date" ) )
+            continue;
+
+        lines.push_back( line );
+    }
+
+    return lines;
+}
+
+
+static std::vector<PLOT_JOB> makeJobs( BOARD* aBoard, const wxString& aSuffix )
+{
+    std::vector<PLOT_JOB> jobs;
+    PCB_PLOT_PARAMS       plotOpts;
+
+    plotOpts.SetFormat( PLOT_FORMAT::GERBER );
+    plotOpts.SetPlotFrameRef( false );
+
+    for( PCB_LAYER_ID layer : { F_Cu, B_Cu, F_Mask, B_Mask, F_SilkS, B_SilkS, Edge_Cuts } )
+    {
+        PLOT_JOB job;
+        job.m_layer = layer;
+        job.m_plotOpts = plotOpts;
+        job.m_fullFileName = wxFileName::CreateTempFileName( "plot_" + aSuffix );
+        jobs.push_back( job );
+    }
+
+    return jobs;
+}
+
+
+/**
+ * Plotting all the layers in one call (so in parallel) must give exactly the files plotting
+ * them one at a time does, and must report every job, once, as it finishes.
+ */
+BOOST_AUTO_TEST_CASE( ParallelMatchesSerial )
+{
+    std::unique_ptr<BOARD> board = KI_TEST::MakeZoneFillBoard();
+
+    ZONE_FILLER                  filler( board.get(), nullptr );
+    std::vector<ZONE_CONTAINER*> zones = board->Zones();
+
+    BOOST_REQUIRE( filler.Fill( zones ) );
+
+    std::vector<PLOT_JOB> parallelJobs = makeJobs( board.get(), "parallel" );
+    std::vector<PLOT_JOB> serialJobs = makeJobs( board.get(), "serial" );
+    std::vector<wxString> reported;
+
+    int created = PlotBoardLayers( board.get(), parallelJobs,
+            [&]( const PLOT_JOB& aJob )
+            {
+                reported.push_back( aJob.m_fullFileName );
+            } );
+
+    BOOST_CHECK_EQUAL( created, (int) parallelJobs.size() );
+    BOOST_CHECK_EQUAL( reported.size(), parallelJobs.size() );
+
+    for( size_t ii = 0; ii < serialJobs.size(); ++ii )
+    {
+        std::vector<PLOT_JOB> job = { serialJobs[ii] };
+
+        BOOST_CHECK_EQUAL( PlotBoardLayers( board.get(), job ), 1 );
+        serialJobs[ii] = job[0];
+    }
+
+    for( size_t ii = 0; ii < parallelJobs.size(); ++ii )
+    {
+        BOOST_TEST_CONTEXT( "Layer " << board->GetLayerName( parallelJobs[ii].m_layer ) )
+        {
+            BOOST_CHECK( parallelJobs[ii].m_success );
+            BOOST_CHECK( serialJobs[ii].m_success );
+            BOOST_CHECK( std::count( reported.begin(), reported.end(),
+                                     parallelJobs[ii].m_fullFileName ) == 1 );
+
+            std::vector<wxString> parallelLines = readPlotFile( parallelJobs[ii].m_fullFileName );
+            std::vector<wxString> serialLines = readPlotFile( serialJobs[ii].m_fullFileName );
+
+            BOOST_REQUIRE_EQUAL( parallelLines.size(), serialLines.size() );
+
+            for( size_t jj = 0; jj < parallelLines.size(); ++jj )
+            {
+                BOOST_TEST_CONTEXT( "Line " << jj )
+                {
+                    BOOST_CHECK( parallelLines[jj] == serialLines[jj] );
+                }
+            }
+        }
+
+        wxRemoveFile( parallelJobs[ii].m_fullFileName );
+        wxRemoveFile( serialJobs[ii].m_fullFileName );
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
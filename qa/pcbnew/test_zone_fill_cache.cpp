@@ -0,0 +1,309 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <wx/dir.h>
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include <class_board.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <property_mgr.h>
+#include <zone_fill_cache.h>
+#include <zone_filler.h>
+#include <drc/drc_engine.h>
+#include <plugins/kicad/kicad_plugin.h>
+
+#include "board_test_utils.h"
+
+
+/**
+ * A filled board saved with its zone fill cache, and a copy of the board file without one
+ * to load it from.  (Loading the board file itself would apply the cache already if the
+ * ZoneFillCache advanced setting is on.)
+ */
+struct ZONE_FILL_CACHE_FIXTURE
+{
+    ZONE_FILL_CACHE_FIXTURE()
+    {
+        PROPERTY_MANAGER::Instance().Rebuild();
+
+        m_board = KI_TEST::MakeZoneFillBoard();
+        fillZones( m_board.get() );
+
+        wxFileName base( wxFileName::CreateTempFileName( "zone_fill_cache" ) );
+        wxRemoveFile( base.GetFullPath() );
+
+        wxFileName boardFile( base );
+        boardFile.SetExt( "kicad_pcb" );
+        m_boardFile = boardFile.GetFullPath();
+
+        wxFileName copyFile( base );
+        copyFile.SetName( base.GetName() + "_copy" );
+        copyFile.SetExt( "kicad_pcb" );
+        m_copyFile = copyFile.GetFullPath();
+
+        PCB_IO io;
+        io.Save( m_boardFile, m_board.get() );
+        wxCopyFile( m_boardFile, m_copyFile );
+    }
+
+    ~ZONE_FILL_CACHE_FIXTURE()
+    {
+        for( const wxString& file : { m_boardFile, m_copyFile,
+                                      ZONE_FILL_CACHE::CacheFileName( m_boardFile ),
+                                      ZONE_FILL_CACHE::CacheFileName( m_copyFile ) } )
+        {
+            if( wxFileName::FileExists( file ) )
+                wxRemoveFile( file );
+        }
+    }
+
+    static void fillZones( BOARD* aBoard )
+    {
+        aBoard->BuildConnectivity();
+        aBoard->GetDesignSettings().m_DRCEngine->ClearConstraintCache();
+
+        ZONE_FILLER                  filler( aBoard, nullptr );
+        std::vector<ZONE_CONTAINER*> zones = aBoard->Zones();
+
+        BOOST_REQUIRE( filler.Fill( zones ) );
+    }
+
+    /**
+     * @return the board, as loaded from the copy without a cache file
+     */
+    std::unique_ptr<BOARD> loadCopy()
+    {
+        PCB_IO                 io;
+        std::unique_ptr<BOARD> board( io.Load( m_copyFile, nullptr ) );
+        BOARD_DESIGN_SETTINGS& bds = board->GetDesignSettings();
+
+        bds.m_DRCEngine = std::make_shared<DRC_ENGINE>( board.get(), &bds );
+        bds.m_DRCEngine->InitEngine( wxFileName() );
+        board->BuildConnectivity();
+
+        return board;
+    }
+
+    /**
+     * Overwrite \a aSize bytes of the cache file at \a aOffset with \a aBytes, or cut the
+     * file at \a aOffset if \a aBytes is null
+     */
+    void damageCache( size_t aOffset, const void* aBytes, size_t aSize )
+    {
+        wxString          cacheFile = ZONE_FILL_CACHE::CacheFileName( m_boardFile );
+        std::vector<char> data;
+
+        {
+            wxFFile file( cacheFile, "rb" );
+            BOOST_REQUIRE( file.IsOpened() );
+            data.resize( file.Length() );
+            BOOST_REQUIRE_EQUAL( file.Read( data.data(), data.size() ), data.size() );
+        }
+
+        BOOST_REQUIRE_LE( aOffset + aSize, data.size() );
+
+        if( aBytes )
+            memcpy( &data[aOffset], aBytes, aSize );
+        else
+            data.resize( aOffset );
+
+        wxFFile file( cacheFile, "wb" );
+        BOOST_REQUIRE( file.IsOpened() );
+        file.Write( data.data(), data.size() );
+    }
+
+    static size_t filledZoneCount( BOARD* aBoard )
+    {
+        size_t count = 0;
+
+        for( ZONE_CONTAINER* zone : aBoard->Zones() )
+        {
+            if( zone->GetFillInputs( zone->GetLayer() ) )
+                count++;
+        }
+
+        return count;
+    }
+
+    std::unique_ptr<BOARD> m_board;
+    wxString               m_boardFile;
+    wxString               m_copyFile;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( ZoneFillCache, ZONE_FILL_CACHE_FIXTURE )
+
+
+/**
+ * The cache restores exactly what the fills were built from, and with it a board refilled
+ * straight after loading keeps all of its fills
+ */
+BOOST_AUTO_TEST_CASE( SaveAndLoad )
+{
+    wxString cacheFile = ZONE_FILL_CACHE::CacheFileName( m_boardFile );
+
+    BOOST_REQUIRE( ZONE_FILL_CACHE::Save( m_board.get(), m_boardFile ) );
+    BOOST_CHECK( wxFileName::FileExists( cacheFile ) );
+
+    // Nothing is left of the temporary file
+    wxArrayString files;
+    wxDir::GetAllFiles( wxFileName( cacheFile ).GetPath(), &files,
+                        wxT( "." ) + wxFileName( cacheFile ).GetName() + wxT( "*" ),
+                        wxDIR_FILES | wxDIR_HIDDEN );
+    BOOST_CHECK_EQUAL( files.size(), 0 );
+
+    std::unique_ptr<BOARD> board = loadCopy();
+
+    BOOST_CHECK_EQUAL( filledZoneCount( board.get() ), 0 );
+    BOOST_REQUIRE_EQUAL( ZONE_FILL_CACHE::Load( board.get(), m_boardFile ), 4 );
+    BOOST_REQUIRE_EQUAL( board->Zones().size(), m_board->Zones().size() );
+
+    std::vector<unsigned> serials;
+
+    for( size_t ii = 0; ii < board->Zones().size(); ++ii )
+    {
+        ZONE_CONTAINER*         zone = board->Zones()[ii];
+        ZONE_CONTAINER*         original = m_board->Zones()[ii];
+        PCB_LAYER_ID            layer = zone->GetLayer();
+        const ZONE_FILL_INPUTS* inputs = zone->GetFillInputs( layer );
+        const ZONE_FILL_INPUTS* originalInputs = original->GetFillInputs( layer );
+
+        BOOST_TEST_CONTEXT( "Zone " << ii )
+        {
+            BOOST_REQUIRE( inputs && originalInputs );
+            BOOST_CHECK( zone->m_Uuid == original->m_Uuid );
+            BOOST_CHECK( zone->GetFilledPolysList( layer ).IsTriangulationUpToDate() );
+            BOOST_CHECK_EQUAL( inputs->m_settingsHash, originalInputs->m_settingsHash );
+            BOOST_REQUIRE_EQUAL( inputs->m_items.size(), originalInputs->m_items.size() );
+
+            for( size_t jj = 0; jj < inputs->m_items.size(); ++jj )
+            {
+                BOOST_CHECK_EQUAL( inputs->m_items[jj].m_id, originalInputs->m_items[jj].m_id );
+                BOOST_CHECK_EQUAL( inputs->m_items[jj].m_hash,
+                                   originalInputs->m_items[jj].m_hash );
+            }
+
+            BOOST_CHECK( zone->RawPolysList( layer ).GetHash()
+                         == original->RawPolysList( layer ).GetHash() );
+
+            serials.push_back( inputs->m_serial );
+        }
+    }
+
+    fillZones( board.get() );
+
+    for( size_t ii = 0; ii < board->Zones().size(); ++ii )
+    {
+        ZONE_CONTAINER* zone = board->Zones()[ii];
+
+        BOOST_TEST_CONTEXT( "Zone " << ii << " refilled" )
+        {
+            BOOST_REQUIRE( zone->GetFillInputs( zone->GetLayer() ) );
+            BOOST_CHECK_EQUAL( zone->GetFillInputs( zone->GetLayer() )->m_serial, serials[ii] );
+        }
+    }
+}
+
+
+/**
+ * Entries whose filled areas no longer match the board's are dropped, and so is a whole
+ * file whose format version or build differs
+ */
+BOOST_AUTO_TEST_CASE( Invalidation )
+{
+    BOOST_REQUIRE( ZONE_FILL_CACHE::Save( m_board.get(), m_boardFile ) );
+
+    {
+        std::unique_ptr<BOARD> board = loadCopy();
+        ZONE_CONTAINER*        zone = board->Zones()[0];
+        SHAPE_POLY_SET         fill = zone->GetFilledPolysList( zone->GetLayer() );
+
+        // As if the zone had been refilled by some other means since
+        fill.Deflate( Millimeter2iu( 0.1 ), 16 );
+        zone->SetFilledPolysList( zone->GetLayer(), fill );
+
+        BOOST_CHECK_EQUAL( ZONE_FILL_CACHE::Load( board.get(), m_boardFile ), 3 );
+        BOOST_CHECK( !zone->GetFillInputs( zone->GetLayer() ) );
+        BOOST_CHECK_EQUAL( filledZoneCount( board.get() ), 3 );
+    }
+
+    // The format version follows the magic string
+    const uint32_t badVersion = 0xffff;
+    const size_t   versionOffset = sizeof( uint32_t ) + strlen( "KiCad zone fill cache" );
+
+    damageCache( versionOffset, &badVersion, sizeof( badVersion ) );
+
+    {
+        std::unique_ptr<BOARD> board = loadCopy();
+
+        BOOST_CHECK_EQUAL( ZONE_FILL_CACHE::Load( board.get(), m_boardFile ), 0 );
+        BOOST_CHECK_EQUAL( filledZoneCount( board.get() ), 0 );
+    }
+
+    // So does the build version
+    BOOST_REQUIRE( ZONE_FILL_CACHE::Save( m_board.get(), m_boardFile ) );
+
+    const char badBuild = '?';
+
+    damageCache( versionOffset + 2 * sizeof( uint32_t ), &badBuild, 1 );
+
+    {
+        std::unique_ptr<BOARD> board = loadCopy();
+
+        BOOST_CHECK_EQUAL( ZONE_FILL_CACHE::Load( board.get(), m_boardFile ), 0 );
+    }
+}
+
+
+/**
+ * A cache file cut short anywhere is ignored as a whole, rather than partly applied
+ */
+BOOST_AUTO_TEST_CASE( Truncated )
+{
+    wxString cacheFile = ZONE_FILL_CACHE::CacheFileName( m_boardFile );
+
+    BOOST_REQUIRE( ZONE_FILL_CACHE::Save( m_board.get(), m_boardFile ) );
+
+    size_t size = wxFileName::GetSize( cacheFile ).ToULong();
+
+    for( size_t cut : { (size_t) 0, (size_t) 3, size / 4, size / 2, size - 1 } )
+    {
+        BOOST_REQUIRE( ZONE_FILL_CACHE::Save( m_board.get(), m_boardFile ) );
+        damageCache( cut, nullptr, 0 );
+
+        std::unique_ptr<BOARD> board = loadCopy();
+
+        BOOST_TEST_CONTEXT( "Cut at " << cut << " of " << size )
+        {
+            BOOST_CHECK_EQUAL( ZONE_FILL_CACHE::Load( board.get(), m_boardFile ), 0 );
+            BOOST_CHECK_EQUAL( filledZoneCount( board.get() ), 0 );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
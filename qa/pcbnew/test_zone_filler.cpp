@@ -0,0 +1,238 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <random>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <property_mgr.h>
+#include <zone_filler.h>
+#include <drc/drc_engine.h>
+
+#include "board_test_utils.h"
+
+
+BOOST_AUTO_TEST_SUITE( ZoneFiller )
+
+
+static void fillZones( BOARD* aBoard )
+{
+    aBoard->BuildConnectivity();
+    aBoard->GetDesignSettings().m_DRCEngine->ClearConstraintCache();
+
+    ZONE_FILLER                  filler( aBoard, nullptr );
+    std::vector<ZONE_CONTAINER*> zones = aBoard->Zones();
+
+    BOOST_REQUIRE( filler.Fill( zones ) );
+}
+
+
+static void refillSplicedZones( BOARD* aBoard )
+{
+    aBoard->BuildConnectivity();
+    aBoard->GetDesignSettings().m_DRCEngine->ClearConstraintCache();
+
+    ZONE_FILLER filler( aBoard, nullptr );
+
+    BOOST_REQUIRE( filler.RefillSplicedZones() );
+}
+
+
+static unsigned fillSerial( const ZONE_CONTAINER* aZone )
+{
+    const ZONE_FILL_INPUTS* inputs = aZone->GetFillInputs( aZone->GetLayer() );
+
+    return inputs ? inputs->m_serial : 0;
+}
+
+
+/**
+ * Check the fills of \a aBoard, as they were refilled, are the fills \a aExpected (in zone
+ * order) to within rounding
+ */
+static void checkFills( BOARD* aBoard, const std::vector<SHAPE_POLY_SET>& aExpected )
+{
+    const double tolerance = (double) Millimeter2iu( 0.1 ) * Millimeter2iu( 0.1 );
+
+    BOOST_REQUIRE_EQUAL( aBoard->Zones().size(), aExpected.size() );
+
+    for( size_t ii = 0; ii < aExpected.size(); ++ii )
+    {
+        ZONE_CONTAINER* zone = aBoard->Zones()[ii];
+        SHAPE_POLY_SET  fill = zone->GetFilledPolysList( zone->GetLayer() );
+        SHAPE_POLY_SET  missing = aExpected[ii];
+        SHAPE_POLY_SET  extra = fill;
+
+        missing.BooleanSubtract( fill, SHAPE_POLY_SET::PM_FAST );
+        extra.BooleanSubtract( aExpected[ii], SHAPE_POLY_SET::PM_FAST );
+
+        BOOST_TEST_CONTEXT( "Zone " << ii )
+        {
+            BOOST_CHECK_GT( KI_TEST::PolySetArea( fill ), 0.0 );
+            BOOST_CHECK_LT( KI_TEST::PolySetArea( missing ), tolerance );
+            BOOST_CHECK_LT( KI_TEST::PolySetArea( extra ), tolerance );
+        }
+    }
+}
+
+
+/**
+ * Check the fills of \a aBoard are the fills \a aExpected (in zone order), vertex for vertex
+ */
+static void checkSameFills( BOARD* aBoard, const std::vector<SHAPE_POLY_SET>& aExpected )
+{
+    BOOST_REQUIRE_EQUAL( aBoard->Zones().size(), aExpected.size() );
+
+    for( size_t ii = 0; ii < aExpected.size(); ++ii )
+    {
+        ZONE_CONTAINER*       zone = aBoard->Zones()[ii];
+        const SHAPE_POLY_SET& fill = zone->GetFilledPolysList( zone->GetLayer() );
+        const SHAPE_POLY_SET& expected = aExpected[ii];
+
+        BOOST_TEST_CONTEXT( "Zone " << ii )
+        {
+            BOOST_REQUIRE_EQUAL( fill.OutlineCount(), expected.OutlineCount() );
+
+            for( int poly = 0; poly < fill.OutlineCount(); ++poly )
+            {
+                BOOST_REQUIRE_EQUAL( fill.CPolygon( poly ).size(),
+                                     expected.CPolygon( poly ).size() );
+
+                for( size_t contour = 0; contour < fill.CPolygon( poly ).size(); ++contour )
+                {
+                    const SHAPE_LINE_CHAIN& chain = fill.CPolygon( poly )[contour];
+                    const SHAPE_LINE_CHAIN& expectedChain = expected.CPolygon( poly )[contour];
+
+                    BOOST_REQUIRE_EQUAL( chain.PointCount(), expectedChain.PointCount() );
+
+                    for( int pt = 0; pt < chain.PointCount(); ++pt )
+                        BOOST_CHECK_EQUAL( chain.CPoint( pt ), expectedChain.CPoint( pt ) );
+                }
+            }
+        }
+    }
+}
+
+
+/**
+ * Edit a filled board a little at a time, refilling it after each edit.  The fills updated
+ * in place must match the fills a full refill gives, and zones out of reach of an edit must
+ * not be refilled at all.  Once the spliced fills are refilled, as before saving or plotting,
+ * the fills must be the full refill's exactly.
+ */
+BOOST_AUTO_TEST_CASE( IncrementalMatchesFull )
+{
+    PROPERTY_MANAGER::Instance().Rebuild();
+
+    std::unique_ptr<BOARD> board = KI_TEST::MakeZoneFillBoard();
+    std::mt19937           rng( 7 );
+
+    auto offset =
+            [&]() -> wxPoint
+            {
+                return wxPoint( Millimeter2iu( 0.1 * ( (int) ( rng() % 41 ) - 20 ) ),
+                                Millimeter2iu( 0.1 * ( (int) ( rng() % 41 ) - 20 ) ) );
+            };
+
+    fillZones( board.get() );
+
+    for( int round = 0; round < 12; ++round )
+    {
+        std::vector<unsigned> serials;
+
+        for( ZONE_CONTAINER* zone : board->Zones() )
+            serials.push_back( fillSerial( zone ) );
+
+        // Track 0 is on F.Cu, well away from the VCC zone there
+        TRACK*  track = board->Tracks()[ round == 0 ? 0 : rng() % board->Tracks().size() ];
+        D_PAD*  pad = board->Modules().front()->Pads()[ rng() % 6 ];
+
+        switch( round == 0 ? 0 : rng() % 4 )
+        {
+        case 0:
+            track->Move( offset() );
+            break;
+
+        case 1:
+            track->SetWidth( track->GetWidth() + Millimeter2iu( 0.1 ) );
+            break;
+
+        case 2:
+            pad->SetPosition( pad->GetPosition() + offset() );
+            break;
+
+        case 3:
+            pad->SetNetCode( board->Modules().front()->Pads()[ rng() % 6 ]->GetNetCode() );
+            break;
+        }
+
+        fillZones( board.get() );
+
+        if( round == 0 )
+        {
+            BOOST_TEST_CONTEXT( "Untouched zones kept their fills" )
+            {
+                BOOST_CHECK_EQUAL( fillSerial( board->Zones()[1] ), serials[1] );
+                BOOST_CHECK_EQUAL( fillSerial( board->Zones()[2] ), serials[2] );
+                BOOST_CHECK_EQUAL( fillSerial( board->Zones()[3] ), serials[3] );
+                BOOST_CHECK_NE( fillSerial( board->Zones()[0] ), serials[0] );
+            }
+        }
+
+        std::vector<SHAPE_POLY_SET> incremental;
+
+        for( ZONE_CONTAINER* zone : board->Zones() )
+            incremental.push_back( zone->GetFilledPolysList( zone->GetLayer() ) );
+
+        // As before saving or plotting
+        refillSplicedZones( board.get() );
+
+        std::vector<SHAPE_POLY_SET> finished;
+
+        for( ZONE_CONTAINER* zone : board->Zones() )
+        {
+            BOOST_CHECK( !zone->HasSplicedFill() );
+            finished.push_back( zone->GetFilledPolysList( zone->GetLayer() ) );
+        }
+
+        // A fill of another version can't be updated, so this refills everything from scratch
+        for( ZONE_CONTAINER* zone : board->Zones() )
+            zone->SetFillVersion( 0 );
+
+        fillZones( board.get() );
+
+        BOOST_TEST_CONTEXT( "Round " << round )
+        {
+            checkFills( board.get(), incremental );
+            checkSameFills( board.get(), finished );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
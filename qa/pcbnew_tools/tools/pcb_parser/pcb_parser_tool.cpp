@@ -24,6 +24,8 @@
 #include <qa_utils/utility_registry.h>
 
 #include <cstdio>
+#include <fstream>
+#include <sstream>
 #include <string>
 
 #include <common.h>
@@ -31,13 +33,16 @@
 
 #include <wx/cmdline.h>
 
+#include <class_board.h>
 #include <class_board_item.h>
 #include <plugins/kicad/kicad_plugin.h>
 #include <plugins/kicad/pcb_parser.h>
 #include <richio.h>
 
 #include <wx/cmdline.h>
+#include <wx/filename.h>
 
+#include <pcbnew_utils/board_file_utils.h>
 #include <qa_utils/stdstream_line_reader.h>
 #include <qa_utils/utility_registry.h>
 
@@ -85,10 +90,68 @@ bool parse( std::istream& aStream, bool aVerbose )
 }
 
 
+static std::string readFile( const wxString& aFilename )
+{
+    std::ifstream      fin( aFilename.ToStdString(), std::ios::binary );
+    std::ostringstream contents;
+
+    contents << fin.rdbuf();
+
+    return contents.str();
+}
+
+
+/**
+ * Load a board the way pcbnew does, save it, then load and save the saved copy.  Both saved
+ * files must be identical, so anything the parser reads differently from what the formatter
+ * wrote shows up as a difference.
+ *
+ * @return true if the round trip was lossless
+ */
+bool roundTrip( const wxString& aFilename, bool aVerbose )
+{
+    wxString first = wxFileName::CreateTempFileName( "pcb_parser" );
+    wxString second = wxFileName::CreateTempFileName( "pcb_parser" );
+    bool     ok = false;
+
+    try
+    {
+        PCB_IO io;
+
+        PROF_COUNTER timer;
+        std::unique_ptr<BOARD> board( io.Load( aFilename, nullptr ) );
+        PARSE_DURATION duration = timer.SinceStart<PARSE_DURATION>();
+
+        KI_TEST::DumpBoardToFile( *board, first.ToStdString() );
+
+        std::unique_ptr<BOARD> reloaded( io.Load( first, nullptr ) );
+        KI_TEST::DumpBoardToFile( *reloaded, second.ToStdString() );
+
+        ok = readFile( first ) == readFile( second );
+
+        if( aVerbose )
+            std::cout << "Load took: " << duration.count() << "us" << std::endl;
+    }
+    catch( const IO_ERROR& e )
+    {
+        std::cerr << e.What().ToStdString() << std::endl;
+    }
+
+    wxRemoveFile( first );
+    wxRemoveFile( second );
+
+    std::cout << "Round trip " << ( ok ? "OK" : "FAILED" ) << ": " << aFilename << std::endl;
+
+    return ok;
+}
+
+
 static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
     { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
             wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
     { wxCMD_LINE_SWITCH, "v", "verbose", _( "print parsing information" ).mb_str() },
+    { wxCMD_LINE_SWITCH, "r", "roundtrip",
+            _( "load, save and reload each input file, checking the saved copies match" ).mb_str() },
     { wxCMD_LINE_PARAM, nullptr, nullptr, _( "input file" ).mb_str(), wxCMD_LINE_VAL_STRING,
             wxCMD_LINE_PARAM_OPTIONAL | wxCMD_LINE_PARAM_MULTIPLE },
     { wxCMD_LINE_NONE }
@@ -123,6 +186,7 @@ int pcb_parser_main_func( int argc, char** argv )
     }
 
     const bool verbose = cl_parser.Found( "verbose" );
+    const bool roundtrip = cl_parser.Found( "roundtrip" );
 
     bool ok = true;
 
@@ -149,6 +213,12 @@ int pcb_parser_main_func( int argc, char** argv )
             if( verbose )
                 std::cout << "Parsing: " << filename << std::endl;
 
+            if( roundtrip )
+            {
+                ok = roundTrip( cl_parser.GetParam( i ), verbose ) && ok;
+                continue;
+            }
+
             std::ifstream fin;
             fin.open( filename );
 
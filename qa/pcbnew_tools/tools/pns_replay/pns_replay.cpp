@@ -0,0 +1,371 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file pns_replay.cpp
+ * Benchmark of the interactive router, driven by recorded PNS::LOGGER sessions.
+ *
+ * The sessions are saved by the router tool (with the '0' key, in debug builds) along with the
+ * board they were recorded on. Replaying them drives PNS::ROUTER through the headless
+ * PNS_KICAD_IFACE_BASE, and reports the latency percentiles of the routing events, along with
+ * the time spent in the shove, walkaround, optimizer and index queries, and their iterations,
+ * as counted by PNS::STATS.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <wx/cmdline.h>
+#include <wx/filename.h>
+
+#include <pcbnew_utils/board_file_utils.h>
+#include <qa_utils/utility_registry.h>
+
+#include <class_board.h>
+#include <drc/drc_engine.h>
+#include <profile.h>
+#include <wildcards_and_files_ext.h>
+
+#include <router/pns_debug_decorator.h>
+#include <router/pns_kicad_iface.h>
+#include <router/pns_logger.h>
+#include <router/pns_node.h>
+#include <router/pns_router.h>
+#include <router/pns_routing_settings.h>
+#include <router/pns_sizes_settings.h>
+#include <router/pns_stats.h>
+
+
+/**
+ * One recorded routing event.
+ */
+struct REPLAY_EVENT
+{
+    PNS::LOGGER::EVENT_TYPE m_type;
+    VECTOR2I                m_p;
+    KIID                    m_uuid;
+};
+
+
+static const char* const EVENT_NAMES[] = { "start-route", "start-drag", "fix", "move", "abort" };
+
+static const int EVENT_TYPE_COUNT = sizeof( EVENT_NAMES ) / sizeof( EVENT_NAMES[0] );
+
+
+/**
+ * Read the events saved by PNS::LOGGER::Save().
+ */
+static bool readEvents( const std::string& aFilename, std::vector<REPLAY_EVENT>& aEvents )
+{
+    std::ifstream fin( aFilename );
+    std::string   line;
+
+    if( !fin )
+        return false;
+
+    while( std::getline( fin, line ) )
+    {
+        std::istringstream stream( line );
+        std::string        tag;
+        std::string        id;
+        int                type;
+        int                x, y;
+
+        if( !( stream >> tag ) )
+            continue;
+
+        if( tag != "event" || !( stream >> type >> x >> y >> id ) )
+            return false;
+
+        if( type < 0 || type >= EVENT_TYPE_COUNT )
+            return false;
+
+        aEvents.push_back( { static_cast<PNS::LOGGER::EVENT_TYPE>( type ), VECTOR2I( x, y ),
+                             id == "null" ? niluuid : KIID( wxString( id ) ) } );
+    }
+
+    return true;
+}
+
+
+static const char* const COUNTER_NAMES[] = { "shove", "walkaround", "optimizer", "index-query" };
+
+
+/**
+ * Return the \a aPercentile percentile of the sorted \a aTimes, by nearest rank.
+ */
+static double percentile( const std::vector<double>& aTimes, int aPercentile )
+{
+    size_t rank = ( aTimes.size() * aPercentile + 99 ) / 100;
+
+    return aTimes[std::max<size_t>( rank, 1 ) - 1];
+}
+
+
+/**
+ * Replay \a aEvents on \a aBoard, and add the time of each event to the times of its type in
+ * \a aTimes.
+ */
+static void replay( BOARD* aBoard, const std::vector<REPLAY_EVENT>& aEvents, PNS::PNS_MODE aMode,
+                    std::vector<double> aTimes[] )
+{
+    PNS_KICAD_IFACE_BASE  iface;
+    PNS::DEBUG_DECORATOR  dbg;
+    PNS::ROUTER           router;
+    PNS::ROUTING_SETTINGS settings( nullptr, "tools.pns" );
+
+    settings.SetMode( aMode );
+
+    iface.SetBoard( aBoard );
+    iface.SetDebugDecorator( &dbg );
+
+    router.SetInterface( &iface );
+    router.ClearWorld();
+    router.SyncWorld();
+    router.LoadSettings( &settings );
+
+    bool dragging = false;
+
+    for( const REPLAY_EVENT& evt : aEvents )
+    {
+        PNS::ITEM* item = nullptr;
+
+        if( evt.m_uuid != niluuid )
+            item = router.GetWorld()->FindItemByParent( aBoard->GetItem( evt.m_uuid ) );
+
+        PROF_COUNTER timer;
+
+        switch( evt.m_type )
+        {
+        case PNS::LOGGER::EVT_START_ROUTE:
+        {
+            router.StopRouting();
+
+            // The log doesn't record the layer: start on the first layer of the start item
+            PNS::SIZES_SETTINGS sizes( router.Sizes() );
+            iface.ImportSizes( sizes, item, -1 );
+            router.UpdateSizes( sizes );
+
+            router.StartRouting( evt.m_p, item, item ? item->Layers().Start() : F_Cu );
+            dragging = false;
+            break;
+        }
+
+        case PNS::LOGGER::EVT_START_DRAG:
+            router.StopRouting();
+            dragging = item && router.StartDragging( evt.m_p, item );
+            break;
+
+        case PNS::LOGGER::EVT_MOVE:
+            if( router.RoutingInProgress() )
+                router.Move( evt.m_p, item );
+
+            break;
+
+        case PNS::LOGGER::EVT_FIX:
+            if( router.RoutingInProgress() && ( router.FixRoute( evt.m_p, item ) || dragging ) )
+                router.StopRouting();
+
+            break;
+
+        case PNS::LOGGER::EVT_ABORT:
+            router.StopRouting();
+            break;
+        }
+
+        timer.Stop();
+
+        aTimes[evt.m_type].push_back( timer.msecs() );
+    }
+
+    router.StopRouting();
+}
+
+
+static bool run( const std::string& aBoardFile, const std::string& aLogFile, PNS::PNS_MODE aMode,
+                 int aRepeat )
+{
+    std::vector<REPLAY_EVENT> events;
+
+    if( !readEvents( aLogFile, events ) )
+    {
+        std::cerr << "Cannot read the events of " << aLogFile << std::endl;
+        return false;
+    }
+
+    std::unique_ptr<BOARD> board = KI_TEST::ReadBoardFromFileOrStream( aBoardFile );
+
+    if( !board )
+        return false;
+
+    BOARD_DESIGN_SETTINGS& bds = board->GetDesignSettings();
+    bds.m_DRCEngine = std::make_shared<DRC_ENGINE>( board.get(), &bds );
+
+    try
+    {
+        wxFileName rules( aBoardFile );
+        rules.SetExt( DesignRulesFileExtension );
+        bds.m_DRCEngine->InitEngine( rules );
+    }
+    catch( ... )
+    {
+        // Best efforts: the default rules are enough for benchmarks
+    }
+
+    std::vector<double> times[EVENT_TYPE_COUNT + 1];
+
+    PNS::STATS::Reset();
+    PNS::STATS::Enable( true );
+
+    // The headless interface doesn't write the routes back to the board, so every run starts
+    // from the same world
+    for( int ii = 0; ii < aRepeat; ++ii )
+        replay( board.get(), events, aMode, times );
+
+    PNS::STATS::Enable( false );
+
+    // The last list gathers the times of all the events
+    std::vector<double>& all = times[EVENT_TYPE_COUNT];
+
+    for( int ii = 0; ii < EVENT_TYPE_COUNT; ++ii )
+        all.insert( all.end(), times[ii].begin(), times[ii].end() );
+
+    printf( "%-12s %8s %12s %10s %10s %10s %10s\n", "event", "count", "total (ms)", "p50 (ms)",
+            "p90 (ms)", "p99 (ms)", "max (ms)" );
+
+    for( int ii = 0; ii <= EVENT_TYPE_COUNT; ++ii )
+    {
+        std::vector<double>& t = times[ii];
+
+        if( t.empty() )
+            continue;
+
+        std::sort( t.begin(), t.end() );
+
+        double total = 0.0;
+
+        for( double time : t )
+            total += time;
+
+        printf( "%-12s %8d %12.2f %10.3f %10.3f %10.3f %10.3f\n",
+                ii < EVENT_TYPE_COUNT ? EVENT_NAMES[ii] : "all", (int) t.size() / aRepeat,
+                total / aRepeat, percentile( t, 50 ), percentile( t, 90 ), percentile( t, 99 ),
+                t.back() );
+    }
+
+    // Times are inclusive: shoves include walkarounds, and all include index queries
+    printf( "\n%-12s %10s %12s %10s %12s\n", "algorithm", "calls", "total (ms)", "mean (ms)",
+            "iterations" );
+
+    for( int ii = 0; ii < PNS::STATS::COUNTER_COUNT; ++ii )
+    {
+        auto    counter = static_cast<PNS::STATS::COUNTER>( ii );
+        int64_t calls = PNS::STATS::Calls( counter );
+
+        printf( "%-12s %10lld %12.2f %10.4f %12lld\n", COUNTER_NAMES[ii],
+                (long long) ( calls / aRepeat ), PNS::STATS::Msecs( counter ) / aRepeat,
+                calls ? PNS::STATS::Msecs( counter ) / calls : 0.0,
+                (long long) ( PNS::STATS::Iterations( counter ) / aRepeat ) );
+    }
+
+    return true;
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "m", "mode",
+            _( "routing mode: walkaround (default), shove or mark" ).mb_str(),
+            wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_OPTION, "r", "repeat", _( "number of replays of the log (default 3)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_PARAM, nullptr, nullptr, _( "board file" ).mb_str(), wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_PARAM, nullptr, nullptr, _( "router log file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum PNS_REPLAY_RET_CODES
+{
+    REPLAY_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+};
+
+
+int pns_replay_main_func( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText(
+            _( "This program replays a router log, as saved by the router tool, on the board it "
+               "was recorded on, and reports the latency of the routing events and the time "
+               "spent in the routing algorithms." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    PNS::PNS_MODE mode = PNS::RM_Walkaround;
+    wxString      modeName;
+
+    if( cl_parser.Found( "mode", &modeName ) )
+    {
+        if( modeName == "shove" )
+            mode = PNS::RM_Shove;
+        else if( modeName == "mark" )
+            mode = PNS::RM_MarkObstacles;
+        else if( modeName != "walkaround" )
+            return KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long repeat = 3;
+    cl_parser.Found( "repeat", &repeat );
+
+    if( repeat < 1 )
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+
+    if( !run( cl_parser.GetParam( 0 ).ToStdString(), cl_parser.GetParam( 1 ).ToStdString(), mode,
+              repeat ) )
+    {
+        return PNS_REPLAY_RET_CODES::REPLAY_FAILED;
+    }
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( {
+        "pns_replay",
+        "Replay recorded router sessions and report the router latency and profile",
+        pns_replay_main_func,
+} );
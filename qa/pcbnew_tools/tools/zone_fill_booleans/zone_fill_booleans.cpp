@@ -0,0 +1,359 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file zone_fill_booleans.cpp
+ * Benchmark of the polygon boolean operations of zone fills.
+ *
+ * The workloads are captured from real boards: the outline of each zone layer and its
+ * clearance holes, as built by ZONE_FILLER.  Replaying them times the merge of the holes and
+ * their subtraction from the outline, the way they were done before (a single merge of all the
+ * holes) and the way ZONE_FILLER does them now (merges by groups, on the thread pool).
+ */
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <wx/cmdline.h>
+#include <wx/filename.h>
+
+#include <geometry/shape_poly_set.h>
+#include <pcbnew_utils/board_file_utils.h>
+#include <qa_utils/utility_registry.h>
+
+#include <class_board.h>
+#include <class_zone.h>
+#include <drc/drc_engine.h>
+#include <profile.h>
+#include <thread_pool.h>
+#include <wildcards_and_files_ext.h>
+#include <zone_filler.h>
+
+
+/**
+ * One captured workload: the outline of a zone layer and its clearance holes.
+ */
+struct BOOLEAN_WORKLOAD
+{
+    std::string    m_name;
+    SHAPE_POLY_SET m_outline;
+    SHAPE_POLY_SET m_holes;
+};
+
+
+/**
+ * Write \a aSet in the format read by SHAPE_POLY_SET::Parse().
+ */
+static void writePolySet( std::ostream& aStream, const SHAPE_POLY_SET& aSet )
+{
+    aStream << "polyset " << aSet.OutlineCount() << "\n";
+
+    for( int ii = 0; ii < aSet.OutlineCount(); ++ii )
+    {
+        const SHAPE_POLY_SET::POLYGON& poly = aSet.CPolygon( ii );
+
+        aStream << "poly " << poly.size() << "\n";
+
+        for( const SHAPE_LINE_CHAIN& chain : poly )
+        {
+            aStream << chain.PointCount();
+
+            for( int jj = 0; jj < chain.PointCount(); ++jj )
+                aStream << " " << chain.CPoint( jj ).x << " " << chain.CPoint( jj ).y;
+
+            aStream << "\n";
+        }
+    }
+}
+
+
+static bool readWorkloads( const std::string& aFilename,
+                           std::vector<BOOLEAN_WORKLOAD>& aWorkloads )
+{
+    std::ifstream     fin( aFilename, std::ios::binary );
+    std::stringstream stream;
+    std::string       tag;
+
+    if( !fin )
+        return false;
+
+    stream << fin.rdbuf();
+
+    while( stream >> tag )
+    {
+        BOOLEAN_WORKLOAD workload;
+
+        if( tag != "workload" || !( stream >> workload.m_name ) )
+            return false;
+
+        if( !workload.m_outline.Parse( stream ) || !workload.m_holes.Parse( stream ) )
+            return false;
+
+        aWorkloads.push_back( std::move( workload ) );
+    }
+
+    return true;
+}
+
+
+static double area( const SHAPE_POLY_SET& aSet )
+{
+    double total = 0.0;
+
+    for( int ii = 0; ii < aSet.OutlineCount(); ++ii )
+    {
+        total += std::abs( aSet.COutline( ii ).Area() );
+
+        for( int jj = 0; jj < aSet.HoleCount( ii ); ++jj )
+            total -= std::abs( aSet.CHole( ii, jj ).Area() );
+    }
+
+    return total;
+}
+
+
+/**
+ * Fill the zones of \a aBoardFile and write the boolean workloads of their fills to
+ * \a aWorkloadFile.
+ */
+static bool capture( const std::string& aBoardFile, const std::string& aWorkloadFile )
+{
+    std::unique_ptr<BOARD> board = KI_TEST::ReadBoardFromFileOrStream( aBoardFile );
+
+    if( !board )
+        return false;
+
+    BOARD_DESIGN_SETTINGS& bds = board->GetDesignSettings();
+    bds.m_DRCEngine = std::make_shared<DRC_ENGINE>( board.get(), &bds );
+
+    try
+    {
+        wxFileName rules( aBoardFile );
+        rules.SetExt( DesignRulesFileExtension );
+        bds.m_DRCEngine->InitEngine( rules );
+    }
+    catch( ... )
+    {
+        // Best efforts: the default rules are enough for benchmarks
+    }
+
+    board->BuildConnectivity();
+
+    std::ofstream fout( aWorkloadFile, std::ios::binary );
+    std::mutex    lock;
+    int           count = 0;
+
+    if( !fout )
+        return false;
+
+    ZONE_FILLER filler( board.get(), nullptr );
+
+    filler.SetClearanceHolesObserver(
+            [&]( const ZONE_CONTAINER* aZone, PCB_LAYER_ID aLayer, const SHAPE_POLY_SET& aOutline,
+                 const SHAPE_POLY_SET& aHoles )
+            {
+                std::lock_guard<std::mutex> guard( lock );
+
+                fout << "workload " << aZone->m_Uuid.AsString().ToStdString() << "/"
+                     << wxString( LSET::Name( aLayer ) ).ToStdString() << "\n";
+                writePolySet( fout, aOutline );
+                writePolySet( fout, aHoles );
+                count++;
+            } );
+
+    std::vector<ZONE_CONTAINER*> zones = board->Zones();
+
+    filler.Fill( zones );
+
+    std::cout << "Captured " << count << " workloads from " << aBoardFile << std::endl;
+
+    return count > 0;
+}
+
+
+/**
+ * Time the merge of the holes and their subtraction from the outline of each workload, both
+ * with a single merge and with merges by groups.
+ */
+static bool replay( const std::string& aWorkloadFile, int aRepeat )
+{
+    std::vector<BOOLEAN_WORKLOAD> workloads;
+
+    if( !readWorkloads( aWorkloadFile, workloads ) )
+    {
+        std::cerr << "Cannot read workloads from " << aWorkloadFile << std::endl;
+        return false;
+    }
+
+    double totalSingle = 0.0;
+    double totalGrouped = 0.0;
+    bool   ok = true;
+
+    printf( "%-48s %8s %12s %12s %8s\n", "workload", "holes", "single (ms)", "grouped (ms)",
+            "speedup" );
+
+    for( const BOOLEAN_WORKLOAD& workload : workloads )
+    {
+        double         single = 0.0;
+        double         grouped = 0.0;
+        SHAPE_POLY_SET singleResult;
+        SHAPE_POLY_SET groupedResult;
+
+        for( int ii = 0; ii < aRepeat; ++ii )
+        {
+            SHAPE_POLY_SET holes = workload.m_holes;
+
+            singleResult = workload.m_outline;
+
+            PROF_COUNTER timer;
+            holes.Simplify( SHAPE_POLY_SET::PM_FAST );
+            singleResult.BooleanSubtract( holes, SHAPE_POLY_SET::PM_FAST );
+            timer.Stop();
+
+            single += timer.msecs();
+        }
+
+        for( int ii = 0; ii < aRepeat; ++ii )
+        {
+            SHAPE_POLY_SET holes = workload.m_holes;
+
+            groupedResult = workload.m_outline;
+
+            PROF_COUNTER timer;
+            holes.SimplifyByGroups( SHAPE_POLY_SET::PM_FAST,
+                    []( std::vector<std::function<void()>>& aTasks )
+                    {
+                        GetKiCadThreadPool().RunAll( aTasks );
+                    } );
+            groupedResult.BooleanSubtract( holes, SHAPE_POLY_SET::PM_FAST );
+            timer.Stop();
+
+            grouped += timer.msecs();
+        }
+
+        single /= aRepeat;
+        grouped /= aRepeat;
+        totalSingle += single;
+        totalGrouped += grouped;
+
+        // The merges round the intersections of the holes differently, so only the areas are
+        // expected to match
+        double singleArea = area( singleResult );
+        double groupedArea = area( groupedResult );
+
+        if( std::abs( singleArea - groupedArea ) > 1e-6 * std::max( singleArea, 1.0 ) )
+        {
+            std::cerr << workload.m_name << ": results differ (areas " << singleArea << " and "
+                      << groupedArea << ")" << std::endl;
+            ok = false;
+        }
+
+        printf( "%-48s %8d %12.2f %12.2f %7.2fx\n", workload.m_name.c_str(),
+                workload.m_holes.OutlineCount(), single, grouped,
+                grouped > 0.0 ? single / grouped : 0.0 );
+    }
+
+    printf( "%-48s %8s %12.2f %12.2f %7.2fx\n", "total", "", totalSingle, totalGrouped,
+            totalGrouped > 0.0 ? totalSingle / totalGrouped : 0.0 );
+
+    return ok;
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_SWITCH, "c", "capture",
+            _( "fill the zones of the given board, and write their workloads to the given "
+               "workload file" ).mb_str() },
+    { wxCMD_LINE_OPTION, "r", "repeat", _( "number of runs of each workload (default 3)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_PARAM, nullptr, nullptr,
+            _( "board and workload files, or workload file" ).mb_str(), wxCMD_LINE_VAL_STRING,
+            wxCMD_LINE_PARAM_MULTIPLE },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum ZONE_FILL_BOOLEANS_RET_CODES
+{
+    CAPTURE_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+    REPLAY_FAILED,
+};
+
+
+int zone_fill_booleans_main_func( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText(
+            _( "This program captures the polygon boolean workloads of the zone fills of a "
+               "board (with --capture <board> <workload file>), or replays them to time the "
+               "boolean operations (with <workload file>)." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    if( cl_parser.Found( "capture" ) )
+    {
+        if( cl_parser.GetParamCount() != 2 )
+            return KI_TEST::RET_CODES::BAD_CMDLINE;
+
+        if( !capture( cl_parser.GetParam( 0 ).ToStdString(),
+                      cl_parser.GetParam( 1 ).ToStdString() ) )
+        {
+            return ZONE_FILL_BOOLEANS_RET_CODES::CAPTURE_FAILED;
+        }
+
+        return KI_TEST::RET_CODES::OK;
+    }
+
+    long repeat = 3;
+    cl_parser.Found( "repeat", &repeat );
+
+    if( cl_parser.GetParamCount() != 1 || repeat < 1 )
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+
+    if( !replay( cl_parser.GetParam( 0 ).ToStdString(), repeat ) )
+        return ZONE_FILL_BOOLEANS_RET_CODES::REPLAY_FAILED;
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( {
+        "zone_fill_booleans",
+        "Capture and replay the polygon boolean workloads of zone fills",
+        zone_fill_booleans_main_func,
+} );